@@ -0,0 +1,103 @@
+//culls each instance's meshlets against the view frustum and their normal cones
+//every meshlet gets its indirect draw written, the ones that can't be seen just draw no instances
+#define GROUP_SIZE 64
+
+struct MeshletInfo
+{
+    float4 boundingSphere;
+    float4 cone;
+    uint firstIndex;
+    uint indexCount;
+    uint vertexCount;
+    uint padding;
+};
+
+struct CullInstance
+{
+    float4x4 modelMatrix;
+    float4 cameraPosition;
+    uint firstMeshlet;
+    uint meshletCount;
+    uint instanceIndex;
+    uint firstCommand;
+    uint cullMode;
+    uint3 padding;
+};
+
+struct DrawIndexedCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+StructuredBuffer<MeshletInfo> meshlets : register(t0);
+StructuredBuffer<CullInstance> instances : register(t1);
+RWStructuredBuffer<DrawIndexedCommand> commands : register(u2);
+
+struct CullConstants
+{
+    float4 frustumPlanes[6];
+    uint instanceCount;
+};
+
+[[vk::push_constant]] CullConstants cullConstants;
+
+bool IsVisible(CullInstance instance, MeshletInfo meshlet)
+{
+    if (instance.cullMode == 0)
+    {
+        return true;
+    }
+
+    float3 center = mul(instance.modelMatrix, float4(meshlet.boundingSphere.xyz, 1.0)).xyz;
+    float radius = meshlet.boundingSphere.w * instance.cameraPosition.w;
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (dot(cullConstants.frustumPlanes[i].xyz, center) + cullConstants.frustumPlanes[i].w < -radius)
+        {
+            return false;
+        }
+    }
+
+    //done in the mesh's own space, where the cone was built, the camera was moved there on the CPU
+    if (instance.cullMode == 2)
+    {
+        float3 offset = meshlet.boundingSphere.xyz - instance.cameraPosition.xyz;
+
+        if (dot(offset, meshlet.cone.xyz) >= meshlet.cone.w * length(offset) + meshlet.boundingSphere.w)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void CSMain(uint3 groupId : SV_GroupID, uint groupIndex : SV_GroupIndex)
+{
+    if (groupId.x >= cullConstants.instanceCount)
+    {
+        return;
+    }
+
+    CullInstance instance = instances[groupId.x];
+
+    for (uint i = groupIndex; i < instance.meshletCount; i += GROUP_SIZE)
+    {
+        MeshletInfo meshlet = meshlets[instance.firstMeshlet + i];
+
+        DrawIndexedCommand command;
+        command.indexCount = meshlet.indexCount;
+        command.instanceCount = IsVisible(instance, meshlet) ? 1 : 0;
+        command.firstIndex = meshlet.firstIndex;
+        command.vertexOffset = 0;
+        command.firstInstance = instance.instanceIndex;
+
+        commands[instance.firstCommand + i] = command;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+//tiled deferred lighting, each 16x16 tile culls the light list against the depth range it covers
+//then every pixel only loops over the lights that reach its tile, so the cost no longer depends on overdraw
+#define TILE_SIZE 16
+#define MAX_TILE_LIGHTS 256
+
+cbuffer GlobalInfo : register(b0)
+{
+    float4x4 view;
+    float4x4 projection;
+    float4 cameraPosition;
+    uint lightCount;
+}
+
+#include "Lighting.hlsli"
+
+Texture2D<float4> gAlbedo : register(t5);
+Texture2D<float4> gAmbient : register(t6);
+Texture2D<float4> gNormal : register(t7);
+Texture2D<float4> gSpecular : register(t8);
+Texture2D<float> gDepth : register(t9);
+
+RWTexture2D<float4> litImage : register(u10);
+
+cbuffer DeferredInfo : register(b12)
+{
+    float4x4 inverseView;
+    float4x4 inverseProjection;
+    uint screenWidth;
+    uint screenHeight;
+}
+
+groupshared uint tileMinDepth;
+groupshared uint tileMaxDepth;
+groupshared uint tileLightCount;
+groupshared uint tileLights[MAX_TILE_LIGHTS];
+
+float3 ViewPositionFromDepth(float2 screenPosition, float depth)
+{
+    float2 ndc = (screenPosition / float2(screenWidth, screenHeight)) * 2.0 - 1.0;
+    float4 viewPosition = mul(inverseProjection, float4(ndc, depth, 1.0));
+    
+    return viewPosition.xyz / viewPosition.w;
+}
+
+[numthreads(TILE_SIZE, TILE_SIZE, 1)]
+void CSMain(uint3 groupId : SV_GroupID, uint3 dispatchId : SV_DispatchThreadID, uint groupIndex : SV_GroupIndex)
+{
+    if (groupIndex == 0)
+    {
+        tileMinDepth = 0xFFFFFFFF;
+        tileMaxDepth = 0;
+        tileLightCount = 0;
+    }
+    
+    GroupMemoryBarrierWithGroupSync();
+    
+    uint2 pixel = dispatchId.xy;
+    bool onScreen = pixel.x < screenWidth && pixel.y < screenHeight;
+    
+    float depth = onScreen ? gDepth.Load(int3(pixel, 0)) : 1.0;
+    bool hasGeometry = depth < 1.0;
+    
+    //depths are positive so their bit patterns sort the same way the floats do
+    if (hasGeometry)
+    {
+        InterlockedMin(tileMinDepth, asuint(depth));
+        InterlockedMax(tileMaxDepth, asuint(depth));
+    }
+    
+    GroupMemoryBarrierWithGroupSync();
+    
+    //nothing but background in the tile, the composite pass leaves those pixels alone
+    if (tileMaxDepth == 0)
+    {
+        return;
+    }
+    
+    //view space box around the part of the frustum the tile's geometry lies in
+    float2 tileMin = float2(groupId.xy * TILE_SIZE);
+    float2 tileMax = min(tileMin + TILE_SIZE, float2(screenWidth, screenHeight));
+    float minDepth = asfloat(tileMinDepth);
+    float maxDepth = asfloat(tileMaxDepth);
+    
+    float3 boundsMin = float3(1e30, 1e30, 1e30);
+    float3 boundsMax = float3(-1e30, -1e30, -1e30);
+    
+    [unroll]
+    for (uint corner = 0; corner < 8; corner++)
+    {
+        float2 cornerPosition = float2((corner & 1) ? tileMax.x : tileMin.x, (corner & 2) ? tileMax.y : tileMin.y);
+        float3 cornerView = ViewPositionFromDepth(cornerPosition, (corner & 4) ? maxDepth : minDepth);
+        
+        boundsMin = min(boundsMin, cornerView);
+        boundsMax = max(boundsMax, cornerView);
+    }
+    
+    for (uint lightIndex = groupIndex; lightIndex < lightCount; lightIndex += TILE_SIZE * TILE_SIZE)
+    {
+        float3 lightView = mul(view, float4(lights[lightIndex].lightPosition.xyz, 1.0)).xyz;
+        float range = lights[lightIndex].maxLightDistance;
+        
+        float3 offset = clamp(lightView, boundsMin, boundsMax) - lightView;
+        
+        if (dot(offset, offset) <= range * range)
+        {
+            uint slot;
+            InterlockedAdd(tileLightCount, 1, slot);
+            
+            if (slot < MAX_TILE_LIGHTS)
+            {
+                tileLights[slot] = lightIndex;
+            }
+        }
+    }
+    
+    GroupMemoryBarrierWithGroupSync();
+    
+    if (!onScreen || !hasGeometry)
+    {
+        return;
+    }
+    
+    int3 location = int3(pixel, 0);
+    float4 albedo = gAlbedo.Load(location);
+    
+    if (albedo.a < 0.5)
+    {
+        litImage[pixel] = float4(albedo.xyz, 1.0);
+        return;
+    }
+    
+    float4 normalShininess = gNormal.Load(location);
+    float3 objectAmbient = gAmbient.Load(location).xyz;
+    float3 objectSpecular = gSpecular.Load(location).xyz;
+    
+    float3 worldPosition = mul(inverseView, float4(ViewPositionFromDepth(float2(pixel) + 0.5, depth), 1.0)).xyz;
+    float3 norm = normalize(normalShininess.xyz);
+    float3 viewDir = normalize(cameraPosition.xyz - worldPosition);
+    
+    float3 result = float3(0, 0, 0);
+    uint tileLightTotal = min(tileLightCount, MAX_TILE_LIGHTS);
+    
+    for (uint i = 0; i < tileLightTotal; i++)
+    {
+        result += ShadeLight(lights[tileLights[i]], worldPosition, norm, viewDir, objectAmbient, albedo.xyz, objectSpecular, normalShininess.w);
+    }
+    
+    litImage[pixel] = float4(result, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+//copies the tiled lighting result into the window's render pass along with the g-buffer depth
+//transparent objects are drawn forward on top of it and depth test against the opaque scene
+Texture2D<float> gDepth : register(t9);
+Texture2D<float4> litImage : register(t11);
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+};
+
+struct PSOutput
+{
+    float4 color : SV_TARGET;
+    float depth : SV_Depth;
+};
+
+//one triangle that covers the whole screen
+VSOutput VSMain(uint vertexIndex : SV_VertexID)
+{
+    float2 uv = float2((vertexIndex << 1) & 2, vertexIndex & 2);
+    
+    VSOutput output;
+    output.position = float4(uv * 2.0 - 1.0, 0.0, 1.0);
+    
+    return output;
+}
+
+PSOutput PSMain(VSOutput input)
+{
+    int3 location = int3(input.position.xy, 0);
+    float depth = gDepth.Load(location);
+    
+    //background keeps the render pass clear color
+    if (depth >= 1.0)
+    {
+        discard;
+    }
+    
+    PSOutput output;
+    output.color = litImage.Load(location);
+    output.depth = depth;
+    
+    return output;
+}
\ No newline at end of file
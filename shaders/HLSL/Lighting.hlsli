@@ -0,0 +1,114 @@
+//light and shadow data shared by the forward pixel shader and the deferred lighting pass
+//both bind them at the same registers so the shading code below is identical for either path
+struct LightInfo
+{
+    float4 lightPosition;
+    float4 lightColor;
+   
+    float4 lightAmbient;
+    float4 lightDiffuse;
+    float4 lightSpecular;
+    
+    float maxLightDistance;
+    
+    int shadowIndex;
+};
+
+//one per shadowed light, a cube face per atlas tile in the order +x, -x, +y, -y, +z, -z
+struct ShadowInfo
+{
+    float4x4 faceViewProjection[6];
+    float4 faceRects[6];
+    
+    //x is the size of an atlas texel in uv, y the normal offset
+    float4 parameters;
+};
+
+StructuredBuffer<LightInfo> lights : register(t1);
+
+StructuredBuffer<ShadowInfo> shadows : register(t3);
+
+Texture2D shadowAtlas : register(t4);
+SamplerComparisonState shadowSampler : register(s4);
+
+//fraction of the light that reaches the point, 1 is fully lit
+float ShadowVisibility(int shadowIndex, float3 worldPosition, float3 normal, float3 lightPosition)
+{
+    ShadowInfo shadow = shadows[shadowIndex];
+    
+    float3 fromLight = worldPosition + normal * shadow.parameters.y - lightPosition;
+    float3 absFromLight = abs(fromLight);
+    
+    //the cube face is picked by the major axis, the same way the faces were laid out
+    uint face;
+    if (absFromLight.x >= absFromLight.y && absFromLight.x >= absFromLight.z)
+    {
+        face = (fromLight.x >= 0.0) ? 0 : 1;
+    }
+    else if (absFromLight.y >= absFromLight.z)
+    {
+        face = (fromLight.y >= 0.0) ? 2 : 3;
+    }
+    else
+    {
+        face = (fromLight.z >= 0.0) ? 4 : 5;
+    }
+    
+    float4 shadowClip = mul(shadow.faceViewProjection[face], float4(lightPosition + fromLight, 1.0));
+    float3 shadowPosition = shadowClip.xyz / shadowClip.w;
+    
+    float4 rect = shadow.faceRects[face];
+    float texelSize = shadow.parameters.x;
+    
+    float2 uv = (shadowPosition.xy * 0.5 + 0.5) * rect.zw + rect.xy;
+    
+    //keep the filter footprint inside the tile so it never reads a neighbouring face
+    float2 minUV = rect.xy + texelSize * 1.5;
+    float2 maxUV = rect.xy + rect.zw - texelSize * 1.5;
+    
+    float visibility = 0.0;
+    
+    [unroll]
+    for (int y = 0; y < 2; y++)
+    {
+        [unroll]
+        for (int x = 0; x < 2; x++)
+        {
+            float2 offset = (float2(x, y) - 0.5) * texelSize;
+            visibility += shadowAtlas.SampleCmpLevelZero(shadowSampler, clamp(uv + offset, minUV, maxUV), shadowPosition.z);
+        }
+    }
+    
+    return visibility * 0.25;
+}
+
+//one light's contribution to a surface point, faded out to nothing at the light's max distance
+float3 ShadeLight(LightInfo light, float3 worldPosition, float3 normal, float3 viewDir, float3 objectAmbient, float3 objectDiffuse, float3 objectSpecular, float shininess)
+{
+    // ambient
+    float3 ambient = light.lightAmbient.xyz * objectAmbient;
+
+    // diffuse 
+    float3 lightDir = normalize(light.lightPosition.xyz - worldPosition);
+    float diff = max(dot(normal, lightDir), 0.0);
+    float3 diffuse = light.lightDiffuse.xyz * (diff * objectDiffuse);
+
+    // specular
+    float3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    float3 specular = light.lightSpecular.xyz * (spec * objectSpecular);
+     
+    float distance = length(light.lightPosition.xyz - worldPosition);
+    float lerpT = distance / light.maxLightDistance;
+    
+    lerpT = min(lerpT, 1.0);
+    
+    float visibility = 1.0;
+    if (light.shadowIndex >= 0)
+    {
+        visibility = ShadowVisibility(light.shadowIndex, worldPosition, normal, light.lightPosition.xyz);
+    }
+    
+    float3 result = ambient + (diffuse + specular) * visibility;
+    return result * (1.0 - lerpT);
+}
\ No newline at end of file
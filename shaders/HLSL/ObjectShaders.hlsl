@@ -17,12 +17,18 @@ struct VSInputVertex
     
     [[vk::location(15)]] float opacity : COLOR6;
     [[vk::location(16)]] float shininess : COLOR7;
-    [[vk::location(17)]] uint lit : COLOR8;
     
-    [[vk::location(18)]] uint textured : TEXTCOORD9;
+    //lit, textured and billboarded are specialization constants, the locations between are left unused
     [[vk::location(19)]] uint textureIndex : TEXCOORD10;
+};
+
+//what the depth pre-pass reads from a mesh's position stream, the locations match VSInputVertex
+struct VSPositionInput
+{
+    [[vk::location(0)]] float3 position : POSITION;
     
-    [[vk::location(20)]] uint billboarded : TEXCOORD11;
+    [[vk::location(3)]] float4x4 model : TEXCOORD1;
+    [[vk::location(11)]] float3 scale : TEXCOORD8;
 };
 
 //Vertex shader output to fragment shader input
@@ -38,9 +44,29 @@ struct VSOutput
     [[vk::location(6)]] float3 specular : COLOR5;
     [[vk::location(7)]] float opacity : COLOR6;
     [[vk::location(8)]] float shininess : COLOR7;
-    [[vk::location(9)]] uint lit : COLOR8;
-    [[vk::location(10)]] uint textured : TEXTCOORD9;
-    [[vk::location(11)]] uint textureIndex : TEXCOORD10;
+    [[vk::location(9)]] uint textureIndex : TEXCOORD10;
+};
+
+//weighted blended transparency sums both targets, so transparent objects can be drawn in any order
+struct AccumulationOutput
+{
+    //weighted premultiplied color and weighted alpha
+    float4 accumulation : SV_TARGET0;
+    
+    //-log(1 - alpha), summing it multiplies the transmittance of every surface
+    float revealage : SV_TARGET1;
+};
+
+//written by the g-buffer pass, the deferred lighting pass reads them back per pixel
+struct GBufferOutput
+{
+    //rgb is the textured diffuse color, a is 1 for lit surfaces
+    float4 albedo : SV_TARGET0;
+    float4 ambient : SV_TARGET1;
+    
+    //xyz is the world normal, w the shininess
+    float4 normal : SV_TARGET2;
+    float4 specular : SV_TARGET3;
 };
 
 // Uniform buffer (constant buffer)
@@ -52,47 +78,54 @@ cbuffer GlobalInfo : register(b0)
     uint lightCount;
 }
 
-struct LightInfo
-{
-    float4 lightPosition;
-    float4 lightColor;
-   
-    float4 lightAmbient;
-    float4 lightDiffuse;
-    float4 lightSpecular;
-    
-    float maxLightDistance;
-};
+#include "Lighting.hlsli"
 
-StructuredBuffer<LightInfo> lights : register(t1);
+//the material variant the pipeline was created for, the renderer draws every instance with the pipeline matching its flags
+//constant, so each variant's fragment shader is compiled without the branches it doesn't take
+[[vk::constant_id(0)]] const bool litVariant = true;
+[[vk::constant_id(1)]] const bool texturedVariant = true;
+[[vk::constant_id(2)]] const bool billboardedVariant = false;
 
 Texture2D textures[] : register(t2);
-SamplerState textureSamplers[] : register(s2);
 
-VSOutput VSMain(VSInputVertex vertexInput)
+//a small immutable set of samplers, each texture's entry in textureSamplerIds picks one
+SamplerState textureSamplers[] : register(s5);
+StructuredBuffer<uint> textureSamplerIds : register(t6);
+
+float4 SampleTextureIndex(uint textureIndex, float2 texCoord)
 {
-    VSOutput output;
-    
-    float4 worldPos;
-    if (vertexInput.billboarded > 0)
+    return textures[NonUniformResourceIndex(textureIndex)].Sample(textureSamplers[NonUniformResourceIndex(textureSamplerIds[textureIndex])], texCoord);
+}
+
+//shared by every vertex shader whose depth has to match the pre-pass exactly, precise keeps the compiler from reordering the math
+float4 TransformPosition(float3 position, float4x4 model, float3 scale, out float4 worldPos)
+{
+    if (billboardedVariant)
     {
-        worldPos = mul(vertexInput.model, float4(0.0, 0.0, 0.0, 1.0));
+        worldPos = mul(model, float4(0.0, 0.0, 0.0, 1.0));
     }
     else
     {
-        worldPos = mul(vertexInput.model, float4(vertexInput.position, 1.0));
+        worldPos = mul(model, float4(position, 1.0));
     }
     
-    float4 viewPos = mul(view, worldPos);
+    precise float4 viewPos = mul(view, worldPos);
     
-    if (vertexInput.billboarded > 0)
+    if (billboardedVariant)
     {
-        viewPos += float4(vertexInput.position.xy * vertexInput.scale.xy, 0.0, 0.0);
+        viewPos += float4(position.xy * scale.xy, 0.0, 0.0);
     }
     
-    float4 clipPos = mul(projection, viewPos);
+    precise float4 clipPos = mul(projection, viewPos);
+    return clipPos;
+}
+
+VSOutput VSMain(VSInputVertex vertexInput)
+{
+    VSOutput output;
     
-    output.position = clipPos;
+    float4 worldPos;
+    output.position = TransformPosition(vertexInput.position, vertexInput.model, vertexInput.scale, worldPos);
     output.worldPosition = worldPos.xyz;
     
     float3x3 normalMatrix = (float3x3)transpose(vertexInput.modelMatrixInverted);
@@ -103,24 +136,33 @@ VSOutput VSMain(VSInputVertex vertexInput)
     output.specular = vertexInput.specular;
     output.opacity = vertexInput.opacity;
     output.shininess = vertexInput.shininess;
-    output.lit = vertexInput.lit;
     output.texCoord = vertexInput.texCoord;
-    output.textured = vertexInput.textured;
     output.textureIndex = vertexInput.textureIndex;
     
     return output;
 }
 
-float4 PSMain(VSOutput input) : SV_TARGET
-{   
-    float4 texColor = float4(1.0, 1.0, 1.0, 1.0);
-    
-    if (input.textured == 1)
+float4 VSDepthPrepass(VSPositionInput vertexInput) : SV_POSITION
+{
+    float4 worldPos;
+    return TransformPosition(vertexInput.position, vertexInput.model, vertexInput.scale, worldPos);
+}
+
+float4 SampleTexture(VSOutput input)
+{
+    if (texturedVariant)
     {
-        texColor = textures[NonUniformResourceIndex(input.textureIndex)].Sample(textureSamplers[input.textureIndex], input.texCoord);
+        return SampleTextureIndex(input.textureIndex, input.texCoord);
     }
     
-    if (input.lit == 0)
+    return float4(1.0, 1.0, 1.0, 1.0);
+}
+
+float4 ShadeFragment(VSOutput input)
+{
+    float4 texColor = SampleTexture(input);
+    
+    if (!litVariant)
     {
         return float4(input.diffuse, input.opacity) * texColor;
     }
@@ -128,35 +170,55 @@ float4 PSMain(VSOutput input) : SV_TARGET
     float3 objectDiffuse = texColor.xyz * input.diffuse;
     float3 objectAmbient = texColor.xyz * input.ambient;
     
+    float3 norm = normalize(input.normal);
+    float3 viewDir = normalize(cameraPosition.xyz - input.worldPosition);
+    
     float3 result = float3(0, 0, 0);
     
     for (uint i = 0; i < lightCount; i++)
     {
-        // ambient
-        float3 ambient = lights[i].lightAmbient.xyz * objectAmbient;
-
-        // diffuse 
-        float3 norm = normalize(input.normal);
-        float3 lightDir = normalize(lights[i].lightPosition.xyz - input.worldPosition);
-        float diff = max(dot(norm, lightDir), 0.0);
-        float3 diffuse = lights[i].lightDiffuse.xyz * (diff * objectDiffuse);
-
-        // specular
-        float3 viewDir = normalize(cameraPosition.xyz - input.worldPosition);
-        float3 reflectDir = reflect(-lightDir, norm);
-        float spec = pow(max(dot(viewDir, reflectDir), 0.0), input.shininess);
-        float3 specular = lights[i].lightSpecular.xyz * (spec * input.specular);
-     
-        float distance = length(lights[i].lightPosition.xyz - input.worldPosition);
-        float lerpT = distance / lights[i].maxLightDistance;
-    
-        lerpT = min(lerpT, 1.0);
-    
-        float3 currentResult = ambient + diffuse + specular;
-        currentResult = currentResult * (1.0 - lerpT);
-
-        result += currentResult;
+        result += ShadeLight(lights[i], input.worldPosition, norm, viewDir, objectAmbient, objectDiffuse, input.specular, input.shininess);
     }
     
     return float4(result, input.opacity);
+}
+
+float4 PSMain(VSOutput input) : SV_TARGET
+{   
+    return ShadeFragment(input);
+}
+
+AccumulationOutput PSAccumulate(VSOutput input)
+{
+    float4 color = ShadeFragment(input);
+    float alpha = saturate(color.a);
+    
+    //nearer surfaces get larger weights so they dominate the blend like they would when sorted
+    float distance = length(cameraPosition.xyz - input.worldPosition);
+    float weight = clamp(alpha * 10.0 / (1e-5 + pow(distance / 5.0, 2.0) + pow(distance / 200.0, 6.0)), 1e-2, 3e3);
+    
+    AccumulationOutput output;
+    output.accumulation = float4(color.xyz * alpha, alpha) * weight;
+    output.revealage = -log(1.0 - min(alpha, 0.999));
+    
+    return output;
+}
+
+//fills a depth buffer with the opaque objects, the color targets are masked off
+//reads no inputs so it can follow the depth pre-pass's position only vertex shader
+void PSDepthOnly()
+{
+}
+
+GBufferOutput PSGBuffer(VSOutput input)
+{
+    float4 texColor = SampleTexture(input);
+    
+    GBufferOutput output;
+    output.albedo = float4(texColor.xyz * input.diffuse, litVariant ? 1.0 : 0.0);
+    output.ambient = float4(texColor.xyz * input.ambient, 1.0);
+    output.normal = float4(normalize(input.normal), input.shininess);
+    output.specular = float4(input.specular, 1.0);
+    
+    return output;
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+//depth only pass that renders one cube face of a point light into its shadow atlas tile
+struct VSShadowInput
+{
+    [[vk::location(0)]] float3 position : POSITION;
+    
+    [[vk::location(3)]] float4x4 model : TEXCOORD1;
+};
+
+struct ShadowPushConstants
+{
+    float4x4 faceViewProjection;
+};
+
+[[vk::push_constant]] ShadowPushConstants pushConstants;
+
+float4 VSMain(VSShadowInput vertexInput) : SV_POSITION
+{
+    //unlit objects and billboards are never drawn here, the renderer skips their material variants
+    float4 worldPos = mul(vertexInput.model, float4(vertexInput.position, 1.0));
+    return mul(pushConstants.faceViewProjection, worldPos);
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+//resolves weighted blended transparency over the opaque scene in the window's render pass
+Texture2D<float4> accumulation : register(t0);
+Texture2D<float> revealage : register(t1);
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+};
+
+//one triangle that covers the whole screen
+VSOutput VSMain(uint vertexIndex : SV_VertexID)
+{
+    float2 uv = float2((vertexIndex << 1) & 2, vertexIndex & 2);
+    
+    VSOutput output;
+    output.position = float4(uv * 2.0 - 1.0, 0.0, 1.0);
+    
+    return output;
+}
+
+float4 PSMain(VSOutput input) : SV_TARGET
+{
+    int3 location = int3(input.position.xy, 0);
+    float opticalDepth = revealage.Load(location);
+    
+    //no transparent surface covered this pixel
+    if (opticalDepth <= 0.0)
+    {
+        discard;
+    }
+    
+    float4 accumulated = accumulation.Load(location);
+    float3 averageColor = accumulated.xyz / max(accumulated.w, 1e-5);
+    
+    //alpha blending with this coverage leaves the product of every surface's 1 - alpha of the scene behind
+    return float4(averageColor, 1.0 - exp(-opticalDepth));
+}
\ No newline at end of file
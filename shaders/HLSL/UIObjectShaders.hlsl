@@ -19,6 +19,17 @@ struct UIVSInputVertex
     [[vk::location(10)]] uint textureIndex : TEXCOORD6;
     
     [[vk::location(11)]] uint isTextCharacter : TEXTCOORD7;
+    
+    //Distance field text attributes
+    [[vk::location(12)]] float4 outlineColor : COLOR5;
+    [[vk::location(13)]] float4 shadowColor : COLOR6;
+    [[vk::location(14)]] float2 distanceRange : TEXCOORD11;
+    [[vk::location(15)]] float2 shadowOffset : TEXCOORD12;
+    [[vk::location(16)]] float outlineWidth : TEXCOORD13;
+    [[vk::location(17)]] uint textRenderMode : TEXCOORD14;
+    
+    //offset and size of the image in its texture, images packed into an atlas only cover part of it
+    [[vk::location(18)]] float4 uvRect : TEXCOORD15;
 };
 
 //Vertex shader output to fragment shader input
@@ -32,6 +43,13 @@ struct VSOutput
     
     [[vk::location(4)]] uint textured : TEXTCOORD4;
     [[vk::location(5)]] uint textureIndex : TEXCOORD5;
+    
+    [[vk::location(6)]] float4 outlineColor : COLOR4;
+    [[vk::location(7)]] float4 shadowColor : COLOR5;
+    [[vk::location(8)]] float2 distanceRange : TEXCOORD6;
+    [[vk::location(9)]] float2 shadowOffset : TEXCOORD7;
+    [[vk::location(10)]] float outlineWidth : TEXCOORD8;
+    [[vk::location(11)]] uint textRenderMode : TEXCOORD9;
 };
 
 // Uniform buffer (constant buffer)
@@ -42,7 +60,15 @@ cbuffer UIGlobalInfo : register(b0)
 }
 
 Texture2D textures[] : register(t1);
-SamplerState textureSamplers[] : register(s1);
+
+//a small immutable set of samplers, each texture's entry in textureSamplerIds picks one
+SamplerState textureSamplers[] : register(s2);
+StructuredBuffer<uint> textureSamplerIds : register(t3);
+
+float4 SampleTextureIndex(uint textureIndex, float2 texCoord)
+{
+    return textures[NonUniformResourceIndex(textureIndex)].Sample(textureSamplers[NonUniformResourceIndex(textureSamplerIds[textureIndex])], texCoord);
+}
 
 VSOutput VSMain(UIVSInputVertex vertexInput)
 {
@@ -78,7 +104,7 @@ VSOutput VSMain(UIVSInputVertex vertexInput)
     
     if (vertexInput.isTextCharacter == 0)
     {
-        output.texCoord = vertexInput.texCoord;
+        output.texCoord = vertexInput.uvRect.xy + (vertexInput.texCoord * vertexInput.uvRect.zw);
     }
     else
     {
@@ -92,16 +118,83 @@ VSOutput VSMain(UIVSInputVertex vertexInput)
     output.textured = vertexInput.textured;
     output.textureIndex = vertexInput.textureIndex;
     
+    output.outlineColor = vertexInput.outlineColor;
+    output.shadowColor = vertexInput.shadowColor;
+    output.distanceRange = vertexInput.distanceRange;
+    output.shadowOffset = vertexInput.shadowOffset;
+    output.outlineWidth = vertexInput.outlineWidth;
+    output.textRenderMode = vertexInput.textRenderMode;
+    
     return output;
 }
 
+float Median(float3 value)
+{
+    return max(min(value.r, value.g), min(max(value.r, value.g), value.b));
+}
+
+//returns the signed distance at the given coordinate, 0.5 is the glyph edge
+float SampleDistance(VSOutput input, float2 texCoord)
+{
+    float4 sample = SampleTextureIndex(input.textureIndex, texCoord);
+    
+    //msdf stores three channels, the median reconstructs sharp corners
+    if (input.textRenderMode == 2)
+    {
+        return Median(sample.rgb);
+    }
+    
+    return sample.r;
+}
+
+float4 DistanceFieldText(VSOutput input)
+{
+    //how many screen pixels one unit of distance covers, keeps edges ~1px wide at any scale
+    float2 unitRange = input.distanceRange;
+    float2 screenTexSize = 1.0 / fwidth(input.texCoord);
+    float screenPxRange = max(0.5 * dot(unitRange, screenTexSize), 1.0);
+    
+    float distance = SampleDistance(input, input.texCoord);
+    
+    float glyphAlpha = clamp(screenPxRange * (distance - 0.5) + 0.5, 0.0, 1.0);
+    float outlineAlpha = clamp(screenPxRange * (distance - (0.5 - input.outlineWidth)) + 0.5, 0.0, 1.0);
+    
+    //outline sits behind the glyph and fades into it, both fade out with the instance
+    float4 result = float4(input.outlineColor.rgb, input.outlineColor.a * outlineAlpha * input.opacity);
+    if (input.outlineWidth <= 0.0)
+    {
+        result = float4(input.color, 0.0);
+    }
+    
+    result.rgb = lerp(result.rgb, input.color, glyphAlpha);
+    result.a = max(result.a, input.opacity * glyphAlpha);
+    
+    if (any(input.shadowOffset != float2(0.0, 0.0)))
+    {
+        float shadowDistance = SampleDistance(input, input.texCoord - input.shadowOffset);
+        float shadowAlpha = clamp(screenPxRange * (shadowDistance - (0.5 - input.outlineWidth)) + 0.5, 0.0, 1.0) * input.shadowColor.a * input.opacity;
+        
+        //composite the text over the shadow
+        float combinedAlpha = result.a + shadowAlpha * (1.0 - result.a);
+        float3 combinedColor = (result.rgb * result.a + input.shadowColor.rgb * shadowAlpha * (1.0 - result.a)) / max(combinedAlpha, 0.0001);
+        result = float4(combinedColor, combinedAlpha);
+    }
+    
+    return result;
+}
+
 float4 PSMain(VSOutput input) : SV_TARGET
 {
+    if (input.textured == 1 && input.textRenderMode != 0)
+    {
+        return DistanceFieldText(input);
+    }
+    
     float4 texColor = float4(1.0, 1.0, 1.0, 1.0);
     
     if (input.textured == 1)
     {
-        texColor = textures[NonUniformResourceIndex(input.textureIndex)].Sample(textureSamplers[input.textureIndex], input.texCoord);
+        texColor = SampleTextureIndex(input.textureIndex, input.texCoord);
     }
     
     return float4(input.color, input.opacity) * texColor;
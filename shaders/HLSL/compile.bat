@@ -1,7 +1,23 @@
 C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T vs_6_0 -E VSMain ObjectShaders.hlsl -Fo VertexShader.spv
 C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T ps_6_0 -E PSMain ObjectShaders.hlsl -Fo PixelShader.spv
 
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T ps_6_0 -E PSGBuffer -fspv-entrypoint-name=PSMain ObjectShaders.hlsl -Fo GBufferPixelShader.spv
+
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T ps_6_0 -E PSAccumulate -fspv-entrypoint-name=PSMain ObjectShaders.hlsl -Fo TransparencyAccumulatePixelShader.spv
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T ps_6_0 -E PSDepthOnly -fspv-entrypoint-name=PSMain ObjectShaders.hlsl -Fo DepthOnlyPixelShader.spv
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T vs_6_0 -E VSDepthPrepass -fspv-entrypoint-name=VSMain ObjectShaders.hlsl -Fo DepthPrepassVertexShader.spv
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T vs_6_0 -E VSMain TransparencyComposite.hlsl -Fo TransparencyCompositeVertexShader.spv
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T ps_6_0 -E PSMain TransparencyComposite.hlsl -Fo TransparencyCompositePixelShader.spv
+
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T cs_6_0 -E CSMain DeferredLighting.hlsl -Fo DeferredLightingComputeShader.spv
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T vs_6_0 -E VSMain DeferredShaders.hlsl -Fo DeferredVertexShader.spv
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T ps_6_0 -E PSMain DeferredShaders.hlsl -Fo DeferredPixelShader.spv
+
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T cs_6_0 -E CSMain ClusterCulling.hlsl -Fo ClusterCullingComputeShader.spv
+
 C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T vs_6_0 -E VSMain UIObjectShaders.hlsl -Fo UIVertexShader.spv
 C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T ps_6_0 -E PSMain UIObjectShaders.hlsl -Fo UIPixelShader.spv
 
+C:/VulkanSDK/1.4.309.0/Bin/dxc.exe -spirv -T vs_6_0 -E VSMain ShadowShaders.hlsl -Fo ShadowVertexShader.spv
+
 pause
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "ChurnBenchmark.h"
+#include "source/Management/Scene.h"
+#include "source/Objects/RenderObject.h"
+#include "source/Components/Transform.h"
+#include "source/Components/Cube.h"
+
+#include <algorithm>
+#include <iostream>
+
+void ChurnBenchmark::Start()
+{
+	m_population = std::min(m_population, VulkanCommonFunctions::MAX_OBJECTS - GetScene()->GetObjectCount());
+	m_liveObjects.resize(m_population, VulkanCommonFunctions::INVALID_OBJECT_HANDLE);
+
+	m_random.seed(GetScene()->GetRandomSeed());
+
+	std::cout << "Churn benchmark: " << m_objectsPerSecond << " objects per second, population " << m_population << std::endl;
+}
+
+void ChurnBenchmark::Update(float deltaTime)
+{
+	if (m_population == 0)
+	{
+		return;
+	}
+
+	m_spawnBudget = std::min(m_spawnBudget + m_objectsPerSecond * deltaTime, m_objectsPerSecond * kMaxSpawnBudgetSeconds);
+
+	while (m_spawnBudget >= 1.0)
+	{
+		if (m_liveCount == m_population)
+		{
+			RemoveOldestObject();
+		}
+
+		SpawnObject();
+		m_spawnBudget -= 1.0;
+	}
+
+	m_reportTimer += deltaTime;
+	if (m_reportTimer >= 1.0)
+	{
+		PrintStatistics();
+		m_reportTimer = 0.0;
+	}
+}
+
+void ChurnBenchmark::SpawnObject()
+{
+	std::uniform_real_distribution<float> positionDistribution(-50.0f, 50.0f);
+	glm::vec3 position = glm::vec3(positionDistribution(m_random), positionDistribution(m_random), positionDistribution(m_random));
+
+	auto spawnStart = std::chrono::steady_clock::now();
+
+	std::shared_ptr<RenderObject> newObject = Scene::CreateObject();
+
+	std::shared_ptr<Transform> newObjectTransform = newObject->AddComponent<Transform>();
+	newObjectTransform->SetPosition(position);
+	newObjectTransform->SetScale(glm::vec3(0.25f));
+
+	std::shared_ptr<Cube> newObjectMesh = newObject->AddComponent<Cube>();
+	newObjectMesh->SetColor(glm::vec3(0.9f));
+	newObjectMesh->SetTextured(false);
+
+	VulkanCommonFunctions::ObjectHandle newHandle = GetScene()->AddObject(newObject);
+
+	m_spawnTime += std::chrono::steady_clock::now() - spawnStart;
+
+	if (newHandle == VulkanCommonFunctions::INVALID_OBJECT_HANDLE)
+	{
+		return;
+	}
+
+	m_liveObjects[(m_oldestIndex + m_liveCount) % m_population] = newHandle;
+	m_liveCount++;
+	m_spawnCount++;
+}
+
+void ChurnBenchmark::RemoveOldestObject()
+{
+	VulkanCommonFunctions::ObjectHandle oldestHandle = m_liveObjects[m_oldestIndex];
+	m_oldestIndex = (m_oldestIndex + 1) % m_population;
+	m_liveCount--;
+
+	auto removeStart = std::chrono::steady_clock::now();
+
+	if (!GetScene()->RemoveObject(oldestHandle))
+	{
+		std::cout << "Churn benchmark failed to remove object, handle: " << oldestHandle << std::endl;
+	}
+
+	m_removeTime += std::chrono::steady_clock::now() - removeStart;
+	m_removeCount++;
+}
+
+void ChurnBenchmark::PrintStatistics()
+{
+	double averageSpawn = (m_spawnCount > 0) ? std::chrono::duration<double, std::micro>(m_spawnTime).count() / m_spawnCount : 0.0;
+	double averageRemove = (m_removeCount > 0) ? std::chrono::duration<double, std::micro>(m_removeTime).count() / m_removeCount : 0.0;
+
+	std::cout << "Churn: spawned " << m_spawnCount << " (" << averageSpawn << " us avg)"
+		<< ", removed " << m_removeCount << " (" << averageRemove << " us avg)"
+		<< ", live objects " << GetScene()->GetObjectCount()
+		<< ", handle slots " << GetScene()->GetObjectHandleSlotCount()
+		<< ", pending buffer frees " << GetScene()->GetPendingDestructionCount()
+		<< ", pool chunks " << SmallObjectPool::Get().GetChunkCount()
+		<< ", pool blocks in use " << SmallObjectPool::Get().GetLiveBlockCount() << std::endl;
+
+	m_spawnCount = 0;
+	m_removeCount = 0;
+	m_spawnTime = std::chrono::nanoseconds(0);
+	m_removeTime = std::chrono::nanoseconds(0);
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "source/Objects/ObjectComponent.h"
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+//spawns and removes objects at a steady rate, once the population is full every spawn also removes the oldest object
+//prints the cost of add/remove and what the pools are holding once a second
+class ChurnBenchmark : public ObjectComponent {
+public:
+	ChurnBenchmark() {};
+
+	void Start() override;
+	void Update(float deltaTime) override;
+
+	void SetObjectsPerSecond(size_t objectsPerSecond) { m_objectsPerSecond = objectsPerSecond; }
+	void SetPopulation(size_t population) { m_population = population; }
+
+private:
+	void SpawnObject();
+	void RemoveOldestObject();
+	void PrintStatistics();
+
+	size_t m_objectsPerSecond = 10000;
+	size_t m_population = 5000;
+
+	//a long hitch shouldn't turn into one giant burst
+	static constexpr double kMaxSpawnBudgetSeconds = 0.25;
+	double m_spawnBudget = 0.0;
+
+	//ring of live handles, oldest at m_oldestIndex
+	std::vector<VulkanCommonFunctions::ObjectHandle> m_liveObjects;
+	size_t m_oldestIndex = 0;
+	size_t m_liveCount = 0;
+
+	std::mt19937 m_random;
+
+	double m_reportTimer = 0.0;
+	size_t m_spawnCount = 0;
+	size_t m_removeCount = 0;
+	std::chrono::nanoseconds m_spawnTime = std::chrono::nanoseconds(0);
+	std::chrono::nanoseconds m_removeTime = std::chrono::nanoseconds(0);
+};
\ No newline at end of file
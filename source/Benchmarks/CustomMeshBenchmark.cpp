@@ -0,0 +1,84 @@
+#include "CustomMeshBenchmark.h"
+#include "source/Management/Scene.h"
+#include "source/Objects/RenderObject.h"
+#include "source/Components/Transform.h"
+#include "source/Components/MeshRenderer.h"
+#include "source/Vulkan Interface/VulkanInterface.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+void CustomMeshBenchmark::Start()
+{
+	m_meshCount = std::min(m_meshCount, VulkanCommonFunctions::MAX_OBJECTS - GetScene()->GetObjectCount());
+
+	//a square grid in front of the camera's start, so every mesh is drawn
+	size_t gridSize = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(m_meshCount))));
+
+	for (size_t i = 0; i < m_meshCount; i++)
+	{
+		SpawnMesh(i, gridSize);
+	}
+
+	std::shared_ptr<VulkanInterface> vulkanInterface = GetScene()->GetVulkanInterface();
+	m_lastRecordedFrameCount = vulkanInterface->GetRecordedFrameCount();
+	m_lastRecordNanoseconds = vulkanInterface->GetRecordNanoseconds();
+
+	std::cout << "Custom mesh benchmark: " << m_meshCount << " custom meshes, " << vulkanInterface->GetRecordingThreadCount() << " recording threads" << std::endl;
+}
+
+void CustomMeshBenchmark::Update(float deltaTime)
+{
+	m_reportTimer += deltaTime;
+	if (m_reportTimer >= 1.0)
+	{
+		PrintStatistics();
+		m_reportTimer = 0.0;
+	}
+}
+
+void CustomMeshBenchmark::SpawnMesh(size_t index, size_t gridSize)
+{
+	float halfExtent = (gridSize - 1) * kSpacing * 0.5f;
+	glm::vec3 position = glm::vec3((index % gridSize) * kSpacing - halfExtent, (index / gridSize) * kSpacing - halfExtent, -20.0f);
+
+	std::shared_ptr<RenderObject> newObject = Scene::CreateObject();
+
+	std::shared_ptr<Transform> newObjectTransform = newObject->AddComponent<Transform>();
+	newObjectTransform->SetPosition(position);
+	newObjectTransform->SetScale(glm::vec3(0.5f));
+
+	std::shared_ptr<MeshRenderer> newObjectMesh = newObject->AddComponent<MeshRenderer>();
+	newObjectMesh->SetVertices({
+		{{-1.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+		{{1.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
+		{{1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+		{{-1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}}
+	});
+	newObjectMesh->SetIndices({ 0, 1, 2, 2, 3, 0 });
+	newObjectMesh->SetColor(glm::vec3(0.9f));
+	newObjectMesh->SetTextured(false);
+
+	if (GetScene()->AddObject(newObject) == VulkanCommonFunctions::INVALID_OBJECT_HANDLE)
+	{
+		std::cout << "Custom mesh benchmark failed to add mesh " << index << std::endl;
+	}
+}
+
+void CustomMeshBenchmark::PrintStatistics()
+{
+	std::shared_ptr<VulkanInterface> vulkanInterface = GetScene()->GetVulkanInterface();
+
+	uint64_t recordedFrameCount = vulkanInterface->GetRecordedFrameCount();
+	uint64_t recordNanoseconds = vulkanInterface->GetRecordNanoseconds();
+
+	uint64_t frames = recordedFrameCount - m_lastRecordedFrameCount;
+	double averageRecord = (frames > 0) ? (recordNanoseconds - m_lastRecordNanoseconds) / 1000000.0 / frames : 0.0;
+
+	std::cout << "Custom meshes: " << frames << " frames, " << averageRecord << " ms avg to fill and record"
+		<< ", VMA allocations " << vulkanInterface->GetAllocationCount() << std::endl;
+
+	m_lastRecordedFrameCount = recordedFrameCount;
+	m_lastRecordNanoseconds = recordNanoseconds;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "source/Objects/ObjectComponent.h"
+
+#include <cstdint>
+
+//fills the scene with custom meshes, each with its own vertex and index buffers the way edited meshes are
+//prints the frame's command recording time and how many VMA allocations are live once a second
+class CustomMeshBenchmark : public ObjectComponent {
+public:
+	CustomMeshBenchmark() {};
+
+	void Start() override;
+	void Update(float deltaTime) override;
+
+	void SetMeshCount(size_t meshCount) { m_meshCount = meshCount; }
+
+private:
+	void SpawnMesh(size_t index, size_t gridSize);
+	void PrintStatistics();
+
+	size_t m_meshCount = 5000;
+	static constexpr float kSpacing = 1.5f;
+
+	double m_reportTimer = 0.0;
+	uint64_t m_lastRecordedFrameCount = 0;
+	uint64_t m_lastRecordNanoseconds = 0;
+};
\ No newline at end of file
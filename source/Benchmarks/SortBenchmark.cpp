@@ -0,0 +1,55 @@
+#include "SortBenchmark.h"
+#include "source/Management/RadixSort.h"
+#include "source/Management/FrameTimeStatistics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+void SortBenchmark::Run(size_t instanceCount, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> depthDistribution(0.1f, 500.0f);
+
+	//transparent instances are drawn back to front, so the key is the inverted depth
+	std::vector<float> depths(instanceCount);
+	std::vector<uint32_t> keys(instanceCount);
+
+	for (size_t i = 0; i < instanceCount; i++)
+	{
+		depths[i] = depthDistribution(random);
+		keys[i] = ~RadixSorter::FloatToKey(depths[i]);
+	}
+
+	RadixSorter sorter;
+	std::vector<uint32_t> radixOrder;
+	std::vector<uint32_t> referenceOrder(instanceCount);
+
+	FrameTimeStatistics radixTimes;
+	FrameTimeStatistics referenceTimes;
+
+	//the first run allocates the scratch buffers, like the first frame would
+	sorter.Sort(keys, radixOrder);
+
+	for (int iteration = 0; iteration < kIterations; iteration++)
+	{
+		auto radixStart = std::chrono::steady_clock::now();
+		sorter.Sort(keys, radixOrder);
+		radixTimes.AddFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - radixStart).count());
+
+		auto referenceStart = std::chrono::steady_clock::now();
+		std::iota(referenceOrder.begin(), referenceOrder.end(), 0);
+		std::stable_sort(referenceOrder.begin(), referenceOrder.end(), [&](uint32_t a, uint32_t b) { return depths[a] > depths[b]; });
+		referenceTimes.AddFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - referenceStart).count());
+	}
+
+	bool matches = radixOrder == referenceOrder;
+
+	std::cout << "Sort benchmark: " << instanceCount << " instances, " << kIterations << " iterations" << std::endl;
+	std::cout << "Radix sort:  " << radixTimes.GetAverage() << " ms avg, " << radixTimes.GetPercentile(99.0) << " ms p99" << std::endl;
+	std::cout << "stable_sort: " << referenceTimes.GetAverage() << " ms avg, " << referenceTimes.GetPercentile(99.0) << " ms p99" << std::endl;
+	std::cout << "Orders " << (matches ? "match" : "DIFFER") << std::endl;
+}
\ No newline at end of file
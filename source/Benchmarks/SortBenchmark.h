@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//times the transparent instance sort on random view depths against std::stable_sort, which it replaced
+//runs on its own without a window so the numbers aren't mixed with rendering
+class SortBenchmark {
+public:
+	static void Run(size_t instanceCount, uint32_t seed);
+
+private:
+	static constexpr int kIterations = 50;
+};
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "TextureBenchmark.h"
+#include "source/Management/FrameTimeStatistics.h"
+#include "source/Management/MipChainBuilder.h"
+#include "source/Management/TextureConverter.h"
+
+#include "stb_image.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+void TextureBenchmark::Run(const std::string& directory)
+{
+	size_t totalPngBytes = 0;
+	size_t totalKtx2Bytes = 0;
+
+	std::cout << "Texture benchmark: " << directory << ", " << kIterations << " iterations" << std::endl;
+
+	for (const auto& entry : std::filesystem::directory_iterator(directory))
+	{
+		if (entry.path().extension() != ".png")
+		{
+			continue;
+		}
+
+		std::string imagePath = entry.path().string();
+
+		int width = 0, height = 0, channels = 0;
+		FrameTimeStatistics pngTimes;
+
+		for (int iteration = 0; iteration < kIterations; iteration++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			stbi_uc* pixels = stbi_load(imagePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+			pngTimes.AddFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+			if (!pixels)
+			{
+				break;
+			}
+
+			stbi_image_free(pixels);
+		}
+
+		if (width == 0 || height == 0)
+		{
+			std::cout << "Failed to load " << imagePath << std::endl;
+			continue;
+		}
+
+		//what the png path keeps on the device, every level at four bytes a texel
+		std::vector<MipChainBuilder::MipLevel> levels;
+		stbi_uc* pixels = stbi_load(imagePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		std::vector<uint8_t> chain = MipChainBuilder::Build(pixels, width, height, true, MipChainBuilder::Filter::Box, levels);
+
+		auto convertStart = std::chrono::steady_clock::now();
+		Ktx2File::Texture texture = TextureConverter::Convert(pixels, width, height, TextureConverter::Format::Bc1, true);
+		double convertTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - convertStart).count();
+		stbi_image_free(pixels);
+
+		//written somewhere else so running the benchmark never changes which files the engine loads
+		std::string ktx2Path = (std::filesystem::temp_directory_path() / entry.path().stem()).string() + TextureConverter::GetVariantExtension(TextureConverter::Format::Bc1);
+		Ktx2File::Write(ktx2Path, texture);
+
+		FrameTimeStatistics ktx2Times;
+
+		for (int iteration = 0; iteration < kIterations; iteration++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			Ktx2File::Texture loaded = Ktx2File::Read(ktx2Path);
+			ktx2Times.AddFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		std::filesystem::remove(ktx2Path);
+
+		totalPngBytes += chain.size();
+		totalKtx2Bytes += texture.data.size();
+
+		std::cout << entry.path().filename().string() << " (" << width << "x" << height << ", " << levels.size() << " levels)" << std::endl;
+		std::cout << "  png decode: " << pngTimes.GetAverage() << " ms avg, " << chain.size() << " bytes on the device" << std::endl;
+		std::cout << "  BC1 KTX2:   " << ktx2Times.GetAverage() << " ms avg, " << texture.data.size() << " bytes on the device, converted offline in " << convertTime << " ms" << std::endl;
+	}
+
+	std::cout << "Total device memory: " << totalPngBytes << " bytes as RGBA8, " << totalKtx2Bytes << " bytes as BC1" << std::endl;
+}
\ No newline at end of file
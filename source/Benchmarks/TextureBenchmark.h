@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+//loads every png in a directory the way textures were loaded before KTX2, and as BC1 KTX2 files converted on the spot
+//prints how long each takes to get to uploadable data and how much device memory its full mip chain needs
+//upload and the GPU's own copies aren't timed, they need a device and are the same work for both
+class TextureBenchmark {
+public:
+	static void Run(const std::string& directory);
+
+private:
+	static constexpr int kIterations = 10;
+};
\ No newline at end of file
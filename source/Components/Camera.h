@@ -25,8 +25,12 @@ public:
 	glm::mat4 GetViewMatrix()
 	{
 		std::shared_ptr<Transform> transform = GetOwner()->GetComponent<Transform>();
-		glm::vec3 position = transform->GetPosition();
-		return glm::lookAt(position, position + transform->Forward(), transform->Up());
+		return BuildViewMatrix(transform->GetPosition(), transform->GetRotation());
+	}
+
+	static glm::mat4 BuildViewMatrix(glm::vec3 position, glm::vec3 rotation)
+	{
+		return glm::lookAt(position, position + Transform::ForwardFromRotation(rotation), Transform::UpFromRotation(rotation));
 	}
 
 private:
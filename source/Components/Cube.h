@@ -17,7 +17,8 @@ private:
     using MeshRenderer::SetIndices;
 	using MeshRenderer::SetVertices;
 
-    const std::vector<VulkanCommonFunctions::Vertex> cubeVertices = {
+    //shared by every instance, a per object copy would allocate on every spawn
+    static inline const std::vector<VulkanCommonFunctions::Vertex> cubeVertices = {
         //top
         {{-0.5f, 0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}},
         {{-0.5f, 0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}},
@@ -55,7 +56,7 @@ private:
         {{0.5f, 0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
     };
 
-    const std::vector<uint16_t> cubeIndices = {
+    static inline const std::vector<uint16_t> cubeIndices = {
         //top
         0, 1, 3,  3, 1, 2,
         //bottom
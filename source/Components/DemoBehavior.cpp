@@ -28,7 +28,22 @@ void DemoBehavior::Start()
     uiTextComponent->SetFontName("JetBrains Mono NL Medium");
     GetScene()->AddUIObject(uiTextObject);
 
-    std::srand(std::time(0));
+    //distance field text stays sharp at any size and gets its outline and shadow from the same atlas
+    std::shared_ptr<RenderObject> uiTitleObject = std::make_shared<RenderObject>();
+    std::shared_ptr<Transform> uiTitleObjectTransform = uiTitleObject->AddComponent<Transform>();
+    uiTitleObjectTransform->SetPosition(glm::vec3(0.0f, -0.8f, 0.0f));
+    uiTitleObjectTransform->SetScale(glm::vec3(1.0f, 1.0f, 1.0f));
+    std::shared_ptr<Text> uiTitleComponent = uiTitleObject->AddComponent<Text>();
+    uiTitleComponent->SetTextString("Volt Engine");
+    GetScene()->AddFont("fonts\\VeraMono-sdf.png", "fonts\\VeraMono-sdf.fnt");
+    uiTitleComponent->SetFontName("Bitstream Vera Sans Mono SDF");
+    uiTitleComponent->SetFontSize(64.0f);
+    uiTitleComponent->SetOutline(1.5f, glm::vec3(0.0f, 0.0f, 0.0f));
+    uiTitleComponent->SetShadow(glm::vec2(0.008f, 0.004f), glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+    GetScene()->AddUIObject(uiTitleObject);
+
+    //seeded by the scene so recorded runs spawn the same objects on replay
+    std::srand(GetScene()->GetRandomSeed());
 
     std::shared_ptr<RenderObject> lightCube = std::make_shared<RenderObject>();
 
@@ -63,13 +78,7 @@ void DemoBehavior::Start()
 
         newObjectTransform->SetParent(lightTransform);
 
-        if ((double)rand() / (RAND_MAX) >= 0.5f)
-        {
-            newObject->AddComponent<Cube>();
-        }
-        else {
-            newObject->AddComponent<Tetrahedron>();
-        }
+        AddRandomMesh(newObject);
 
         std::shared_ptr<MeshRenderer> currentMesh = newObject->GetComponent<MeshRenderer>();
 
@@ -138,20 +147,14 @@ void DemoBehavior::Update(float deltaTime)
     {
         float positionRange = 100.0f;
 
-        std::shared_ptr<RenderObject> newObject = std::make_shared<RenderObject>();
+        std::shared_ptr<RenderObject> newObject = Scene::CreateObject();
 
         std::shared_ptr<Transform> newObjectTransform = newObject->AddComponent<Transform>();
         newObjectTransform->SetPosition(glm::vec3(((double)rand() / (RAND_MAX)) * positionRange, ((double)rand() / (RAND_MAX)) * positionRange, ((double)rand() / (RAND_MAX)) * positionRange));
         newObjectTransform->SetRotation(glm::vec3(((double)rand() / (RAND_MAX)) * 360.0f, ((double)rand() / (RAND_MAX)) * 360.0f, ((double)rand() / (RAND_MAX)) * 360.0f));
         newObjectTransform->SetScale(glm::vec3(0.5f));
 
-        if ((double)rand() / (RAND_MAX) >= 0.5f)
-        {
-            newObject->AddComponent<Cube>();
-        }
-        else {
-            newObject->AddComponent<Tetrahedron>();
-        }
+        AddRandomMesh(newObject);
 
         std::shared_ptr<MeshRenderer> currentMesh = newObject->GetComponent<MeshRenderer>();
 
@@ -205,6 +208,13 @@ void DemoBehavior::Update(float deltaTime)
         }
     }
 
+    //compare the GPU pass times printed for each setting to see what the pre-pass saves in this scene
+    if (GetWindowManager()->KeyPressedThisFrame(Qt::Key::Key_P))
+    {
+        std::shared_ptr<VulkanInterface> vulkanInterface = GetScene()->GetVulkanInterface();
+        vulkanInterface->SetDepthPrepassEnabled(!vulkanInterface->IsDepthPrepassEnabled());
+    }
+
     if (GetWindowManager()->KeyPressedThisFrame(Qt::Key::Key_L))
     {
         GetWindowManager()->RemoveButton("Write Debug Text");
@@ -219,4 +229,33 @@ void DemoBehavior::Update(float deltaTime)
 void DemoBehavior::WriteDebugText()
 {
     qDebug() << "This is a test of the button system.";
+}
+
+void DemoBehavior::AddRandomMesh(std::shared_ptr<RenderObject> object)
+{
+    double meshChoice = (double)rand() / (RAND_MAX);
+
+    if (!spawnSpheres)
+    {
+        if (meshChoice >= 0.5f)
+        {
+            object->AddComponent<Cube>();
+        }
+        else {
+            object->AddComponent<Tetrahedron>();
+        }
+        return;
+    }
+
+    if (meshChoice >= 2.0 / 3.0)
+    {
+        object->AddComponent<Cube>();
+    }
+    else if (meshChoice >= 1.0 / 3.0)
+    {
+        object->AddComponent<Tetrahedron>();
+    }
+    else {
+        object->AddComponent<Sphere>();
+    }
 }
\ No newline at end of file
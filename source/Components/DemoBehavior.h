@@ -6,6 +6,7 @@
 #include "source/Objects/RenderObject.h"
 #include "source/Components/Cube.h"
 #include "source/Components/Tetrahedron.h"
+#include "source/Components/Sphere.h"
 #include "source/Components/LightSource.h"
 #include "source/Components/Text.h"
 
@@ -18,7 +19,12 @@ public:
 
     void WriteDebugText();
 
+    //spheres carry the LOD chain and meshlets, off by default so the usual scene is only cubes and tetrahedrons
+    void SetSpawnSpheres(bool enabled) { spawnSpheres = enabled; }
+
 private:
+    void AddRandomMesh(std::shared_ptr<RenderObject> object);
+
     alignas(16) std::vector<glm::vec3> objectPositions = {
         glm::vec3(0.0f,  0.0f,  0.0f),
         glm::vec3(2.0f,  5.0f, -15.0f),
@@ -48,4 +54,5 @@ private:
     VulkanCommonFunctions::ObjectHandle lightObjectHandle = 0;
 	std::set<VulkanCommonFunctions::ObjectHandle> objectHandles;
 	float currentTime = 0.0f;
+	bool spawnSpheres = false;
 };
\ No newline at end of file
@@ -25,4 +25,33 @@ void MeshRenderer::SetIndices(std::vector<uint16_t> indices)
 	m_useIndices = true;
 
 	SetDirtyData(true);
+}
+
+void MeshRenderer::GenerateLods(const MeshSimplifier::Settings& settings)
+{
+	if (GetMeshName() == kCustomMeshName || !m_useIndices)
+	{
+		return;
+	}
+
+	MeshSimplifier::BuildLodChain(m_vertices, m_indices, m_lodLevels, settings);
+	m_indexBufferSize = m_indices.size();
+}
+
+void MeshRenderer::GenerateMeshlets()
+{
+	if (GetMeshName() == kCustomMeshName || !m_useIndices)
+	{
+		return;
+	}
+
+	if (m_lodLevels.empty())
+	{
+		VulkanCommonFunctions::LodLevel fullLevel;
+		fullLevel.indexCount = static_cast<uint32_t>(m_indices.size());
+		m_lodLevels.push_back(fullLevel);
+	}
+
+	m_meshlets.clear();
+	MeshletBuilder::BuildForLevels(m_vertices, m_indices, m_lodLevels, m_meshlets);
 }
\ No newline at end of file
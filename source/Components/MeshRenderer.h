@@ -3,6 +3,8 @@
 #include "source/Objects/ObjectComponent.h"
 #include "source/Vulkan Interface/VulkanCommonFunctions.h"
 #include "source/Vulkan Interface/GraphicsBuffer.h"
+#include "source/Management/MeshSimplifier.h"
+#include "source/Management/MeshletBuilder.h"
 
 #include <glm.hpp>
 
@@ -24,6 +26,18 @@ public:
 	void SetIndices(std::vector<uint16_t> indices);
 	size_t GetIndexBufferSize() { return m_indexBufferSize; }
 
+	//empty means the whole index buffer is the only level
+	virtual const std::vector<VulkanCommonFunctions::LodLevel>& GetLodLevels() { return m_lodLevels; }
+
+	//for named indexed meshes, has to happen before the first object using the mesh is added to the scene
+	void GenerateLods(const MeshSimplifier::Settings& settings);
+
+	//empty when the mesh is only ever culled as a whole
+	virtual const std::vector<VulkanCommonFunctions::MeshletInfo>& GetMeshlets() { return m_meshlets; }
+
+	//splits every level into clusters the renderer can cull one by one, call it after GenerateLods
+	void GenerateMeshlets();
+
 	glm::vec3 GetColor() { return m_color; }
 	void SetColor(glm::vec3 color) { m_color = color; }
 
@@ -69,6 +83,8 @@ public:
 protected:
 	std::vector<VulkanCommonFunctions::Vertex> m_vertices;
 	std::vector<uint16_t> m_indices;
+	std::vector<VulkanCommonFunctions::LodLevel> m_lodLevels;
+	std::vector<VulkanCommonFunctions::MeshletInfo> m_meshlets;
 
 	std::shared_ptr<GraphicsBuffer> m_vertexBuffer = nullptr;
 	std::shared_ptr<GraphicsBuffer> m_indexBuffer = nullptr;
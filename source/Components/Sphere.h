@@ -0,0 +1,87 @@
+#pragma once
+
+#include "source/Components/MeshRenderer.h"
+#include "source/Management/MeshSimplifier.h"
+#include "source/Management/MeshletBuilder.h"
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <cmath>
+
+class Sphere : public MeshRenderer {
+public:
+    Sphere() : MeshRenderer()
+    {
+        m_meshName = "Sphere";
+    }
+
+    const std::vector<VulkanCommonFunctions::Vertex>& GetVertices() override { return GetSphereMesh().vertices; };
+    const std::vector<uint16_t>& GetIndices() override { return GetSphereMesh().indices; };
+    const std::vector<VulkanCommonFunctions::LodLevel>& GetLodLevels() override { return GetSphereMesh().lodLevels; };
+    const std::vector<VulkanCommonFunctions::MeshletInfo>& GetMeshlets() override { return GetSphereMesh().meshlets; };
+
+private:
+    using MeshRenderer::SetIndices;
+    using MeshRenderer::SetVertices;
+
+    struct SphereMesh {
+        std::vector<VulkanCommonFunctions::Vertex> vertices;
+        std::vector<uint16_t> indices;
+        std::vector<VulkanCommonFunctions::LodLevel> lodLevels;
+        std::vector<VulkanCommonFunctions::MeshletInfo> meshlets;
+    };
+
+    static const uint32_t kSegments = 32;
+    static const uint32_t kRings = 16;
+
+    //wound clockwise like the other meshes, shared by every instance
+    //a function local static, so the mesh is built, simplified and split into meshlets when the first sphere asks for it, never during static init
+    static const SphereMesh& GetSphereMesh()
+    {
+        static const SphereMesh sphereMesh = BuildSphereMesh();
+        return sphereMesh;
+    }
+
+    static SphereMesh BuildSphereMesh()
+    {
+        SphereMesh mesh;
+        const float pi = 3.14159265358979f;
+
+        for (uint32_t ring = 0; ring <= kRings; ring++)
+        {
+            float phi = pi * ring / kRings;
+
+            for (uint32_t segment = 0; segment <= kSegments; segment++)
+            {
+                float theta = 2.0f * pi * segment / kSegments;
+
+                glm::vec3 position = 0.5f * glm::vec3(sin(phi) * cos(theta), cos(phi), sin(phi) * sin(theta));
+                mesh.vertices.push_back({ position, position * 2.0f, {(float)segment / kSegments, (float)ring / kRings} });
+            }
+        }
+
+        for (uint32_t ring = 0; ring < kRings; ring++)
+        {
+            for (uint32_t segment = 0; segment < kSegments; segment++)
+            {
+                uint16_t current = static_cast<uint16_t>(ring * (kSegments + 1) + segment);
+                uint16_t below = static_cast<uint16_t>(current + kSegments + 1);
+
+                //the triangles touching a pole would have two corners in the same place
+                if (ring != 0)
+                {
+                    mesh.indices.insert(mesh.indices.end(), { current, below, static_cast<uint16_t>(current + 1) });
+                }
+
+                if (ring != kRings - 1)
+                {
+                    mesh.indices.insert(mesh.indices.end(), { static_cast<uint16_t>(current + 1), below, static_cast<uint16_t>(below + 1) });
+                }
+            }
+        }
+
+        MeshSimplifier::BuildLodChain(mesh.vertices, mesh.indices, mesh.lodLevels, MeshSimplifier::Settings());
+        MeshletBuilder::BuildForLevels(mesh.vertices, mesh.indices, mesh.lodLevels, mesh.meshlets);
+
+        return mesh;
+    }
+};
\ No newline at end of file
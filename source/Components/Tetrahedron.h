@@ -17,7 +17,8 @@ private:
     using MeshRenderer::SetIndices;
     using MeshRenderer::SetVertices;
 
-    const std::vector<VulkanCommonFunctions::Vertex> tetrahedronVertices = {
+    //shared by every instance, a per object copy would allocate on every spawn
+    static inline const std::vector<VulkanCommonFunctions::Vertex> tetrahedronVertices = {
         //front
         {{-sqrt(2.0f / 9.0f), -sqrt(2.0f / 3.0f), -1.0f / 3.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, 0.0f}},
         {{sqrt(8.0f / 9.0f), 0.0f, -1.0f / 3.0f}, {0.0f, 0.0f, -1.0f}, {1.0f, 0.5f}},
@@ -39,7 +40,7 @@ private:
         {{-sqrt(2.0f / 9.0f), sqrt(2.0f / 3.0f), -1.0f / 3.0f}, {0.15713484f, 0.2721655f, 0.11111f}, {0.0f, 1.0f}}
     };
 
-    const std::vector<uint16_t> tetrahedronIndices = {
+    static inline const std::vector<uint16_t> tetrahedronIndices = {
         //front
         0, 1, 2,
 
@@ -93,6 +93,18 @@ void Text::GetCharacterInstanceInfo(std::pair<size_t, size_t> screenSize, std::s
 		currentCharacterInfo.scale = glm::vec3(widthScale * scale.x, heightScale * scale.y, scale.z);
 
 		currentCharacterInfo.isTextCharacter = 1;
+		currentCharacterInfo.textRenderMode = static_cast<uint32_t>(currentFont->GetAtlasType());
+
+		//distance field settings, ignored by the shader for bitmap fonts
+		if (currentFont->IsDistanceField())
+		{
+			currentCharacterInfo.distanceRange = currentFont->GetDistanceRangeUV();
+			currentCharacterInfo.outlineWidth = m_outlineWidth / currentFont->GetDistanceRange();
+			currentCharacterInfo.outlineColor = glm::vec4(m_outlineColor, 1.0f);
+			currentCharacterInfo.shadowOffset = m_shadowOffset;
+			currentCharacterInfo.shadowColor = m_shadowColor;
+		}
+
 		currentCharacterInfo.characterTextureSize = glm::vec2(currentGlyphInfo.width, currentGlyphInfo.height);
 		currentCharacterInfo.textureOffset = glm::vec2(currentGlyphInfo.locationX, currentGlyphInfo.locationY);
 
@@ -17,6 +17,19 @@ public:
 	void SetFontSize(float fontSize) { m_fontSize = fontSize; m_textDataDirty = true; }
 	float GetFontSize() { return m_fontSize; }
 
+	void SetColor(glm::vec4 color) { m_color = color; m_textDataDirty = true; }
+	glm::vec4 GetColor() { return m_color; }
+
+	//outline and shadow are only drawn for distance field fonts, width is in atlas pixels
+	void SetOutline(float width, glm::vec3 color) { m_outlineWidth = width; m_outlineColor = color; m_textDataDirty = true; }
+	float GetOutlineWidth() { return m_outlineWidth; }
+	glm::vec3 GetOutlineColor() { return m_outlineColor; }
+
+	//offset is in atlas texture coordinates, a zero vector disables the shadow
+	void SetShadow(glm::vec2 offset, glm::vec4 color) { m_shadowOffset = offset; m_shadowColor = color; m_textDataDirty = true; }
+	glm::vec2 GetShadowOffset() { return m_shadowOffset; }
+	glm::vec4 GetShadowColor() { return m_shadowColor; }
+
 	const std::vector<VulkanCommonFunctions::UIVertex>& GetVertices() override { return m_squareVertices; };
 	const std::vector<uint16_t>& GetIndices() override { return m_squareIndices; };
 
@@ -54,6 +67,12 @@ private:
 
 	float m_fontSize = 40.0f;
 
+	float m_outlineWidth = 0.0f;
+	glm::vec3 m_outlineColor = glm::vec3(0.0f);
+
+	glm::vec2 m_shadowOffset = glm::vec2(0.0f);
+	glm::vec4 m_shadowColor = glm::vec4(0.0f, 0.0f, 0.0f, 0.5f);
+
 	float m_additionalCharacterSpacing = 0.0f;
 	float m_additionalLineSpacing = 0.0f;
 
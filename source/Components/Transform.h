@@ -60,23 +60,28 @@ public:
 	void Move(glm::vec3 amountToMove) { m_position += glm::vec4(amountToMove, 0.0f); }
 	void Scale(glm::vec3 amountToScale) { m_scale += glm::vec4(amountToScale, 0.0f); }
 
-	glm::vec3 Forward()
+	glm::vec3 Forward() { return ForwardFromRotation(m_rotation); }
+	glm::vec3 Right() { return RightFromRotation(m_rotation); }
+	glm::vec3 Up() { return UpFromRotation(m_rotation); }
+
+	//static versions so a copied rotation can be used without a component
+	static glm::vec3 ForwardFromRotation(glm::vec3 rotation)
 	{
 		glm::vec3 forward;
-		forward.x = cos(glm::radians(m_rotation.y)) * cos(glm::radians(m_rotation.x));
-		forward.y = sin(glm::radians(m_rotation.x));
-		forward.z = sin(glm::radians(m_rotation.y)) * cos(glm::radians(m_rotation.x));
+		forward.x = cos(glm::radians(rotation.y)) * cos(glm::radians(rotation.x));
+		forward.y = sin(glm::radians(rotation.x));
+		forward.z = sin(glm::radians(rotation.y)) * cos(glm::radians(rotation.x));
 		return glm::normalize(forward);
 	}
 
-	glm::vec3 Right()
+	static glm::vec3 RightFromRotation(glm::vec3 rotation)
 	{
-		return glm::normalize(glm::cross(Forward(), glm::vec3(0.0f, 1.0f, 0.0f)));
+		return glm::normalize(glm::cross(ForwardFromRotation(rotation), glm::vec3(0.0f, 1.0f, 0.0f)));
 	}
 
-	glm::vec3 Up()
+	static glm::vec3 UpFromRotation(glm::vec3 rotation)
 	{
-		return glm::normalize(glm::cross(Right(), Forward()));
+		return glm::normalize(glm::cross(RightFromRotation(rotation), ForwardFromRotation(rotation)));
 	}
 
 private:
@@ -20,10 +20,17 @@ public:
 		m_texturePath = texturePath;
 		m_textured = true;
 		m_textureDataDirty = true;
+		m_atlasPagePath = "";
+		m_uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 		CalculateMeshInfo();
 	};
 	void SetTextured(bool textured) { m_textured = textured; }
 
+	//an image packed into a UI atlas page is drawn from that page, the texture path is still the original image
+	void SetAtlasRegion(const std::string& pagePath, glm::vec4 uvRect) { m_atlasPagePath = pagePath; m_uvRect = uvRect; }
+	std::string GetSampledTexturePath() { return m_atlasPagePath.empty() ? m_texturePath : m_atlasPagePath; }
+	glm::vec4 GetUVRect() { return m_uvRect; }
+
 	void CalculateMeshInfo();
 
 	glm::vec3 GetColor() { return m_color; }
@@ -59,5 +66,8 @@ private:
 	int m_imageWidth = 0;
 	int m_imageHeight = 0;
 
+	std::string m_atlasPagePath = "";
+	glm::vec4 m_uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
 	alignas(16) glm::vec3 m_color = glm::vec3(1.0f);
 };
\ No newline at end of file
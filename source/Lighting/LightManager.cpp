@@ -0,0 +1,433 @@
+#include "LightManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+	//21 bits per axis, cells are stored relative to the middle of that range
+	constexpr int kCellBits = 21;
+	constexpr int64_t kCellOffset = int64_t(1) << (kCellBits - 1);
+	constexpr uint64_t kCellMask = (uint64_t(1) << kCellBits) - 1;
+
+	glm::ivec3 DecodeCellKey(uint64_t key)
+	{
+		return glm::ivec3(
+			static_cast<int>(static_cast<int64_t>(key & kCellMask) - kCellOffset),
+			static_cast<int>(static_cast<int64_t>((key >> kCellBits) & kCellMask) - kCellOffset),
+			static_cast<int>(static_cast<int64_t>((key >> (kCellBits * 2)) & kCellMask) - kCellOffset));
+	}
+}
+
+LightManager::LightManager(float cellSize)
+{
+	m_cellSize = std::max(cellSize, 0.001f);
+}
+
+void LightManager::BeginFrame()
+{
+	m_frame++;
+}
+
+void LightManager::SetLight(size_t lightKey, size_t lightIndex, glm::vec3 position, float range, float intensity)
+{
+	range = std::max(range, 0.0f);
+
+	auto existing = m_keyToSlot.find(lightKey);
+	size_t slot;
+
+	//the insert below can rehash, which leaves existing pointing nowhere
+	bool isNewLight = existing == m_keyToSlot.end();
+
+	if (isNewLight)
+	{
+		if (!m_freeSlots.empty())
+		{
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else {
+			slot = m_entries.size();
+			m_entries.emplace_back();
+		}
+
+		m_entries[slot] = Entry();
+		m_entries[slot].lightKey = lightKey;
+		m_entries[slot].inUse = true;
+		m_keyToSlot[lightKey] = slot;
+	}
+	else {
+		slot = existing->second;
+	}
+
+	Entry& entry = m_entries[slot];
+	entry.lightIndex = lightIndex;
+	entry.intensity = intensity;
+	entry.lastSetFrame = m_frame;
+
+	glm::ivec3 minCell = GetCell(position - glm::vec3(range));
+	glm::ivec3 maxCell = GetCell(position + glm::vec3(range));
+
+	bool cellsChanged = isNewLight || minCell != entry.minCell || maxCell != entry.maxCell;
+
+	entry.position = position;
+	entry.range = range;
+
+	//most lights stay inside the same cells from one frame to the next, those don't touch the grid at all
+	if (!cellsChanged)
+	{
+		return;
+	}
+
+	RemoveFromCells(slot);
+
+	entry.minCell = minCell;
+	entry.maxCell = maxCell;
+
+	InsertIntoCells(slot);
+}
+
+void LightManager::EndFrame()
+{
+	for (size_t slot = 0; slot < m_entries.size(); slot++)
+	{
+		if (m_entries[slot].inUse && m_entries[slot].lastSetFrame != m_frame)
+		{
+			RemoveLight(m_entries[slot].lightKey);
+		}
+	}
+}
+
+void LightManager::RemoveLight(size_t lightKey)
+{
+	auto existing = m_keyToSlot.find(lightKey);
+
+	if (existing == m_keyToSlot.end())
+	{
+		return;
+	}
+
+	size_t slot = existing->second;
+	RemoveFromCells(slot);
+
+	m_entries[slot] = Entry();
+	m_freeSlots.push_back(slot);
+	m_keyToSlot.erase(existing);
+}
+
+void LightManager::Clear()
+{
+	m_cells.clear();
+	m_largeLights.clear();
+	m_entries.clear();
+	m_freeSlots.clear();
+	m_keyToSlot.clear();
+}
+
+size_t LightManager::SelectLights(const ViewInfo& view, size_t maxLights, std::vector<Selection>& outSelections)
+{
+	outSelections.clear();
+	m_query++;
+
+	Frustum frustum = BuildFrustum(view);
+
+	for (size_t i = 0; i < m_largeLights.size(); i++)
+	{
+		TestLight(m_largeLights[i], view, frustum, outSelections);
+	}
+
+	glm::ivec3 minCell = GetCell(frustum.boundsMin);
+	glm::ivec3 maxCell = GetCell(frustum.boundsMax);
+	glm::ivec3 cellSpan = maxCell - minCell + glm::ivec3(1);
+
+	uint64_t frustumCellCount = static_cast<uint64_t>(cellSpan.x) * static_cast<uint64_t>(cellSpan.y) * static_cast<uint64_t>(cellSpan.z);
+
+	//a long far plane can cover more cells than hold lights, walk the occupied ones instead in that case
+	if (frustumCellCount > m_cells.size())
+	{
+		for (auto it = m_cells.begin(); it != m_cells.end(); it++)
+		{
+			glm::ivec3 cell = DecodeCellKey(it->first);
+			glm::vec3 cellMin = glm::vec3(cell) * m_cellSize;
+
+			if (!BoxInFrustum(frustum, cellMin, cellMin + glm::vec3(m_cellSize)))
+			{
+				continue;
+			}
+
+			for (size_t i = 0; i < it->second.size(); i++)
+			{
+				TestLight(it->second[i], view, frustum, outSelections);
+			}
+		}
+	}
+	else {
+		for (int z = minCell.z; z <= maxCell.z; z++)
+		{
+			for (int y = minCell.y; y <= maxCell.y; y++)
+			{
+				for (int x = minCell.x; x <= maxCell.x; x++)
+				{
+					auto cell = m_cells.find(MakeCellKey(x, y, z));
+
+					if (cell == m_cells.end())
+					{
+						continue;
+					}
+
+					for (size_t i = 0; i < cell->second.size(); i++)
+					{
+						TestLight(cell->second[i], view, frustum, outSelections);
+					}
+				}
+			}
+		}
+	}
+
+	size_t visibleCount = outSelections.size();
+
+	//ties go to the lower key so the same scene always uploads the same lights
+	auto higherContribution = [](const Selection& a, const Selection& b) {
+		if (a.contribution != b.contribution)
+		{
+			return a.contribution > b.contribution;
+		}
+
+		return a.lightKey < b.lightKey;
+	};
+
+	if (outSelections.size() > maxLights)
+	{
+		std::partial_sort(outSelections.begin(), outSelections.begin() + maxLights, outSelections.end(), higherContribution);
+		outSelections.resize(maxLights);
+	}
+	else {
+		std::sort(outSelections.begin(), outSelections.end(), higherContribution);
+	}
+
+	return visibleCount;
+}
+
+LightManager::Frustum LightManager::BuildFrustum(const ViewInfo& view)
+{
+	Frustum frustum;
+
+	glm::vec3 forward = glm::normalize(view.forward);
+	glm::vec3 right = glm::normalize(glm::cross(forward, view.up));
+	glm::vec3 up = glm::cross(right, forward);
+
+	float tanHalfY = std::tan(glm::radians(view.fov) * 0.5f);
+	float tanHalfX = tanHalfY * view.aspectRatio;
+
+	//normals point into the frustum, a point is inside when dot(normal, point) + distance >= 0 for every plane
+	glm::vec3 inside = view.position + forward * ((view.nearPlane + view.farPlane) * 0.5f);
+
+	auto makePlane = [inside](glm::vec3 normal, glm::vec3 point) {
+		Plane plane;
+		plane.normal = glm::normalize(normal);
+
+		if (glm::dot(plane.normal, inside - point) < 0.0f)
+		{
+			plane.normal = -plane.normal;
+		}
+
+		plane.distance = -glm::dot(plane.normal, point);
+		return plane;
+	};
+
+	frustum.planes[0] = makePlane(forward, view.position + forward * view.nearPlane);
+	frustum.planes[1] = makePlane(forward, view.position + forward * view.farPlane);
+	frustum.planes[2] = makePlane(glm::cross(up, forward - right * tanHalfX), view.position);
+	frustum.planes[3] = makePlane(glm::cross(up, forward + right * tanHalfX), view.position);
+	frustum.planes[4] = makePlane(glm::cross(right, forward + up * tanHalfY), view.position);
+	frustum.planes[5] = makePlane(glm::cross(right, forward - up * tanHalfY), view.position);
+
+	frustum.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+	frustum.boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+
+	float depths[2] = { view.nearPlane, view.farPlane };
+
+	for (int i = 0; i < 2; i++)
+	{
+		glm::vec3 center = view.position + forward * depths[i];
+		glm::vec3 halfRight = right * (tanHalfX * depths[i]);
+		glm::vec3 halfUp = up * (tanHalfY * depths[i]);
+
+		for (int corner = 0; corner < 4; corner++)
+		{
+			glm::vec3 point = center + halfRight * ((corner & 1) ? 1.0f : -1.0f) + halfUp * ((corner & 2) ? 1.0f : -1.0f);
+
+			frustum.boundsMin = glm::min(frustum.boundsMin, point);
+			frustum.boundsMax = glm::max(frustum.boundsMax, point);
+		}
+	}
+
+	return frustum;
+}
+
+bool LightManager::SphereInFrustum(const Frustum& frustum, glm::vec3 center, float radius)
+{
+	//the plane tests alone let through spheres sitting past the corners, the bounds catch most of those
+	glm::vec3 closest = glm::max(frustum.boundsMin, glm::min(center, frustum.boundsMax));
+	glm::vec3 offset = closest - center;
+
+	if (glm::dot(offset, offset) > radius * radius)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < frustum.planes.size(); i++)
+	{
+		if (glm::dot(frustum.planes[i].normal, center) + frustum.planes[i].distance < -radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool LightManager::BoxInFrustum(const Frustum& frustum, glm::vec3 boxMin, glm::vec3 boxMax)
+{
+	for (size_t i = 0; i < frustum.planes.size(); i++)
+	{
+		const Plane& plane = frustum.planes[i];
+
+		//the corner furthest along the plane normal, if that one is outside the whole box is
+		glm::vec3 corner(
+			plane.normal.x >= 0.0f ? boxMax.x : boxMin.x,
+			plane.normal.y >= 0.0f ? boxMax.y : boxMin.y,
+			plane.normal.z >= 0.0f ? boxMax.z : boxMin.z);
+
+		if (glm::dot(plane.normal, corner) + plane.distance < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+float LightManager::ComputeContribution(const ViewInfo& view, const Entry& entry)
+{
+	if (entry.range <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	//falls off the same way the shadow selector weights its lights, scaled by how bright the light is
+	float distance = glm::length(entry.position - view.position);
+	return entry.intensity / (1.0f + distance / entry.range);
+}
+
+uint64_t LightManager::MakeCellKey(int x, int y, int z)
+{
+	uint64_t keyX = static_cast<uint64_t>(static_cast<int64_t>(x) + kCellOffset) & kCellMask;
+	uint64_t keyY = static_cast<uint64_t>(static_cast<int64_t>(y) + kCellOffset) & kCellMask;
+	uint64_t keyZ = static_cast<uint64_t>(static_cast<int64_t>(z) + kCellOffset) & kCellMask;
+
+	return keyX | (keyY << kCellBits) | (keyZ << (kCellBits * 2));
+}
+
+glm::ivec3 LightManager::GetCell(glm::vec3 position)
+{
+	glm::vec3 cell = glm::floor(position / m_cellSize);
+	glm::vec3 limit = glm::vec3(static_cast<float>(kCellOffset - 1));
+
+	return glm::ivec3(glm::clamp(cell, -limit, limit));
+}
+
+void LightManager::InsertIntoCells(size_t slot)
+{
+	Entry& entry = m_entries[slot];
+	glm::ivec3 span = entry.maxCell - entry.minCell + glm::ivec3(1);
+
+	entry.isLarge = span.x > kMaxCellSpan || span.y > kMaxCellSpan || span.z > kMaxCellSpan;
+
+	if (entry.isLarge)
+	{
+		m_largeLights.push_back(slot);
+		return;
+	}
+
+	for (int z = entry.minCell.z; z <= entry.maxCell.z; z++)
+	{
+		for (int y = entry.minCell.y; y <= entry.maxCell.y; y++)
+		{
+			for (int x = entry.minCell.x; x <= entry.maxCell.x; x++)
+			{
+				m_cells[MakeCellKey(x, y, z)].push_back(slot);
+			}
+		}
+	}
+}
+
+void LightManager::RemoveFromCells(size_t slot)
+{
+	Entry& entry = m_entries[slot];
+
+	auto eraseSlot = [slot](std::vector<size_t>& slots) {
+		auto found = std::find(slots.begin(), slots.end(), slot);
+
+		if (found != slots.end())
+		{
+			*found = slots.back();
+			slots.pop_back();
+		}
+	};
+
+	if (entry.isLarge)
+	{
+		eraseSlot(m_largeLights);
+		entry.isLarge = false;
+		return;
+	}
+
+	for (int z = entry.minCell.z; z <= entry.maxCell.z; z++)
+	{
+		for (int y = entry.minCell.y; y <= entry.maxCell.y; y++)
+		{
+			for (int x = entry.minCell.x; x <= entry.maxCell.x; x++)
+			{
+				auto cell = m_cells.find(MakeCellKey(x, y, z));
+
+				if (cell == m_cells.end())
+				{
+					continue;
+				}
+
+				eraseSlot(cell->second);
+
+				if (cell->second.empty())
+				{
+					m_cells.erase(cell);
+				}
+			}
+		}
+	}
+}
+
+void LightManager::TestLight(size_t slot, const ViewInfo& view, const Frustum& frustum, std::vector<Selection>& outSelections)
+{
+	Entry& entry = m_entries[slot];
+
+	if (entry.lastQuery == m_query)
+	{
+		return;
+	}
+
+	entry.lastQuery = m_query;
+
+	//the shader fades every light to nothing at its max distance, so a light whose sphere misses the frustum can't light anything on screen
+	if (!SphereInFrustum(frustum, entry.position, entry.range))
+	{
+		return;
+	}
+
+	Selection selection;
+	selection.lightIndex = entry.lightIndex;
+	selection.lightKey = entry.lightKey;
+	selection.contribution = ComputeContribution(view, entry);
+
+	outSelections.push_back(selection);
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//keeps every light in a spatial hash keyed by the cells its range overlaps
+//each frame only the cells the view frustum touches are visited, so picking the lights to upload doesn't scale with the scene
+class LightManager {
+public:
+	struct ViewInfo {
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 forward = glm::vec3(0.0f, 0.0f, -1.0f);
+		glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+
+		//vertical field of view in degrees
+		float fov = 45.0f;
+		float aspectRatio = 1.0f;
+		float nearPlane = 0.1f;
+		float farPlane = 100.0f;
+	};
+
+	struct Selection {
+		//index into the frame's light list and the object handle that stays the same across frames
+		size_t lightIndex = 0;
+		size_t lightKey = 0;
+
+		float contribution = 0.0f;
+	};
+
+	LightManager(float cellSize = kDefaultCellSize);
+
+	//call SetLight for every light in the frame between these, lights that weren't set are removed by EndFrame
+	void BeginFrame();
+	void SetLight(size_t lightKey, size_t lightIndex, glm::vec3 position, float range, float intensity);
+	void EndFrame();
+
+	void RemoveLight(size_t lightKey);
+	void Clear();
+
+	//lights whose range reaches into the view, highest contribution first and at most maxLights of them
+	//returns how many lights were visible before the cap was applied
+	size_t SelectLights(const ViewInfo& view, size_t maxLights, std::vector<Selection>& outSelections);
+
+	size_t GetLightCount() { return m_keyToSlot.size(); }
+	size_t GetOccupiedCellCount() { return m_cells.size(); }
+
+	//lights that reach this many cells along any axis skip the grid and are tested every frame
+	static constexpr int kMaxCellSpan = 8;
+	static constexpr float kDefaultCellSize = 16.0f;
+
+private:
+	struct Plane {
+		glm::vec3 normal = glm::vec3(0.0f);
+		float distance = 0.0f;
+	};
+
+	struct Frustum {
+		std::array<Plane, 6> planes;
+
+		glm::vec3 boundsMin = glm::vec3(0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.0f);
+	};
+
+	struct Entry {
+		size_t lightKey = 0;
+		size_t lightIndex = 0;
+
+		glm::vec3 position = glm::vec3(0.0f);
+		float range = 0.0f;
+		float intensity = 0.0f;
+
+		//inclusive range of cells the light is stored in, unused for large lights
+		glm::ivec3 minCell = glm::ivec3(0);
+		glm::ivec3 maxCell = glm::ivec3(-1);
+		bool isLarge = false;
+
+		uint64_t lastSetFrame = 0;
+		uint64_t lastQuery = 0;
+		bool inUse = false;
+	};
+
+	static Frustum BuildFrustum(const ViewInfo& view);
+	static bool SphereInFrustum(const Frustum& frustum, glm::vec3 center, float radius);
+	static bool BoxInFrustum(const Frustum& frustum, glm::vec3 boxMin, glm::vec3 boxMax);
+	static float ComputeContribution(const ViewInfo& view, const Entry& entry);
+
+	static uint64_t MakeCellKey(int x, int y, int z);
+	glm::ivec3 GetCell(glm::vec3 position);
+
+	void InsertIntoCells(size_t slot);
+	void RemoveFromCells(size_t slot);
+
+	//visits a light once per query even when it's stored in several cells
+	void TestLight(size_t slot, const ViewInfo& view, const Frustum& frustum, std::vector<Selection>& outSelections);
+
+	float m_cellSize;
+
+	std::unordered_map<uint64_t, std::vector<size_t>> m_cells;
+	std::vector<size_t> m_largeLights;
+
+	std::vector<Entry> m_entries;
+	std::vector<size_t> m_freeSlots;
+	std::unordered_map<size_t, size_t> m_keyToSlot;
+
+	uint64_t m_frame = 0;
+	uint64_t m_query = 0;
+};
\ No newline at end of file
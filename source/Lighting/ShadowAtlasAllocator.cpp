@@ -0,0 +1,152 @@
+#include "ShadowAtlasAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+ShadowAtlasAllocator::ShadowAtlasAllocator(uint32_t atlasSize, uint32_t minTileSize)
+{
+	if (atlasSize == 0 || minTileSize == 0 || RoundUpToPowerOfTwo(atlasSize) != atlasSize || RoundUpToPowerOfTwo(minTileSize) != minTileSize)
+	{
+		throw std::invalid_argument("shadow atlas sizes must be powers of two");
+	}
+
+	m_atlasSize = atlasSize;
+	m_minTileSize = std::min(minTileSize, atlasSize);
+
+	Clear();
+}
+
+uint32_t ShadowAtlasAllocator::RoundUpToPowerOfTwo(uint32_t value)
+{
+	uint32_t result = 1;
+
+	while (result < value && result < 0x80000000u)
+	{
+		result <<= 1;
+	}
+
+	return result;
+}
+
+uint32_t ShadowAtlasAllocator::GetLevel(uint32_t size)
+{
+	uint32_t level = 0;
+
+	while (GetTileSize(level + 1) >= size && GetTileSize(level + 1) >= m_minTileSize)
+	{
+		level++;
+	}
+
+	return level;
+}
+
+ShadowAtlasAllocator::Tile ShadowAtlasAllocator::Allocate(uint32_t size)
+{
+	size = std::clamp(RoundUpToPowerOfTwo(size), m_minTileSize, m_atlasSize);
+	uint32_t targetLevel = GetLevel(size);
+
+	//find the smallest free tile that is at least as big as the request
+	int sourceLevel = static_cast<int>(targetLevel);
+	while (sourceLevel >= 0 && m_freeTiles[sourceLevel].empty())
+	{
+		sourceLevel--;
+	}
+
+	if (sourceLevel < 0)
+	{
+		return Tile();
+	}
+
+	uint64_t key = *m_freeTiles[sourceLevel].begin();
+	m_freeTiles[sourceLevel].erase(m_freeTiles[sourceLevel].begin());
+
+	uint32_t x = static_cast<uint32_t>(key & 0xFFFFFFFFull);
+	uint32_t y = static_cast<uint32_t>(key >> 32);
+
+	//split down to the requested size, keeping the top left quarter and freeing the other three
+	for (uint32_t level = static_cast<uint32_t>(sourceLevel) + 1; level <= targetLevel; level++)
+	{
+		uint32_t childSize = GetTileSize(level);
+
+		m_freeTiles[level].insert(MakeKey(x + childSize, y));
+		m_freeTiles[level].insert(MakeKey(x, y + childSize));
+		m_freeTiles[level].insert(MakeKey(x + childSize, y + childSize));
+	}
+
+	Tile tile;
+	tile.x = x;
+	tile.y = y;
+	tile.size = GetTileSize(targetLevel);
+
+	m_allocatedTileCount++;
+	m_allocatedArea += static_cast<uint64_t>(tile.size) * tile.size;
+
+	return tile;
+}
+
+void ShadowAtlasAllocator::Free(Tile tile)
+{
+	if (!tile.IsValid())
+	{
+		return;
+	}
+
+	m_allocatedTileCount--;
+	m_allocatedArea -= static_cast<uint64_t>(tile.size) * tile.size;
+
+	uint32_t level = GetLevel(tile.size);
+	uint32_t x = tile.x;
+	uint32_t y = tile.y;
+
+	//merge with the three siblings for as long as they are all free
+	while (level > 0)
+	{
+		uint32_t parentSize = GetTileSize(level - 1);
+		uint32_t childSize = GetTileSize(level);
+
+		uint32_t parentX = x & ~(parentSize - 1);
+		uint32_t parentY = y & ~(parentSize - 1);
+
+		std::set<uint64_t>& freeTiles = m_freeTiles[level];
+		bool siblingsFree = true;
+
+		for (uint32_t i = 0; i < 4 && siblingsFree; i++)
+		{
+			uint32_t siblingX = parentX + (i % 2) * childSize;
+			uint32_t siblingY = parentY + (i / 2) * childSize;
+
+			if (siblingX == x && siblingY == y)
+			{
+				continue;
+			}
+
+			siblingsFree = freeTiles.contains(MakeKey(siblingX, siblingY));
+		}
+
+		if (!siblingsFree)
+		{
+			break;
+		}
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			freeTiles.erase(MakeKey(parentX + (i % 2) * childSize, parentY + (i / 2) * childSize));
+		}
+
+		x = parentX;
+		y = parentY;
+		level--;
+	}
+
+	m_freeTiles[level].insert(MakeKey(x, y));
+}
+
+void ShadowAtlasAllocator::Clear()
+{
+	m_freeTiles.clear();
+	m_freeTiles.resize(GetLevel(m_minTileSize) + 1);
+	m_freeTiles[0].insert(MakeKey(0, 0));
+
+	m_allocatedTileCount = 0;
+	m_allocatedArea = 0;
+}
\ No newline at end of file
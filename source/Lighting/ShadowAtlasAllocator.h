@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+//hands out square power of two tiles of one big shadow map, a quadtree where freed siblings merge back into their parent
+//doesn't touch vulkan so packing can be checked on its own
+class ShadowAtlasAllocator {
+public:
+	struct Tile {
+		uint32_t x = 0;
+		uint32_t y = 0;
+		uint32_t size = 0;
+
+		bool IsValid() const { return size > 0; }
+	};
+
+	//both sizes must be powers of two
+	ShadowAtlasAllocator(uint32_t atlasSize, uint32_t minTileSize);
+
+	//size is rounded up to a power of two and clamped to the atlas, returns an invalid tile when there's no room
+	Tile Allocate(uint32_t size);
+	void Free(Tile tile);
+	void Clear();
+
+	uint32_t GetAtlasSize() { return m_atlasSize; }
+	uint32_t GetMinTileSize() { return m_minTileSize; }
+	size_t GetAllocatedTileCount() { return m_allocatedTileCount; }
+	uint64_t GetAllocatedArea() { return m_allocatedArea; }
+
+	static uint32_t RoundUpToPowerOfTwo(uint32_t value);
+
+private:
+	//level 0 is the whole atlas, every level down halves the tile size
+	uint32_t GetLevel(uint32_t size);
+	uint32_t GetTileSize(uint32_t level) { return m_atlasSize >> level; }
+
+	static uint64_t MakeKey(uint32_t x, uint32_t y) { return (static_cast<uint64_t>(y) << 32) | x; }
+
+	uint32_t m_atlasSize = 0;
+	uint32_t m_minTileSize = 0;
+
+	//ordered so allocation always takes the free tile closest to the top left, which keeps packing deterministic
+	std::vector<std::set<uint64_t>> m_freeTiles;
+
+	size_t m_allocatedTileCount = 0;
+	uint64_t m_allocatedArea = 0;
+};
\ No newline at end of file
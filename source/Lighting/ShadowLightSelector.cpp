@@ -0,0 +1,106 @@
+#include "ShadowLightSelector.h"
+#include "source/Lighting/ShadowAtlasAllocator.h"
+
+#include <algorithm>
+#include <cmath>
+
+float ShadowLightSelector::ComputeScreenCoverage(const ViewInfo& view, glm::vec3 lightPosition, float range)
+{
+	if (range <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	glm::vec3 toLight = lightPosition - view.position;
+	float distance = glm::length(toLight);
+
+	//the camera is inside the light's range, anything it looks at could be lit
+	if (distance <= range)
+	{
+		return 1.0f;
+	}
+
+	float halfFovY = glm::radians(view.fov) * 0.5f;
+	float tanHalfY = std::tan(halfFovY);
+	float tanHalfX = tanHalfY * view.aspectRatio;
+
+	//the cone through the corners of the screen contains the whole view frustum
+	float viewConeHalfAngle = std::atan(std::sqrt(tanHalfX * tanHalfX + tanHalfY * tanHalfY));
+	float lightHalfAngle = std::asin(range / distance);
+
+	glm::vec3 forward = glm::normalize(view.forward);
+	float angleToLight = std::acos(std::clamp(glm::dot(toLight / distance, forward), -1.0f, 1.0f));
+
+	if (angleToLight - lightHalfAngle > viewConeHalfAngle)
+	{
+		return 0.0f;
+	}
+
+	//fraction of the narrower screen axis the light's range spans, squared to get an area
+	float smallerHalfFov = std::min(halfFovY, std::atan(tanHalfX));
+	float linearCoverage = std::min(lightHalfAngle / smallerHalfFov, 1.0f);
+
+	return linearCoverage * linearCoverage;
+}
+
+float ShadowLightSelector::ComputePriority(const ViewInfo& view, const Light& light)
+{
+	float coverage = ComputeScreenCoverage(view, light.position, light.range);
+
+	if (coverage <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	float distance = glm::length(light.position - view.position);
+	return coverage / (1.0f + distance / light.range);
+}
+
+uint32_t ShadowLightSelector::ChooseTileSize(float coverage, const Settings& settings)
+{
+	float linearCoverage = std::sqrt(std::clamp(coverage, 0.0f, 1.0f));
+	uint32_t tileSize = ShadowAtlasAllocator::RoundUpToPowerOfTwo(static_cast<uint32_t>(settings.maxTileSize * linearCoverage));
+
+	return std::clamp(tileSize, settings.minTileSize, settings.maxTileSize);
+}
+
+void ShadowLightSelector::Select(const ViewInfo& view, const std::vector<Light>& lights, const Settings& settings, std::vector<Selection>& outSelections)
+{
+	outSelections.clear();
+
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		float priority = ComputePriority(view, lights[i]);
+
+		if (priority <= 0.0f)
+		{
+			continue;
+		}
+
+		Selection selection;
+		selection.light = lights[i];
+		selection.priority = priority;
+		selection.tileSize = ChooseTileSize(ComputeScreenCoverage(view, lights[i].position, lights[i].range), settings);
+
+		outSelections.push_back(selection);
+	}
+
+	//ties go to the lower key so the same scene always picks the same lights
+	auto higherPriority = [](const Selection& a, const Selection& b) {
+		if (a.priority != b.priority)
+		{
+			return a.priority > b.priority;
+		}
+
+		return a.light.lightKey < b.light.lightKey;
+	};
+
+	if (outSelections.size() > settings.maxShadowedLights)
+	{
+		std::partial_sort(outSelections.begin(), outSelections.begin() + settings.maxShadowedLights, outSelections.end(), higherPriority);
+		outSelections.resize(settings.maxShadowedLights);
+	}
+	else {
+		std::sort(outSelections.begin(), outSelections.end(), higherPriority);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//decides which lights get a shadow map this frame and how much of the atlas each one deserves
+//only works on positions and ranges so it runs without a device
+class ShadowLightSelector {
+public:
+	struct ViewInfo {
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 forward = glm::vec3(0.0f, 0.0f, -1.0f);
+
+		//vertical field of view in degrees
+		float fov = 45.0f;
+		float aspectRatio = 1.0f;
+	};
+
+	struct Light {
+		//index into the frame's light list and the object handle that stays the same across frames
+		size_t lightIndex = 0;
+		size_t lightKey = 0;
+
+		glm::vec3 position = glm::vec3(0.0f);
+		float range = 0.0f;
+	};
+
+	struct Selection {
+		Light light;
+
+		float priority = 0.0f;
+		uint32_t tileSize = 0;
+	};
+
+	struct Settings {
+		size_t maxShadowedLights = 8;
+
+		uint32_t minTileSize = 64;
+		uint32_t maxTileSize = 512;
+	};
+
+	//0 when nothing the light reaches can be on screen, 1 when its range covers the whole view
+	static float ComputeScreenCoverage(const ViewInfo& view, glm::vec3 lightPosition, float range);
+
+	//coverage weighted towards the lights closest to the camera
+	static float ComputePriority(const ViewInfo& view, const Light& light);
+
+	//tile edge for one cube face, proportional to how much of the screen the light covers
+	static uint32_t ChooseTileSize(float coverage, const Settings& settings);
+
+	//highest priority first, lights that can't affect the view are never selected
+	static void Select(const ViewInfo& view, const std::vector<Light>& lights, const Settings& settings, std::vector<Selection>& outSelections);
+};
\ No newline at end of file
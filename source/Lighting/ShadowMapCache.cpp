@@ -0,0 +1,204 @@
+#include "ShadowMapCache.h"
+
+#include <gtc/matrix_transform.hpp>
+
+namespace {
+	constexpr uint64_t kHashSeed = 14695981039346656037ull;
+	constexpr uint64_t kHashPrime = 1099511628211ull;
+	constexpr size_t kNoEntry = static_cast<size_t>(-1);
+}
+
+ShadowMapCache::ShadowMapCache(uint32_t atlasSize, uint32_t minTileSize) : m_allocator(atlasSize, minTileSize)
+{
+}
+
+void ShadowMapCache::BeginFrame(const std::vector<ShadowLightSelector::Selection>& selections)
+{
+	m_previousEntries.swap(m_entries);
+	m_entries.clear();
+
+	m_previousIndices.clear();
+	for (size_t i = 0; i < m_previousEntries.size(); i++)
+	{
+		m_previousIndices[m_previousEntries[i].light.lightKey] = i;
+	}
+
+	//a light keeps its tiles unless the size it wants is more than one step away, so lights near a threshold don't thrash
+	std::vector<size_t> reusedEntries(selections.size(), kNoEntry);
+	std::vector<bool> previousReused(m_previousEntries.size(), false);
+
+	for (size_t i = 0; i < selections.size(); i++)
+	{
+		auto previous = m_previousIndices.find(selections[i].light.lightKey);
+
+		if (previous == m_previousIndices.end())
+		{
+			continue;
+		}
+
+		uint32_t currentSize = m_previousEntries[previous->second].faces[0].size;
+		uint32_t wantedSize = selections[i].tileSize;
+
+		if (currentSize * 2 >= wantedSize && currentSize <= wantedSize * 2)
+		{
+			reusedEntries[i] = previous->second;
+			previousReused[previous->second] = true;
+		}
+	}
+
+	//free everything that isn't kept before placing new lights so their space can be reused straight away
+	for (size_t i = 0; i < m_previousEntries.size(); i++)
+	{
+		if (!previousReused[i])
+		{
+			FreeFaces(m_previousEntries[i]);
+		}
+	}
+
+	for (size_t i = 0; i < selections.size(); i++)
+	{
+		Entry entry;
+
+		if (reusedEntries[i] != kNoEntry)
+		{
+			entry = m_previousEntries[reusedEntries[i]];
+		}
+		else if (!AllocateFaces(entry, selections[i].tileSize)) {
+			continue;
+		}
+
+		entry.light = selections[i].light;
+		entry.casterHash = kHashSeed;
+		entry.needsRender = false;
+
+		m_entries.push_back(entry);
+	}
+
+	m_previousEntries.clear();
+}
+
+void ShadowMapCache::AddCaster(const glm::mat4& modelMatrix, float radius)
+{
+	glm::vec3 center = glm::vec3(modelMatrix[3]);
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		Entry& entry = m_entries[i];
+		float reach = entry.light.range + radius;
+		glm::vec3 offset = center - entry.light.position;
+
+		if (glm::dot(offset, offset) > reach * reach)
+		{
+			continue;
+		}
+
+		entry.casterHash = HashBytes(entry.casterHash, &modelMatrix[0][0], sizeof(float) * 16);
+	}
+}
+
+void ShadowMapCache::EndFrame()
+{
+	m_renderedLightCount = 0;
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		Entry& entry = m_entries[i];
+
+		entry.needsRender = !entry.rendered
+			|| entry.renderedPosition != entry.light.position
+			|| entry.renderedRange != entry.light.range
+			|| entry.renderedCasterHash != entry.casterHash;
+
+		if (!entry.needsRender)
+		{
+			continue;
+		}
+
+		entry.rendered = true;
+		entry.renderedPosition = entry.light.position;
+		entry.renderedRange = entry.light.range;
+		entry.renderedCasterHash = entry.casterHash;
+
+		m_renderedLightCount++;
+	}
+}
+
+void ShadowMapCache::Clear()
+{
+	m_entries.clear();
+	m_previousEntries.clear();
+	m_previousIndices.clear();
+	m_allocator.Clear();
+}
+
+glm::mat4 ShadowMapCache::GetFaceViewProjection(glm::vec3 lightPosition, uint32_t face, float nearPlane, float farPlane)
+{
+	static const std::array<glm::vec3, kFaceCount> directions = {
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+	};
+
+	static const std::array<glm::vec3, kFaceCount> ups = {
+		glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+	};
+
+	glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+	glm::mat4 view = glm::lookAt(lightPosition, lightPosition + directions[face], ups[face]);
+
+	return projection * view;
+}
+
+bool ShadowMapCache::AllocateFaces(Entry& entry, uint32_t tileSize)
+{
+	//fall back to smaller tiles when the atlas is too full for the size the light asked for
+	for (uint32_t size = tileSize; size >= m_allocator.GetMinTileSize(); size /= 2)
+	{
+		bool allocated = true;
+
+		for (uint32_t face = 0; face < kFaceCount; face++)
+		{
+			entry.faces[face] = m_allocator.Allocate(size);
+
+			if (!entry.faces[face].IsValid())
+			{
+				allocated = false;
+				break;
+			}
+		}
+
+		if (allocated)
+		{
+			entry.rendered = false;
+			return true;
+		}
+
+		FreeFaces(entry);
+	}
+
+	return false;
+}
+
+void ShadowMapCache::FreeFaces(Entry& entry)
+{
+	for (uint32_t face = 0; face < kFaceCount; face++)
+	{
+		m_allocator.Free(entry.faces[face]);
+		entry.faces[face] = ShadowAtlasAllocator::Tile();
+	}
+}
+
+uint64_t ShadowMapCache::HashBytes(uint64_t hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= kHashPrime;
+	}
+
+	return hash;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include "source/Lighting/ShadowAtlasAllocator.h"
+#include "source/Lighting/ShadowLightSelector.h"
+
+#include <glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//keeps each shadowed light's six cube face tiles in the atlas between frames
+//a light's faces are only re-rendered when it moved, its tiles changed, or something inside its range moved
+class ShadowMapCache {
+public:
+	static constexpr uint32_t kFaceCount = 6;
+
+	struct Entry {
+		ShadowLightSelector::Light light;
+		std::array<ShadowAtlasAllocator::Tile, kFaceCount> faces;
+
+		//true when the faces have to be drawn again this frame
+		bool needsRender = true;
+
+		//what the faces were last drawn with
+		bool rendered = false;
+		glm::vec3 renderedPosition = glm::vec3(0.0f);
+		float renderedRange = 0.0f;
+		uint64_t renderedCasterHash = 0;
+
+		//built up by AddCaster during the frame
+		uint64_t casterHash = 0;
+	};
+
+	ShadowMapCache(uint32_t atlasSize, uint32_t minTileSize);
+
+	//frees tiles of lights that weren't selected and places the new ones, selections must be highest priority first
+	//lights that don't fit even at the smallest tile size go without a shadow this frame
+	void BeginFrame(const std::vector<ShadowLightSelector::Selection>& selections);
+
+	//mixes a caster's transform into every shadowed light whose range its bounding sphere touches
+	void AddCaster(const glm::mat4& modelMatrix, float radius);
+
+	//marks the entries that are out of date, the caller is expected to render every one it marks
+	void EndFrame();
+
+	const std::vector<Entry>& GetEntries() { return m_entries; }
+	ShadowAtlasAllocator& GetAllocator() { return m_allocator; }
+
+	size_t GetRenderedLightCount() { return m_renderedLightCount; }
+
+	void Clear();
+
+	//90 degree view of one cube face, faces go +x, -x, +y, -y, +z, -z so the shader picks one by major axis
+	static glm::mat4 GetFaceViewProjection(glm::vec3 lightPosition, uint32_t face, float nearPlane, float farPlane);
+
+	static constexpr float kNearPlane = 0.05f;
+
+private:
+	bool AllocateFaces(Entry& entry, uint32_t tileSize);
+	void FreeFaces(Entry& entry);
+
+	static uint64_t HashBytes(uint64_t hash, const void* data, size_t size);
+
+	ShadowAtlasAllocator m_allocator;
+
+	std::vector<Entry> m_entries;
+	std::vector<Entry> m_previousEntries;
+	std::unordered_map<size_t, size_t> m_previousIndices;
+
+	size_t m_renderedLightCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "AtlasPacker.h"
+
+#include <algorithm>
+#include <iomanip>
+
+AtlasPacker::AtlasPacker(uint32_t pageWidth, uint32_t pageHeight, uint32_t padding)
+{
+	m_pageWidth = pageWidth;
+	m_pageHeight = pageHeight;
+	m_padding = padding;
+}
+
+bool AtlasPacker::Add(uint32_t width, uint32_t height, Placement& placement)
+{
+	uint32_t paddedWidth = width + m_padding * 2;
+	uint32_t paddedHeight = height + m_padding * 2;
+
+	if (paddedWidth > m_pageWidth || paddedHeight > m_pageHeight)
+	{
+		return false;
+	}
+
+	//earlier pages are tried first, so small rectangles still fill gaps left on them
+	for (size_t i = 0; i <= m_pages.size(); i++)
+	{
+		if (i == m_pages.size())
+		{
+			Page newPage;
+			newPage.skyline.push_back({ 0, 0, m_pageWidth });
+			m_pages.push_back(newPage);
+		}
+
+		Page& page = m_pages[i];
+
+		size_t nodeIndex;
+		uint32_t y;
+		if (!FindPosition(page, paddedWidth, paddedHeight, nodeIndex, y))
+		{
+			continue;
+		}
+
+		placement.page = static_cast<uint32_t>(i);
+		placement.x = page.skyline[nodeIndex].x + m_padding;
+		placement.y = y + m_padding;
+		placement.width = width;
+		placement.height = height;
+
+		Insert(page, nodeIndex, y, paddedWidth, paddedHeight);
+
+		page.usedArea += static_cast<uint64_t>(width) * height;
+		page.rectangleCount++;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool AtlasPacker::FindPosition(const Page& page, uint32_t width, uint32_t height, size_t& nodeIndex, uint32_t& y)
+{
+	bool found = false;
+	uint32_t bestTop = UINT32_MAX;
+
+	for (size_t i = 0; i < page.skyline.size(); i++)
+	{
+		if (page.skyline[i].x + width > m_pageWidth)
+		{
+			break;
+		}
+
+		//the rectangle rests on the highest node it spans
+		uint32_t restingY = 0;
+		uint32_t coveredWidth = 0;
+		for (size_t j = i; coveredWidth < width; j++)
+		{
+			restingY = std::max(restingY, page.skyline[j].y);
+			coveredWidth += page.skyline[j].width;
+		}
+
+		if (restingY + height > m_pageHeight || restingY + height >= bestTop)
+		{
+			continue;
+		}
+
+		bestTop = restingY + height;
+		nodeIndex = i;
+		y = restingY;
+		found = true;
+	}
+
+	return found;
+}
+
+void AtlasPacker::Insert(Page& page, size_t nodeIndex, uint32_t y, uint32_t width, uint32_t height)
+{
+	std::vector<SkylineNode>& skyline = page.skyline;
+
+	SkylineNode newNode;
+	newNode.x = skyline[nodeIndex].x;
+	newNode.y = y + height;
+	newNode.width = width;
+	skyline.insert(skyline.begin() + nodeIndex, newNode);
+
+	//nodes the new one covers are removed or cut down to what sticks out past it
+	uint32_t newNodeEnd = newNode.x + newNode.width;
+	size_t next = nodeIndex + 1;
+	while (next < skyline.size() && skyline[next].x < newNodeEnd)
+	{
+		uint32_t overlap = newNodeEnd - skyline[next].x;
+
+		if (skyline[next].width <= overlap)
+		{
+			skyline.erase(skyline.begin() + next);
+			continue;
+		}
+
+		skyline[next].x += overlap;
+		skyline[next].width -= overlap;
+		break;
+	}
+
+	for (size_t i = 0; i + 1 < skyline.size();)
+	{
+		if (skyline[i].y == skyline[i + 1].y)
+		{
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		}
+		else {
+			i++;
+		}
+	}
+}
+
+double AtlasPacker::GetOccupancy(size_t page)
+{
+	return static_cast<double>(m_pages[page].usedArea) / (static_cast<double>(m_pageWidth) * m_pageHeight);
+}
+
+void AtlasPacker::PrintReport(std::ostream& stream)
+{
+	uint32_t rectangleCount = 0;
+	uint64_t usedArea = 0;
+
+	for (size_t i = 0; i < m_pages.size(); i++)
+	{
+		rectangleCount += m_pages[i].rectangleCount;
+		usedArea += m_pages[i].usedArea;
+	}
+
+	stream << rectangleCount << " rectangles on " << m_pages.size() << " " << m_pageWidth << "x" << m_pageHeight << " pages" << std::endl;
+
+	for (size_t i = 0; i < m_pages.size(); i++)
+	{
+		stream << "  page " << i << ": " << std::setw(4) << m_pages[i].rectangleCount << " rectangles, "
+			<< std::fixed << std::setprecision(1) << GetOccupancy(i) * 100.0 << "% occupied" << std::endl;
+	}
+
+	if (!m_pages.empty())
+	{
+		double totalArea = static_cast<double>(m_pageWidth) * m_pageHeight * m_pages.size();
+		stream << "  overall: " << std::fixed << std::setprecision(1) << usedArea / totalArea * 100.0 << "% occupied" << std::endl;
+	}
+}
\ No newline at end of file
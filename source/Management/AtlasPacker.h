@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+//packs rectangles into fixed size pages with the skyline bottom-left heuristic, opening a new page when none has room
+//it only places rectangles, so it runs and can be checked without a device
+class AtlasPacker {
+public:
+	struct Placement {
+		uint32_t page = 0;
+
+		//where the rectangle itself starts, the padding around it is outside of this
+		uint32_t x = 0;
+		uint32_t y = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+	//padding is left on every side of a rectangle, so filtering near its edge doesn't pick up its neighbours
+	AtlasPacker(uint32_t pageWidth, uint32_t pageHeight, uint32_t padding);
+
+	//false when the rectangle and its padding don't fit on an empty page
+	bool Add(uint32_t width, uint32_t height, Placement& placement);
+
+	size_t GetPageCount() { return m_pages.size(); }
+	uint32_t GetPageWidth() { return m_pageWidth; }
+	uint32_t GetPageHeight() { return m_pageHeight; }
+
+	//the share of a page covered by rectangles, padding doesn't count
+	double GetOccupancy(size_t page);
+
+	void PrintReport(std::ostream& stream);
+
+private:
+	//the top edge of everything packed so far, the nodes cover the page's width from left to right
+	struct SkylineNode {
+		uint32_t x = 0;
+		uint32_t y = 0;
+		uint32_t width = 0;
+	};
+
+	struct Page {
+		std::vector<SkylineNode> skyline;
+		uint64_t usedArea = 0;
+		uint32_t rectangleCount = 0;
+	};
+
+	//the lowest spot whose top ends lowest, false when nothing on the page has room
+	bool FindPosition(const Page& page, uint32_t width, uint32_t height, size_t& nodeIndex, uint32_t& y);
+	void Insert(Page& page, size_t nodeIndex, uint32_t y, uint32_t width, uint32_t height);
+
+	std::vector<Page> m_pages;
+
+	uint32_t m_pageWidth;
+	uint32_t m_pageHeight;
+	uint32_t m_padding;
+};
\ No newline at end of file
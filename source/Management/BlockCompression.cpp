@@ -0,0 +1,235 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	const uint32_t kTexelsPerBlock = 16;
+
+	uint16_t PackColor(const float* color)
+	{
+		uint32_t red = static_cast<uint32_t>(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+		uint32_t green = static_cast<uint32_t>(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+		uint32_t blue = static_cast<uint32_t>(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+
+		return static_cast<uint16_t>((red << 11) | (green << 5) | blue);
+	}
+
+	void UnpackColor(uint16_t packed, int* color)
+	{
+		int red = (packed >> 11) & 31;
+		int green = (packed >> 5) & 63;
+		int blue = packed & 31;
+
+		color[0] = (red << 3) | (red >> 2);
+		color[1] = (green << 2) | (green >> 4);
+		color[2] = (blue << 3) | (blue >> 2);
+	}
+
+	//the two colors between the endpoints, or their midpoint and transparent black when the endpoints are in the other order
+	void BuildPalette(uint16_t color0, uint16_t color1, int palette[4][4], bool punchThroughAlpha)
+	{
+		UnpackColor(color0, palette[0]);
+		UnpackColor(color1, palette[1]);
+		palette[0][3] = 255;
+		palette[1][3] = 255;
+
+		for (int channel = 0; channel < 3; channel++)
+		{
+			if (color0 > color1)
+			{
+				palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+				palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+			}
+			else {
+				palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+				palette[3][channel] = 0;
+			}
+		}
+
+		palette[2][3] = 255;
+		palette[3][3] = (color0 <= color1 && punchThroughAlpha) ? 0 : 255;
+	}
+}
+
+std::vector<uint8_t> BlockCompression::EncodeBc1(const uint8_t* pixels, uint32_t width, uint32_t height)
+{
+	uint32_t blocksWide = GetBlockCount(width);
+	uint32_t blocksHigh = GetBlockCount(height);
+
+	std::vector<uint8_t> blocks(static_cast<size_t>(blocksWide) * blocksHigh * kBc1BlockBytes);
+
+	for (uint32_t blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+		{
+			//blocks hanging over the edge repeat the last row and column, those texels are never sampled
+			float texels[kTexelsPerBlock][3];
+			float mean[3] = { 0.0f, 0.0f, 0.0f };
+
+			for (uint32_t i = 0; i < kTexelsPerBlock; i++)
+			{
+				uint32_t x = std::min(blockX * kBlockDimension + i % kBlockDimension, width - 1);
+				uint32_t y = std::min(blockY * kBlockDimension + i / kBlockDimension, height - 1);
+				const uint8_t* pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+
+				for (int channel = 0; channel < 3; channel++)
+				{
+					texels[i][channel] = pixel[channel];
+					mean[channel] += pixel[channel] / static_cast<float>(kTexelsPerBlock);
+				}
+			}
+
+			float covariance[3][3] = {};
+			for (uint32_t i = 0; i < kTexelsPerBlock; i++)
+			{
+				for (int row = 0; row < 3; row++)
+				{
+					for (int column = 0; column < 3; column++)
+					{
+						covariance[row][column] += (texels[i][row] - mean[row]) * (texels[i][column] - mean[column]);
+					}
+				}
+			}
+
+			//the direction the colors spread along most, a few power iterations are close enough for 565 endpoints
+			float axis[3] = { 1.0f, 1.0f, 1.0f };
+			for (int iteration = 0; iteration < 8; iteration++)
+			{
+				float next[3];
+				for (int row = 0; row < 3; row++)
+				{
+					next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+				}
+
+				float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+				if (length <= 0.0f)
+				{
+					break;
+				}
+
+				for (int channel = 0; channel < 3; channel++)
+				{
+					axis[channel] = next[channel] / length;
+				}
+			}
+
+			float minimum = 0.0f;
+			float maximum = 0.0f;
+
+			for (uint32_t i = 0; i < kTexelsPerBlock; i++)
+			{
+				float projection = (texels[i][0] - mean[0]) * axis[0] + (texels[i][1] - mean[1]) * axis[1] + (texels[i][2] - mean[2]) * axis[2];
+				minimum = std::min(minimum, projection);
+				maximum = std::max(maximum, projection);
+			}
+
+			float endpoint0[3];
+			float endpoint1[3];
+
+			for (int channel = 0; channel < 3; channel++)
+			{
+				endpoint0[channel] = mean[channel] + axis[channel] * maximum;
+				endpoint1[channel] = mean[channel] + axis[channel] * minimum;
+			}
+
+			uint16_t color0 = PackColor(endpoint0);
+			uint16_t color1 = PackColor(endpoint1);
+
+			//the four color mode needs the first endpoint to be the larger one
+			if (color0 < color1)
+			{
+				std::swap(color0, color1);
+			}
+
+			int palette[4][4];
+			BuildPalette(color0, color1, palette, false);
+
+			uint32_t indices = 0;
+
+			//equal endpoints leave every index at 0, which is already the right color
+			if (color0 != color1)
+			{
+				for (uint32_t i = 0; i < kTexelsPerBlock; i++)
+				{
+					uint32_t bestIndex = 0;
+					float bestDistance = 0.0f;
+
+					for (uint32_t entry = 0; entry < 4; entry++)
+					{
+						float distance = 0.0f;
+						for (int channel = 0; channel < 3; channel++)
+						{
+							float difference = texels[i][channel] - palette[entry][channel];
+							distance += difference * difference;
+						}
+
+						if (entry == 0 || distance < bestDistance)
+						{
+							bestIndex = entry;
+							bestDistance = distance;
+						}
+					}
+
+					indices |= bestIndex << (i * 2);
+				}
+			}
+
+			uint8_t* block = &blocks[(static_cast<size_t>(blockY) * blocksWide + blockX) * kBc1BlockBytes];
+			block[0] = color0 & 0xFF;
+			block[1] = color0 >> 8;
+			block[2] = color1 & 0xFF;
+			block[3] = color1 >> 8;
+			block[4] = indices & 0xFF;
+			block[5] = (indices >> 8) & 0xFF;
+			block[6] = (indices >> 16) & 0xFF;
+			block[7] = indices >> 24;
+		}
+	}
+
+	return blocks;
+}
+
+std::vector<uint8_t> BlockCompression::DecodeBc1(const uint8_t* blocks, uint32_t width, uint32_t height, bool punchThroughAlpha)
+{
+	uint32_t blocksWide = GetBlockCount(width);
+	uint32_t blocksHigh = GetBlockCount(height);
+
+	std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+
+	for (uint32_t blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+		{
+			const uint8_t* block = &blocks[(static_cast<size_t>(blockY) * blocksWide + blockX) * kBc1BlockBytes];
+
+			uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+			uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+			uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+
+			int palette[4][4];
+			BuildPalette(color0, color1, palette, punchThroughAlpha);
+
+			for (uint32_t i = 0; i < kTexelsPerBlock; i++)
+			{
+				uint32_t x = blockX * kBlockDimension + i % kBlockDimension;
+				uint32_t y = blockY * kBlockDimension + i / kBlockDimension;
+
+				if (x >= width || y >= height)
+				{
+					continue;
+				}
+
+				const int* color = palette[(indices >> (i * 2)) & 3];
+				uint8_t* pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+
+				for (int channel = 0; channel < 4; channel++)
+				{
+					pixel[channel] = static_cast<uint8_t>(color[channel]);
+				}
+			}
+		}
+	}
+
+	return pixels;
+}
\ No newline at end of file
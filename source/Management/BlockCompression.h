@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//BC1 is the one block format simple enough to encode at load time and decode on the CPU
+//textures in the other formats are expected to be compressed offline by dedicated tools
+class BlockCompression {
+public:
+	static constexpr uint32_t kBlockDimension = 4;
+	static constexpr uint32_t kBc1BlockBytes = 8;
+
+	static uint32_t GetBlockCount(uint32_t texels) { return (texels + kBlockDimension - 1) / kBlockDimension; }
+
+	//fits each 4x4 block's colors to a line through them, alpha is dropped
+	static std::vector<uint8_t> EncodeBc1(const uint8_t* pixels, uint32_t width, uint32_t height);
+
+	//punchThroughAlpha decodes the transparent palette entry the way RGBA BC1 formats do, RGB formats read it as opaque black
+	static std::vector<uint8_t> DecodeBc1(const uint8_t* blocks, uint32_t width, uint32_t height, bool punchThroughAlpha);
+};
\ No newline at end of file
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "source/Management/InputEventQueue.h"
+
+#include <bitset>
+
+#include <qnamespace.h>
+
+//flat snapshot of the input for one frame, built once at frame start and read only afterwards
+struct FrameInputState {
+	//latin-1 keys map directly, Qt's special keys (0x01000000 range) are packed after them
+	static constexpr size_t kKeyCount = 512;
+	static constexpr size_t kMouseButtonCount = 32;
+
+	static size_t KeyIndex(uint32_t keyCode)
+	{
+		if (keyCode < 0x100)
+		{
+			return keyCode;
+		}
+
+		if (keyCode >= 0x01000000 && keyCode < 0x01000100)
+		{
+			return 0x100 + (keyCode - 0x01000000);
+		}
+
+		return kKeyCount;
+	}
+
+	//Qt::MouseButton is a single bit flag, the bit position is the index
+	static size_t MouseButtonIndex(uint32_t button)
+	{
+		for (size_t i = 0; i < kMouseButtonCount; i++)
+		{
+			if (button == (1u << i))
+			{
+				return i;
+			}
+		}
+
+		return kMouseButtonCount;
+	}
+
+	void BeginFrame()
+	{
+		keysPressedThisFrame.reset();
+		keysReleasedThisFrame.reset();
+		mouseButtonsPressedThisFrame.reset();
+		mouseButtonsReleasedThisFrame.reset();
+
+		mouseDelta = glm::vec2(0.0f);
+		scrollDelta = glm::vec2(0.0f);
+	}
+
+	void ApplyEvent(const InputEvent& event)
+	{
+		switch (event.type)
+		{
+		case InputEvent::Type::KeyDown:
+		{
+			size_t index = KeyIndex(event.code);
+			if (index >= kKeyCount)
+			{
+				break;
+			}
+
+			//ignore auto repeat so "this frame" only fires on the transition
+			if (!keysDown.test(index))
+			{
+				keysPressedThisFrame.set(index);
+			}
+			keysDown.set(index);
+			break;
+		}
+		case InputEvent::Type::KeyUp:
+		{
+			size_t index = KeyIndex(event.code);
+			if (index >= kKeyCount)
+			{
+				break;
+			}
+
+			keysDown.reset(index);
+			keysReleasedThisFrame.set(index);
+			break;
+		}
+		case InputEvent::Type::MouseButtonDown:
+		{
+			size_t index = MouseButtonIndex(event.code);
+			if (index >= kMouseButtonCount)
+			{
+				break;
+			}
+
+			mouseButtonsDown.set(index);
+			mouseButtonsPressedThisFrame.set(index);
+			break;
+		}
+		case InputEvent::Type::MouseButtonUp:
+		{
+			size_t index = MouseButtonIndex(event.code);
+			if (index >= kMouseButtonCount)
+			{
+				break;
+			}
+
+			mouseButtonsDown.reset(index);
+			mouseButtonsReleasedThisFrame.set(index);
+			break;
+		}
+		case InputEvent::Type::MouseMove:
+			//the cursor is re-centred after every move while tracking, so each event is a delta
+			mouseDelta += event.value;
+			break;
+		case InputEvent::Type::Scroll:
+			scrollDelta += event.value;
+			break;
+		case InputEvent::Type::ButtonClicked:
+			//the window manager runs the button's callback, it doesn't change any held state
+			break;
+		}
+
+		lastEventTimestamp = event.timestamp;
+	}
+
+	bool KeyDown(Qt::Key keyCode) const
+	{
+		size_t index = KeyIndex(static_cast<uint32_t>(keyCode));
+		return index < kKeyCount && keysDown.test(index);
+	}
+
+	bool KeyPressedThisFrame(Qt::Key keyCode) const
+	{
+		size_t index = KeyIndex(static_cast<uint32_t>(keyCode));
+		return index < kKeyCount && keysPressedThisFrame.test(index);
+	}
+
+	bool KeyReleasedThisFrame(Qt::Key keyCode) const
+	{
+		size_t index = KeyIndex(static_cast<uint32_t>(keyCode));
+		return index < kKeyCount && keysReleasedThisFrame.test(index);
+	}
+
+	bool MouseButtonDown(Qt::MouseButton button) const
+	{
+		size_t index = MouseButtonIndex(static_cast<uint32_t>(button));
+		return index < kMouseButtonCount && mouseButtonsDown.test(index);
+	}
+
+	bool MouseButtonPressedThisFrame(Qt::MouseButton button) const
+	{
+		size_t index = MouseButtonIndex(static_cast<uint32_t>(button));
+		return index < kMouseButtonCount && mouseButtonsPressedThisFrame.test(index);
+	}
+
+	bool MouseButtonReleasedThisFrame(Qt::MouseButton button) const
+	{
+		size_t index = MouseButtonIndex(static_cast<uint32_t>(button));
+		return index < kMouseButtonCount && mouseButtonsReleasedThisFrame.test(index);
+	}
+
+	std::bitset<kKeyCount> keysDown;
+	std::bitset<kKeyCount> keysPressedThisFrame;
+	std::bitset<kKeyCount> keysReleasedThisFrame;
+
+	std::bitset<kMouseButtonCount> mouseButtonsDown;
+	std::bitset<kMouseButtonCount> mouseButtonsPressedThisFrame;
+	std::bitset<kMouseButtonCount> mouseButtonsReleasedThisFrame;
+
+	glm::vec2 mouseDelta = glm::vec2(0.0f);
+	glm::vec2 scrollDelta = glm::vec2(0.0f);
+
+	uint64_t lastEventTimestamp = 0;
+};
\ No newline at end of file
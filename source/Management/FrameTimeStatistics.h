@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+//collects frame times so runs of the same recording can be compared by their distribution, not just the average
+class FrameTimeStatistics {
+public:
+	void AddFrame(double frameTime) { m_frameTimes.push_back(frameTime); }
+	void Clear() { m_frameTimes.clear(); }
+
+	size_t GetFrameCount() { return m_frameTimes.size(); }
+
+	//percentile in [0, 100], nearest rank
+	double GetPercentile(double percentile)
+	{
+		if (m_frameTimes.empty())
+		{
+			return 0.0;
+		}
+
+		std::vector<double> sorted = m_frameTimes;
+		size_t rank = static_cast<size_t>(std::clamp(percentile / 100.0, 0.0, 1.0) * (sorted.size() - 1));
+
+		std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+		return sorted[rank];
+	}
+
+	double GetAverage()
+	{
+		if (m_frameTimes.empty())
+		{
+			return 0.0;
+		}
+
+		return std::accumulate(m_frameTimes.begin(), m_frameTimes.end(), 0.0) / m_frameTimes.size();
+	}
+
+	void Print(std::ostream& stream)
+	{
+		if (m_frameTimes.empty())
+		{
+			return;
+		}
+
+		stream << std::fixed << std::setprecision(3)
+			<< "Frame times over " << m_frameTimes.size() << " frames (ms):"
+			<< " avg " << GetAverage() * 1000.0
+			<< " p50 " << GetPercentile(50.0) * 1000.0
+			<< " p90 " << GetPercentile(90.0) * 1000.0
+			<< " p95 " << GetPercentile(95.0) * 1000.0
+			<< " p99 " << GetPercentile(99.0) * 1000.0
+			<< " max " << GetPercentile(100.0) * 1000.0
+			<< std::defaultfloat << std::endl;
+	}
+
+private:
+	std::vector<double> m_frameTimes;
+};
\ No newline at end of file
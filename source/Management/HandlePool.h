@@ -0,0 +1,88 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <cstdint>
+#include <vector>
+
+//hands out object handles whose low 32 bits are a slot + 1 and high 32 bits count how often the slot was reused
+//freed slots are reused, but a stale handle never matches the object that took its slot
+//a slot whose generation reaches the maximum is retired instead of wrapping back to handles that were already given out
+class HandlePool {
+public:
+	static_assert(sizeof(VulkanCommonFunctions::ObjectHandle) >= sizeof(uint64_t), "generational handles need a 64 bit handle type");
+
+	HandlePool(uint32_t maxGeneration = UINT32_MAX) : m_maxGeneration(maxGeneration) {};
+
+	VulkanCommonFunctions::ObjectHandle Allocate()
+	{
+		uint32_t slot = 0;
+
+		if (!m_freeSlots.empty())
+		{
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else {
+			slot = static_cast<uint32_t>(m_generations.size());
+			m_generations.push_back(0);
+		}
+
+		m_liveCount++;
+		return MakeHandle(slot, m_generations[slot]);
+	}
+
+	bool Free(VulkanCommonFunctions::ObjectHandle handle)
+	{
+		if (!IsValid(handle))
+		{
+			return false;
+		}
+
+		uint32_t slot = GetSlot(handle);
+		m_generations[slot]++;
+		m_liveCount--;
+
+		//a retired slot keeps the maximum generation, which no handle was ever given
+		if (m_generations[slot] < m_maxGeneration)
+		{
+			m_freeSlots.push_back(slot);
+		}
+		else {
+			m_retiredCount++;
+		}
+
+		return true;
+	}
+
+	bool IsValid(VulkanCommonFunctions::ObjectHandle handle)
+	{
+		if (handle == VulkanCommonFunctions::INVALID_OBJECT_HANDLE)
+		{
+			return false;
+		}
+
+		uint32_t slot = GetSlot(handle);
+		return slot < m_generations.size() && m_generations[slot] == GetGeneration(handle);
+	}
+
+	size_t GetSlotCount() { return m_generations.size(); }
+	size_t GetLiveCount() { return m_liveCount; }
+	size_t GetRetiredCount() { return m_retiredCount; }
+
+	static uint32_t GetSlot(VulkanCommonFunctions::ObjectHandle handle) { return static_cast<uint32_t>(handle & 0xFFFFFFFFull) - 1; }
+	static uint32_t GetGeneration(VulkanCommonFunctions::ObjectHandle handle) { return static_cast<uint32_t>(static_cast<uint64_t>(handle) >> 32); }
+
+private:
+	static VulkanCommonFunctions::ObjectHandle MakeHandle(uint32_t slot, uint32_t generation)
+	{
+		return static_cast<VulkanCommonFunctions::ObjectHandle>((static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(slot) + 1));
+	}
+
+	std::vector<uint32_t> m_generations;
+	std::vector<uint32_t> m_freeSlots;
+	size_t m_liveCount = 0;
+	size_t m_retiredCount = 0;
+
+	uint32_t m_maxGeneration = UINT32_MAX;
+};
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "HotReloader.h"
+
+#include <fstream>
+#include <iostream>
+
+HotReloader::HotReloader(HotReloaderCreateInfo createInfo)
+{
+	m_shaderDirectory = createInfo.shaderDirectory;
+
+	//debug shaders compile faster, reloads are for iterating on them anyway
+	ShaderCompiler::ShaderCompilerCreateInfo compilerCreateInfo{};
+	compilerCreateInfo.shaderDirectory = m_shaderDirectory;
+	compilerCreateInfo.configuration = ShaderCompiler::Configuration::Debug;
+
+	try
+	{
+		m_compiler = std::make_shared<ShaderCompiler>(compilerCreateInfo);
+	}
+	catch (const std::exception& exception)
+	{
+		std::cout << "Warning: shaders won't be recompiled when they change, " << exception.what() << std::endl;
+	}
+
+	//the sources as they are now, only later edits are compiled
+	std::set<std::string> compiledFilePaths;
+	PollShaders(compiledFilePaths);
+
+	m_thread = std::thread(&HotReloader::Work, this);
+}
+
+void HotReloader::WatchTexture(const std::string& textureFilePath, const std::vector<std::string>& filePaths)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (size_t i = 0; i < filePaths.size(); i++)
+	{
+		WatchedFile watchedFile;
+		watchedFile.textureFilePath = textureFilePath;
+		watchedFile.writeTime = GetWriteTime(filePaths[i]);
+
+		m_textureFiles[filePaths[i]] = watchedFile;
+	}
+}
+
+HotReloader::Changes HotReloader::TakeChanges()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Changes changes = std::move(m_changes);
+	m_changes = Changes();
+
+	return changes;
+}
+
+void HotReloader::Work()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_stopRequested.wait_for(lock, kPollInterval, [this]() { return m_stopping; });
+
+		if (m_stopping)
+		{
+			return;
+		}
+
+		//a handful of file times, cheap enough to check with the lock held
+		for (auto it = m_textureFiles.begin(); it != m_textureFiles.end(); it++)
+		{
+			std::filesystem::file_time_type writeTime = GetWriteTime(it->first);
+
+			if (writeTime != it->second.writeTime)
+			{
+				it->second.writeTime = writeTime;
+				m_changes.textureFilePaths.insert(it->second.textureFilePath);
+			}
+		}
+
+		//compiling takes a while, the render thread can take what is already there meanwhile
+		lock.unlock();
+
+		std::set<std::string> compiledFilePaths;
+		PollShaders(compiledFilePaths);
+
+		lock.lock();
+		m_changes.shaderFilePaths.insert(compiledFilePaths.begin(), compiledFilePaths.end());
+	}
+}
+
+void HotReloader::PollShaders(std::set<std::string>& compiledFilePaths)
+{
+	std::set<std::string> changedFileNames;
+
+	std::error_code error;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(m_shaderDirectory, error))
+	{
+		std::filesystem::path extension = entry.path().extension();
+		if (extension != ".hlsl" && extension != ".hlsli")
+		{
+			continue;
+		}
+
+		std::string fileName = entry.path().filename().string();
+		std::filesystem::file_time_type writeTime = GetWriteTime(entry.path().string());
+
+		auto it = m_shaderWriteTimes.find(fileName);
+		if (it != m_shaderWriteTimes.end() && it->second != writeTime)
+		{
+			changedFileNames.insert(fileName);
+		}
+
+		m_shaderWriteTimes[fileName] = writeTime;
+	}
+
+	if (changedFileNames.empty() || m_compiler == nullptr)
+	{
+		return;
+	}
+
+	std::set<std::string> affectedSources = FindAffectedSources(changedFileNames);
+
+	for (const ShaderCompiler::Shader& shader : m_compiler->GetShaders())
+	{
+		if (affectedSources.count(shader.sourceFileName) == 0)
+		{
+			continue;
+		}
+
+		auto compileStart = std::chrono::steady_clock::now();
+
+		if (m_compiler->Compile(shader))
+		{
+			compiledFilePaths.insert(m_shaderDirectory + "/" + shader.outputFileName);
+			std::cout << "Recompiled " << shader.outputFileName << " in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count() << " ms" << std::endl;
+		}
+	}
+}
+
+std::set<std::string> HotReloader::FindAffectedSources(const std::set<std::string>& changedFileNames)
+{
+	std::set<std::string> affectedSources = changedFileNames;
+
+	//includes can include each other, so this goes until a pass adds nothing
+	bool added = true;
+	while (added)
+	{
+		added = false;
+
+		for (auto it = m_shaderWriteTimes.begin(); it != m_shaderWriteTimes.end(); it++)
+		{
+			if (affectedSources.count(it->first) == 0 && IncludesAny(it->first, affectedSources))
+			{
+				affectedSources.insert(it->first);
+				added = true;
+			}
+		}
+	}
+
+	return affectedSources;
+}
+
+bool HotReloader::IncludesAny(const std::string& fileName, const std::set<std::string>& includedFileNames)
+{
+	std::ifstream sourceFile(m_shaderDirectory + "/" + fileName);
+
+	std::string line;
+	while (std::getline(sourceFile, line))
+	{
+		if (line.find("#include") == std::string::npos)
+		{
+			continue;
+		}
+
+		for (auto it = includedFileNames.begin(); it != includedFileNames.end(); it++)
+		{
+			if (line.find("\"" + *it + "\"") != std::string::npos)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+std::filesystem::file_time_type HotReloader::GetWriteTime(const std::string& filePath)
+{
+	//files that don't exist get the minimum, so writing them later counts as a change
+	std::error_code error;
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(filePath, error);
+
+	return error ? std::filesystem::file_time_type::min() : writeTime;
+}
+
+void HotReloader::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_stopRequested.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
\ No newline at end of file
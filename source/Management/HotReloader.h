@@ -0,0 +1,77 @@
+#pragma once
+
+#include "source/Management/ShaderCompiler.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+//watches the shader sources and textures on a background thread, so edits show up while running instead of after a restart
+//changed sources are recompiled there from the shader directory's manifest in the debug configuration, the render thread only picks up the results
+class HotReloader {
+public:
+	struct HotReloaderCreateInfo {
+		//the directory the sources, the manifest and the compiled spv files are all in
+		std::string shaderDirectory;
+	};
+
+	struct Changes {
+		//spv files a compile has just replaced, named the way pipelines are created with them
+		std::set<std::string> shaderFilePaths;
+
+		//textures whose image or one of its KTX2 files changed
+		std::set<std::string> textureFilePaths;
+	};
+
+	HotReloader(HotReloaderCreateInfo createInfo);
+
+	//the texture is reported when any of the files changes, a file that doesn't exist yet is reported once it is written
+	void WatchTexture(const std::string& textureFilePath, const std::vector<std::string>& filePaths);
+
+	//everything that changed since the last call
+	Changes TakeChanges();
+
+	void Destroy();
+
+private:
+	struct WatchedFile {
+		std::string textureFilePath;
+		std::filesystem::file_time_type writeTime;
+	};
+
+	void Work();
+
+	//every source that includes one of the files, directly or through another include, and the files themselves
+	std::set<std::string> FindAffectedSources(const std::set<std::string>& changedFileNames);
+	bool IncludesAny(const std::string& fileName, const std::set<std::string>& includedFileNames);
+
+	//checks the sources for changes and recompiles what they affect, worker thread only
+	void PollShaders(std::set<std::string>& compiledFilePaths);
+
+	static std::filesystem::file_time_type GetWriteTime(const std::string& filePath);
+
+	static constexpr std::chrono::milliseconds kPollInterval = std::chrono::milliseconds(250);
+
+	std::string m_shaderDirectory;
+
+	//null when the manifest couldn't be read, textures are still reloaded then
+	std::shared_ptr<ShaderCompiler> m_compiler = nullptr;
+
+	//by file name, only touched by the worker thread after the constructor
+	std::map<std::string, std::filesystem::file_time_type> m_shaderWriteTimes;
+
+	std::map<std::string, WatchedFile> m_textureFiles;
+	Changes m_changes;
+
+	std::mutex m_mutex;
+	std::condition_variable m_stopRequested;
+	std::thread m_thread;
+	bool m_stopping = false;
+};
\ No newline at end of file
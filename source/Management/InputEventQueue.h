@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <glm.hpp>
+
+struct InputEvent {
+	enum class Type : uint8_t {
+		KeyDown,
+		KeyUp,
+		MouseButtonDown,
+		MouseButtonUp,
+		MouseMove,
+		Scroll,
+		ButtonClicked
+	};
+
+	Type type = Type::KeyDown;
+
+	//Qt::Key, Qt::MouseButton or the id of a ui button depending on the type
+	uint32_t code = 0;
+
+	//cursor offset or scroll amount
+	glm::vec2 value = glm::vec2(0.0f);
+
+	//steady clock time in nanoseconds when Qt delivered the event
+	uint64_t timestamp = 0;
+
+	static uint64_t Now()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+};
+
+//single producer single consumer ring, Qt's thread pushes and the frame loop pops
+class InputEventQueue {
+public:
+	static constexpr size_t kCapacity = 4096;
+
+	//returns false if the ring is full, the event is dropped
+	bool Push(const InputEvent& event)
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		size_t next = (head + 1) & kMask;
+
+		if (next == m_tail.load(std::memory_order_acquire))
+		{
+			m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_events[head] = event;
+		m_head.store(next, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(InputEvent& outEvent)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+
+		if (tail == m_head.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		outEvent = m_events[tail];
+		m_tail.store((tail + 1) & kMask, std::memory_order_release);
+		return true;
+	}
+
+	//returns how many events were dropped since the last call
+	size_t TakeDroppedCount() { return m_droppedEvents.exchange(0, std::memory_order_relaxed); }
+
+private:
+	static_assert((kCapacity & (kCapacity - 1)) == 0, "input queue capacity must be a power of two");
+	static constexpr size_t kMask = kCapacity - 1;
+
+	std::array<InputEvent, kCapacity> m_events;
+
+	//kept on separate cache lines so the two threads don't fight over them
+	alignas(64) std::atomic<size_t> m_head = 0;
+	alignas(64) std::atomic<size_t> m_tail = 0;
+	alignas(64) std::atomic<size_t> m_droppedEvents = 0;
+};
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "InputRecorder.h"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+InputRecorder::~InputRecorder()
+{
+	Stop();
+}
+
+void InputRecorder::StartRecording(const std::string& filePath, uint32_t randomSeed)
+{
+	Stop();
+
+	m_recordFile.open(filePath, std::ios::binary | std::ios::trunc);
+
+	if (!m_recordFile.is_open())
+	{
+		throw std::runtime_error("failed to open input recording " + filePath);
+	}
+
+	FileHeader header;
+	header.randomSeed = randomSeed;
+	m_recordFile.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+
+	m_randomSeed = randomSeed;
+	m_frameCount = 0;
+	m_mode = Mode::Record;
+}
+
+void InputRecorder::StartReplay(const std::string& filePath)
+{
+	Stop();
+
+	std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("failed to open input recording " + filePath);
+	}
+
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	m_replayData.resize(fileSize);
+
+	file.seekg(0);
+	file.read(m_replayData.data(), fileSize);
+	file.close();
+
+	m_replayOffset = 0;
+
+	FileHeader header;
+	if (!ReadValue(header) || header.magic != kMagic)
+	{
+		throw std::runtime_error(filePath + " is not an input recording");
+	}
+
+	if (header.version != kVersion)
+	{
+		throw std::runtime_error("unsupported input recording version " + std::to_string(header.version));
+	}
+
+	m_randomSeed = header.randomSeed;
+	m_frameCount = 0;
+	m_replayFinished = false;
+	m_mode = Mode::Replay;
+}
+
+void InputRecorder::Stop()
+{
+	if (m_mode == Mode::Record)
+	{
+		m_recordFile.flush();
+		m_recordFile.close();
+
+		std::cout << "Recorded " << m_frameCount << " frames of input" << std::endl;
+	}
+
+	m_replayData.clear();
+	m_replayOffset = 0;
+
+	m_mode = Mode::Off;
+}
+
+void InputRecorder::RecordFrame(double deltaTime, const std::vector<InputEvent>& events)
+{
+	if (m_mode != Mode::Record)
+	{
+		return;
+	}
+
+	m_packedEvents.resize(events.size());
+
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		PackedEvent& packed = m_packedEvents[i];
+		packed.type = static_cast<uint8_t>(events[i].type);
+		packed.code = events[i].code;
+		packed.valueX = events[i].value.x;
+		packed.valueY = events[i].value.y;
+	}
+
+	uint32_t eventCount = static_cast<uint32_t>(events.size());
+
+	m_recordFile.write(reinterpret_cast<const char*>(&deltaTime), sizeof(double));
+	m_recordFile.write(reinterpret_cast<const char*>(&eventCount), sizeof(uint32_t));
+
+	if (eventCount > 0)
+	{
+		m_recordFile.write(reinterpret_cast<const char*>(m_packedEvents.data()), sizeof(PackedEvent) * eventCount);
+	}
+
+	m_frameCount++;
+}
+
+bool InputRecorder::ReadFrame(double& outDeltaTime, std::vector<InputEvent>& outEvents)
+{
+	outEvents.clear();
+
+	if (m_mode != Mode::Replay || m_replayFinished)
+	{
+		return false;
+	}
+
+	double deltaTime = 0.0;
+	uint32_t eventCount = 0;
+
+	if (!ReadValue(deltaTime) || !ReadValue(eventCount))
+	{
+		m_replayFinished = true;
+		return false;
+	}
+
+	uint64_t now = InputEvent::Now();
+
+	for (uint32_t i = 0; i < eventCount; i++)
+	{
+		PackedEvent packed;
+		if (!ReadValue(packed))
+		{
+			std::cerr << "Input recording is truncated at frame " << m_frameCount << std::endl;
+			m_replayFinished = true;
+			return false;
+		}
+
+		InputEvent event;
+		event.type = static_cast<InputEvent::Type>(packed.type);
+		event.code = packed.code;
+		event.value = glm::vec2(packed.valueX, packed.valueY);
+		event.timestamp = now;
+
+		outEvents.push_back(event);
+	}
+
+	outDeltaTime = deltaTime;
+	m_frameCount++;
+
+	return true;
+}
+
+template<typename T>
+bool InputRecorder::ReadValue(T& outValue)
+{
+	if (m_replayOffset + sizeof(T) > m_replayData.size())
+	{
+		return false;
+	}
+
+	std::memcpy(&outValue, m_replayData.data() + m_replayOffset, sizeof(T));
+	m_replayOffset += sizeof(T);
+
+	return true;
+}
\ No newline at end of file
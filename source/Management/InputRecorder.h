@@ -0,0 +1,81 @@
+#pragma once
+
+#include "source/Management/InputEventQueue.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//writes the input events and delta time of every simulation frame to a binary log, and feeds them back on replay
+//layout is a header followed by one record per frame: double delta time, uint32 event count, packed events
+class InputRecorder {
+public:
+	enum class Mode {
+		Off,
+		Record,
+		Replay
+	};
+
+	InputRecorder() {};
+	~InputRecorder();
+
+	void StartRecording(const std::string& filePath, uint32_t randomSeed);
+
+	//loads the whole log up front so replaying doesn't touch the disk mid run
+	void StartReplay(const std::string& filePath);
+
+	//flushes a recording, safe to call more than once
+	void Stop();
+
+	Mode GetMode() { return m_mode; }
+	bool IsRecording() { return m_mode == Mode::Record; }
+	bool IsReplaying() { return m_mode == Mode::Replay; }
+	bool IsReplayFinished() { return m_replayFinished; }
+
+	//seed the recorded run used, valid after StartReplay
+	uint32_t GetRandomSeed() { return m_randomSeed; }
+	uint64_t GetFrameCount() { return m_frameCount; }
+
+	void RecordFrame(double deltaTime, const std::vector<InputEvent>& events);
+
+	//returns false once every recorded frame has been read
+	bool ReadFrame(double& outDeltaTime, std::vector<InputEvent>& outEvents);
+
+private:
+	static constexpr uint32_t kMagic = 0x43455256; //"VREC"
+	static constexpr uint32_t kVersion = 1;
+
+	struct FileHeader {
+		uint32_t magic = kMagic;
+		uint32_t version = kVersion;
+		uint32_t randomSeed = 0;
+		uint32_t reserved = 0;
+	};
+
+	//timestamps aren't stored, only the order of events within a frame matters
+	struct PackedEvent {
+		uint8_t type = 0;
+		uint8_t padding[3] = {};
+		uint32_t code = 0;
+		float valueX = 0.0f;
+		float valueY = 0.0f;
+	};
+
+	static_assert(sizeof(PackedEvent) == 16, "recorded input events must stay 16 bytes");
+
+	template<typename T>
+	bool ReadValue(T& outValue);
+
+	Mode m_mode = Mode::Off;
+
+	std::ofstream m_recordFile;
+	std::vector<PackedEvent> m_packedEvents;
+
+	std::vector<char> m_replayData;
+	size_t m_replayOffset = 0;
+	bool m_replayFinished = false;
+
+	uint32_t m_randomSeed = 0;
+	uint64_t m_frameCount = 0;
+};
\ No newline at end of file
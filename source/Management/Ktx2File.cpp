@@ -0,0 +1,355 @@
+#include "Ktx2File.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	const uint8_t kIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	const size_t kHeaderSize = 80;
+	const size_t kLevelIndexEntrySize = 24;
+
+	//khr_df values the descriptors written here use
+	const uint32_t kColorModelRgbsda = 1;
+	const uint32_t kColorModelBc1a = 128;
+	const uint32_t kColorPrimariesBt709 = 1;
+	const uint32_t kTransferLinear = 1;
+	const uint32_t kTransferSrgb = 2;
+	const uint32_t kChannelAlpha = 15;
+	const uint32_t kChannelQualifierLinear = 0x10;
+
+	uint32_t ReadUint32(const std::vector<uint8_t>& bytes, size_t offset)
+	{
+		uint32_t value;
+		std::memcpy(&value, &bytes[offset], sizeof(value));
+		return value;
+	}
+
+	uint64_t ReadUint64(const std::vector<uint8_t>& bytes, size_t offset)
+	{
+		uint64_t value;
+		std::memcpy(&value, &bytes[offset], sizeof(value));
+		return value;
+	}
+
+	void WriteUint32(std::vector<uint8_t>& bytes, size_t offset, uint32_t value)
+	{
+		std::memcpy(&bytes[offset], &value, sizeof(value));
+	}
+
+	void WriteUint64(std::vector<uint8_t>& bytes, size_t offset, uint64_t value)
+	{
+		std::memcpy(&bytes[offset], &value, sizeof(value));
+	}
+}
+
+bool Ktx2File::GetBlockInfo(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockBytes)
+{
+	blockWidth = 4;
+	blockHeight = 4;
+
+	switch (format)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		blockWidth = 1;
+		blockHeight = 1;
+		blockBytes = 4;
+		return true;
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+		blockBytes = 8;
+		return true;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+	case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+	case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+		blockBytes = 16;
+		return true;
+	default:
+		return false;
+	}
+}
+
+size_t Ktx2File::GetLevelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+	uint32_t blockWidth, blockHeight, blockBytes;
+	if (!GetBlockInfo(format, blockWidth, blockHeight, blockBytes))
+	{
+		return 0;
+	}
+
+	size_t blocksWide = (width + blockWidth - 1) / blockWidth;
+	size_t blocksHigh = (height + blockHeight - 1) / blockHeight;
+
+	return blocksWide * blocksHigh * blockBytes;
+}
+
+bool Ktx2File::IsSrgb(VkFormat format)
+{
+	return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+		|| format == VK_FORMAT_BC3_SRGB_BLOCK || format == VK_FORMAT_BC7_SRGB_BLOCK || format == VK_FORMAT_ASTC_4x4_SRGB_BLOCK;
+}
+
+VkFormat Ktx2File::WithColorSpace(VkFormat format, bool srgb)
+{
+	static const std::array<std::pair<VkFormat, VkFormat>, 6> kFormatPairs = { {
+		{ VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_SRGB },
+		{ VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGB_SRGB_BLOCK },
+		{ VK_FORMAT_BC1_RGBA_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK },
+		{ VK_FORMAT_BC3_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK },
+		{ VK_FORMAT_BC7_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK },
+		{ VK_FORMAT_ASTC_4x4_UNORM_BLOCK, VK_FORMAT_ASTC_4x4_SRGB_BLOCK }
+	} };
+
+	for (size_t i = 0; i < kFormatPairs.size(); i++)
+	{
+		if (format == kFormatPairs[i].first || format == kFormatPairs[i].second)
+		{
+			return srgb ? kFormatPairs[i].second : kFormatPairs[i].first;
+		}
+	}
+
+	return format;
+}
+
+void Ktx2File::SkipLevels(Texture& texture, uint32_t levelCount)
+{
+	levelCount = std::min<uint32_t>(levelCount, static_cast<uint32_t>(texture.levelOffsets.size()) - 1);
+
+	if (levelCount == 0)
+	{
+		return;
+	}
+
+	size_t skippedBytes = texture.levelOffsets[levelCount];
+	texture.data.erase(texture.data.begin(), texture.data.begin() + skippedBytes);
+	texture.levelOffsets.erase(texture.levelOffsets.begin(), texture.levelOffsets.begin() + levelCount);
+	texture.levelSizes.erase(texture.levelSizes.begin(), texture.levelSizes.begin() + levelCount);
+
+	for (size_t i = 0; i < texture.levelOffsets.size(); i++)
+	{
+		texture.levelOffsets[i] -= skippedBytes;
+	}
+
+	texture.width = std::max(texture.width >> levelCount, 1u);
+	texture.height = std::max(texture.height >> levelCount, 1u);
+}
+
+void Ktx2File::KeepLevels(Texture& texture, uint32_t levelCount)
+{
+	levelCount = std::max(levelCount, 1u);
+	texture.generateMipmaps = false;
+
+	if (levelCount >= texture.levelOffsets.size())
+	{
+		return;
+	}
+
+	texture.data.resize(texture.levelOffsets[levelCount]);
+	texture.levelOffsets.resize(levelCount);
+	texture.levelSizes.resize(levelCount);
+}
+
+Ktx2File::Texture Ktx2File::Read(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+
+	if (!file.is_open()) {
+		throw std::runtime_error("failed to open file: " + filePath);
+	}
+
+	std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+	file.close();
+
+	if (bytes.size() < kHeaderSize || std::memcmp(bytes.data(), kIdentifier, sizeof(kIdentifier)) != 0)
+	{
+		throw std::runtime_error("not a KTX2 file: " + filePath);
+	}
+
+	Texture texture;
+	texture.format = static_cast<VkFormat>(ReadUint32(bytes, 12));
+	texture.width = ReadUint32(bytes, 20);
+	texture.height = ReadUint32(bytes, 24);
+
+	uint32_t depth = ReadUint32(bytes, 28);
+	uint32_t layerCount = ReadUint32(bytes, 32);
+	uint32_t faceCount = ReadUint32(bytes, 36);
+	uint32_t supercompressionScheme = ReadUint32(bytes, 44);
+
+	//a level count of 0 asks the loader to generate the mips, only the first level is stored then
+	uint32_t levelCount = std::max(ReadUint32(bytes, 40), 1u);
+	texture.generateMipmaps = ReadUint32(bytes, 40) == 0;
+
+	if (depth > 1 || layerCount > 1 || faceCount != 1 || texture.width == 0 || texture.height == 0)
+	{
+		throw std::runtime_error("KTX2 file isn't a single 2D image: " + filePath);
+	}
+
+	if (supercompressionScheme != 0)
+	{
+		throw std::runtime_error("supercompressed KTX2 files aren't supported: " + filePath);
+	}
+
+	uint32_t blockWidth, blockHeight, blockBytes;
+	if (!GetBlockInfo(texture.format, blockWidth, blockHeight, blockBytes))
+	{
+		throw std::runtime_error("unsupported format in KTX2 file: " + filePath);
+	}
+
+	if (bytes.size() < kHeaderSize + levelCount * kLevelIndexEntrySize)
+	{
+		throw std::runtime_error("KTX2 file is truncated: " + filePath);
+	}
+
+	std::vector<std::pair<uint64_t, uint64_t>> levelRanges(levelCount);
+	size_t dataSize = 0;
+
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		size_t entry = kHeaderSize + i * kLevelIndexEntrySize;
+		levelRanges[i] = { ReadUint64(bytes, entry), ReadUint64(bytes, entry + 8) };
+
+		uint32_t levelWidth = std::max(texture.width >> i, 1u);
+		uint32_t levelHeight = std::max(texture.height >> i, 1u);
+
+		if (levelRanges[i].second != GetLevelSize(texture.format, levelWidth, levelHeight) || levelRanges[i].first + levelRanges[i].second > bytes.size())
+		{
+			throw std::runtime_error("KTX2 file has a malformed level: " + filePath);
+		}
+
+		texture.levelOffsets.push_back(dataSize);
+		texture.levelSizes.push_back(static_cast<size_t>(levelRanges[i].second));
+		dataSize += static_cast<size_t>(levelRanges[i].second);
+	}
+
+	//the file stores the smallest level first, uploads want the largest first
+	texture.data.resize(dataSize);
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		std::memcpy(&texture.data[texture.levelOffsets[i]], &bytes[static_cast<size_t>(levelRanges[i].first)], texture.levelSizes[i]);
+	}
+
+	return texture;
+}
+
+void Ktx2File::Write(const std::string& filePath, const Texture& texture)
+{
+	std::vector<uint32_t> descriptor = BuildDataFormatDescriptor(texture.format);
+
+	uint32_t blockWidth, blockHeight, blockBytes;
+	GetBlockInfo(texture.format, blockWidth, blockHeight, blockBytes);
+
+	//levels start on a multiple of both the block size and 4
+	size_t alignment = std::max<size_t>(blockBytes, 4);
+
+	uint32_t levelCount = static_cast<uint32_t>(texture.levelOffsets.size());
+	size_t descriptorOffset = kHeaderSize + levelCount * kLevelIndexEntrySize;
+	size_t descriptorSize = descriptor.size() * sizeof(uint32_t);
+	size_t fileSize = descriptorOffset + descriptorSize;
+
+	std::vector<size_t> levelFileOffsets(levelCount);
+	for (uint32_t i = levelCount; i-- > 0;)
+	{
+		fileSize = (fileSize + alignment - 1) / alignment * alignment;
+		levelFileOffsets[i] = fileSize;
+		fileSize += texture.levelSizes[i];
+	}
+
+	std::vector<uint8_t> bytes(fileSize, 0);
+	std::memcpy(bytes.data(), kIdentifier, sizeof(kIdentifier));
+
+	WriteUint32(bytes, 12, static_cast<uint32_t>(texture.format));
+	WriteUint32(bytes, 16, 1);
+	WriteUint32(bytes, 20, texture.width);
+	WriteUint32(bytes, 24, texture.height);
+	WriteUint32(bytes, 28, 0);
+	WriteUint32(bytes, 32, 0);
+	WriteUint32(bytes, 36, 1);
+	WriteUint32(bytes, 40, levelCount);
+	WriteUint32(bytes, 44, 0);
+	WriteUint32(bytes, 48, static_cast<uint32_t>(descriptorOffset));
+	WriteUint32(bytes, 52, static_cast<uint32_t>(descriptorSize));
+
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		size_t entry = kHeaderSize + i * kLevelIndexEntrySize;
+		WriteUint64(bytes, entry, levelFileOffsets[i]);
+		WriteUint64(bytes, entry + 8, texture.levelSizes[i]);
+		WriteUint64(bytes, entry + 16, texture.levelSizes[i]);
+
+		std::memcpy(&bytes[levelFileOffsets[i]], &texture.data[texture.levelOffsets[i]], texture.levelSizes[i]);
+	}
+
+	std::memcpy(&bytes[descriptorOffset], descriptor.data(), descriptorSize);
+
+	std::ofstream file(filePath, std::ios::binary);
+
+	if (!file.is_open()) {
+		throw std::runtime_error("failed to open file: " + filePath);
+	}
+
+	file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+std::vector<uint32_t> Ktx2File::BuildDataFormatDescriptor(VkFormat format)
+{
+	bool rgba8 = format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB;
+	bool bc1 = format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+
+	if (!rgba8 && !bc1)
+	{
+		throw std::runtime_error("KTX2 files can only be written as RGBA8 or BC1!");
+	}
+
+	uint32_t sampleCount = rgba8 ? 4 : 1;
+	uint32_t blockSize = 24 + 16 * sampleCount;
+	uint32_t transfer = IsSrgb(format) ? kTransferSrgb : kTransferLinear;
+
+	//one basic descriptor block, its total size comes first
+	std::vector<uint32_t> descriptor;
+	descriptor.push_back(4 + blockSize);
+	descriptor.push_back(0);
+	descriptor.push_back(2 | (blockSize << 16));
+	descriptor.push_back((rgba8 ? kColorModelRgbsda : kColorModelBc1a) | (kColorPrimariesBt709 << 8) | (transfer << 16));
+
+	//texel block dimensions minus one, then the bytes in each plane
+	descriptor.push_back(rgba8 ? 0 : (3 | (3 << 8)));
+	descriptor.push_back(rgba8 ? 4 : 8);
+	descriptor.push_back(0);
+
+	if (rgba8)
+	{
+		uint32_t channels[4] = { 0, 1, 2, kChannelAlpha };
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			//alpha is never sRGB encoded
+			uint32_t channelType = channels[i] | ((channels[i] == kChannelAlpha && transfer == kTransferSrgb) ? kChannelQualifierLinear : 0);
+
+			descriptor.push_back((i * 8) | (7 << 16) | (channelType << 24));
+			descriptor.push_back(0);
+			descriptor.push_back(0);
+			descriptor.push_back(255);
+		}
+	}
+	else {
+		descriptor.push_back(0 | (63 << 16));
+		descriptor.push_back(0);
+		descriptor.push_back(0);
+		descriptor.push_back(UINT32_MAX);
+	}
+
+	return descriptor;
+}
\ No newline at end of file
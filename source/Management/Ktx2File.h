@@ -0,0 +1,50 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//reads and writes single 2D images in the KTX2 container, its format is a VkFormat so block compressed levels upload as they are
+//supercompressed files aren't supported, they need a transcoder this tree doesn't have
+class Ktx2File {
+public:
+	struct Texture {
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		uint32_t width = 0;
+		uint32_t height = 0;
+
+		//every level one after another, largest first, each tightly packed
+		std::vector<uint8_t> data;
+		std::vector<size_t> levelOffsets;
+		std::vector<size_t> levelSizes;
+
+		//only the first level is stored and the rest are built when it is uploaded, a level count of 0 in the file
+		bool generateMipmaps = false;
+	};
+
+	//throws when the file isn't a KTX2 file or holds something other than one uncompressed or block compressed 2D image
+	static Texture Read(const std::string& filePath);
+
+	//only RGBA8 and BC1, the formats this tree can produce
+	static void Write(const std::string& filePath, const Texture& texture);
+
+	//block size in texels and bytes, uncompressed formats are 1x1 blocks, false for formats a texture can't be read as
+	static bool GetBlockInfo(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockBytes);
+	static size_t GetLevelSize(VkFormat format, uint32_t width, uint32_t height);
+
+	static bool IsSrgb(VkFormat format);
+
+	//the same format read as srgb or linear, the blocks don't change so a texture can be used either way
+	static VkFormat WithColorSpace(VkFormat format, bool srgb);
+
+	//leaves out the largest levels, the last level is always kept
+	static void SkipLevels(Texture& texture, uint32_t levelCount);
+
+	//leaves out the smallest levels, the first level is always kept and nothing is generated on upload
+	static void KeepLevels(Texture& texture, uint32_t levelCount);
+
+private:
+	static std::vector<uint32_t> BuildDataFormatDescriptor(VkFormat format);
+};
\ No newline at end of file
@@ -0,0 +1,459 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	//sum of squared distances to every plane that met at a vertex, each plane weighted by its triangle's area
+	struct Quadric {
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double weight = 0.0;
+
+		static Quadric FromPlane(const glm::vec3& normal, float distance, double weight)
+		{
+			Quadric quadric;
+			quadric.a00 = weight * normal.x * normal.x;
+			quadric.a01 = weight * normal.x * normal.y;
+			quadric.a02 = weight * normal.x * normal.z;
+			quadric.a11 = weight * normal.y * normal.y;
+			quadric.a12 = weight * normal.y * normal.z;
+			quadric.a22 = weight * normal.z * normal.z;
+			quadric.b0 = weight * normal.x * distance;
+			quadric.b1 = weight * normal.y * distance;
+			quadric.b2 = weight * normal.z * distance;
+			quadric.c = weight * distance * distance;
+			quadric.weight = weight;
+
+			return quadric;
+		}
+
+		void Add(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02;
+			a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+		}
+
+		//mean squared distance of the point to the planes
+		double Evaluate(const glm::vec3& point) const
+		{
+			double x = point.x, y = point.y, z = point.z;
+
+			double error = a00 * x * x + a11 * y * y + a22 * z * z
+				+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+				+ 2.0 * (b0 * x + b1 * y + b2 * z)
+				+ c;
+
+			return (weight > 0.0) ? std::max(error, 0.0) / weight : 0.0;
+		}
+	};
+
+	struct Collapse {
+		double error = 0.0;
+		uint32_t from = 0;
+		uint32_t to = 0;
+	};
+
+	//boundary planes stand up from open edges so the outline of a mesh isn't eaten away
+	const double kBoundaryWeight = 10.0;
+
+	//a level that removes less than this share of the previous level's triangles isn't worth a separate range
+	const float kMinimumReduction = 0.85f;
+}
+
+float MeshSimplifier::GetBoundingRadius(const std::vector<VulkanCommonFunctions::Vertex>& vertices)
+{
+	float radiusSquared = 0.0f;
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		radiusSquared = std::max(radiusSquared, glm::dot(vertices[i].pos, vertices[i].pos));
+	}
+
+	return std::sqrt(radiusSquared);
+}
+
+void MeshSimplifier::BuildLodChain(const std::vector<VulkanCommonFunctions::Vertex>& vertices, std::vector<uint16_t>& indices, std::vector<VulkanCommonFunctions::LodLevel>& levels, const Settings& settings)
+{
+	levels.clear();
+
+	VulkanCommonFunctions::LodLevel fullDetail;
+	fullDetail.indexCount = static_cast<uint32_t>(indices.size());
+	levels.push_back(fullDetail);
+
+	float radius = GetBoundingRadius(vertices);
+
+	if (indices.empty() || radius <= 0.0f)
+	{
+		return;
+	}
+
+	//every level is simplified from the full mesh so its error is measured against what it stands in for
+	std::vector<uint16_t> original = indices;
+	size_t previousCount = original.size();
+	uint32_t maxLevels = std::min(settings.maxLevels, VulkanCommonFunctions::MAX_LOD_LEVELS);
+
+	for (uint32_t level = 1; level < maxLevels; level++)
+	{
+		size_t targetTriangles = static_cast<size_t>((previousCount / 3) * settings.reductionPerLevel);
+
+		if (targetTriangles < settings.minTriangles)
+		{
+			break;
+		}
+
+		float error = 0.0f;
+		std::vector<uint16_t> reduced = Simplify(vertices, original, targetTriangles * 3, settings.maxRelativeError * radius, error);
+
+		if (reduced.empty() || reduced.size() > previousCount * kMinimumReduction)
+		{
+			break;
+		}
+
+		VulkanCommonFunctions::LodLevel lod;
+		lod.firstIndex = static_cast<uint32_t>(indices.size());
+		lod.indexCount = static_cast<uint32_t>(reduced.size());
+		lod.error = error / radius;
+
+		indices.insert(indices.end(), reduced.begin(), reduced.end());
+		levels.push_back(lod);
+
+		previousCount = reduced.size();
+	}
+}
+
+std::vector<uint16_t> MeshSimplifier::Simplify(const std::vector<VulkanCommonFunctions::Vertex>& vertices, const std::vector<uint16_t>& indices, size_t targetIndexCount, float maxError, float& outError)
+{
+	outError = 0.0f;
+
+	//vertices at the same position are split only for their normals or uvs, collapses work on the positions
+	std::vector<uint32_t> sortedVertices(vertices.size());
+	for (uint32_t i = 0; i < sortedVertices.size(); i++)
+	{
+		sortedVertices[i] = i;
+	}
+
+	std::sort(sortedVertices.begin(), sortedVertices.end(), [&](uint32_t left, uint32_t right) {
+		const glm::vec3& a = vertices[left].pos;
+		const glm::vec3& b = vertices[right].pos;
+
+		if (a.x != b.x) return a.x < b.x;
+		if (a.y != b.y) return a.y < b.y;
+		return a.z < b.z;
+	});
+
+	std::vector<uint32_t> vertexPosition(vertices.size());
+	std::vector<uint32_t> positionVertexOffsets;
+	std::vector<glm::vec3> positions;
+
+	for (size_t i = 0; i < sortedVertices.size(); i++)
+	{
+		const glm::vec3& position = vertices[sortedVertices[i]].pos;
+
+		if (positions.empty() || positions.back() != position)
+		{
+			positions.push_back(position);
+			positionVertexOffsets.push_back(static_cast<uint32_t>(i));
+		}
+
+		vertexPosition[sortedVertices[i]] = static_cast<uint32_t>(positions.size() - 1);
+	}
+	positionVertexOffsets.push_back(static_cast<uint32_t>(sortedVertices.size()));
+
+	size_t positionCount = positions.size();
+
+	std::vector<uint16_t> current;
+	current.reserve(indices.size());
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		uint32_t a = vertexPosition[indices[i]];
+		uint32_t b = vertexPosition[indices[i + 1]];
+		uint32_t c = vertexPosition[indices[i + 2]];
+
+		if (a != b && b != c && a != c)
+		{
+			current.insert(current.end(), { indices[i], indices[i + 1], indices[i + 2] });
+		}
+	}
+
+	std::vector<Quadric> quadrics(positionCount);
+
+	for (size_t i = 0; i < current.size(); i += 3)
+	{
+		const glm::vec3& p0 = positions[vertexPosition[current[i]]];
+		const glm::vec3& p1 = positions[vertexPosition[current[i + 1]]];
+		const glm::vec3& p2 = positions[vertexPosition[current[i + 2]]];
+
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float doubleArea = glm::length(normal);
+
+		if (doubleArea <= 0.0f)
+		{
+			continue;
+		}
+
+		normal /= doubleArea;
+		Quadric plane = Quadric::FromPlane(normal, -glm::dot(normal, p0), doubleArea * 0.5);
+
+		for (size_t corner = 0; corner < 3; corner++)
+		{
+			quadrics[vertexPosition[current[i + corner]]].Add(plane);
+		}
+	}
+
+	//an edge is open when no triangle runs along it the other way
+	std::vector<std::pair<uint32_t, uint32_t>> directedEdges;
+	directedEdges.reserve(current.size());
+
+	for (size_t i = 0; i < current.size(); i += 3)
+	{
+		for (size_t corner = 0; corner < 3; corner++)
+		{
+			directedEdges.emplace_back(vertexPosition[current[i + corner]], vertexPosition[current[i + (corner + 1) % 3]]);
+		}
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> sortedEdges = directedEdges;
+	std::sort(sortedEdges.begin(), sortedEdges.end());
+
+	for (size_t i = 0; i < directedEdges.size(); i++)
+	{
+		uint32_t from = directedEdges[i].first;
+		uint32_t to = directedEdges[i].second;
+
+		if (std::binary_search(sortedEdges.begin(), sortedEdges.end(), std::make_pair(to, from)))
+		{
+			continue;
+		}
+
+		size_t triangle = i / 3;
+		const glm::vec3& p0 = positions[vertexPosition[current[triangle * 3]]];
+		const glm::vec3& p1 = positions[vertexPosition[current[triangle * 3 + 1]]];
+		const glm::vec3& p2 = positions[vertexPosition[current[triangle * 3 + 2]]];
+
+		glm::vec3 edge = positions[to] - positions[from];
+		glm::vec3 boundaryNormal = glm::cross(edge, glm::cross(p1 - p0, p2 - p0));
+		float length = glm::length(boundaryNormal);
+
+		if (length <= 0.0f)
+		{
+			continue;
+		}
+
+		boundaryNormal /= length;
+		Quadric plane = Quadric::FromPlane(boundaryNormal, -glm::dot(boundaryNormal, positions[from]), glm::dot(edge, edge) * kBoundaryWeight);
+
+		quadrics[from].Add(plane);
+		quadrics[to].Add(plane);
+	}
+
+	std::vector<uint32_t> collapseTarget(positionCount);
+	for (uint32_t i = 0; i < positionCount; i++)
+	{
+		collapseTarget[i] = i;
+	}
+
+	double maxErrorSquared = static_cast<double>(maxError) * maxError;
+	double reachedErrorSquared = 0.0;
+
+	std::vector<uint32_t> adjacencyOffsets;
+	std::vector<uint32_t> adjacency;
+	std::vector<std::pair<uint32_t, uint32_t>> edges;
+	std::vector<Collapse> collapses;
+	std::vector<uint8_t> locked;
+	std::vector<uint16_t> next;
+
+	//each pass collapses the cheapest edges that don't touch one another, then rebuilds the triangles
+	while (current.size() > targetIndexCount)
+	{
+		adjacencyOffsets.assign(positionCount + 1, 0);
+		for (size_t i = 0; i < current.size(); i++)
+		{
+			adjacencyOffsets[vertexPosition[current[i]] + 1]++;
+		}
+
+		for (size_t i = 1; i < adjacencyOffsets.size(); i++)
+		{
+			adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+		}
+
+		adjacency.resize(current.size());
+		std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+		for (size_t i = 0; i < current.size(); i++)
+		{
+			adjacency[cursor[vertexPosition[current[i]]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		edges.clear();
+		for (size_t i = 0; i < current.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t a = vertexPosition[current[i + corner]];
+				uint32_t b = vertexPosition[current[i + (corner + 1) % 3]];
+				edges.emplace_back(std::min(a, b), std::max(a, b));
+			}
+		}
+
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		collapses.clear();
+		for (size_t i = 0; i < edges.size(); i++)
+		{
+			Quadric combined = quadrics[edges[i].first];
+			combined.Add(quadrics[edges[i].second]);
+
+			Collapse collapse;
+			double firstOntoSecond = combined.Evaluate(positions[edges[i].second]);
+			double secondOntoFirst = combined.Evaluate(positions[edges[i].first]);
+
+			if (firstOntoSecond <= secondOntoFirst)
+			{
+				collapse = { firstOntoSecond, edges[i].first, edges[i].second };
+			}
+			else {
+				collapse = { secondOntoFirst, edges[i].second, edges[i].first };
+			}
+
+			collapses.push_back(collapse);
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& left, const Collapse& right) { return left.error < right.error; });
+
+		locked.assign(positionCount, 0);
+		size_t trianglesToRemove = (current.size() - targetIndexCount + 2) / 3;
+		size_t removedTriangles = 0;
+		size_t collapseCount = 0;
+
+		for (size_t i = 0; i < collapses.size() && removedTriangles < trianglesToRemove; i++)
+		{
+			const Collapse& collapse = collapses[i];
+
+			if (collapse.error > maxErrorSquared)
+			{
+				break;
+			}
+
+			if (locked[collapse.from] || locked[collapse.to])
+			{
+				continue;
+			}
+
+			//moving the vertex must not turn any of the triangles that survive it over
+			bool flips = false;
+			size_t collapsingTriangles = 0;
+
+			for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && !flips; a++)
+			{
+				uint32_t triangle = adjacency[a];
+				uint32_t corners[3];
+				glm::vec3 before[3];
+				glm::vec3 after[3];
+
+				for (size_t corner = 0; corner < 3; corner++)
+				{
+					corners[corner] = vertexPosition[current[triangle * 3 + corner]];
+					before[corner] = positions[corners[corner]];
+					after[corner] = (corners[corner] == collapse.from) ? positions[collapse.to] : before[corner];
+				}
+
+				if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to)
+				{
+					collapsingTriangles++;
+					continue;
+				}
+
+				glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+				flips = glm::dot(normalBefore, normalAfter) < 0.0f;
+			}
+
+			if (flips)
+			{
+				continue;
+			}
+
+			collapseTarget[collapse.from] = collapse.to;
+			quadrics[collapse.to].Add(quadrics[collapse.from]);
+
+			for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++)
+			{
+				for (size_t corner = 0; corner < 3; corner++)
+				{
+					locked[vertexPosition[current[adjacency[a] * 3 + corner]]] = 1;
+				}
+			}
+
+			removedTriangles += collapsingTriangles;
+			reachedErrorSquared = std::max(reachedErrorSquared, collapse.error);
+			collapseCount++;
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		next.clear();
+		for (size_t i = 0; i < current.size(); i += 3)
+		{
+			uint16_t triangle[3];
+			uint32_t trianglePositions[3];
+
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				uint16_t vertex = current[i + corner];
+				uint32_t position = vertexPosition[vertex];
+				uint32_t target = collapseTarget[position];
+
+				//the moved corner takes the vertex at its new position that looks most like the one it had
+				if (target != position)
+				{
+					float bestScore = INFINITY;
+
+					for (uint32_t candidate = positionVertexOffsets[target]; candidate < positionVertexOffsets[target + 1]; candidate++)
+					{
+						const VulkanCommonFunctions::Vertex& original = vertices[vertex];
+						const VulkanCommonFunctions::Vertex& replacement = vertices[sortedVertices[candidate]];
+
+						glm::vec3 normalDifference = original.normal - replacement.normal;
+						glm::vec2 texCoordDifference = original.texCoord - replacement.texCoord;
+						float score = glm::dot(normalDifference, normalDifference) + glm::dot(texCoordDifference, texCoordDifference);
+
+						if (score < bestScore)
+						{
+							bestScore = score;
+							triangle[corner] = static_cast<uint16_t>(sortedVertices[candidate]);
+						}
+					}
+
+					trianglePositions[corner] = target;
+				}
+				else {
+					triangle[corner] = vertex;
+					trianglePositions[corner] = position;
+				}
+			}
+
+			if (trianglePositions[0] == trianglePositions[1] || trianglePositions[1] == trianglePositions[2] || trianglePositions[0] == trianglePositions[2])
+			{
+				continue;
+			}
+
+			next.insert(next.end(), { triangle[0], triangle[1], triangle[2] });
+		}
+
+		current.swap(next);
+	}
+
+	outError = static_cast<float>(std::sqrt(reachedErrorSquared));
+	return current;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <cstdint>
+#include <vector>
+
+//quadric error edge collapse, each vertex is moved onto a neighbour so lower levels only need new indices
+//vertices at the same position are treated as one, seams pick the neighbour's vertex whose normal and uv fit best
+class MeshSimplifier {
+public:
+	struct Settings {
+		//including the full detail level, capped at MAX_LOD_LEVELS
+		uint32_t maxLevels = 4;
+
+		//each level aims for this fraction of the previous level's triangles
+		float reductionPerLevel = 0.5f;
+
+		//no level strays further than this fraction of the bounding radius from the full mesh
+		float maxRelativeError = 0.1f;
+
+		uint32_t minTriangles = 8;
+	};
+
+	//appends every lower level's indices to indices and fills levels, level 0 is the indices that were passed in
+	static void BuildLodChain(const std::vector<VulkanCommonFunctions::Vertex>& vertices, std::vector<uint16_t>& indices, std::vector<VulkanCommonFunctions::LodLevel>& levels, const Settings& settings);
+
+	//collapses edges until at most targetIndexCount indices are left or the next collapse would move the surface further than maxError
+	//outError is how far the result strays from the original surface, in the mesh's units
+	static std::vector<uint16_t> Simplify(const std::vector<VulkanCommonFunctions::Vertex>& vertices, const std::vector<uint16_t>& indices, size_t targetIndexCount, float maxError, float& outError);
+
+	//about the mesh's origin, which is where instances are placed
+	static float GetBoundingRadius(const std::vector<VulkanCommonFunctions::Vertex>& vertices);
+};
@@ -0,0 +1,315 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+namespace {
+	//a cone this wide covers triangles facing almost every way, it would never cull anything
+	const float kMinimumConeDot = 0.1f;
+
+	const uint32_t kNotInMeshlet = UINT32_MAX;
+
+	std::array<uint16_t, 3> SortedTriangle(const uint16_t* triangle)
+	{
+		std::array<uint16_t, 3> sorted = { triangle[0], triangle[1], triangle[2] };
+
+		//the winding decides which side is the front, keep it by only rotating the smallest index to the front
+		while (sorted[0] > sorted[1] || sorted[0] > sorted[2])
+		{
+			std::rotate(sorted.begin(), sorted.begin() + 1, sorted.end());
+		}
+
+		return sorted;
+	}
+}
+
+void MeshletBuilder::BuildForLevels(const std::vector<VulkanCommonFunctions::Vertex>& vertices, std::vector<uint16_t>& indices, std::vector<VulkanCommonFunctions::LodLevel>& levels, std::vector<VulkanCommonFunctions::MeshletInfo>& meshlets)
+{
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		levels[i].firstMeshlet = static_cast<uint32_t>(meshlets.size());
+		Build(vertices, indices, levels[i].firstIndex, levels[i].indexCount, meshlets);
+		levels[i].meshletCount = static_cast<uint32_t>(meshlets.size()) - levels[i].firstMeshlet;
+	}
+}
+
+void MeshletBuilder::Build(const std::vector<VulkanCommonFunctions::Vertex>& vertices, std::vector<uint16_t>& indices, uint32_t firstIndex, uint32_t indexCount, std::vector<VulkanCommonFunctions::MeshletInfo>& meshlets)
+{
+	uint32_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	std::vector<uint16_t> source(indices.begin() + firstIndex, indices.begin() + firstIndex + triangleCount * 3);
+
+	//neighbours are found through positions, meshes split their vertices along every seam and hard edge
+	std::vector<uint32_t> sortedVertices(vertices.size());
+	std::iota(sortedVertices.begin(), sortedVertices.end(), 0);
+	std::sort(sortedVertices.begin(), sortedVertices.end(), [&](uint32_t a, uint32_t b) {
+		const glm::vec3& positionA = vertices[a].pos;
+		const glm::vec3& positionB = vertices[b].pos;
+
+		if (positionA.x != positionB.x) return positionA.x < positionB.x;
+		if (positionA.y != positionB.y) return positionA.y < positionB.y;
+		if (positionA.z != positionB.z) return positionA.z < positionB.z;
+		return a < b;
+	});
+
+	std::vector<uint32_t> positionIds(vertices.size());
+	uint32_t positionCount = 0;
+
+	for (size_t i = 0; i < sortedVertices.size(); i++)
+	{
+		if (i > 0 && vertices[sortedVertices[i]].pos != vertices[sortedVertices[i - 1]].pos)
+		{
+			positionCount++;
+		}
+
+		positionIds[sortedVertices[i]] = positionCount;
+	}
+
+	positionCount++;
+
+	//triangles touching each position, laid out one position after another
+	std::vector<uint32_t> adjacencyOffsets(positionCount + 1, 0);
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		adjacencyOffsets[positionIds[source[i]] + 1]++;
+	}
+
+	for (uint32_t i = 0; i < positionCount; i++)
+	{
+		adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+	}
+
+	std::vector<uint32_t> adjacency(source.size());
+	std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		adjacency[adjacencyFill[positionIds[source[i]]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> vertexMeshlet(vertices.size(), kNotInMeshlet);
+	std::vector<uint32_t> candidates;
+
+	uint32_t writeIndex = firstIndex;
+	uint32_t emittedCount = 0;
+	uint32_t nextSeed = 0;
+
+	while (emittedCount < triangleCount)
+	{
+		uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+
+		VulkanCommonFunctions::MeshletInfo meshlet;
+		meshlet.firstIndex = writeIndex;
+
+		candidates.clear();
+
+		while (emitted[nextSeed])
+		{
+			nextSeed++;
+		}
+
+		uint32_t triangle = nextSeed;
+
+		while (true)
+		{
+			const uint16_t* corners = &source[triangle * 3];
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				if (vertexMeshlet[corners[corner]] != meshletId)
+				{
+					vertexMeshlet[corners[corner]] = meshletId;
+					meshlet.vertexCount++;
+				}
+
+				uint32_t position = positionIds[corners[corner]];
+				for (uint32_t i = adjacencyOffsets[position]; i < adjacencyOffsets[position + 1]; i++)
+				{
+					if (!emitted[adjacency[i]])
+					{
+						candidates.push_back(adjacency[i]);
+					}
+				}
+
+				indices[writeIndex++] = corners[corner];
+			}
+
+			emitted[triangle] = true;
+			emittedCount++;
+			meshlet.indexCount += 3;
+
+			if (meshlet.indexCount / 3 >= kMaxTriangles)
+			{
+				break;
+			}
+
+			//the neighbour that brings the fewest new vertices along, so clusters stay compact
+			uint32_t bestCandidate = UINT32_MAX;
+			uint32_t bestNewVertices = 4;
+
+			for (size_t i = 0; i < candidates.size();)
+			{
+				if (emitted[candidates[i]])
+				{
+					candidates[i] = candidates.back();
+					candidates.pop_back();
+					continue;
+				}
+
+				const uint16_t* candidateCorners = &source[candidates[i] * 3];
+				uint32_t newVertices = 0;
+
+				for (int corner = 0; corner < 3; corner++)
+				{
+					//a corner listed twice in a degenerate triangle is only counted once by the real vertex count, overcounting here is harmless
+					if (vertexMeshlet[candidateCorners[corner]] != meshletId)
+					{
+						newVertices++;
+					}
+				}
+
+				if (newVertices < bestNewVertices && meshlet.vertexCount + newVertices <= kMaxVertices)
+				{
+					bestCandidate = candidates[i];
+					bestNewVertices = newVertices;
+				}
+
+				i++;
+			}
+
+			//nothing connected is left, a cluster jumping across the mesh would have bounds too loose to cull
+			if (bestCandidate == UINT32_MAX)
+			{
+				break;
+			}
+
+			triangle = bestCandidate;
+		}
+
+		ComputeBounds(vertices, &indices[meshlet.firstIndex], meshlet.indexCount / 3, meshlet);
+		meshlets.push_back(meshlet);
+	}
+}
+
+void MeshletBuilder::ComputeBounds(const std::vector<VulkanCommonFunctions::Vertex>& vertices, const uint16_t* triangles, uint32_t triangleCount, VulkanCommonFunctions::MeshletInfo& meshlet)
+{
+	glm::vec3 boundsMin = vertices[triangles[0]].pos;
+	glm::vec3 boundsMax = boundsMin;
+
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		boundsMin = glm::min(boundsMin, vertices[triangles[i]].pos);
+		boundsMax = glm::max(boundsMax, vertices[triangles[i]].pos);
+	}
+
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	float radius = 0.0f;
+
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		radius = std::max(radius, glm::length(vertices[triangles[i]].pos - center));
+	}
+
+	meshlet.boundingSphere = glm::vec4(center, radius);
+
+	//front faces are wound clockwise, so the cross product of their edges points inwards
+	std::vector<glm::vec3> normals;
+	normals.reserve(triangleCount);
+	glm::vec3 normalSum = glm::vec3(0.0f);
+
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		glm::vec3 a = vertices[triangles[i * 3]].pos;
+		glm::vec3 b = vertices[triangles[i * 3 + 1]].pos;
+		glm::vec3 c = vertices[triangles[i * 3 + 2]].pos;
+
+		glm::vec3 normal = -glm::cross(b - a, c - a);
+		float length = glm::length(normal);
+
+		if (length <= 0.0f)
+		{
+			continue;
+		}
+
+		normals.push_back(normal / length);
+		normalSum += normals.back();
+	}
+
+	//the default never passes the cull test, dot(offset, 0) is never above the positive right hand side
+	meshlet.cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	float sumLength = glm::length(normalSum);
+	if (normals.empty() || sumLength <= 0.0f)
+	{
+		return;
+	}
+
+	glm::vec3 axis = normalSum / sumLength;
+	float minimumDot = 1.0f;
+
+	for (size_t i = 0; i < normals.size(); i++)
+	{
+		minimumDot = std::min(minimumDot, glm::dot(normals[i], axis));
+	}
+
+	if (minimumDot <= kMinimumConeDot)
+	{
+		return;
+	}
+
+	//the normals lie within acos(minimumDot) of the axis, the camera sees only backs once it is more than 90 degrees past that
+	meshlet.cone = glm::vec4(axis, std::sqrt(1.0f - minimumDot * minimumDot));
+}
+
+bool MeshletBuilder::Validate(const std::vector<uint16_t>& originalIndices, const std::vector<uint16_t>& indices, uint32_t firstIndex, uint32_t indexCount, const std::vector<VulkanCommonFunctions::MeshletInfo>& meshlets)
+{
+	uint32_t expectedIndex = firstIndex;
+
+	for (size_t i = 0; i < meshlets.size(); i++)
+	{
+		const VulkanCommonFunctions::MeshletInfo& meshlet = meshlets[i];
+
+		if (meshlet.firstIndex != expectedIndex || meshlet.indexCount == 0 || meshlet.indexCount % 3 != 0 || meshlet.indexCount / 3 > kMaxTriangles)
+		{
+			return false;
+		}
+
+		std::vector<uint16_t> meshletVertices(indices.begin() + meshlet.firstIndex, indices.begin() + meshlet.firstIndex + meshlet.indexCount);
+		std::sort(meshletVertices.begin(), meshletVertices.end());
+
+		size_t vertexCount = std::unique(meshletVertices.begin(), meshletVertices.end()) - meshletVertices.begin();
+		if (vertexCount > kMaxVertices || vertexCount != meshlet.vertexCount)
+		{
+			return false;
+		}
+
+		expectedIndex += meshlet.indexCount;
+	}
+
+	uint32_t triangleCount = indexCount / 3;
+	if (expectedIndex != firstIndex + triangleCount * 3)
+	{
+		return false;
+	}
+
+	std::vector<std::array<uint16_t, 3>> originalTriangles;
+	std::vector<std::array<uint16_t, 3>> builtTriangles;
+
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		originalTriangles.push_back(SortedTriangle(&originalIndices[firstIndex + i * 3]));
+		builtTriangles.push_back(SortedTriangle(&indices[firstIndex + i * 3]));
+	}
+
+	std::sort(originalTriangles.begin(), originalTriangles.end());
+	std::sort(builtTriangles.begin(), builtTriangles.end());
+
+	return originalTriangles == builtTriangles;
+}
\ No newline at end of file
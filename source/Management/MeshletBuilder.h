@@ -0,0 +1,26 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <cstdint>
+#include <vector>
+
+//splits a mesh into small clusters of neighbouring triangles that can each be culled on the GPU
+//triangles are only reordered, so the clusters of a range still draw exactly what the range drew before
+class MeshletBuilder {
+public:
+	static constexpr uint32_t kMaxVertices = 64;
+	static constexpr uint32_t kMaxTriangles = 124;
+
+	//reorders indices[firstIndex, firstIndex + indexCount) cluster by cluster and appends one meshlet per cluster
+	static void Build(const std::vector<VulkanCommonFunctions::Vertex>& vertices, std::vector<uint16_t>& indices, uint32_t firstIndex, uint32_t indexCount, std::vector<VulkanCommonFunctions::MeshletInfo>& meshlets);
+
+	//builds each level's clusters and points the level at them
+	static void BuildForLevels(const std::vector<VulkanCommonFunctions::Vertex>& vertices, std::vector<uint16_t>& indices, std::vector<VulkanCommonFunctions::LodLevel>& levels, std::vector<VulkanCommonFunctions::MeshletInfo>& meshlets);
+
+	//every triangle of the range in exactly one meshlet and every meshlet within the limits, for checking a build
+	static bool Validate(const std::vector<uint16_t>& originalIndices, const std::vector<uint16_t>& indices, uint32_t firstIndex, uint32_t indexCount, const std::vector<VulkanCommonFunctions::MeshletInfo>& meshlets);
+
+private:
+	static void ComputeBounds(const std::vector<VulkanCommonFunctions::Vertex>& vertices, const uint16_t* triangles, uint32_t triangleCount, VulkanCommonFunctions::MeshletInfo& meshlet);
+};
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "MipChainBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	const uint32_t kChannels = 4;
+
+	//in texels of the smaller level, wider keeps more detail but rings more around hard edges
+	const float kKaiserRadius = 3.0f;
+	const float kKaiserBeta = 4.0f;
+
+	const float kPi = 3.14159265358979f;
+
+	float SrgbToLinear(float value)
+	{
+		return (value <= 0.04045f) ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSrgb(float value)
+	{
+		return (value <= 0.0031308f) ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+
+	//zeroth order modified Bessel function, the series converges quickly for the betas a filter uses
+	float BesselI0(float x)
+	{
+		float sum = 1.0f;
+		float term = 1.0f;
+		float halfX = x * 0.5f;
+
+		for (int k = 1; k < 16; k++)
+		{
+			term *= (halfX / k) * (halfX / k);
+			sum += term;
+		}
+
+		return sum;
+	}
+
+	float KaiserWeight(float distance, float radius)
+	{
+		float ratio = distance / radius;
+		if (std::abs(ratio) >= 1.0f)
+		{
+			return 0.0f;
+		}
+
+		float sinc = (distance == 0.0f) ? 1.0f : std::sin(kPi * distance) / (kPi * distance);
+		return sinc * BesselI0(kKaiserBeta * std::sqrt(1.0f - ratio * ratio)) / BesselI0(kKaiserBeta);
+	}
+
+	//filters along one axis only, the two axes are done one after the other
+	void ResampleAxis(const std::vector<float>& source, uint32_t sourceWidth, uint32_t sourceHeight, bool horizontal, uint32_t length, std::vector<float>& destination)
+	{
+		uint32_t sourceLength = horizontal ? sourceWidth : sourceHeight;
+		uint32_t width = horizontal ? length : sourceWidth;
+		uint32_t height = horizontal ? sourceHeight : length;
+
+		destination.assign(static_cast<size_t>(width) * height * kChannels, 0.0f);
+
+		//how many source texels one destination texel covers, the kernel is stretched to match
+		float scale = static_cast<float>(sourceLength) / length;
+		float radius = kKaiserRadius * scale;
+
+		std::vector<float> weights;
+
+		for (uint32_t i = 0; i < length; i++)
+		{
+			float center = (i + 0.5f) * scale;
+			int first = static_cast<int>(std::floor(center - radius));
+			int last = static_cast<int>(std::ceil(center + radius));
+
+			weights.clear();
+			float weightSum = 0.0f;
+
+			for (int tap = first; tap <= last; tap++)
+			{
+				weights.push_back(KaiserWeight((tap + 0.5f - center) / scale, kKaiserRadius));
+				weightSum += weights.back();
+			}
+
+			for (uint32_t other = 0; other < (horizontal ? height : width); other++)
+			{
+				float result[kChannels] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+				for (int tap = first; tap <= last; tap++)
+				{
+					//the edges are clamped, wrapping would bleed the opposite side into textures that don't tile
+					uint32_t clamped = static_cast<uint32_t>(std::clamp(tap, 0, static_cast<int>(sourceLength) - 1));
+					size_t sourceIndex = horizontal ? (static_cast<size_t>(other) * sourceWidth + clamped) : (static_cast<size_t>(clamped) * sourceWidth + other);
+
+					for (uint32_t channel = 0; channel < kChannels; channel++)
+					{
+						result[channel] += source[sourceIndex * kChannels + channel] * weights[tap - first];
+					}
+				}
+
+				size_t destinationIndex = horizontal ? (static_cast<size_t>(other) * width + i) : (static_cast<size_t>(i) * width + other);
+
+				for (uint32_t channel = 0; channel < kChannels; channel++)
+				{
+					destination[destinationIndex * kChannels + channel] = result[channel] / weightSum;
+				}
+			}
+		}
+	}
+}
+
+uint32_t MipChainBuilder::GetMipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t levelCount = 1;
+	uint32_t size = std::max(width, height);
+
+	while (size > 1)
+	{
+		size /= 2;
+		levelCount++;
+	}
+
+	return levelCount;
+}
+
+std::vector<uint8_t> MipChainBuilder::Build(const uint8_t* pixels, uint32_t width, uint32_t height, bool srgb, Filter filter, std::vector<MipLevel>& levels)
+{
+	uint32_t levelCount = GetMipLevelCount(width, height);
+
+	levels.clear();
+	size_t chainSize = 0;
+
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		MipLevel level;
+		level.width = std::max(width >> i, 1u);
+		level.height = std::max(height >> i, 1u);
+		level.offset = chainSize;
+		level.size = static_cast<size_t>(level.width) * level.height * kChannels;
+
+		chainSize += level.size;
+		levels.push_back(level);
+	}
+
+	std::vector<uint8_t> chain(chainSize);
+	std::copy(pixels, pixels + levels[0].size, chain.begin());
+
+	//each level is filtered from the one above it in float, rounding to bytes is only done for storage
+	std::vector<float> current(levels[0].size);
+	for (size_t i = 0; i < current.size(); i++)
+	{
+		float value = pixels[i] / 255.0f;
+		current[i] = (srgb && i % kChannels != 3) ? SrgbToLinear(value) : value;
+	}
+
+	std::vector<float> next;
+
+	for (uint32_t i = 1; i < levelCount; i++)
+	{
+		const MipLevel& previous = levels[i - 1];
+		const MipLevel& level = levels[i];
+
+		if (filter == Filter::Box)
+		{
+			DownsampleBox(current, previous.width, previous.height, next, level.width, level.height);
+		}
+		else {
+			DownsampleKaiser(current, previous.width, previous.height, next, level.width, level.height);
+		}
+
+		for (size_t j = 0; j < next.size(); j++)
+		{
+			//the Kaiser filter's negative lobes can overshoot around hard edges
+			float value = std::clamp(next[j], 0.0f, 1.0f);
+			value = (srgb && j % kChannels != 3) ? LinearToSrgb(value) : value;
+
+			chain[level.offset + j] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+		}
+
+		std::swap(current, next);
+	}
+
+	return chain;
+}
+
+void MipChainBuilder::DownsampleBox(const std::vector<float>& source, uint32_t sourceWidth, uint32_t sourceHeight, std::vector<float>& destination, uint32_t width, uint32_t height)
+{
+	destination.assign(static_cast<size_t>(width) * height * kChannels, 0.0f);
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			//an axis that is already 1 texel wide is only halved along the other one
+			uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+			uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+			uint32_t y0 = std::min(y * 2, sourceHeight - 1);
+			uint32_t y1 = std::min(y * 2 + 1, sourceHeight - 1);
+
+			for (uint32_t channel = 0; channel < kChannels; channel++)
+			{
+				float sum = source[(static_cast<size_t>(y0) * sourceWidth + x0) * kChannels + channel]
+					+ source[(static_cast<size_t>(y0) * sourceWidth + x1) * kChannels + channel]
+					+ source[(static_cast<size_t>(y1) * sourceWidth + x0) * kChannels + channel]
+					+ source[(static_cast<size_t>(y1) * sourceWidth + x1) * kChannels + channel];
+
+				destination[(static_cast<size_t>(y) * width + x) * kChannels + channel] = sum * 0.25f;
+			}
+		}
+	}
+}
+
+void MipChainBuilder::DownsampleKaiser(const std::vector<float>& source, uint32_t sourceWidth, uint32_t sourceHeight, std::vector<float>& destination, uint32_t width, uint32_t height)
+{
+	std::vector<float> horizontal;
+	ResampleAxis(source, sourceWidth, sourceHeight, true, width, horizontal);
+	ResampleAxis(horizontal, width, sourceHeight, false, height, destination);
+}
\ No newline at end of file
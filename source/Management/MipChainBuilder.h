@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//downsamples RGBA8 images on the CPU, it has no Vulkan dependency so chains can also be built offline
+//devices that can blit with linear filtering build them on the GPU instead, this is for everything else
+class MipChainBuilder {
+public:
+	enum class Filter {
+		//averages each 2x2 block, fast but lets some detail alias into the smaller levels
+		Box,
+
+		//Kaiser windowed sinc, keeps smaller levels sharper without the box filter's aliasing
+		Kaiser
+	};
+
+	struct MipLevel {
+		uint32_t width;
+		uint32_t height;
+
+		//in bytes, from the start of the chain
+		size_t offset;
+		size_t size;
+	};
+
+	//down to and including the 1x1 level
+	static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
+	//returns every level one after another, starting with a copy of the image, and fills levels with where each one is
+	//srgb filters the color channels in linear space, alpha is always filtered as it is
+	static std::vector<uint8_t> Build(const uint8_t* pixels, uint32_t width, uint32_t height, bool srgb, Filter filter, std::vector<MipLevel>& levels);
+
+private:
+	static void DownsampleBox(const std::vector<float>& source, uint32_t sourceWidth, uint32_t sourceHeight, std::vector<float>& destination, uint32_t width, uint32_t height);
+	static void DownsampleKaiser(const std::vector<float>& source, uint32_t sourceWidth, uint32_t sourceHeight, std::vector<float>& destination, uint32_t width, uint32_t height);
+};
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+//least significant byte first radix sort over 32 bit keys, stable and linear in the number of keys
+//passes where every key has the same byte are skipped, so keys clustered in a small range sort in fewer passes
+class RadixSorter {
+public:
+	//maps a float to a key with the same ordering, negative values included
+	static uint32_t FloatToKey(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	}
+
+	//fills order with the indices of keys from smallest to largest key, equal keys keep their input order
+	void Sort(const std::vector<uint32_t>& keys, std::vector<uint32_t>& order)
+	{
+		size_t count = keys.size();
+
+		order.resize(count);
+		m_keys.resize(count);
+		m_scratchKeys.resize(count);
+		m_scratchOrder.resize(count);
+
+		//all four histograms are built in one read of the keys
+		std::array<std::array<uint32_t, kBucketCount>, kPassCount> histograms{};
+
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t key = keys[i];
+
+			for (uint32_t pass = 0; pass < kPassCount; pass++)
+			{
+				histograms[pass][(key >> (pass * kBitsPerPass)) & (kBucketCount - 1)]++;
+			}
+
+			m_keys[i] = key;
+			order[i] = static_cast<uint32_t>(i);
+		}
+
+		uint32_t* sourceKeys = m_keys.data();
+		uint32_t* sourceOrder = order.data();
+		uint32_t* destinationKeys = m_scratchKeys.data();
+		uint32_t* destinationOrder = m_scratchOrder.data();
+
+		for (uint32_t pass = 0; pass < kPassCount; pass++)
+		{
+			std::array<uint32_t, kBucketCount>& histogram = histograms[pass];
+			uint32_t shift = pass * kBitsPerPass;
+
+			if (count == 0 || histogram[(sourceKeys[0] >> shift) & (kBucketCount - 1)] == count)
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t bucket = 0; bucket < kBucketCount; bucket++)
+			{
+				uint32_t bucketSize = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketSize;
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				uint32_t key = sourceKeys[i];
+				uint32_t destination = histogram[(key >> shift) & (kBucketCount - 1)]++;
+
+				destinationKeys[destination] = key;
+				destinationOrder[destination] = sourceOrder[i];
+			}
+
+			std::swap(sourceKeys, destinationKeys);
+			std::swap(sourceOrder, destinationOrder);
+		}
+
+		if (sourceOrder != order.data())
+		{
+			order.swap(m_scratchOrder);
+		}
+	}
+
+private:
+	static constexpr uint32_t kBitsPerPass = 8;
+	static constexpr uint32_t kBucketCount = 1 << kBitsPerPass;
+	static constexpr uint32_t kPassCount = 32 / kBitsPerPass;
+
+	//kept between sorts so sorting every frame doesn't allocate
+	std::vector<uint32_t> m_keys;
+	std::vector<uint32_t> m_scratchKeys;
+	std::vector<uint32_t> m_scratchOrder;
+};
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "RenderSnapshot.h"
+#include "source/Objects/RenderObject.h"
+
+namespace {
+	//euler angles in degrees, takes the short way around so 359 -> 1 doesn't spin backwards
+	glm::vec3 LerpRotation(glm::vec3 previous, glm::vec3 current, float alpha)
+	{
+		glm::vec3 difference = current - previous;
+		difference = glm::mod(difference + 180.0f, 360.0f) - 180.0f;
+		return current - difference * (1.0f - alpha);
+	}
+}
+
+void RenderSnapshot::Clear()
+{
+	camera = CameraSnapshot();
+
+	//keep the vectors so their capacity is reused next tick
+	for (auto it = meshInstances.begin(); it != meshInstances.end(); it++)
+	{
+		it->second.clear();
+	}
+
+	customMeshes.clear();
+	lights.clear();
+
+	simulationTick = 0;
+	simulationTime = 0.0;
+}
+
+VulkanCommonFunctions::InstanceInfo RenderSnapshot::InterpolateInstance(const InstanceSnapshot* previous, const InstanceSnapshot& current, float alpha)
+{
+	VulkanCommonFunctions::InstanceInfo result = current.info;
+
+	if (previous == nullptr || alpha >= 1.0f)
+	{
+		RenderObject::SetInstanceTransform(result, current.position, current.rotation, current.scale);
+		return result;
+	}
+
+	glm::vec3 position = glm::mix(previous->position, current.position, alpha);
+	glm::vec3 rotation = LerpRotation(previous->rotation, current.rotation, alpha);
+	glm::vec3 scale = glm::mix(previous->scale, current.scale, alpha);
+
+	RenderObject::SetInstanceTransform(result, position, rotation, scale);
+	return result;
+}
+
+void RenderSnapshot::InterpolateInstances(const std::vector<InstanceSnapshot>* previous, const std::vector<InstanceSnapshot>& current, float alpha, std::vector<VulkanCommonFunctions::InstanceInfo>& outInstances)
+{
+	outInstances.clear();
+	outInstances.reserve(current.size());
+
+	size_t previousIndex = 0;
+
+	for (size_t i = 0; i < current.size(); i++)
+	{
+		const InstanceSnapshot* match = nullptr;
+
+		if (previous != nullptr)
+		{
+			while (previousIndex < previous->size() && (*previous)[previousIndex].handle < current[i].handle)
+			{
+				previousIndex++;
+			}
+
+			if (previousIndex < previous->size() && (*previous)[previousIndex].handle == current[i].handle)
+			{
+				match = &(*previous)[previousIndex];
+			}
+		}
+
+		//objects that only exist in the newer snapshot are drawn where they are
+		outInstances.push_back(InterpolateInstance(match, current[i], alpha));
+	}
+}
+
+void RenderSnapshot::InterpolateLights(const std::vector<LightSnapshot>* previous, const std::vector<LightSnapshot>& current, float alpha, std::vector<VulkanCommonFunctions::LightInfo>& outLights)
+{
+	outLights.clear();
+	outLights.reserve(current.size());
+
+	size_t previousIndex = 0;
+
+	for (size_t i = 0; i < current.size(); i++)
+	{
+		VulkanCommonFunctions::LightInfo light = current[i].info;
+
+		if (previous != nullptr && alpha < 1.0f)
+		{
+			while (previousIndex < previous->size() && (*previous)[previousIndex].handle < current[i].handle)
+			{
+				previousIndex++;
+			}
+
+			if (previousIndex < previous->size() && (*previous)[previousIndex].handle == current[i].handle)
+			{
+				light.lightPosition = glm::mix((*previous)[previousIndex].info.lightPosition, current[i].info.lightPosition, alpha);
+			}
+		}
+
+		outLights.push_back(light);
+	}
+}
+
+RenderSnapshot::CameraSnapshot RenderSnapshot::InterpolateCamera(const CameraSnapshot& previous, const CameraSnapshot& current, float alpha)
+{
+	if (!previous.valid || alpha >= 1.0f)
+	{
+		return current;
+	}
+
+	CameraSnapshot result = current;
+	result.position = glm::mix(previous.position, current.position, alpha);
+	result.rotation = LerpRotation(previous.rotation, current.rotation, alpha);
+	result.fov = glm::mix(previous.fov, current.fov, alpha);
+
+	return result;
+}
+
+RenderSnapshot& RenderSnapshotBuffer::BeginWrite()
+{
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+
+	for (int i = 0; i < kSlotCount; i++)
+	{
+		if (i == m_latestSlot || i == m_previousSlot || i == m_readCurrentSlot || i == m_readPreviousSlot)
+		{
+			continue;
+		}
+
+		m_writeSlot = i;
+		break;
+	}
+
+	m_slots[m_writeSlot].Clear();
+	return m_slots[m_writeSlot];
+}
+
+void RenderSnapshotBuffer::Publish()
+{
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+
+	if (m_writeSlot == kNoSlot)
+	{
+		return;
+	}
+
+	m_previousSlot = m_latestSlot;
+	m_latestSlot = m_writeSlot;
+	m_writeSlot = kNoSlot;
+}
+
+bool RenderSnapshotBuffer::Acquire(const RenderSnapshot*& outPrevious, const RenderSnapshot*& outCurrent)
+{
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+
+	if (m_latestSlot == kNoSlot)
+	{
+		outPrevious = nullptr;
+		outCurrent = nullptr;
+		return false;
+	}
+
+	m_readCurrentSlot = m_latestSlot;
+	m_readPreviousSlot = (m_previousSlot == kNoSlot) ? m_latestSlot : m_previousSlot;
+
+	outCurrent = &m_slots[m_readCurrentSlot];
+	outPrevious = &m_slots[m_readPreviousSlot];
+	return true;
+}
+
+void RenderSnapshotBuffer::Release()
+{
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+
+	m_readCurrentSlot = kNoSlot;
+	m_readPreviousSlot = kNoSlot;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+#include "source/Vulkan Interface/GraphicsBuffer.h"
+
+#include <glm.hpp>
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//everything the renderer needs from the simulation for one tick, copied out so the two can run on different threads
+struct RenderSnapshot {
+	struct CameraSnapshot {
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 rotation = glm::vec3(0.0f);
+
+		float fov = 45.0f;
+		float nearPlane = 0.1f;
+		float farPlane = 10000.0f;
+
+		bool valid = false;
+	};
+
+	//world space transform is kept separately from the instance info so it can be interpolated
+	struct InstanceSnapshot {
+		VulkanCommonFunctions::ObjectHandle handle = VulkanCommonFunctions::INVALID_OBJECT_HANDLE;
+
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 rotation = glm::vec3(0.0f);
+		glm::vec3 scale = glm::vec3(1.0f);
+
+		//material part of the instance info, the matrices are rebuilt when drawing
+		VulkanCommonFunctions::InstanceInfo info{};
+	};
+
+	struct CustomMeshSnapshot {
+		InstanceSnapshot instance;
+
+		std::shared_ptr<GraphicsBuffer> vertexBuffer = nullptr;
+		std::shared_ptr<GraphicsBuffer> indexBuffer = nullptr;
+
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+		bool indexed = false;
+	};
+
+	struct LightSnapshot {
+		VulkanCommonFunctions::ObjectHandle handle = VulkanCommonFunctions::INVALID_OBJECT_HANDLE;
+		VulkanCommonFunctions::LightInfo info{};
+	};
+
+	void Clear();
+
+	//instances are sorted by handle within each mesh so two snapshots can be matched with a single pass
+	static void InterpolateInstances(const std::vector<InstanceSnapshot>* previous, const std::vector<InstanceSnapshot>& current, float alpha, std::vector<VulkanCommonFunctions::InstanceInfo>& outInstances);
+	static VulkanCommonFunctions::InstanceInfo InterpolateInstance(const InstanceSnapshot* previous, const InstanceSnapshot& current, float alpha);
+	static void InterpolateLights(const std::vector<LightSnapshot>* previous, const std::vector<LightSnapshot>& current, float alpha, std::vector<VulkanCommonFunctions::LightInfo>& outLights);
+	static CameraSnapshot InterpolateCamera(const CameraSnapshot& previous, const CameraSnapshot& current, float alpha);
+
+	CameraSnapshot camera;
+
+	std::map<std::string, std::vector<InstanceSnapshot>> meshInstances;
+	std::vector<CustomMeshSnapshot> customMeshes;
+	std::vector<LightSnapshot> lights;
+
+	uint64_t simulationTick = 0;
+	double simulationTime = 0.0;
+};
+
+//hands snapshots from the simulation to the renderer without either side waiting on the other
+//the renderer holds the two newest snapshots while drawing, the writer always has a free slot
+class RenderSnapshotBuffer {
+public:
+	RenderSnapshotBuffer() {};
+
+	//returns a cleared slot that the renderer isn't using, only one writer at a time
+	RenderSnapshot& BeginWrite();
+	void Publish();
+
+	//returns false if nothing has been published yet, previous equals current after the first publish
+	bool Acquire(const RenderSnapshot*& outPrevious, const RenderSnapshot*& outCurrent);
+	void Release();
+
+private:
+	static constexpr int kSlotCount = 5;
+	static constexpr int kNoSlot = -1;
+
+	std::array<RenderSnapshot, kSlotCount> m_slots;
+
+	std::mutex m_indexMutex;
+
+	int m_writeSlot = kNoSlot;
+	int m_latestSlot = kNoSlot;
+	int m_previousSlot = kNoSlot;
+
+	int m_readCurrentSlot = kNoSlot;
+	int m_readPreviousSlot = kNoSlot;
+};
\ No newline at end of file
@@ -2,11 +2,16 @@
 #include "source/Objects/RenderObject.h"
 #include "source/Components/Cube.h"
 
+#include <algorithm>
+#include <ctime>
+
 Scene::Scene(WindowManager* windowManager, std::shared_ptr<VulkanInterface> vulkanInterface)
 {
 	m_windowManager = windowManager;
     m_vulkanInterface = vulkanInterface;
 	m_fontManager = std::make_shared<FontManager>();
+
+    m_randomSeed = static_cast<uint32_t>(std::time(0));
 }
 
 void Scene::Update()
@@ -23,9 +28,52 @@ void Scene::Update()
 
     m_lastFrame = currentFrameTime;
 
+    //only kept for recorded runs so they can be compared afterwards
+    if (m_deltaTime > 0.0 && m_windowManager->GetInputRecorder().GetMode() != InputRecorder::Mode::Off)
+    {
+        m_frameTimeStatistics.AddFrame(m_deltaTime);
+    }
+
+    if (!IsSimulationThreaded())
+    {
+        m_simulationTick++;
+        m_simulationTime += m_deltaTime;
+        SimulateTick(m_deltaTime, m_simulationTick, m_simulationTime);
+    }
+
+    UpdateUI(m_deltaTime);
+}
+
+void Scene::SimulateTick(double deltaTime, uint64_t tick, double simulationTime)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_simulationMutex);
+
+        m_nextSnapshotTick = tick;
+
+        Simulate(deltaTime);
+
+        RenderSnapshot& snapshot = m_renderSnapshots.BeginWrite();
+        CaptureRenderSnapshot(snapshot);
+        snapshot.simulationTick = tick;
+        snapshot.simulationTime = simulationTime;
+
+        m_nextSnapshotTick = tick + 1;
+    }
+
+    m_renderSnapshots.Publish();
+}
+
+void Scene::Simulate(double deltaTime)
+{
+    //input is frozen for the rest of the tick so every update sees the same state
+    deltaTime = m_windowManager->BeginFrame(deltaTime);
+
+    m_updatingObjects = true;
+
     for (auto it = m_objects.begin(); it != m_objects.end(); it++)
     {
-		std::vector<std::shared_ptr<ObjectComponent>> components = it->second->GetAllComponents();
+		const RenderObject::ComponentList& components = it->second->GetAllComponents();
 
         for (size_t i = 0; i < components.size(); i++)
         {
@@ -40,15 +88,35 @@ void Scene::Update()
 				components[i]->SetStarted(true);
             }
 
-			components[i]->Update(m_deltaTime);
+			components[i]->Update(deltaTime);
         }
 
         UpdateMeshData(it->second);
     }
 
+    m_updatingObjects = false;
+
+    for (size_t i = 0; i < m_deferredRemovals.size(); i++)
+    {
+        RemoveObject(m_deferredRemovals[i]);
+    }
+    m_deferredRemovals.clear();
+
+    for (size_t i = 0; i < m_updateCallbacks.size(); i++)
+    {
+		m_updateCallbacks[i](deltaTime);
+    }
+}
+
+void Scene::UpdateUI(double deltaTime)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_uiObjectsMutex);
+
+    m_updatingUIObjects = true;
+
     for (auto it = m_uiObjects.begin(); it != m_uiObjects.end(); it++)
     {
-        std::vector<std::shared_ptr<ObjectComponent>> components = it->second->GetAllComponents();
+        const RenderObject::ComponentList& components = it->second->GetAllComponents();
 
         for (size_t i = 0; i < components.size(); i++)
         {
@@ -63,18 +131,226 @@ void Scene::Update()
                 components[i]->SetStarted(true);
             }
 
-            components[i]->Update(m_deltaTime);
+            components[i]->Update(deltaTime);
         }
 
         UpdateUIData(it->second);
     }
 
-    for (size_t i = 0; i < m_updateCallbacks.size(); i++)
+    m_updatingUIObjects = false;
+
+    for (size_t i = 0; i < m_deferredUIRemovals.size(); i++)
+    {
+        RemoveUIObject(m_deferredUIRemovals[i]);
+    }
+    m_deferredUIRemovals.clear();
+}
+
+void Scene::CaptureRenderSnapshot(RenderSnapshot& snapshot)
+{
+    std::vector<std::string> textureFilePaths = m_vulkanInterface->GetTextureFilePaths();
+
+    for (auto it = m_meshNameToObjectMap.begin(); it != m_meshNameToObjectMap.end(); it++)
+    {
+        bool isCustomMesh = it->first == MeshRenderer::kCustomMeshName;
+
+        for (auto handleIt = it->second.begin(); handleIt != it->second.end(); handleIt++)
+        {
+            std::shared_ptr<RenderObject> currentObject = GetRenderObject(*handleIt);
+            if (currentObject == nullptr)
+            {
+                continue;
+            }
+
+            std::shared_ptr<MeshRenderer> meshComponent = currentObject->GetComponent<MeshRenderer>();
+            std::shared_ptr<Transform> transform = currentObject->GetComponent<Transform>();
+
+            if (meshComponent == nullptr || transform == nullptr || !meshComponent->IsEnabled())
+            {
+                continue;
+            }
+
+            RenderSnapshot::InstanceSnapshot instance;
+            instance.handle = *handleIt;
+            instance.position = transform->GetWorldPosition();
+            instance.rotation = transform->GetWorldRotation();
+            instance.scale = transform->GetWorldScale();
+            instance.info = currentObject->GetInstanceInfo(textureFilePaths);
+
+            if (!isCustomMesh)
+            {
+                snapshot.meshInstances[it->first].push_back(instance);
+                continue;
+            }
+
+            RenderSnapshot::CustomMeshSnapshot customMesh;
+            customMesh.instance = instance;
+            customMesh.vertexBuffer = meshComponent->GetVertexBuffer();
+            customMesh.indexBuffer = meshComponent->GetIndexBuffer();
+            customMesh.vertexCount = static_cast<uint32_t>(meshComponent->GetVertexBufferSize());
+            customMesh.indexCount = static_cast<uint32_t>(meshComponent->GetIndexBufferSize());
+            customMesh.indexed = meshComponent->IsIndexed();
+
+            //buffers are created on the render thread, skip the mesh until they exist
+            if (customMesh.vertexBuffer == nullptr || (customMesh.indexed && customMesh.indexBuffer == nullptr))
+            {
+                continue;
+            }
+
+            snapshot.customMeshes.push_back(customMesh);
+        }
+    }
+
+    for (auto it = m_objects.begin(); it != m_objects.end(); it++)
+    {
+        std::shared_ptr<Camera> camera = it->second->GetComponent<Camera>();
+        if (camera == nullptr || !camera->IsMainCamera() || snapshot.camera.valid)
+        {
+            continue;
+        }
+
+        std::shared_ptr<Transform> transform = it->second->GetComponent<Transform>();
+
+        snapshot.camera.position = transform->GetPosition();
+        snapshot.camera.rotation = transform->GetRotation();
+        snapshot.camera.fov = camera->GetFOV();
+        snapshot.camera.nearPlane = camera->GetNearPlane();
+        snapshot.camera.farPlane = camera->GetFarPlane();
+        snapshot.camera.valid = true;
+    }
+
+    for (auto it = m_objects.begin(); it != m_objects.end(); it++)
+    {
+        std::shared_ptr<LightSource> light = it->second->GetComponent<LightSource>();
+        if (light == nullptr || !light->IsEnabled())
+        {
+            continue;
+        }
+
+        RenderSnapshot::LightSnapshot lightSnapshot;
+        lightSnapshot.handle = it->first;
+        lightSnapshot.info = light->GetLightInfo();
+        snapshot.lights.push_back(lightSnapshot);
+    }
+}
+
+void Scene::StartSimulation()
+{
+    if (!m_useSimulationThread || m_simulationThread != nullptr)
+    {
+        return;
+    }
+
+    m_renderThreadId = std::this_thread::get_id();
+
+    m_simulationThread = std::make_unique<SimulationThread>(this, m_fixedTimestep);
+    m_simulationThread->Start();
+}
+
+void Scene::StopSimulation()
+{
+    if (m_simulationThread == nullptr)
+    {
+        return;
+    }
+
+    m_simulationThread->Stop();
+    m_simulationThread = nullptr;
+
+    //anything the simulation queued before stopping still has to run
+    ProcessRenderThreadWork();
+}
+
+void Scene::RunOnRenderThread(std::function<void()> work)
+{
+    if (!IsSimulationThreaded() || std::this_thread::get_id() == m_renderThreadId)
+    {
+        work();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_renderThreadWorkMutex);
+    m_renderThreadWork.push_back(work);
+}
+
+void Scene::ProcessRenderThreadWork()
+{
+    std::vector<std::function<void()>> work;
+
     {
-		m_updateCallbacks[i](m_deltaTime);
+        std::lock_guard<std::mutex> lock(m_renderThreadWorkMutex);
+        work.swap(m_renderThreadWork);
+    }
+
+    if (work.empty())
+    {
+        return;
     }
 
-    m_windowManager->NewFrame();
+    //the queued work reads components, keep the simulation from changing them underneath it
+    std::lock_guard<std::mutex> simulationLock(m_simulationMutex);
+
+    for (size_t i = 0; i < work.size(); i++)
+    {
+        work[i]();
+    }
+}
+
+bool Scene::AcquireRenderSnapshots(const RenderSnapshot*& outPrevious, const RenderSnapshot*& outCurrent, float& outInterpolation)
+{
+    outInterpolation = 1.0f;
+
+    if (!m_renderSnapshots.Acquire(outPrevious, outCurrent))
+    {
+        return false;
+    }
+
+    if (IsSimulationThreaded())
+    {
+        outInterpolation = m_simulationThread->GetInterpolationAlpha(outPrevious->simulationTime, outCurrent->simulationTime);
+    }
+
+    //neither snapshot drawn this frame can reference buffers removed before the previous one was captured
+    RetireDestroyedBuffers(outPrevious->simulationTick);
+
+    return true;
+}
+
+void Scene::DeferBufferDestruction(std::shared_ptr<GraphicsBuffer> buffer)
+{
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    PendingBufferDestruction pendingDestruction;
+    pendingDestruction.buffer = buffer;
+    pendingDestruction.releaseTick = m_nextSnapshotTick;
+
+    std::lock_guard<std::mutex> lock(m_buffersToDestroyMutex);
+    m_buffersToDestroy.push_back(pendingDestruction);
+}
+
+void Scene::RetireDestroyedBuffers(uint64_t oldestDrawnTick)
+{
+    std::lock_guard<std::mutex> lock(m_buffersToDestroyMutex);
+
+    size_t keptCount = 0;
+
+    for (size_t i = 0; i < m_buffersToDestroy.size(); i++)
+    {
+        if (m_buffersToDestroy[i].releaseTick > oldestDrawnTick)
+        {
+            m_buffersToDestroy[keptCount] = m_buffersToDestroy[i];
+            keptCount++;
+            continue;
+        }
+
+        //the renderer still waits for the frames in flight before it actually frees anything
+        m_vulkanInterface->DeferDestruction(m_buffersToDestroy[i].buffer);
+    }
+
+    m_buffersToDestroy.resize(keptCount);
 }
 
 void Scene::UpdateUIData(std::shared_ptr<RenderObject> currentObject)
@@ -106,11 +382,24 @@ void Scene::UpdateUIData(std::shared_ptr<RenderObject> currentObject)
 
     if (imageComponent->IsTextureDataDirty())
     {
-        UpdateTexture(imageComponent->GetTexturePath());
+        UpdateUITexture(imageComponent);
         imageComponent->SetTextureDataDirty(false);
     }
 }
 
+void Scene::UpdateUITexture(std::shared_ptr<UIImage> imageComponent)
+{
+    UIAtlas::Region region;
+    bool inAtlas = m_uiAtlas.Find(imageComponent->GetTexturePath(), region);
+    if (inAtlas)
+    {
+        imageComponent->SetAtlasRegion(region.pagePath, region.uvRect);
+    }
+
+    //atlas pages only get their first level, images packed next to each other would bleed together in the smaller ones
+    UpdateTexture(imageComponent->GetSampledTexturePath(), !inAtlas);
+}
+
 void Scene::UpdateMeshData(std::shared_ptr<RenderObject> currentObject)
 {
     if (currentObject == nullptr)
@@ -132,7 +421,7 @@ void Scene::UpdateMeshData(std::shared_ptr<RenderObject> currentObject)
 
     if (meshComponent->IsMeshDataDirty())
     {
-        FinalizeMesh(currentObject);
+        RunOnRenderThread([this, currentObject]() { FinalizeMesh(currentObject); });
         meshComponent->SetDirtyData(false);
     }
 
@@ -143,6 +432,11 @@ void Scene::UpdateMeshData(std::shared_ptr<RenderObject> currentObject)
     }
 }
 
+std::shared_ptr<RenderObject> Scene::CreateObject()
+{
+    return MakePooled<RenderObject>();
+}
+
 VulkanCommonFunctions::ObjectHandle Scene::AddObject(std::shared_ptr <RenderObject> newObject)
 {
     if (m_objects.size() >= VulkanCommonFunctions::MAX_OBJECTS)
@@ -150,42 +444,51 @@ VulkanCommonFunctions::ObjectHandle Scene::AddObject(std::shared_ptr <RenderObje
 		return VulkanCommonFunctions::INVALID_OBJECT_HANDLE;
     }
 
-    m_currentObjectHandle++;
+    VulkanCommonFunctions::ObjectHandle newHandle = m_objectHandles.Allocate();
 
-    m_objects[m_currentObjectHandle] = newObject;
+    m_objects[newHandle] = newObject;
+    newObject->SetHandle(newHandle);
     newObject->SetSceneManager(this);
     newObject->SetWindowManager(m_windowManager);
 
+    if (newObject->GetTagId() != TagTable::kNoTag)
+    {
+        m_tagIndex[newObject->GetTagId()].insert(newHandle);
+    }
+
     std::shared_ptr<MeshRenderer> meshComponent = newObject->GetComponent<MeshRenderer>();
 
     if (meshComponent == nullptr)
     {
-        return m_currentObjectHandle;
+        return newHandle;
     }
 
-	m_vulkanInterface->UpdateObjectBuffers(meshComponent);
+    RunOnRenderThread([this, meshComponent]() { m_vulkanInterface->UpdateObjectBuffers(meshComponent); });
 
     std::string objectName = meshComponent->GetMeshName();
-    m_meshNameToObjectMap[objectName].insert(m_currentObjectHandle);
+    m_meshNameToObjectMap[objectName].insert(newHandle);
 
     if (meshComponent->GetTextured())
     {
         UpdateTexture(meshComponent->GetTexturePath());
     }
 
-    return m_currentObjectHandle;
+    return newHandle;
 }
 
 VulkanCommonFunctions::ObjectHandle Scene::AddUIObject(std::shared_ptr <RenderObject> newObject)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_uiObjectsMutex);
+
     if (m_uiObjects.size() >= VulkanCommonFunctions::MAX_OBJECTS)
     {
         return VulkanCommonFunctions::INVALID_OBJECT_HANDLE;
     }
 
-    m_currentUIObjectHandle++;
+    VulkanCommonFunctions::ObjectHandle newHandle = m_uiObjectHandles.Allocate();
 
-    m_uiObjects[m_currentUIObjectHandle] = newObject;
+    m_uiObjects[newHandle] = newObject;
+    newObject->SetHandle(newHandle);
     newObject->SetSceneManager(this);
     newObject->SetWindowManager(m_windowManager);
 
@@ -193,15 +496,15 @@ VulkanCommonFunctions::ObjectHandle Scene::AddUIObject(std::shared_ptr <RenderOb
 
     if (imageComponent == nullptr)
     {
-        return m_currentUIObjectHandle;
+        return newHandle;
     }
 
     if (imageComponent->GetTextured())
     {
-        UpdateTexture(imageComponent->GetTexturePath());
+        UpdateUITexture(imageComponent);
     }
 
-    return m_currentUIObjectHandle;
+    return newHandle;
 }
 
 bool Scene::RemoveObject(VulkanCommonFunctions::ObjectHandle objectToRemove)
@@ -213,16 +516,29 @@ bool Scene::RemoveObject(VulkanCommonFunctions::ObjectHandle objectToRemove)
         return false;
     }
 
+    //the object stays in the scene until the loop updating it has finished
+    if (m_updatingObjects)
+    {
+        if (std::find(m_deferredRemovals.begin(), m_deferredRemovals.end(), objectToRemove) != m_deferredRemovals.end())
+        {
+            return false;
+        }
+
+        m_deferredRemovals.push_back(objectToRemove);
+        return true;
+    }
+
     currentObject->SetSceneManager(nullptr);
 
     bool removalSuccessful = true;
 
     removalSuccessful = m_objects.erase(objectToRemove);
+    m_objectHandles.Free(objectToRemove);
+    currentObject->SetHandle(VulkanCommonFunctions::INVALID_OBJECT_HANDLE);
 
-    std::shared_ptr<GraphicsBuffer> instanceBuffer = currentObject->GetInstanceBuffer({});
-    if (instanceBuffer != nullptr)
+    if (currentObject->GetTagId() != TagTable::kNoTag)
     {
-		m_buffersToDestroy.push_back(instanceBuffer);
+        RemoveFromTagIndex(currentObject->GetTagId(), objectToRemove);
     }
 
     std::shared_ptr<MeshRenderer> meshComponent = currentObject->GetComponent<MeshRenderer>();
@@ -235,13 +551,13 @@ bool Scene::RemoveObject(VulkanCommonFunctions::ObjectHandle objectToRemove)
 	std::shared_ptr<GraphicsBuffer> vertexBuffer = meshComponent->GetVertexBuffer();
     if (vertexBuffer != nullptr)
     {
-		m_buffersToDestroy.push_back(vertexBuffer);
+		DeferBufferDestruction(vertexBuffer);
     }
 
 	std::shared_ptr<GraphicsBuffer> indexBuffer = meshComponent->GetIndexBuffer();
     if (indexBuffer != nullptr)
 	{
-        m_buffersToDestroy.push_back(indexBuffer);
+        DeferBufferDestruction(indexBuffer);
 	}
 
     std::string objectName = meshComponent->GetMeshName();
@@ -256,6 +572,8 @@ bool Scene::RemoveObject(VulkanCommonFunctions::ObjectHandle objectToRemove)
 
 bool Scene::RemoveUIObject(VulkanCommonFunctions::ObjectHandle objectToRemove)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_uiObjectsMutex);
+
     std::shared_ptr<RenderObject> currentObject = GetUIRenderObject(objectToRemove);
 
     if (currentObject == nullptr)
@@ -263,17 +581,25 @@ bool Scene::RemoveUIObject(VulkanCommonFunctions::ObjectHandle objectToRemove)
         return false;
     }
 
+    //the object stays in the scene until the loop updating it has finished
+    if (m_updatingUIObjects)
+    {
+        if (std::find(m_deferredUIRemovals.begin(), m_deferredUIRemovals.end(), objectToRemove) != m_deferredUIRemovals.end())
+        {
+            return false;
+        }
+
+        m_deferredUIRemovals.push_back(objectToRemove);
+        return true;
+    }
+
     currentObject->SetSceneManager(nullptr);
 
     bool removalSuccessful = true;
 
     removalSuccessful = m_uiObjects.erase(objectToRemove);
-
-    std::shared_ptr<GraphicsBuffer> instanceBuffer = currentObject->GetInstanceBuffer({});
-    if (instanceBuffer != nullptr)
-    {
-        m_buffersToDestroy.push_back(instanceBuffer);
-    }
+    m_uiObjectHandles.Free(objectToRemove);
+    currentObject->SetHandle(VulkanCommonFunctions::INVALID_OBJECT_HANDLE);
 
     std::shared_ptr<UIMeshRenderer> meshComponent = currentObject->GetComponent<UIMeshRenderer>();
 
@@ -285,13 +611,13 @@ bool Scene::RemoveUIObject(VulkanCommonFunctions::ObjectHandle objectToRemove)
     std::shared_ptr<GraphicsBuffer> vertexBuffer = meshComponent->GetVertexBuffer();
     if (vertexBuffer != nullptr)
     {
-        m_buffersToDestroy.push_back(vertexBuffer);
+        DeferBufferDestruction(vertexBuffer);
     }
 
     std::shared_ptr<GraphicsBuffer> indexBuffer = meshComponent->GetIndexBuffer();
     if (indexBuffer != nullptr)
     {
-        m_buffersToDestroy.push_back(indexBuffer);
+        DeferBufferDestruction(indexBuffer);
     }
 
     return removalSuccessful;
@@ -312,6 +638,8 @@ std::shared_ptr<RenderObject> Scene::GetRenderObject(VulkanCommonFunctions::Obje
 
 std::shared_ptr<RenderObject> Scene::GetUIRenderObject(VulkanCommonFunctions::ObjectHandle handle)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_uiObjectsMutex);
+
     if (handle == VulkanCommonFunctions::INVALID_OBJECT_HANDLE)
     {
         return nullptr;
@@ -339,13 +667,13 @@ void Scene::FinalizeUIMesh(std::shared_ptr<RenderObject> updatedObject)
     std::shared_ptr<GraphicsBuffer> oldVertexBuffer = meshComponent->GetVertexBuffer();
     if (oldVertexBuffer != nullptr)
     {
-        m_buffersToDestroy.push_back(oldVertexBuffer);
+        DeferBufferDestruction(oldVertexBuffer);
     }
 
     std::shared_ptr<GraphicsBuffer> oldIndexBuffer = meshComponent->GetIndexBuffer();
     if (oldIndexBuffer != nullptr)
     {
-        m_buffersToDestroy.push_back(oldIndexBuffer);
+        DeferBufferDestruction(oldIndexBuffer);
     }
 
     std::shared_ptr<GraphicsBuffer> vertexBuffer = m_vulkanInterface->CreateUIVertexBuffer(meshComponent);
@@ -353,11 +681,6 @@ void Scene::FinalizeUIMesh(std::shared_ptr<RenderObject> updatedObject)
 
     meshComponent->SetVertexBuffer(vertexBuffer);
     meshComponent->SetIndexBuffer(indexBuffer);
-
-    if (updatedObject->GetInstanceBuffer({}) == nullptr)
-    {
-        GenerateInstanceBuffer(updatedObject);
-    }
 }
 
 void Scene::FinalizeMesh(std::shared_ptr<RenderObject> updatedObject)
@@ -381,13 +704,13 @@ void Scene::FinalizeMesh(std::shared_ptr<RenderObject> updatedObject)
 	std::shared_ptr<GraphicsBuffer> oldVertexBuffer = meshComponent->GetVertexBuffer();
     if (oldVertexBuffer != nullptr)
 	{
-		m_buffersToDestroy.push_back(oldVertexBuffer);
+		DeferBufferDestruction(oldVertexBuffer);
 	}
 
 	std::shared_ptr<GraphicsBuffer> oldIndexBuffer = meshComponent->GetIndexBuffer();
 	if (oldIndexBuffer != nullptr)
 	{
-		m_buffersToDestroy.push_back(oldIndexBuffer);
+		DeferBufferDestruction(oldIndexBuffer);
 	}
 
     std::shared_ptr<GraphicsBuffer> vertexBuffer = m_vulkanInterface->CreateVertexBuffer(meshComponent);
@@ -395,67 +718,129 @@ void Scene::FinalizeMesh(std::shared_ptr<RenderObject> updatedObject)
 
 	meshComponent->SetVertexBuffer(vertexBuffer);
 	meshComponent->SetIndexBuffer(indexBuffer);
+}
 
-    if (updatedObject->GetInstanceBuffer({}) == nullptr)
+void Scene::UpdateTexture(std::string newTexturePath, bool mipmapped)
+{
+    if (m_vulkanInterface->HasTexture(newTexturePath))
     {
-		GenerateInstanceBuffer(updatedObject);
+        return;
     }
+
+    //several objects can queue the same texture before the first load runs
+    RunOnRenderThread([this, newTexturePath, mipmapped]() {
+        if (!m_vulkanInterface->HasTexture(newTexturePath))
+        {
+            m_vulkanInterface->UpdateTextureResources(newTexturePath, true, VK_FORMAT_R8G8B8A8_SRGB, SamplerCache::SamplerState(), mipmapped);
+        }
+    });
 }
 
-void Scene::GenerateInstanceBuffer(std::shared_ptr<RenderObject> newObject)
+VulkanCommonFunctions::ObjectHandle Scene::GetObjectByTag(std::string tag)
+{
+    return GetObjectByTag(TagTable::Get().Find(tag));
+}
+
+VulkanCommonFunctions::ObjectHandle Scene::GetObjectByTag(TagTable::TagId tag)
 {
-    if (newObject == nullptr)
+    const HandleSet& taggedObjects = GetObjectsByTag(tag);
+
+    if (taggedObjects.empty())
     {
-        return;
+        return VulkanCommonFunctions::INVALID_OBJECT_HANDLE;
     }
 
-	std::shared_ptr<GraphicsBuffer> instanceBuffer = m_vulkanInterface->CreateInstanceBuffer(1);
-    newObject->SetInstanceBuffer(instanceBuffer);
+    return *taggedObjects.begin();
 }
 
-void Scene::UpdateTexture(std::string newTexturePath)
+void Scene::RemoveFromTagIndex(TagTable::TagId tag, VulkanCommonFunctions::ObjectHandle handle)
 {
-    if (m_vulkanInterface->HasTexture(newTexturePath))
+    auto taggedObjects = m_tagIndex.find(tag);
+
+    if (taggedObjects == m_tagIndex.end())
     {
         return;
     }
 
-    m_vulkanInterface->UpdateTextureResources(newTexturePath);
+    taggedObjects->second.erase(handle);
+
+    //tags that come and go with spawned objects would otherwise leave an empty set behind each
+    if (taggedObjects->second.empty())
+    {
+        m_tagIndex.erase(taggedObjects);
+    }
 }
 
-VulkanCommonFunctions::ObjectHandle Scene::GetObjectByTag(std::string tag)
+const Scene::HandleSet& Scene::GetObjectsByTag(std::string tag)
 {
-    for (auto it = m_objects.begin(); it != m_objects.end(); it++)
+    return GetObjectsByTag(TagTable::Get().Find(tag));
+}
+
+const Scene::HandleSet& Scene::GetObjectsByTag(TagTable::TagId tag)
+{
+    if (tag == TagTable::kNoTag)
     {
-        std::shared_ptr<RenderObject> currentObject = it->second;
-        
-        if (currentObject->GetTag() == tag)
-        {
-            return it->first;
-        }
+        return kEmptyHandleSet;
+    }
+
+    auto taggedObjects = m_tagIndex.find(tag);
+
+    if (taggedObjects == m_tagIndex.end())
+    {
+        return kEmptyHandleSet;
+    }
+
+    return taggedObjects->second;
+}
+
+void Scene::UpdateObjectTag(RenderObject* object, TagTable::TagId previousTag, TagTable::TagId newTag)
+{
+    VulkanCommonFunctions::ObjectHandle handle = object->GetHandle();
+
+    //ui objects share the scene pointer but live in their own handle space
+    std::shared_ptr<RenderObject> sceneObject = GetRenderObject(handle);
+    if (sceneObject == nullptr || sceneObject.get() != object)
+    {
+        return;
+    }
+
+    if (previousTag != TagTable::kNoTag)
+    {
+        RemoveFromTagIndex(previousTag, handle);
+    }
+
+    if (newTag != TagTable::kNoTag)
+    {
+        m_tagIndex[newTag].insert(handle);
     }
-    return VulkanCommonFunctions::INVALID_OBJECT_HANDLE;
 }
 
 std::shared_ptr<Font> Scene::AddFont(std::string atlasFilePath, std::string descriptionFilePath)
 {
     std::shared_ptr<Font> newFont = m_fontManager->AddFont(atlasFilePath, descriptionFilePath);
-    m_vulkanInterface->UpdateTextureResources(atlasFilePath);
+
+    //distance values must not go through srgb conversion
+    VkFormat atlasFormat = newFont->IsDistanceField() ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R8G8B8A8_SRGB;
+
+    //glyphs sit next to each other in the atlas, repeating or sampling smaller levels would blend neighbouring glyphs into each other
+    SamplerCache::SamplerState atlasSamplerState;
+    atlasSamplerState.addressMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    atlasSamplerState.anisotropic = false;
+
+    RunOnRenderThread([this, atlasFilePath, atlasFormat, atlasSamplerState]() { m_vulkanInterface->UpdateTextureResources(atlasFilePath, true, atlasFormat, atlasSamplerState, false); });
 
     return newFont;
 }
 
 void Scene::Cleanup()
 {
-    for (auto it = m_objects.begin(); it != m_objects.end(); it++)
-    {
-        std::shared_ptr<GraphicsBuffer> instanceBuffer = it->second->GetInstanceBuffer({});
+    StopSimulation();
 
-        if (instanceBuffer != nullptr)
-        {
-            instanceBuffer->DestroyBuffer();
-        }
+    m_windowManager->GetInputRecorder().Stop();
+    m_frameTimeStatistics.Print(std::cout);
 
+    for (auto it = m_objects.begin(); it != m_objects.end(); it++)
+    {
         std::shared_ptr<MeshRenderer> meshComponent = it->second->GetComponent<MeshRenderer>();
         if (meshComponent != nullptr)
         {
@@ -475,13 +860,6 @@ void Scene::Cleanup()
 
     for (auto it = m_uiObjects.begin(); it != m_uiObjects.end(); it++)
     {
-        std::shared_ptr<GraphicsBuffer> instanceBuffer = it->second->GetInstanceBuffer({});
-
-        if (instanceBuffer != nullptr)
-        {
-            instanceBuffer->DestroyBuffer();
-        }
-
         std::shared_ptr<Text> textComponent = it->second->GetComponent<Text>();
         if (textComponent != nullptr)
         {
@@ -511,9 +889,11 @@ void Scene::Cleanup()
 
     for (size_t i = 0; i < m_buffersToDestroy.size(); i++)
     {
-        if (m_buffersToDestroy[i] != nullptr)
+        if (m_buffersToDestroy[i].buffer != nullptr)
         {
-            m_buffersToDestroy[i]->DestroyBuffer();
+            m_buffersToDestroy[i].buffer->DestroyBuffer();
         }
     }
+
+    m_buffersToDestroy.clear();
 }
\ No newline at end of file
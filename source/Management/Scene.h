@@ -4,75 +4,190 @@
 #include "source/Vulkan Interface/VulkanCommonFunctions.h"
 #include "source/Components/UIImage.h"
 #include "source/Text Rendering/FontManager.h"
+#include "source/Management/RenderSnapshot.h"
+#include "source/Management/SimulationThread.h"
+#include "source/Management/FrameTimeStatistics.h"
+#include "source/Management/HandlePool.h"
+#include "source/Management/UIAtlas.h"
+#include "source/Objects/PoolAllocator.h"
 
 #include <memory>
 #include <vector>
 #include <functional>
 #include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <set>
+#include <unordered_map>
 
 class RenderObject;
 
 class alignas(16) Scene {
 public:
+	static constexpr double kDefaultFixedTimestep = 1.0 / 60.0;
+
+	//node based containers draw from the object pool so adding and removing objects doesn't hit the heap
+	using ObjectMap = std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>, std::less<VulkanCommonFunctions::ObjectHandle>, PoolAllocator<std::pair<const VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>>>>;
+	using HandleSet = std::set<VulkanCommonFunctions::ObjectHandle, std::less<VulkanCommonFunctions::ObjectHandle>, PoolAllocator<VulkanCommonFunctions::ObjectHandle>>;
+
 	Scene(WindowManager* windowManager, std::shared_ptr<VulkanInterface> vulkanInterface);
 
+	//called by the renderer every frame, simulates too unless the simulation has its own thread
 	void Update();
 
+	//one simulation step followed by publishing a render snapshot
+	void SimulateTick(double deltaTime, uint64_t tick, double simulationTime);
+
+	//runs the simulation at a fixed timestep on its own thread, set before rendering starts
+	//ui objects are still updated and drawn on the render thread in this mode
+	void SetFixedTimestepSimulation(bool enabled, double fixedTimestep = kDefaultFixedTimestep) { m_useSimulationThread = enabled; m_fixedTimestep = fixedTimestep; }
+	bool IsSimulationThreaded() { return m_simulationThread != nullptr && m_simulationThread->IsRunning(); }
+	void StartSimulation();
+	void StopSimulation();
+
+	//vulkan resources can only be touched from the render thread, work from the simulation thread is queued
+	void RunOnRenderThread(std::function<void()> work);
+	void ProcessRenderThreadWork();
+
+	//the two newest snapshots and how far to interpolate between them, release once the frame is recorded
+	bool AcquireRenderSnapshots(const RenderSnapshot*& outPrevious, const RenderSnapshot*& outCurrent, float& outInterpolation);
+	void ReleaseRenderSnapshots() { m_renderSnapshots.Release(); }
+
 	void Cleanup();
 
+	//seeds anything random in the scene, defaults to the current time, set from the recording when replaying
+	void SetRandomSeed(uint32_t seed) { m_randomSeed = seed; }
+	uint32_t GetRandomSeed() { return m_randomSeed; }
+
+	std::shared_ptr<VulkanInterface> GetVulkanInterface() { return m_vulkanInterface; }
+
 	std::shared_ptr<Font> AddFont(std::string atlasFilePath, std::string descriptionFilePath);
 
+	//UI images added afterwards are drawn from the atlas pages they were packed into
+	bool LoadUIAtlas(std::string descriptionFilePath) { return m_uiAtlas.Load(descriptionFilePath); }
+
+	//allocates from the object pool, prefer it over make_shared for objects that are spawned often
+	static std::shared_ptr<RenderObject> CreateObject();
+
 	VulkanCommonFunctions::ObjectHandle AddObject(std::shared_ptr <RenderObject> newObject);
+	//called from an update, the object is removed once every object has been updated
 	bool RemoveObject(VulkanCommonFunctions::ObjectHandle objectToRemove);
 
 	VulkanCommonFunctions::ObjectHandle AddUIObject(std::shared_ptr <RenderObject> newObject);
 	bool RemoveUIObject(VulkanCommonFunctions::ObjectHandle objectToRemove);
 
 	void FinalizeMesh(std::shared_ptr<RenderObject> updatedObject);
-	void GenerateInstanceBuffer(std::shared_ptr<RenderObject> updatedObject);
 
 	void FinalizeUIMesh(std::shared_ptr<RenderObject> updatedObject);
 
-	void UpdateTexture(std::string newTexturePath);
+	void UpdateTexture(std::string newTexturePath, bool mipmapped = true);
 
 	std::shared_ptr<FontManager> GetFontManager() { return m_fontManager; }
 
-	std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> GetObjects() { return m_objects; };
-	std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> GetUIObjects() { return m_uiObjects; };
-	std::map<std::string, std::set<VulkanCommonFunctions::ObjectHandle>> GetMeshNameToObjectMap() { return m_meshNameToObjectMap; }
+	ObjectMap GetObjects() { return m_objects; };
+	ObjectMap GetUIObjects() { std::lock_guard<std::recursive_mutex> lock(m_uiObjectsMutex); return m_uiObjects; };
+	std::map<std::string, HandleSet> GetMeshNameToObjectMap() { return m_meshNameToObjectMap; }
 
+	//constant time through the tag index, returns the lowest handle when several objects share the tag
+	//handles reuse freed slots, so that isn't necessarily the object that was added first
 	VulkanCommonFunctions::ObjectHandle GetObjectByTag(std::string tag);
+	VulkanCommonFunctions::ObjectHandle GetObjectByTag(TagTable::TagId tag);
+	//the returned set is owned by the scene, it is only valid until an object is added, removed or retagged
+	const HandleSet& GetObjectsByTag(std::string tag);
+	const HandleSet& GetObjectsByTag(TagTable::TagId tag);
+
+	//called by RenderObject::SetTag, ignored for ui objects
+	void UpdateObjectTag(RenderObject* object, TagTable::TagId previousTag, TagTable::TagId newTag);
 	std::shared_ptr<RenderObject> GetRenderObject(VulkanCommonFunctions::ObjectHandle handle);
 	std::shared_ptr<RenderObject> GetUIRenderObject(VulkanCommonFunctions::ObjectHandle handle);
 
 	size_t GetObjectCount() { return m_objects.size(); };
+	size_t GetObjectHandleSlotCount() { return m_objectHandles.GetSlotCount(); }
+	size_t GetPendingDestructionCount() { std::lock_guard<std::mutex> lock(m_buffersToDestroyMutex); return m_buffersToDestroy.size(); }
 
 	void RegisterUpdateCallback(std::function<void(float)> callback) {
 		m_updateCallbacks.push_back(callback);
 	}
 
 private:
+	void Simulate(double deltaTime);
+	void UpdateUI(double deltaTime);
+	void CaptureRenderSnapshot(RenderSnapshot& snapshot);
+
 	void UpdateMeshData(std::shared_ptr<RenderObject> currentObject);
 	void UpdateUIData(std::shared_ptr<RenderObject> currentObject);
+	void UpdateUITexture(std::shared_ptr<UIImage> imageComponent);
+
+	//the buffer is handed to the renderer once no snapshot it can still draw references it
+	void DeferBufferDestruction(std::shared_ptr<GraphicsBuffer> buffer);
+	void RetireDestroyedBuffers(uint64_t oldestDrawnTick);
 
-	std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> m_objects = {};
-	std::map<std::string, std::set<VulkanCommonFunctions::ObjectHandle>> m_meshNameToObjectMap;
+	//drops the tag's set once it is empty
+	void RemoveFromTagIndex(TagTable::TagId tag, VulkanCommonFunctions::ObjectHandle handle);
 
-	std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> m_uiObjects = {};
+	ObjectMap m_objects = {};
+	std::map<std::string, HandleSet> m_meshNameToObjectMap;
+
+	std::unordered_map<TagTable::TagId, HandleSet> m_tagIndex;
+	inline static const HandleSet kEmptyHandleSet = {};
+
+	ObjectMap m_uiObjects = {};
+	UIAtlas m_uiAtlas;
 
 	WindowManager* m_windowManager;
 	std::shared_ptr<VulkanInterface> m_vulkanInterface;
 	std::shared_ptr<FontManager> m_fontManager;
 
-	VulkanCommonFunctions::ObjectHandle m_currentObjectHandle = 0;
-	VulkanCommonFunctions::ObjectHandle m_currentUIObjectHandle = 0;
+	HandlePool m_objectHandles;
+	HandlePool m_uiObjectHandles;
+
+	//removals asked for by an update wait until every object has been updated, so the object and component list being walked stay alive
+	bool m_updatingObjects = false;
+	bool m_updatingUIObjects = false;
+	std::vector<VulkanCommonFunctions::ObjectHandle> m_deferredRemovals;
+	std::vector<VulkanCommonFunctions::ObjectHandle> m_deferredUIRemovals;
 
 	std::vector<std::function<void(float)>> m_updateCallbacks;
 
-	std::vector<std::shared_ptr<GraphicsBuffer>> m_buffersToDestroy;
+	struct PendingBufferDestruction {
+		std::shared_ptr<GraphicsBuffer> buffer = nullptr;
+
+		//first snapshot that was captured without the buffer
+		uint64_t releaseTick = 0;
+	};
+
+	std::vector<PendingBufferDestruction> m_buffersToDestroy;
+	std::mutex m_buffersToDestroyMutex;
+
+	//tick whose snapshot will be captured next, buffers removed now are gone from that snapshot on
+	std::atomic<uint64_t> m_nextSnapshotTick = 1;
 
 	double m_deltaTime = 0.0f;	// Time between current frame and last frame
 	double m_lastFrame = -1.0f; // Time of last frame
 
+	//lockstep mode counts ticks the same way the simulation thread does
+	uint64_t m_simulationTick = 0;
+	double m_simulationTime = 0.0;
+
+	bool m_useSimulationThread = false;
+	double m_fixedTimestep = kDefaultFixedTimestep;
+	std::unique_ptr<SimulationThread> m_simulationThread = nullptr;
+	std::thread::id m_renderThreadId;
+
+	//held by the simulation for a whole tick, and by the render thread while it runs queued work
+	std::mutex m_simulationMutex;
+
+	std::mutex m_renderThreadWorkMutex;
+	std::vector<std::function<void()>> m_renderThreadWork;
+
+	//ui objects are added from the simulation but updated and drawn on the render thread
+	std::recursive_mutex m_uiObjectsMutex;
+
+	RenderSnapshotBuffer m_renderSnapshots;
+
+	uint32_t m_randomSeed = 0;
+	FrameTimeStatistics m_frameTimeStatistics;
+
 	bool temp = false;
 };
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include "ShaderCompiler.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+ShaderCompiler::ShaderCompiler(ShaderCompilerCreateInfo createInfo)
+{
+	m_shaderDirectory = createInfo.shaderDirectory;
+	m_configuration = createInfo.configuration;
+
+	m_compilerPath = FindTool("dxc");
+	m_optimizerPath = FindTool("spirv-opt");
+
+	LoadManifest();
+}
+
+void ShaderCompiler::LoadManifest()
+{
+	std::string manifestFilePath = m_shaderDirectory + "/" + kManifestFileName;
+	std::ifstream manifest(manifestFilePath);
+
+	if (!manifest.is_open())
+	{
+		throw std::runtime_error("failed to open " + manifestFilePath + "!");
+	}
+
+	std::string line;
+	uint32_t lineNumber = 0;
+	while (std::getline(manifest, line))
+	{
+		lineNumber++;
+
+		size_t commentStart = line.find('#');
+		if (commentStart != std::string::npos)
+		{
+			line.erase(commentStart);
+		}
+
+		std::istringstream lineStream(line);
+
+		Shader shader;
+		if (!(lineStream >> shader.sourceFileName))
+		{
+			continue;
+		}
+
+		if (!(lineStream >> shader.profile >> shader.entryPoint >> shader.outputFileName))
+		{
+			throw std::runtime_error(manifestFilePath + " line " + std::to_string(lineNumber) + " needs a source, profile, entry point and output!");
+		}
+
+		//checked here so a typo fails the whole build before anything is compiled
+		GetSpirvEntryPoint(shader.profile);
+
+		m_shaders.push_back(shader);
+	}
+}
+
+bool ShaderCompiler::Compile(const Shader& shader)
+{
+	std::string sourceFilePath = m_shaderDirectory + "/" + shader.sourceFileName;
+	std::string outputFilePath = m_shaderDirectory + "/" + shader.outputFileName;
+	std::string temporaryFilePath = outputFilePath + ".build";
+	std::string unoptimizedFilePath = outputFilePath + ".unoptimized";
+
+	bool release = (m_configuration == Configuration::Release);
+
+	//bindings a stage doesn't use are kept, layouts reflected from the shaders then have every resource the CPU side writes
+	std::vector<std::string> compileArguments = { "-spirv", "-T", shader.profile, "-E", shader.entryPoint,
+		"-fspv-entrypoint-name=" + GetSpirvEntryPoint(shader.profile), "-fspv-preserve-bindings" };
+
+	if (release)
+	{
+		compileArguments.push_back("-O3");
+	}
+	else {
+		compileArguments.push_back("-Od");
+		compileArguments.push_back("-Zi");
+	}
+
+	compileArguments.push_back(sourceFilePath);
+	compileArguments.push_back("-Fo");
+	compileArguments.push_back(release ? unoptimizedFilePath : temporaryFilePath);
+
+	bool success = Run(m_compilerPath, compileArguments) && std::filesystem::exists(release ? unoptimizedFilePath : temporaryFilePath);
+
+	//dxc's own optimizer doesn't reach what spirv-opt's full pass list does, and only this removes the names and line info
+	if (success && release)
+	{
+		success = Run(m_optimizerPath, { "-O", "--strip-debug", "--preserve-bindings", unoptimizedFilePath, "-o", temporaryFilePath }) && std::filesystem::exists(temporaryFilePath);
+	}
+
+	std::error_code error;
+	std::filesystem::remove(unoptimizedFilePath, error);
+
+	if (!success)
+	{
+		std::filesystem::remove(temporaryFilePath, error);
+		std::cout << "Warning: couldn't compile " << shader.outputFileName << " from " << shader.sourceFileName << ", keeping the last one" << std::endl;
+		return false;
+	}
+
+	std::filesystem::rename(temporaryFilePath, outputFilePath, error);
+
+	if (error)
+	{
+		std::cout << "Warning: couldn't replace " << outputFilePath << ", " << error.message() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool ShaderCompiler::BuildAll(const std::string& shaderDirectory, Configuration configuration, bool printStats)
+{
+	ShaderCompilerCreateInfo createInfo{};
+	createInfo.shaderDirectory = shaderDirectory;
+	createInfo.configuration = configuration;
+
+	std::shared_ptr<ShaderCompiler> compiler = nullptr;
+
+	try
+	{
+		compiler = std::make_shared<ShaderCompiler>(createInfo);
+	}
+	catch (const std::exception& exception)
+	{
+		std::cout << "Couldn't build shaders, " << exception.what() << std::endl;
+		return false;
+	}
+
+	if (printStats)
+	{
+		const char* configurationName = (configuration == Configuration::Release) ? "release" : "debug";
+		std::cout << "Building " << compiler->GetShaders().size() << " shaders in " << shaderDirectory << " for " << configurationName << std::endl;
+	}
+
+	size_t failedCount = 0;
+
+	for (const Shader& shader : compiler->GetShaders())
+	{
+		auto compileStart = std::chrono::steady_clock::now();
+
+		if (!compiler->Compile(shader))
+		{
+			failedCount++;
+			continue;
+		}
+
+		if (!printStats)
+		{
+			continue;
+		}
+
+		std::error_code error;
+		uintmax_t outputSize = std::filesystem::file_size(shaderDirectory + "/" + shader.outputFileName, error);
+
+		std::cout << shader.outputFileName << ": " << (error ? 0 : outputSize) << " bytes in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count() << " ms" << std::endl;
+	}
+
+	if (failedCount > 0)
+	{
+		std::cout << failedCount << " of " << compiler->GetShaders().size() << " shaders failed to build" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool ShaderCompiler::Run(const std::string& toolPath, const std::vector<std::string>& arguments)
+{
+	std::string command = "\"" + toolPath + "\"";
+
+	for (size_t i = 0; i < arguments.size(); i++)
+	{
+		command += " \"" + arguments[i] + "\"";
+	}
+
+#ifdef _WIN32
+	//cmd strips the outer quotes of the whole line, without these it would take the tool's own
+	command = "\"" + command + "\"";
+#endif
+
+	return std::system(command.c_str()) == 0;
+}
+
+std::string ShaderCompiler::FindTool(const std::string& toolName)
+{
+#ifdef _WIN32
+	std::string fileName = toolName + ".exe";
+#else
+	std::string fileName = toolName;
+#endif
+
+	const char* sdkPath = std::getenv("VULKAN_SDK");
+
+	if (sdkPath != nullptr)
+	{
+		//the Windows SDK calls the directory Bin, the Linux and macOS ones bin
+		for (const char* binDirectory : { "Bin", "bin" })
+		{
+			std::filesystem::path toolPath = std::filesystem::path(sdkPath) / binDirectory / fileName;
+
+			if (std::filesystem::exists(toolPath))
+			{
+				return toolPath.string();
+			}
+		}
+	}
+
+	return toolName;
+}
+
+std::string ShaderCompiler::GetSpirvEntryPoint(const std::string& profile)
+{
+	if (profile.rfind("vs", 0) == 0)
+	{
+		return "VSMain";
+	}
+
+	if (profile.rfind("ps", 0) == 0)
+	{
+		return "PSMain";
+	}
+
+	if (profile.rfind("cs", 0) == 0)
+	{
+		return "CSMain";
+	}
+
+	throw std::runtime_error("shader profile " + profile + " isn't one the pipelines load!");
+}
\ No newline at end of file
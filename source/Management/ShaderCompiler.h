@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//compiles the HLSL sources listed in the shader directory's manifest to the spv files pipelines load
+//dxc and spirv-opt come from the Vulkan SDK when VULKAN_SDK is set and from the path otherwise, so the same build runs on any platform
+class ShaderCompiler {
+public:
+	enum class Configuration {
+		//unoptimized with debug info, for stepping through shaders and fast recompiles
+		Debug,
+
+		//optimized again by spirv-opt with the debug info stripped, bindings and decorations are kept for reflection
+		Release
+	};
+
+	struct ShaderCompilerCreateInfo {
+		//the directory the manifest, the sources and the compiled spv files are all in
+		std::string shaderDirectory;
+		Configuration configuration = Configuration::Release;
+	};
+
+	//one line of the manifest, the source and output are file names in the shader directory
+	struct Shader {
+		std::string sourceFileName;
+		std::string profile;
+		std::string entryPoint;
+		std::string outputFileName;
+	};
+
+	//throws when the manifest can't be read
+	ShaderCompiler(ShaderCompilerCreateInfo createInfo);
+
+	const std::vector<Shader>& GetShaders() const { return m_shaders; }
+
+	//compiles to a temporary file and renames it over the output, so a pipeline never reads a half written one
+	//the tools print their own errors, a failed compile leaves the last good output in place
+	bool Compile(const Shader& shader);
+
+	//compiles every shader in the manifest and returns false if any of them failed
+	//only failures are printed unless printStats asks for every shader's size and compile time
+	static bool BuildAll(const std::string& shaderDirectory, Configuration configuration, bool printStats = false);
+
+	static constexpr const char* kManifestFileName = "shader_manifest.txt";
+
+private:
+	void LoadManifest();
+
+	//every argument is quoted, so paths with spaces survive the shell
+	static bool Run(const std::string& toolPath, const std::vector<std::string>& arguments);
+
+	//the SDK's copy when there is one, otherwise the name is left for the shell to find on the path
+	static std::string FindTool(const std::string& toolName);
+
+	//pipelines look for these names whatever the entry point is called in the source
+	static std::string GetSpirvEntryPoint(const std::string& profile);
+
+	std::string m_shaderDirectory;
+	Configuration m_configuration = Configuration::Release;
+
+	std::string m_compilerPath;
+	std::string m_optimizerPath;
+
+	std::vector<Shader> m_shaders;
+};
\ No newline at end of file
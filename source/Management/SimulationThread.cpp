@@ -0,0 +1,86 @@
+#include "SimulationThread.h"
+#include "source/Management/Scene.h"
+
+#include <algorithm>
+#include <iostream>
+
+SimulationThread::SimulationThread(Scene* scene, double fixedTimestep)
+{
+	m_scene = scene;
+	m_fixedTimestep = fixedTimestep;
+}
+
+SimulationThread::~SimulationThread()
+{
+	Stop();
+}
+
+void SimulationThread::Start()
+{
+	if (m_running)
+	{
+		return;
+	}
+
+	m_startTime = std::chrono::steady_clock::now();
+	m_running = true;
+	m_thread = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop()
+{
+	m_running = false;
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+double SimulationThread::GetElapsedTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+float SimulationThread::GetInterpolationAlpha(double previousSnapshotTime, double currentSnapshotTime)
+{
+	double snapshotSpan = currentSnapshotTime - previousSnapshotTime;
+
+	if (snapshotSpan <= 0.0)
+	{
+		return 1.0f;
+	}
+
+	double renderTime = GetElapsedTime() - m_fixedTimestep;
+
+	return static_cast<float>(std::clamp((renderTime - previousSnapshotTime) / snapshotSpan, 0.0, 1.0));
+}
+
+void SimulationThread::Run()
+{
+	double simulationTime = 0.0;
+	uint64_t tick = 0;
+
+	while (m_running)
+	{
+		double elapsed = GetElapsedTime();
+
+		if (elapsed - simulationTime > m_fixedTimestep * kMaxTicksPerUpdate)
+		{
+			std::cerr << "Simulation is running behind, skipping " << (elapsed - simulationTime) << " seconds" << std::endl;
+			simulationTime = elapsed - m_fixedTimestep;
+		}
+
+		if (simulationTime + m_fixedTimestep > elapsed)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(simulationTime + m_fixedTimestep - elapsed));
+			continue;
+		}
+
+		tick++;
+		simulationTime += m_fixedTimestep;
+
+		//the same delta every tick keeps the simulation deterministic
+		m_scene->SimulateTick(m_fixedTimestep, tick, simulationTime);
+	}
+}
\ No newline at end of file
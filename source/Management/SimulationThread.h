@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+class Scene;
+
+//runs Scene::Simulate at a fixed timestep on its own thread and publishes a render snapshot after every tick
+class SimulationThread {
+public:
+	SimulationThread(Scene* scene, double fixedTimestep);
+	~SimulationThread();
+
+	void Start();
+	void Stop();
+
+	bool IsRunning() { return m_running; }
+
+	double GetFixedTimestep() { return m_fixedTimestep; }
+
+	//seconds since Start on the clock the ticks are scheduled against
+	double GetElapsedTime();
+
+	//how far between the two newest snapshots the renderer should be, rendering runs one tick behind
+	float GetInterpolationAlpha(double previousSnapshotTime, double currentSnapshotTime);
+
+private:
+	void Run();
+
+	Scene* m_scene = nullptr;
+
+	double m_fixedTimestep = 1.0 / 60.0;
+
+	//if the simulation falls further behind than this it drops time instead of trying to catch up
+	static constexpr int kMaxTicksPerUpdate = 5;
+
+	std::thread m_thread;
+	std::atomic<bool> m_running = false;
+
+	std::chrono::steady_clock::time_point m_startTime;
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "TextureConverter.h"
+#include "source/Management/BlockCompression.h"
+#include "source/Management/MipChainBuilder.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+Ktx2File::Texture TextureConverter::Convert(const uint8_t* pixels, uint32_t width, uint32_t height, Format format, bool srgb)
+{
+	std::vector<MipChainBuilder::MipLevel> levels;
+	std::vector<uint8_t> chain = MipChainBuilder::Build(pixels, width, height, srgb, MipChainBuilder::Filter::Kaiser, levels);
+
+	Ktx2File::Texture texture;
+	texture.width = width;
+	texture.height = height;
+
+	if (format == Format::Bc1)
+	{
+		texture.format = srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+	}
+	else {
+		texture.format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+	}
+
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		texture.levelOffsets.push_back(texture.data.size());
+
+		if (format == Format::Bc1)
+		{
+			std::vector<uint8_t> blocks = BlockCompression::EncodeBc1(&chain[levels[i].offset], levels[i].width, levels[i].height);
+			texture.data.insert(texture.data.end(), blocks.begin(), blocks.end());
+		}
+		else {
+			texture.data.insert(texture.data.end(), chain.begin() + levels[i].offset, chain.begin() + levels[i].offset + levels[i].size);
+		}
+
+		texture.levelSizes.push_back(texture.data.size() - texture.levelOffsets.back());
+	}
+
+	return texture;
+}
+
+bool TextureConverter::ConvertFile(const std::string& imageFilePath, Format format)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	int width, height, channels;
+	stbi_uc* pixels = stbi_load(imageFilePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+	if (!pixels)
+	{
+		std::cout << "Failed to load " << imageFilePath << std::endl;
+		return false;
+	}
+
+	//images are loaded as sRGB color by default, so the converted files are too
+	Ktx2File::Texture texture = Convert(pixels, width, height, format, true);
+	stbi_image_free(pixels);
+
+	std::string outputPath = std::filesystem::path(imageFilePath).replace_extension().string() + GetVariantExtension(format);
+
+	try
+	{
+		Ktx2File::Write(outputPath, texture);
+	}
+	catch (const std::exception& exception)
+	{
+		std::cout << exception.what() << std::endl;
+		return false;
+	}
+
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Wrote " << outputPath << ": " << width << "x" << height << ", " << texture.levelOffsets.size() << " levels, "
+		<< texture.data.size() << " bytes, " << milliseconds << " ms" << std::endl;
+
+	return true;
+}
+
+Ktx2File::Texture TextureConverter::DecodeBc1(const Ktx2File::Texture& texture)
+{
+	bool punchThroughAlpha = texture.format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || texture.format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+
+	Ktx2File::Texture decoded;
+	decoded.format = Ktx2File::IsSrgb(texture.format) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+	decoded.width = texture.width;
+	decoded.height = texture.height;
+
+	for (size_t i = 0; i < texture.levelOffsets.size(); i++)
+	{
+		uint32_t levelWidth = std::max(texture.width >> i, 1u);
+		uint32_t levelHeight = std::max(texture.height >> i, 1u);
+
+		std::vector<uint8_t> pixels = BlockCompression::DecodeBc1(&texture.data[texture.levelOffsets[i]], levelWidth, levelHeight, punchThroughAlpha);
+
+		decoded.levelOffsets.push_back(decoded.data.size());
+		decoded.levelSizes.push_back(pixels.size());
+		decoded.data.insert(decoded.data.end(), pixels.begin(), pixels.end());
+	}
+
+	return decoded;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "source/Management/Ktx2File.h"
+
+#include <cstdint>
+#include <string>
+
+//turns images into KTX2 textures with full mip chains ahead of time, so loading them is a file read instead of a decode
+//BC7 and ASTC files come from external encoders, this writes the BC1 and RGBA8 files the engine can produce itself
+class TextureConverter {
+public:
+	enum class Format {
+		Rgba8,
+		Bc1
+	};
+
+	//extension the loader looks for next to a texture's image for files in the format
+	static std::string GetVariantExtension(Format format) { return (format == Format::Bc1) ? ".bc1.ktx2" : ".rgba8.ktx2"; }
+
+	//pixels are RGBA8, srgb picks the sRGB variant of the format and filters the mips in linear space
+	static Ktx2File::Texture Convert(const uint8_t* pixels, uint32_t width, uint32_t height, Format format, bool srgb);
+
+	//writes the converted image next to it, prints what it wrote and returns false when the image couldn't be read or written
+	static bool ConvertFile(const std::string& imageFilePath, Format format);
+
+	//the fallback for devices that can't sample BC1, every level is decoded to RGBA8
+	static Ktx2File::Texture DecodeBc1(const Ktx2File::Texture& texture);
+};
\ No newline at end of file
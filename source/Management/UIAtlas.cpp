@@ -0,0 +1,240 @@
+#include "UIAtlas.h"
+#include "source/Management/AtlasPacker.h"
+#include "source/Management/Ktx2File.h"
+#include "source/Management/TextureConverter.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+bool UIAtlas::Build(const std::string& directory)
+{
+	struct Image {
+		std::string path;
+		int width = 0;
+		int height = 0;
+		stbi_uc* pixels = nullptr;
+		AtlasPacker::Placement placement;
+	};
+
+	std::vector<Image> images;
+
+	for (const auto& entry : std::filesystem::directory_iterator(directory))
+	{
+		if (entry.path().extension() != ".png")
+		{
+			continue;
+		}
+
+		Image image;
+		image.path = entry.path().string();
+
+		int channels;
+		if (!stbi_info(image.path.c_str(), &image.width, &image.height, &channels))
+		{
+			std::cout << "Failed to load " << image.path << std::endl;
+			continue;
+		}
+
+		if (image.width > static_cast<int>(kMaxImageSize) || image.height > static_cast<int>(kMaxImageSize))
+		{
+			continue;
+		}
+
+		image.pixels = stbi_load(image.path.c_str(), &image.width, &image.height, &channels, STBI_rgb_alpha);
+		if (image.pixels == nullptr)
+		{
+			std::cout << "Failed to load " << image.path << std::endl;
+			continue;
+		}
+
+		images.push_back(image);
+	}
+
+	if (images.empty())
+	{
+		std::cout << "No images up to " << kMaxImageSize << "x" << kMaxImageSize << " in " << directory << std::endl;
+		return false;
+	}
+
+	//the skyline packs tightest when the tallest rectangles go first
+	std::sort(images.begin(), images.end(), [](const Image& a, const Image& b) {
+		return (a.height != b.height) ? a.height > b.height : a.width > b.width;
+	});
+
+	AtlasPacker packer(kPageSize, kPageSize, kPadding);
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		packer.Add(images[i].width, images[i].height, images[i].placement);
+	}
+
+	std::vector<std::vector<uint8_t>> pages(packer.GetPageCount(), std::vector<uint8_t>(static_cast<size_t>(kPageSize) * kPageSize * 4, 0));
+
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		const Image& image = images[i];
+		const AtlasPacker::Placement& placement = image.placement;
+		std::vector<uint8_t>& page = pages[placement.page];
+
+		//the padding repeats the image's edge, so linear filtering at the border doesn't blend in transparent black
+		int padding = static_cast<int>(kPadding);
+		for (int y = -padding; y < image.height + padding; y++)
+		{
+			int sourceY = std::clamp(y, 0, image.height - 1);
+
+			for (int x = -padding; x < image.width + padding; x++)
+			{
+				int sourceX = std::clamp(x, 0, image.width - 1);
+
+				size_t source = (static_cast<size_t>(sourceY) * image.width + sourceX) * 4;
+				size_t destination = (static_cast<size_t>(placement.y + y) * kPageSize + placement.x + x) * 4;
+				std::copy(image.pixels + source, image.pixels + source + 4, page.begin() + destination);
+			}
+		}
+
+		stbi_image_free(image.pixels);
+	}
+
+	std::filesystem::path descriptionPath = std::filesystem::path(directory) / kDescriptionFileName;
+	std::ofstream description(descriptionPath);
+	if (!description.good())
+	{
+		std::cout << "Failed to write " << descriptionPath.string() << std::endl;
+		return false;
+	}
+
+	description << "common pages=" << pages.size() << " scaleW=" << kPageSize << " scaleH=" << kPageSize << std::endl;
+
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		//the png is never written, its path is what textures are registered under
+		std::filesystem::path pagePath = std::filesystem::path(directory) / ("ui_atlas_" + std::to_string(i) + ".png");
+
+		Ktx2File::Texture texture;
+		texture.format = VK_FORMAT_R8G8B8A8_SRGB;
+		texture.width = kPageSize;
+		texture.height = kPageSize;
+		texture.data = std::move(pages[i]);
+		texture.levelOffsets.push_back(0);
+		texture.levelSizes.push_back(texture.data.size());
+
+		std::string ktx2Path = std::filesystem::path(pagePath).replace_extension().string() + TextureConverter::GetVariantExtension(TextureConverter::Format::Rgba8);
+
+		try
+		{
+			Ktx2File::Write(ktx2Path, texture);
+		}
+		catch (const std::exception& exception)
+		{
+			std::cout << exception.what() << std::endl;
+			return false;
+		}
+
+		description << "page id=" << i << " file=\"" << pagePath.string() << "\"" << std::endl;
+	}
+
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		const AtlasPacker::Placement& placement = images[i].placement;
+		description << "image file=\"" << images[i].path << "\" page=" << placement.page << " x=" << placement.x << " y=" << placement.y
+			<< " width=" << placement.width << " height=" << placement.height << std::endl;
+	}
+
+	std::cout << "Wrote " << descriptionPath.string() << std::endl;
+	packer.PrintReport(std::cout);
+
+	return true;
+}
+
+bool UIAtlas::Load(const std::string& descriptionFilePath)
+{
+	std::ifstream description(descriptionFilePath);
+	if (!description.good())
+	{
+		std::cerr << "Error: UI atlas description file not found: " << descriptionFilePath << std::endl;
+		return false;
+	}
+
+	std::vector<std::string> pagePaths;
+	float pageWidth = static_cast<float>(kPageSize);
+	float pageHeight = static_cast<float>(kPageSize);
+
+	std::string line;
+	while (std::getline(description, line))
+	{
+		if (line.rfind("common ", 0) == 0)
+		{
+			pageWidth = static_cast<float>(ReadValue(line, "scaleW"));
+			pageHeight = static_cast<float>(ReadValue(line, "scaleH"));
+		}
+		else if (line.rfind("page ", 0) == 0)
+		{
+			uint32_t pageId = ReadValue(line, "id");
+			pagePaths.resize(std::max<size_t>(pagePaths.size(), pageId + 1));
+			pagePaths[pageId] = ReadQuotedValue(line, "file");
+		}
+		else if (line.rfind("image ", 0) == 0)
+		{
+			uint32_t page = ReadValue(line, "page");
+			if (page >= pagePaths.size())
+			{
+				continue;
+			}
+
+			Region region;
+			region.pagePath = pagePaths[page];
+			region.uvRect = glm::vec4(ReadValue(line, "x") / pageWidth, ReadValue(line, "y") / pageHeight,
+				ReadValue(line, "width") / pageWidth, ReadValue(line, "height") / pageHeight);
+
+			m_regions[GetKey(ReadQuotedValue(line, "file"))] = region;
+		}
+	}
+
+	return true;
+}
+
+bool UIAtlas::Find(const std::string& imagePath, Region& region) const
+{
+	auto it = m_regions.find(GetKey(imagePath));
+	if (it == m_regions.end())
+	{
+		return false;
+	}
+
+	region = it->second;
+	return true;
+}
+
+std::string UIAtlas::GetKey(const std::string& path)
+{
+	return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+std::string UIAtlas::ReadQuotedValue(const std::string& line, const std::string& name)
+{
+	size_t start = line.find(" " + name + "=\"");
+	if (start == std::string::npos)
+	{
+		return "";
+	}
+
+	start += name.size() + 3;
+	size_t end = line.find('"', start);
+
+	return line.substr(start, end - start);
+}
+
+uint32_t UIAtlas::ReadValue(const std::string& line, const std::string& name)
+{
+	size_t start = line.find(" " + name + "=");
+	if (start == std::string::npos)
+	{
+		return 0;
+	}
+
+	return static_cast<uint32_t>(std::stoul(line.substr(start + name.size() + 2)));
+}
\ No newline at end of file
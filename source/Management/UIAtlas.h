@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+//small UI images packed ahead of time into shared pages, so they share a few textures instead of one each
+//pages are only written as RGBA8 KTX2 files, the texture loader finds them next to the page's png path
+class UIAtlas {
+public:
+	struct Region {
+		std::string pagePath;
+
+		//offset in xy and size in zw, in the page's texture coordinates
+		glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	};
+
+	//packs every png in the directory up to kMaxImageSize on a side, writes the pages and the description next to them
+	//prints how full each page is, false when nothing could be written
+	static bool Build(const std::string& directory);
+
+	//images the description doesn't list are left as they are, false when it couldn't be read
+	bool Load(const std::string& descriptionFilePath);
+
+	bool Find(const std::string& imagePath, Region& region) const;
+
+	static constexpr uint32_t kPageSize = 1024;
+	static constexpr uint32_t kMaxImageSize = 256;
+	static constexpr uint32_t kPadding = 2;
+	static constexpr const char* kDescriptionFileName = "ui_atlas.txt";
+
+private:
+	//paths are compared the way the filesystem would, so textures\Crosshair.png and textures/Crosshair.png match
+	static std::string GetKey(const std::string& path);
+
+	static std::string ReadQuotedValue(const std::string& line, const std::string& name);
+	static uint32_t ReadValue(const std::string& line, const std::string& name);
+
+	std::unordered_map<std::string, Region> m_regions;
+};
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #include <iostream>
 
+#include <QThread>
+
 WindowManager::WindowManager(QWidget* parentProgram, size_t width, size_t height, std::string title) :
 	QVBoxLayout(parentProgram), m_parentProgram(parentProgram), m_width(width), m_height(height), m_title(title)
 {
@@ -31,6 +33,7 @@ void WindowManager::InitializeWindow(QVulkanInstance* vulkanInstance)
     QObject::connect(m_vulkanWindow, &VulkanWindow::MouseButtonUp, this, &WindowManager::AddMouseButtonUp);
 
     QObject::connect(m_vulkanWindow, &VulkanWindow::MouseMoved, this, &WindowManager::CursorMoved);
+    QObject::connect(m_vulkanWindow, &VulkanWindow::MouseScrolled, this, &WindowManager::MouseScrolled);
 
     m_wrappingWidget = QWidget::createWindowContainer(m_vulkanWindow);
     m_wrappingWidget->resize(m_width, m_height);
@@ -38,108 +41,250 @@ void WindowManager::InitializeWindow(QVulkanInstance* vulkanInstance)
 	addWidget(m_wrappingWidget);
 }
 
-void WindowManager::NewFrame()
+double WindowManager::BeginFrame(double deltaTime)
 {
-    m_keysPressedThisFrame.clear();
+    m_frameInput.BeginFrame();
+    m_frameEvents.clear();
+
+    InputEvent currentEvent;
+    while (m_inputEvents.Pop(currentEvent))
+    {
+        //still drained while replaying so the queue doesn't fill up
+        if (!m_inputRecorder.IsReplaying())
+        {
+            m_frameEvents.push_back(currentEvent);
+        }
+    }
+
+    size_t droppedEvents = m_inputEvents.TakeDroppedCount();
+    if (droppedEvents > 0)
+    {
+        std::cerr << "Input event queue full, dropped " << droppedEvents << " events" << std::endl;
+    }
+
+    if (m_inputRecorder.IsReplaying() && !m_inputRecorder.IsReplayFinished())
+    {
+        if (!m_inputRecorder.ReadFrame(deltaTime, m_frameEvents))
+        {
+            std::cout << "Replay finished after " << m_inputRecorder.GetFrameCount() << " frames" << std::endl;
+            Shutdown();
+        }
+    }
+
+    for (size_t i = 0; i < m_frameEvents.size(); i++)
+    {
+        m_frameInput.ApplyEvent(m_frameEvents[i]);
+    }
+
+    m_inputRecorder.RecordFrame(deltaTime, m_frameEvents);
+
+    for (size_t i = 0; i < m_frameEvents.size(); i++)
+    {
+        if (m_frameEvents[i].type != InputEvent::Type::ButtonClicked)
+        {
+            continue;
+        }
+
+        std::function<void()> callback;
+        {
+            std::lock_guard<std::mutex> lock(m_buttonCallbacksMutex);
+            auto callbackIt = m_buttonCallbacks.find(m_frameEvents[i].code);
+            if (callbackIt == m_buttonCallbacks.end())
+            {
+                continue;
+            }
+            callback = callbackIt->second;
+        }
 
-	m_mouseDelta = glm::vec2(0.0f, 0.0f);
-	m_scrollDelta = glm::vec2(0.0f, 0.0f);
+        //called outside the lock so a callback can add or remove buttons
+        callback();
+    }
+
+    return deltaTime;
 }
 
 bool WindowManager::KeyPressed(Qt::Key keyCode)
 {
-    return m_pressedKeys.contains(keyCode);
+    return m_frameInput.KeyDown(keyCode);
 }
 
 bool WindowManager::KeyPressedThisFrame(Qt::Key keyCode)
 {
-    return m_keysPressedThisFrame.contains(keyCode);
+    return m_frameInput.KeyPressedThisFrame(keyCode);
+}
+
+bool WindowManager::KeyReleasedThisFrame(Qt::Key keyCode)
+{
+    return m_frameInput.KeyReleasedThisFrame(keyCode);
 }
 
 bool WindowManager::MouseButtonPressed(Qt::MouseButton mouseButton)
 {
-    return m_pressedMouseButtons.contains(mouseButton);
+    return m_frameInput.MouseButtonDown(mouseButton);
 }
 
 bool WindowManager::MouseButtonPressedThisFrame(Qt::MouseButton mouseButton)
 {
-    return m_pressedMouseButtonsThisFrame.contains(mouseButton);
+    return m_frameInput.MouseButtonPressedThisFrame(mouseButton);
+}
+
+bool WindowManager::MouseButtonReleasedThisFrame(Qt::MouseButton mouseButton)
+{
+    return m_frameInput.MouseButtonReleasedThisFrame(mouseButton);
 }
 
 void WindowManager::AddKeyDown(Qt::Key pressedKey)
 {
-    m_keysPressedThisFrame.insert(pressedKey);
-    m_pressedKeys.insert(pressedKey);
+    InputEvent newEvent;
+    newEvent.type = InputEvent::Type::KeyDown;
+    newEvent.code = static_cast<uint32_t>(pressedKey);
+    newEvent.timestamp = InputEvent::Now();
+    m_inputEvents.Push(newEvent);
 }
 
 void WindowManager::AddKeyUp(Qt::Key releasedKey)
 {
-    m_keysPressedThisFrame.erase(releasedKey);
-    m_pressedKeys.erase(releasedKey);
+    InputEvent newEvent;
+    newEvent.type = InputEvent::Type::KeyUp;
+    newEvent.code = static_cast<uint32_t>(releasedKey);
+    newEvent.timestamp = InputEvent::Now();
+    m_inputEvents.Push(newEvent);
 }
 
 void WindowManager::AddMouseButtonDown(Qt::MouseButton pressedButton)
 {
-    m_pressedMouseButtons.insert(pressedButton);
-    m_pressedMouseButtonsThisFrame.insert(pressedButton);
+    InputEvent newEvent;
+    newEvent.type = InputEvent::Type::MouseButtonDown;
+    newEvent.code = static_cast<uint32_t>(pressedButton);
+    newEvent.timestamp = InputEvent::Now();
+    m_inputEvents.Push(newEvent);
 }
 
 void WindowManager::AddMouseButtonUp(Qt::MouseButton releasedButton)
 {
-    m_pressedMouseButtons.erase(releasedButton);
-    m_pressedMouseButtonsThisFrame.erase(releasedButton);
+    InputEvent newEvent;
+    newEvent.type = InputEvent::Type::MouseButtonUp;
+    newEvent.code = static_cast<uint32_t>(releasedButton);
+    newEvent.timestamp = InputEvent::Now();
+    m_inputEvents.Push(newEvent);
 }
 
 void WindowManager::CursorMoved(float xpos, float ypos)
 {
-    m_mouseDelta = {xpos, ypos};
-	m_mouseDelta.y = -m_mouseDelta.y;
+    InputEvent newEvent;
+    newEvent.type = InputEvent::Type::MouseMove;
+    newEvent.value = glm::vec2(xpos, -ypos);
+    newEvent.timestamp = InputEvent::Now();
+    m_inputEvents.Push(newEvent);
+}
+
+void WindowManager::MouseScrolled(float xDelta, float yDelta)
+{
+    InputEvent newEvent;
+    newEvent.type = InputEvent::Type::Scroll;
+    newEvent.value = glm::vec2(xDelta, yDelta);
+    newEvent.timestamp = InputEvent::Now();
+    m_inputEvents.Push(newEvent);
+}
+
+bool WindowManager::ForwardToGuiThread(const std::function<void()>& call)
+{
+    if (QThread::currentThread() == thread())
+    {
+        return false;
+    }
+
+    QMetaObject::invokeMethod(this, call, Qt::QueuedConnection);
+    return true;
 }
 
 void WindowManager::Shutdown()
 {
+    //the renderer's shutdown state is only touched on the gui thread, replays and behaviors can finish on the simulation thread
+    if (ForwardToGuiThread([this]() { Shutdown(); }))
+    {
+        return;
+    }
+
     m_vulkanWindow->Shutdown();
     QMetaObject::invokeMethod(m_parentProgram, "close", Qt::QueuedConnection);
 }
 
 void WindowManager::SetLockCursor(bool lockCursor)
 {
+    m_cursorLocked = lockCursor;
+
+    if (ForwardToGuiThread([this, lockCursor]() { m_vulkanWindow->SetLockCursor(lockCursor); }))
+    {
+        return;
+    }
+
     m_vulkanWindow->SetLockCursor(lockCursor);
 }
 
 bool WindowManager::IsCursorLocked()
 {
-    return m_vulkanWindow->IsCursorLocked();
+    return m_cursorLocked;
 }
 
 void WindowManager::SetIsTrackingMouse(bool isTrackingMouse)
 {
+    m_trackingMouse = isTrackingMouse;
+
+    if (ForwardToGuiThread([this, isTrackingMouse]() { m_vulkanWindow->SetTrackingMouse(isTrackingMouse); }))
+    {
+        return;
+    }
+
     m_vulkanWindow->SetTrackingMouse(isTrackingMouse);
 }
 
 bool WindowManager::IsTrackingMouse()
 {
-    return m_vulkanWindow->IsTrackingMouse();
+    return m_trackingMouse;
 }
 
 void WindowManager::AddButton(std::string title, const std::function<void()>& callback)
 {
+    if (ForwardToGuiThread([this, title, callback]() { AddButton(title, callback); }))
+    {
+        return;
+    }
+
     if (m_buttons.contains(title))
     {
 		qDebug() << "Button with title " << title << " already exists!";
     }
 
+    //ids are handed out in the order buttons are added, so a recorded click replays on the same button
+    uint32_t buttonId = m_nextButtonId++;
+
+    {
+        std::lock_guard<std::mutex> lock(m_buttonCallbacksMutex);
+        m_buttonCallbacks[buttonId] = callback;
+    }
+
     QPushButton* newButton = new QPushButton(QString::fromStdString(title));
-    connect(newButton, &QPushButton::clicked, [callback]() {
-        callback();
+    connect(newButton, &QPushButton::clicked, [this, buttonId]() {
+        InputEvent newEvent;
+        newEvent.type = InputEvent::Type::ButtonClicked;
+        newEvent.code = buttonId;
+        newEvent.timestamp = InputEvent::Now();
+        m_inputEvents.Push(newEvent);
     });
 
 	m_buttonLayout->addWidget(newButton);
     m_buttons[title] = newButton;
+    m_buttonIds[title] = buttonId;
 }
 
 void WindowManager::RemoveButton(std::string title)
 {
+    if (ForwardToGuiThread([this, title]() { RemoveButton(title); }))
+    {
+        return;
+    }
+
     if (!m_buttons.contains(title))
     {
         qDebug() << "Button with title " << title << " does not exist!";
@@ -149,4 +294,10 @@ void WindowManager::RemoveButton(std::string title)
     m_buttonLayout->removeWidget(buttonToRemove);
     delete buttonToRemove;
     m_buttons.erase(title);
+
+    {
+        std::lock_guard<std::mutex> lock(m_buttonCallbacksMutex);
+        m_buttonCallbacks.erase(m_buttonIds[title]);
+    }
+    m_buttonIds.erase(title);
 }
\ No newline at end of file
@@ -1,7 +1,14 @@
 #pragma once
 
+#include "source/Management/InputEventQueue.h"
+#include "source/Management/FrameInputState.h"
+#include "source/Management/InputRecorder.h"
+
 #include <string>
-#include <set>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
 
 #include <glm.hpp>
 
@@ -38,23 +45,33 @@ public:
 	size_t GetWidth() { return m_width; }
 	size_t GetHeight() { return m_height; }
 
-	glm::vec2 GetMouseDelta() { return m_mouseDelta; };
-	glm::vec2 GetScrollDelta() { return m_scrollDelta; };
+	glm::vec2 GetMouseDelta() { return m_frameInput.mouseDelta; };
+	glm::vec2 GetScrollDelta() { return m_frameInput.scrollDelta; };
 
 	VulkanWindow* GetVulkanWindow() { return m_vulkanWindow; }
 
-	void NewFrame();
+	//drains the queued input events into this frame's input state, call once before any update
+	//returns the delta time the frame should use, which is the recorded one while replaying
+	double BeginFrame(double deltaTime);
+	const FrameInputState& GetFrameInput() { return m_frameInput; }
+
+	//set up before rendering starts, live input is ignored while replaying
+	InputRecorder& GetInputRecorder() { return m_inputRecorder; }
 
 	bool KeyPressed(Qt::Key keyCode);
 	bool KeyPressedThisFrame(Qt::Key keyCode);
+	bool KeyReleasedThisFrame(Qt::Key keyCode);
 
 	bool MouseButtonPressed(Qt::MouseButton mouseButton);
 	bool MouseButtonPressedThisFrame(Qt::MouseButton mouseButton);
+	bool MouseButtonReleasedThisFrame(Qt::MouseButton mouseButton);
 
 	void SetFrameBufferResized(bool resized) { m_framebufferResized = true; };
 
+	//safe to call from the simulation thread, the shutdown itself runs on the gui thread
 	void Shutdown();
 
+	//safe to call from the simulation thread, widget changes are forwarded to the gui thread
 	void SetLockCursor(bool lockCursor);
 	bool IsCursorLocked();
 
@@ -69,8 +86,12 @@ public slots:
 	void AddMouseButtonUp(Qt::MouseButton releasedButton);
 
 	void CursorMoved(float xpos, float ypos);
+	void MouseScrolled(float xDelta, float yDelta);
 
 private:
+	//queues the call on the gui thread and returns true when called from another thread
+	bool ForwardToGuiThread(const std::function<void()>& call);
+
 	VulkanWindow* m_vulkanWindow = nullptr;
 	std::shared_ptr<VulkanInterface> m_vulkanInterface = nullptr;
 	std::shared_ptr<Scene> m_scene = nullptr;
@@ -80,22 +101,30 @@ private:
 	QHBoxLayout* m_buttonLayout;
 
 	std::map<std::string, QPushButton*> m_buttons;
+	std::map<std::string, uint32_t> m_buttonIds;
+	uint32_t m_nextButtonId = 0;
+
+	//clicks go through the input queue so callbacks run in BeginFrame, on the simulation thread and under the scene's lock
+	std::mutex m_buttonCallbacksMutex;
+	std::map<uint32_t, std::function<void()>> m_buttonCallbacks;
 
 	//members
 	bool m_framebufferResized = false;
 	size_t m_width = 0;
 	size_t m_height = 0;
 
-	glm::vec2 m_mouseDelta = glm::vec2(0.0f, 0.0f);
 	bool m_firstMouseMovement = true;
 
-	glm::vec2 m_scrollDelta = glm::vec2(0.0f, 0.0f);
+	//mirrors of the window state so other threads see a change right away
+	std::atomic<bool> m_cursorLocked = false;
+	std::atomic<bool> m_trackingMouse = true;
 
-	std::set<Qt::Key> m_pressedKeys;
-	std::set<Qt::Key> m_keysPressedThisFrame;
+	//written by the Qt slots, drained by BeginFrame
+	InputEventQueue m_inputEvents;
+	FrameInputState m_frameInput;
 
-	std::set<Qt::MouseButton> m_pressedMouseButtons;
-	std::set<Qt::MouseButton> m_pressedMouseButtonsThisFrame;
+	InputRecorder m_inputRecorder;
+	std::vector<InputEvent> m_frameEvents;
 
 	std::string m_title = "";
 };
\ No newline at end of file
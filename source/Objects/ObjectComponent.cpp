@@ -3,12 +3,14 @@
 
 Scene* ObjectComponent::GetScene()
 {
-	if (m_owner == nullptr)
+	std::shared_ptr<RenderObject> owner = m_owner.lock();
+
+	if (owner == nullptr)
 	{
 		return nullptr;
 	}
 
-	return m_owner->GetSceneManager();
+	return owner->GetSceneManager();
 }
 
 WindowManager* ObjectComponent::GetWindowManager()
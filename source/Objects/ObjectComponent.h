@@ -16,8 +16,8 @@ public:
 	virtual void Start() {};
 	virtual void Update(float deltaTime) {};
 
-	std::shared_ptr<RenderObject> GetOwner() { return m_owner; }
-	void SetOwner(std::shared_ptr<RenderObject> owner) { m_owner = std::shared_ptr<RenderObject>(owner); }
+	std::shared_ptr<RenderObject> GetOwner() { return m_owner.lock(); }
+	void SetOwner(std::shared_ptr<RenderObject> owner) { m_owner = owner; }
 	Scene* GetScene();
 
 	WindowManager* GetWindowManager();
@@ -29,7 +29,8 @@ public:
 	void SetStarted(bool started) { m_started = started; }
 
 private:
-	std::shared_ptr<RenderObject> m_owner = nullptr;
+	//weak so the object and its components don't keep each other alive after removal
+	std::weak_ptr<RenderObject> m_owner;
 	bool m_enabled = true;
 	bool m_started = false;
 };
\ No newline at end of file
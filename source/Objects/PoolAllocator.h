@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+
+//fixed size blocks carved out of larger chunks, freed blocks go on a free list instead of back to the heap
+//objects spawned and removed every frame end up reusing the same memory once the pool has warmed up
+class SmallObjectPool {
+public:
+	static constexpr size_t kGranularity = 16;
+	static constexpr size_t kMaxBlockSize = 512;
+	static constexpr size_t kChunkSize = 64 * 1024;
+
+	//never destroyed so blocks freed during static destruction still have somewhere to go
+	static SmallObjectPool& Get()
+	{
+		static SmallObjectPool* pool = new SmallObjectPool();
+		return *pool;
+	}
+
+	static bool IsPooledSize(size_t size, size_t alignment) { return size <= kMaxBlockSize && alignment <= kGranularity; }
+
+	void* Allocate(size_t size)
+	{
+		SizeClass& sizeClass = m_sizeClasses[SizeClassIndex(size)];
+		std::lock_guard<std::mutex> lock(sizeClass.mutex);
+
+		if (sizeClass.freeList == nullptr)
+		{
+			AddChunk(sizeClass, (SizeClassIndex(size) + 1) * kGranularity);
+		}
+
+		FreeBlock* block = sizeClass.freeList;
+		sizeClass.freeList = block->next;
+		sizeClass.liveBlocks++;
+
+		return block;
+	}
+
+	void Free(void* memory, size_t size)
+	{
+		SizeClass& sizeClass = m_sizeClasses[SizeClassIndex(size)];
+		std::lock_guard<std::mutex> lock(sizeClass.mutex);
+
+		FreeBlock* block = static_cast<FreeBlock*>(memory);
+		block->next = sizeClass.freeList;
+		sizeClass.freeList = block;
+		sizeClass.liveBlocks--;
+	}
+
+	size_t GetLiveBlockCount()
+	{
+		size_t liveBlocks = 0;
+
+		for (size_t i = 0; i < m_sizeClasses.size(); i++)
+		{
+			std::lock_guard<std::mutex> lock(m_sizeClasses[i].mutex);
+			liveBlocks += m_sizeClasses[i].liveBlocks;
+		}
+
+		return liveBlocks;
+	}
+
+	size_t GetChunkCount()
+	{
+		size_t chunkCount = 0;
+
+		for (size_t i = 0; i < m_sizeClasses.size(); i++)
+		{
+			std::lock_guard<std::mutex> lock(m_sizeClasses[i].mutex);
+			chunkCount += m_sizeClasses[i].chunkCount;
+		}
+
+		return chunkCount;
+	}
+
+private:
+	SmallObjectPool() {};
+
+	struct FreeBlock {
+		FreeBlock* next = nullptr;
+	};
+
+	struct SizeClass {
+		std::mutex mutex;
+		FreeBlock* freeList = nullptr;
+		size_t liveBlocks = 0;
+		size_t chunkCount = 0;
+	};
+
+	static size_t SizeClassIndex(size_t size) { return (size == 0) ? 0 : (size - 1) / kGranularity; }
+
+	//chunks are never returned, the pool only grows to the peak number of live objects
+	void AddChunk(SizeClass& sizeClass, size_t blockSize)
+	{
+		std::byte* chunk = static_cast<std::byte*>(::operator new(kChunkSize, std::align_val_t(kGranularity)));
+		size_t blockCount = kChunkSize / blockSize;
+
+		for (size_t i = 0; i < blockCount; i++)
+		{
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+			block->next = sizeClass.freeList;
+			sizeClass.freeList = block;
+		}
+
+		sizeClass.chunkCount++;
+	}
+
+	std::array<SizeClass, kMaxBlockSize / kGranularity> m_sizeClasses;
+};
+
+//standard allocator over SmallObjectPool, anything too big or too aligned for it goes to the heap
+template <typename T>
+class PoolAllocator {
+public:
+	using value_type = T;
+
+	PoolAllocator() noexcept {}
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+	T* allocate(size_t count)
+	{
+		size_t size = sizeof(T) * count;
+
+		if (!SmallObjectPool::IsPooledSize(size, alignof(T)))
+		{
+			return static_cast<T*>(::operator new(size, std::align_val_t(alignof(T))));
+		}
+
+		return static_cast<T*>(SmallObjectPool::Get().Allocate(size));
+	}
+
+	void deallocate(T* memory, size_t count)
+	{
+		size_t size = sizeof(T) * count;
+
+		if (!SmallObjectPool::IsPooledSize(size, alignof(T)))
+		{
+			::operator delete(memory, size, std::align_val_t(alignof(T)));
+			return;
+		}
+
+		SmallObjectPool::Get().Free(memory, size);
+	}
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+};
+
+//make_shared through the pool, the object and its control block share one block
+template <typename T, typename... Args>
+std::shared_ptr<T> MakePooled(Args&&... args)
+{
+	return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
\ No newline at end of file
@@ -7,6 +7,17 @@ RenderObject::RenderObject()
 
 }
 
+void RenderObject::SetTag(std::string tag)
+{
+	TagTable::TagId previousTag = m_tag;
+	m_tag = TagTable::Get().Intern(tag);
+
+	if (m_sceneManager != nullptr && previousTag != m_tag)
+	{
+		m_sceneManager->UpdateObjectTag(this, previousTag, m_tag);
+	}
+}
+
 VulkanCommonFunctions::InstanceInfo RenderObject::GetInstanceInfo(const std::vector<std::string>& textureFilePaths)
 {
 	VulkanCommonFunctions::InstanceInfo result {};
@@ -25,23 +36,7 @@ VulkanCommonFunctions::InstanceInfo RenderObject::GetInstanceInfo(const std::vec
 		return result;
 	}
 
-	result.modelMatrix = glm::mat4(1.0f);
-	result.modelMatrix = glm::translate(result.modelMatrix, transform->GetWorldPosition());
-
-	result.modelMatrix = glm::scale(result.modelMatrix, transform->GetWorldScale());
-
-	glm::vec3 rotation = transform->GetWorldRotation();
-
-	result.modelMatrix = glm::rotate(result.modelMatrix, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-	result.modelMatrix = glm::rotate(result.modelMatrix, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-	result.modelMatrix = glm::rotate(result.modelMatrix, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
-	//need to transpose the matrix because hlsl expects column major matrices
-	result.modelMatrix = glm::transpose(result.modelMatrix);
-
-	result.modelMatrixInverse = glm::inverse(result.modelMatrix);
-
-	result.scale = transform->GetWorldScale();
+	SetInstanceTransform(result, transform->GetWorldPosition(), transform->GetWorldRotation(), transform->GetWorldScale());
 
 	result.ambient = meshRenderer->GetColor();
 	result.diffuse = meshRenderer->GetColor();
@@ -50,16 +45,27 @@ VulkanCommonFunctions::InstanceInfo RenderObject::GetInstanceInfo(const std::vec
 
 	result.opacity = meshRenderer->GetOpacity();
 
-	result.lit = (meshRenderer->GetLit()) ? 1 : 0;
+	result.materialVariant = 0;
 
-	result.textured = (meshRenderer->GetTextured()) ? 1 : 0;
+	if (meshRenderer->GetLit())
+	{
+		result.materialVariant |= VulkanCommonFunctions::MATERIAL_VARIANT_LIT;
+	}
 
-	result.isBillboarded = (meshRenderer->IsBillboarded()) ? 1 : 0;
+	if (meshRenderer->GetTextured())
+	{
+		result.materialVariant |= VulkanCommonFunctions::MATERIAL_VARIANT_TEXTURED;
+	}
+
+	if (meshRenderer->IsBillboarded())
+	{
+		result.materialVariant |= VulkanCommonFunctions::MATERIAL_VARIANT_BILLBOARDED;
+	}
 
 	auto iterator = std::find(textureFilePaths.begin(), textureFilePaths.end(), meshRenderer->GetTexturePath());
 
 	result.textureIndex = std::distance(textureFilePaths.begin(), iterator);
-	if (result.textureIndex > textureFilePaths.size())
+	if (result.textureIndex >= textureFilePaths.size())
 	{
 		result.textureIndex = 0;
 	}
@@ -86,11 +92,12 @@ VulkanCommonFunctions::UIInstanceInfo RenderObject::GetUIInstanceInfo(const std:
 	result.opacity = imageComponent->GetOpacity();
 	result.textured = (imageComponent->GetTextured()) ? 1 : 0;
 	result.isTextCharacter = 0;
+	result.uvRect = imageComponent->GetUVRect();
 
-	auto iterator = std::find(textureFilePaths.begin(), textureFilePaths.end(), imageComponent->GetTexturePath());
+	auto iterator = std::find(textureFilePaths.begin(), textureFilePaths.end(), imageComponent->GetSampledTexturePath());
 
 	result.textureIndex = std::distance(textureFilePaths.begin(), iterator);
-	if (result.textureIndex > textureFilePaths.size())
+	if (result.textureIndex >= textureFilePaths.size())
 	{
 		result.textureIndex = 0;
 	}
@@ -98,33 +105,21 @@ VulkanCommonFunctions::UIInstanceInfo RenderObject::GetUIInstanceInfo(const std:
 	return result;
 }
 
-std::shared_ptr<GraphicsBuffer> RenderObject::GetInstanceBuffer(const std::vector<std::string>& textureFilePaths)
+void RenderObject::SetInstanceTransform(VulkanCommonFunctions::InstanceInfo& info, glm::vec3 position, glm::vec3 rotation, glm::vec3 scale)
 {
-	if (m_instanceBuffer == nullptr)
-	{
-		return nullptr;
-	}
-
-	VulkanCommonFunctions::InstanceInfo info = GetInstanceInfo(textureFilePaths);
+	info.modelMatrix = glm::mat4(1.0f);
+	info.modelMatrix = glm::translate(info.modelMatrix, position);
 
-	std::array<VulkanCommonFunctions::InstanceInfo, 1> infoArray = { info };
+	info.modelMatrix = glm::scale(info.modelMatrix, scale);
 
-	m_instanceBuffer->LoadData(infoArray.data(), sizeof(VulkanCommonFunctions::InstanceInfo));
+	info.modelMatrix = glm::rotate(info.modelMatrix, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	info.modelMatrix = glm::rotate(info.modelMatrix, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	info.modelMatrix = glm::rotate(info.modelMatrix, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
 
-	return m_instanceBuffer;
-}
-
-std::shared_ptr<GraphicsBuffer> RenderObject::GetUIInstanceBuffer(const std::vector<std::string>& textureFilePaths)
-{
-	if (m_instanceBuffer == nullptr)
-	{
-		return nullptr;
-	}
-
-	VulkanCommonFunctions::UIInstanceInfo info = GetUIInstanceInfo(textureFilePaths);
-	std::array<VulkanCommonFunctions::UIInstanceInfo, 1> infoArray = { info };
+	//need to transpose the matrix because hlsl expects column major matrices
+	info.modelMatrix = glm::transpose(info.modelMatrix);
 
-	m_instanceBuffer->LoadData(infoArray.data(), sizeof(VulkanCommonFunctions::UIInstanceInfo));
+	info.modelMatrixInverse = glm::inverse(info.modelMatrix);
 
-	return m_instanceBuffer;
+	info.scale = scale;
 }
\ No newline at end of file
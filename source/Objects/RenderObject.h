@@ -9,6 +9,8 @@
 #include "source/Objects/ObjectComponent.h"
 #include "source/Vulkan Interface/GraphicsBuffer.h"
 #include "source/Components/Transform.h"
+#include "source/Objects/PoolAllocator.h"
+#include "source/Objects/TagTable.h"
 
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
@@ -30,7 +32,7 @@ public:
 	template <typename T>
 	std::shared_ptr<T> AddComponent()
 	{
-		std::shared_ptr<T> newComponent = std::make_shared<T>();
+		std::shared_ptr<T> newComponent = MakePooled<T>();
 		m_components.push_back(newComponent);
 
 		newComponent->SetOwner(shared_from_this());
@@ -54,13 +56,15 @@ public:
 		return nullptr;
 	}
 
-	std::vector<std::shared_ptr<ObjectComponent>> GetAllComponents() { return m_components; }
+	using ComponentList = std::vector<std::shared_ptr<ObjectComponent>, PoolAllocator<std::shared_ptr<ObjectComponent>>>;
+
+	//index it rather than iterating, components can be added while the list is being walked
+	const ComponentList& GetAllComponents() { return m_components; }
 
     VulkanCommonFunctions::InstanceInfo GetInstanceInfo(const std::vector<std::string>& textureFilePaths);
 	VulkanCommonFunctions::UIInstanceInfo GetUIInstanceInfo(const std::vector<std::string>& textureFilePaths);
-	std::shared_ptr<GraphicsBuffer> GetInstanceBuffer(const std::vector<std::string>& textureFilePaths);
-	std::shared_ptr<GraphicsBuffer> GetUIInstanceBuffer(const std::vector<std::string>& textureFilePaths);
-	void SetInstanceBuffer(std::shared_ptr<GraphicsBuffer> instanceBuffer) { m_instanceBuffer = instanceBuffer; }
+	//fills the model matrices from a world space transform, rotation is euler degrees
+	static void SetInstanceTransform(VulkanCommonFunctions::InstanceInfo& info, glm::vec3 position, glm::vec3 rotation, glm::vec3 scale);
 
 	void SetSceneManager(Scene* sceneManager) { m_sceneManager = sceneManager; }
 	Scene* GetSceneManager() { return m_sceneManager; }
@@ -70,17 +74,23 @@ public:
 
 	bool IsInitialized() { return m_initialized; }
 
-	void SetTag(std::string tag) { m_tag = tag; }
-	std::string GetTag() { return m_tag; }
+	//keeps the scene's tag index up to date if the object has already been added
+	void SetTag(std::string tag);
+	std::string GetTag() { return TagTable::Get().GetName(m_tag); }
+	TagTable::TagId GetTagId() { return m_tag; }
+
+	//set by the scene while the object is part of it
+	void SetHandle(VulkanCommonFunctions::ObjectHandle handle) { m_handle = handle; }
+	VulkanCommonFunctions::ObjectHandle GetHandle() { return m_handle; }
 
 private:
-	std::vector<std::shared_ptr<ObjectComponent>> m_components;
+	ComponentList m_components;
 	WindowManager* m_windowManager = nullptr;
-	std::shared_ptr<GraphicsBuffer> m_instanceBuffer = nullptr;
 	
 	Scene* m_sceneManager = nullptr;
 
-	std::string m_tag = "";
+	TagTable::TagId m_tag = TagTable::kNoTag;
+	VulkanCommonFunctions::ObjectHandle m_handle = VulkanCommonFunctions::INVALID_OBJECT_HANDLE;
 
 	bool m_initialized = false;
 };
\ No newline at end of file
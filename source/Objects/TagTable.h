@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//interns tag strings so objects store and compare a small id instead of the string
+//shared by every scene, ids are never reused so they stay valid for the life of the program
+class TagTable {
+public:
+	using TagId = uint32_t;
+
+	//the empty tag, objects start with it and it isn't indexed
+	static constexpr TagId kNoTag = 0;
+
+	static TagTable& Get()
+	{
+		static TagTable table;
+		return table;
+	}
+
+	//returns the existing id if the tag was seen before
+	TagId Intern(const std::string& tag)
+	{
+		if (tag.empty())
+		{
+			return kNoTag;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto existing = m_ids.find(tag);
+		if (existing != m_ids.end())
+		{
+			return existing->second;
+		}
+
+		TagId newId = static_cast<TagId>(m_names.size());
+		m_names.push_back(tag);
+		m_ids[tag] = newId;
+
+		return newId;
+	}
+
+	//kNoTag if nothing was ever tagged with it, lookups don't add to the table
+	TagId Find(const std::string& tag)
+	{
+		if (tag.empty())
+		{
+			return kNoTag;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto existing = m_ids.find(tag);
+		return (existing != m_ids.end()) ? existing->second : kNoTag;
+	}
+
+	std::string GetName(TagId tagId)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (tagId >= m_names.size())
+		{
+			return "";
+		}
+
+		return m_names[tagId];
+	}
+
+private:
+	TagTable() { m_names.push_back(""); }
+
+	std::mutex m_mutex;
+
+	std::unordered_map<std::string, TagId> m_ids;
+	std::vector<std::string> m_names;
+};
\ No newline at end of file
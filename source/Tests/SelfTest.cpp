@@ -0,0 +1,288 @@
+#include "SelfTest.h"
+#include "source/Management/AtlasPacker.h"
+#include "source/Management/HandlePool.h"
+#include "source/Management/MeshletBuilder.h"
+#include "source/Management/RenderSnapshot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+size_t SelfTest::s_checkCount = 0;
+size_t SelfTest::s_failureCount = 0;
+
+bool SelfTest::Run()
+{
+	s_checkCount = 0;
+	s_failureCount = 0;
+
+	TestHandlePool();
+	TestRenderSnapshotBuffer();
+	TestMeshletBuilder();
+	TestAtlasPacker();
+
+	std::cout << "Self test: " << (s_checkCount - s_failureCount) << " of " << s_checkCount << " checks passed" << std::endl;
+	return s_failureCount == 0;
+}
+
+void SelfTest::Check(bool condition, const char* description)
+{
+	s_checkCount++;
+
+	if (!condition)
+	{
+		s_failureCount++;
+		std::cerr << "Self test failed: " << description << std::endl;
+	}
+}
+
+void SelfTest::TestHandlePool()
+{
+	HandlePool pool;
+
+	VulkanCommonFunctions::ObjectHandle first = pool.Allocate();
+	VulkanCommonFunctions::ObjectHandle second = pool.Allocate();
+	Check(first != VulkanCommonFunctions::INVALID_OBJECT_HANDLE && second != VulkanCommonFunctions::INVALID_OBJECT_HANDLE, "handle pool never hands out the invalid handle");
+	Check(first != second, "handle pool hands out distinct handles");
+	Check(!pool.IsValid(VulkanCommonFunctions::INVALID_OBJECT_HANDLE), "handle pool rejects the invalid handle");
+
+	Check(pool.Free(first), "handle pool frees a live handle");
+	Check(!pool.Free(first), "handle pool rejects freeing a handle twice");
+	Check(!pool.IsValid(first), "freed handle is no longer valid");
+
+	VulkanCommonFunctions::ObjectHandle reused = pool.Allocate();
+	Check(HandlePool::GetSlot(reused) == HandlePool::GetSlot(first), "handle pool reuses a freed slot");
+	Check(HandlePool::GetGeneration(reused) == HandlePool::GetGeneration(first) + 1, "reused slot moves to the next generation");
+	Check(!pool.IsValid(first) && pool.IsValid(reused), "stale handle doesn't match the object that took its slot");
+	Check(pool.GetLiveCount() == 2 && pool.GetSlotCount() == 2, "handle pool counts live handles and slots");
+
+	//a small maximum stands in for the 32 bit generation wrapping around
+	const uint32_t maxGeneration = 3;
+	HandlePool wrappingPool(maxGeneration);
+
+	std::vector<VulkanCommonFunctions::ObjectHandle> slotHandles;
+	for (uint32_t generation = 0; generation < maxGeneration; generation++)
+	{
+		VulkanCommonFunctions::ObjectHandle handle = wrappingPool.Allocate();
+		Check(HandlePool::GetSlot(handle) == 0 && HandlePool::GetGeneration(handle) == generation, "slot is reused until its generation runs out");
+
+		slotHandles.push_back(handle);
+		wrappingPool.Free(handle);
+	}
+
+	Check(wrappingPool.GetRetiredCount() == 1, "slot is retired when its generation runs out");
+
+	VulkanCommonFunctions::ObjectHandle afterWrap = wrappingPool.Allocate();
+	Check(HandlePool::GetSlot(afterWrap) == 1, "retired slot is never handed out again");
+
+	bool anyStaleValid = false;
+	for (size_t i = 0; i < slotHandles.size(); i++)
+	{
+		anyStaleValid = anyStaleValid || wrappingPool.IsValid(slotHandles[i]);
+	}
+	Check(!anyStaleValid, "no handle from a retired slot is valid again");
+}
+
+void SelfTest::TestRenderSnapshotBuffer()
+{
+	RenderSnapshotBuffer buffer;
+
+	const RenderSnapshot* previous = nullptr;
+	const RenderSnapshot* current = nullptr;
+	Check(!buffer.Acquire(previous, current) && previous == nullptr && current == nullptr, "nothing is acquired before the first publish");
+
+	buffer.BeginWrite().simulationTick = 1;
+	buffer.Publish();
+
+	Check(buffer.Acquire(previous, current), "snapshot is acquired after the first publish");
+	Check(previous == current && current->simulationTick == 1, "previous is the current snapshot after the first publish");
+	buffer.Release();
+
+	buffer.BeginWrite().simulationTick = 2;
+	buffer.Publish();
+
+	Check(buffer.Acquire(previous, current), "snapshot is acquired after the second publish");
+	Check(previous->simulationTick == 1 && current->simulationTick == 2, "acquire returns the two newest snapshots in order");
+
+	//the writer keeps going while the renderer holds its two snapshots
+	bool overwroteHeldSnapshot = false;
+	for (uint64_t tick = 3; tick < 20; tick++)
+	{
+		RenderSnapshot& written = buffer.BeginWrite();
+		overwroteHeldSnapshot = overwroteHeldSnapshot || &written == previous || &written == current;
+		written.simulationTick = tick;
+		buffer.Publish();
+	}
+
+	Check(!overwroteHeldSnapshot, "writer never gets a snapshot the renderer holds");
+	Check(previous->simulationTick == 1 && current->simulationTick == 2, "held snapshots are unchanged while the writer publishes");
+	buffer.Release();
+
+	Check(buffer.Acquire(previous, current), "snapshot is acquired after releasing");
+	Check(previous->simulationTick == 18 && current->simulationTick == 19, "acquire after releasing returns the newest snapshots");
+	buffer.Release();
+}
+
+void SelfTest::TestMeshletBuilder()
+{
+	//a fan adds one vertex per triangle, so its clusters are cut by the vertex limit
+	std::vector<VulkanCommonFunctions::Vertex> fanVertices;
+	std::vector<uint16_t> fanIndices;
+
+	const uint32_t fanTriangles = 200;
+	fanVertices.push_back({ glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f) });
+
+	for (uint32_t i = 0; i <= fanTriangles; i++)
+	{
+		float angle = 6.2831853f * i / (fanTriangles + 1);
+		fanVertices.push_back({ glm::vec3(std::cos(angle), std::sin(angle), 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f) });
+	}
+
+	for (uint32_t i = 0; i < fanTriangles; i++)
+	{
+		fanIndices.insert(fanIndices.end(), { 0, static_cast<uint16_t>(i + 2), static_cast<uint16_t>(i + 1) });
+	}
+
+	//one quad in front of the fan, so the range under test doesn't start at index 0
+	std::vector<uint16_t> quadIndices = { 0, 2, 1, 0, 3, 2 };
+	fanIndices.insert(fanIndices.begin(), quadIndices.begin(), quadIndices.end());
+
+	std::vector<uint16_t> originalFanIndices = fanIndices;
+	std::vector<VulkanCommonFunctions::MeshletInfo> fanMeshlets;
+	MeshletBuilder::Build(fanVertices, fanIndices, 6, fanTriangles * 3, fanMeshlets);
+
+	Check(MeshletBuilder::Validate(originalFanIndices, fanIndices, 6, fanTriangles * 3, fanMeshlets), "fan meshlets cover every triangle once within the limits");
+	Check(std::equal(quadIndices.begin(), quadIndices.end(), fanIndices.begin()), "meshlet build leaves indices outside its range alone");
+
+	uint32_t largestVertexCount = 0;
+	for (size_t i = 0; i < fanMeshlets.size(); i++)
+	{
+		largestVertexCount = std::max(largestVertexCount, fanMeshlets[i].vertexCount);
+	}
+	Check(largestVertexCount == MeshletBuilder::kMaxVertices, "fan meshlets fill up to the vertex limit");
+
+	//the same triangle over and over never adds a vertex, so its clusters are cut by the triangle limit
+	std::vector<uint16_t> repeatedIndices;
+	const uint32_t repeatedTriangles = MeshletBuilder::kMaxTriangles * 2 + 10;
+
+	for (uint32_t i = 0; i < repeatedTriangles; i++)
+	{
+		repeatedIndices.insert(repeatedIndices.end(), { 0, 2, 1 });
+	}
+
+	std::vector<uint16_t> originalRepeatedIndices = repeatedIndices;
+	std::vector<VulkanCommonFunctions::MeshletInfo> repeatedMeshlets;
+	MeshletBuilder::Build(fanVertices, repeatedIndices, 0, repeatedTriangles * 3, repeatedMeshlets);
+
+	Check(MeshletBuilder::Validate(originalRepeatedIndices, repeatedIndices, 0, repeatedTriangles * 3, repeatedMeshlets), "repeated triangle meshlets cover every triangle once within the limits");
+	Check(repeatedMeshlets.size() == 3 && repeatedMeshlets[0].indexCount / 3 == MeshletBuilder::kMaxTriangles, "repeated triangle meshlets fill up to the triangle limit");
+
+	//every corner of a cluster has to sit inside its bounding sphere or the cluster could be culled while visible
+	bool cornersInBounds = true;
+	for (size_t i = 0; i < fanMeshlets.size(); i++)
+	{
+		const VulkanCommonFunctions::MeshletInfo& meshlet = fanMeshlets[i];
+		glm::vec3 center = glm::vec3(meshlet.boundingSphere);
+
+		for (uint32_t index = meshlet.firstIndex; index < meshlet.firstIndex + meshlet.indexCount; index++)
+		{
+			cornersInBounds = cornersInBounds && glm::length(fanVertices[fanIndices[index]].pos - center) <= meshlet.boundingSphere.w + 0.0001f;
+		}
+	}
+	Check(cornersInBounds, "meshlet bounding spheres contain every corner");
+
+	//the fan faces one way, so its cones are tight enough to cull with
+	bool conesFaceAway = true;
+	for (size_t i = 0; i < fanMeshlets.size(); i++)
+	{
+		conesFaceAway = conesFaceAway && std::abs(std::abs(fanMeshlets[i].cone.z) - 1.0f) < 0.0001f && fanMeshlets[i].cone.w < 0.0001f;
+	}
+	Check(conesFaceAway, "flat meshlets get a cone along their normal");
+
+	std::vector<uint16_t> emptyIndices;
+	std::vector<VulkanCommonFunctions::MeshletInfo> emptyMeshlets;
+	MeshletBuilder::Build(fanVertices, emptyIndices, 0, 0, emptyMeshlets);
+	Check(emptyMeshlets.empty(), "empty range builds no meshlets");
+}
+
+void SelfTest::TestAtlasPacker()
+{
+	const uint32_t pageSize = 256;
+	const uint32_t padding = 2;
+
+	AtlasPacker packer(pageSize, pageSize, padding);
+	AtlasPacker::Placement placement;
+
+	Check(!packer.Add(pageSize, 16, placement), "packer rejects a rectangle whose padding doesn't fit on a page");
+	Check(packer.Add(pageSize - padding * 2, pageSize - padding * 2, placement) && placement.x == padding && placement.y == padding, "packer fits a rectangle that fills a page with its padding");
+
+	//sizes like UI images, enough of them to spill over several pages
+	std::mt19937 random(7);
+	std::uniform_int_distribution<uint32_t> sizeDistribution(1, 96);
+
+	std::vector<AtlasPacker::Placement> placements;
+	std::vector<uint64_t> pageAreas(1, static_cast<uint64_t>(pageSize - padding * 2) * (pageSize - padding * 2));
+	bool everyRectangleFit = true;
+
+	for (int i = 0; i < 400; i++)
+	{
+		uint32_t width = sizeDistribution(random);
+		uint32_t height = sizeDistribution(random);
+
+		if (!packer.Add(width, height, placement))
+		{
+			everyRectangleFit = false;
+			continue;
+		}
+
+		everyRectangleFit = everyRectangleFit && placement.width == width && placement.height == height;
+		placements.push_back(placement);
+
+		pageAreas.resize(std::max<size_t>(pageAreas.size(), placement.page + 1), 0);
+		pageAreas[placement.page] += static_cast<uint64_t>(width) * height;
+	}
+
+	Check(everyRectangleFit, "packer places every rectangle that fits on a page at its size");
+	Check(packer.GetPageCount() > 2, "packer opens new pages when the others are full");
+
+	//the padding has to stay inside the page, filtering at the border would otherwise wrap or clamp into the image
+	bool inBounds = true;
+	for (size_t i = 0; i < placements.size(); i++)
+	{
+		const AtlasPacker::Placement& current = placements[i];
+		inBounds = inBounds && current.page < packer.GetPageCount() && current.x >= padding && current.y >= padding
+			&& current.x + current.width + padding <= pageSize && current.y + current.height + padding <= pageSize;
+	}
+	Check(inBounds, "packed rectangles and their padding stay inside the page");
+
+	//padded rectangles may touch but never overlap, so every image keeps its own border of padding
+	bool overlapping = false;
+	for (size_t i = 0; i < placements.size(); i++)
+	{
+		for (size_t j = i + 1; j < placements.size(); j++)
+		{
+			const AtlasPacker::Placement& a = placements[i];
+			const AtlasPacker::Placement& b = placements[j];
+
+			if (a.page != b.page)
+			{
+				continue;
+			}
+
+			bool separateX = a.x + a.width + padding <= b.x - padding || b.x + b.width + padding <= a.x - padding;
+			bool separateY = a.y + a.height + padding <= b.y - padding || b.y + b.height + padding <= a.y - padding;
+			overlapping = overlapping || (!separateX && !separateY);
+		}
+	}
+	Check(!overlapping, "packed rectangles and their padding never overlap");
+
+	bool occupancyMatches = true;
+	for (size_t page = 0; page < packer.GetPageCount(); page++)
+	{
+		double expected = static_cast<double>(pageAreas[page]) / (static_cast<double>(pageSize) * pageSize);
+		occupancyMatches = occupancyMatches && std::abs(packer.GetOccupancy(page) - expected) < 0.000001 && packer.GetOccupancy(page) <= 1.0;
+	}
+	Check(occupancyMatches, "page occupancy counts the packed rectangles without their padding");
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+//checks the cpu side containers and builders without a window or a device, run with --self-test
+//every check runs even after one fails so a single run lists all of them
+class SelfTest {
+public:
+	//returns true if every check passed
+	static bool Run();
+
+private:
+	static void TestHandlePool();
+	static void TestRenderSnapshotBuffer();
+	static void TestMeshletBuilder();
+	static void TestAtlasPacker();
+
+	static void Check(bool condition, const char* description);
+
+	static size_t s_checkCount;
+	static size_t s_failureCount;
+};
\ No newline at end of file
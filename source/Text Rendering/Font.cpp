@@ -71,6 +71,31 @@ void Font::LoadFontData()
 				}
 			}
 		}
+		else if (lineParts[0] == "distanceField")
+		{
+			//if starts with distanceField, the atlas stores distances instead of coverage
+			for (size_t i = 1; i < lineParts.size(); i++)
+			{
+				size_t equalPos = lineParts[i].find('=');
+				std::string variableName = lineParts[i].substr(0, equalPos);
+				std::string value = lineParts[i].substr(equalPos + 1);
+				if (variableName == "fieldType")
+				{
+					if (value == "msdf" || value == "mtsdf")
+					{
+						m_atlasType = AtlasType::MSDF;
+					}
+					else if (value == "sdf" || value == "psdf")
+					{
+						m_atlasType = AtlasType::SDF;
+					}
+				}
+				else if (variableName == "distanceRange")
+				{
+					m_distanceRange = std::stof(value);
+				}
+			}
+		}
 		else if (lineParts[0] == "char")
 		{
 			GlyphInfo newGlyph;
@@ -135,6 +160,12 @@ void Font::LoadFontData()
 		}
 	}
 
+	if (IsDistanceField() && m_distanceRange <= 0.0f)
+	{
+		std::cerr << "Warning: Distance field font has no distance range, defaulting to 4 pixels: " << m_fontDescriptionFilePath << std::endl;
+		m_distanceRange = 4.0f;
+	}
+
 	for (auto it = m_glyphMap.begin(); it != m_glyphMap.end(); it++)
 	{
 		it->second.scaleMultiplierX = it->second.width / maxWidth;
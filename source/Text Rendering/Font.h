@@ -9,9 +9,16 @@
 
 //generate fonts at: https://fonts.varg.dev/
 //font file/rendering documentation at: https://www.angelcode.com/products/bmfont/
+//distance field atlases (sdf/msdf) are detected from the "distanceField" line written by msdf-bmfont style generators
 
 class Font {
 public:
+	enum class AtlasType {
+		Bitmap,
+		SDF,
+		MSDF
+	};
+
 	struct GlyphInfo {
 		char character;
 
@@ -44,6 +51,13 @@ public:
 	float GetBaseHeight() { return m_baseHeight; }
 	float GetLineHeight() { return m_lineHeight; }
 
+	AtlasType GetAtlasType() { return m_atlasType; }
+	bool IsDistanceField() { return m_atlasType != AtlasType::Bitmap; }
+
+	//distance range of the atlas in pixels, the shader needs it in texture coordinates
+	float GetDistanceRange() { return m_distanceRange; }
+	glm::vec2 GetDistanceRangeUV() { return glm::vec2(m_distanceRange / m_fontAtlasTextureWidth, m_distanceRange / m_fontAtlasTextureHeight); }
+
 private:
 	void LoadFontData();
 	void SplitBySpace(const std::string& str, std::vector<std::string>& outTokens);
@@ -61,5 +75,8 @@ private:
 	float m_baseHeight = 0.0f;
 	float m_lineHeight = 0.0f;
 
+	AtlasType m_atlasType = AtlasType::Bitmap;
+	float m_distanceRange = 0.0f;
+
 	std::map<char, GlyphInfo> m_glyphMap;
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 std::shared_ptr<Font> FontManager::AddFont(std::string atlasFilePath, std::string descriptionFilePath)
 {
 	std::shared_ptr<Font> newFont = std::make_shared<Font>(atlasFilePath, descriptionFilePath);
+
+	std::lock_guard<std::mutex> lock(m_fontMutex);
 	m_fonts[newFont->GetFontName()] = newFont;
 
 	return newFont;
@@ -10,6 +12,8 @@ std::shared_ptr<Font> FontManager::AddFont(std::string atlasFilePath, std::strin
 
 std::shared_ptr<Font> FontManager::GetFontByName(const std::string& fontName)
 {
+	std::lock_guard<std::mutex> lock(m_fontMutex);
+
 	auto it = m_fonts.find(fontName);
 	if (it != m_fonts.end())
 	{
@@ -2,6 +2,8 @@
 
 #include "source/Text Rendering/Font.h"
 
+#include <mutex>
+
 class FontManager {
 public:
 	FontManager() {};
@@ -11,5 +13,7 @@ public:
 	std::shared_ptr<Font> GetFontByName(const std::string& fontName);
 
 private:
+	//fonts can be added from the simulation thread while the renderer looks them up
+	std::mutex m_fontMutex;
 	std::map<std::string, std::shared_ptr<Font>> m_fonts;
 };
\ No newline at end of file
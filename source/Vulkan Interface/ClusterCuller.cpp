@@ -0,0 +1,346 @@
+#include "ClusterCuller.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+ClusterCuller::ClusterCuller(ClusterCullerCreateInfo createInfo)
+{
+	m_framesInFlight = createInfo.framesInFlight;
+	m_allocator = createInfo.allocator;
+	m_device = createInfo.device;
+	m_commandPool = createInfo.commandPool;
+	m_graphicsQueue = createInfo.graphicsQueue;
+
+	CreateDescriptorSetLayout();
+	CreateDescriptorPool();
+	CreateFrameBuffers();
+
+	//the meshlet binding always needs a buffer behind it, even before the first mesh is added
+	AddMesh("", { VulkanCommonFunctions::MeshletInfo() });
+
+	CreateDescriptorSets();
+
+	ComputePipelineCreateInfo cullCreateInfo{};
+	cullCreateInfo.computeShaderFilePath = "shaders/HLSL/ClusterCullingComputeShader.spv";
+	cullCreateInfo.descriptorSetLayout = m_descriptorSetLayout;
+	cullCreateInfo.device = m_device;
+	cullCreateInfo.pushConstantSize = sizeof(CullConstants);
+
+	m_cullPipeline = std::make_shared<ComputePipeline>(cullCreateInfo);
+}
+
+bool ClusterCuller::IsSupported(VkPhysicalDevice physicalDevice)
+{
+	VkPhysicalDeviceFeatures features;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+
+	return features.multiDrawIndirect == VK_TRUE && features.drawIndirectFirstInstance == VK_TRUE;
+}
+
+void ClusterCuller::CreateDescriptorSetLayout()
+{
+	//binding numbers match the registers in ClusterCulling.hlsl
+	std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+
+	for (uint32_t i = 0; i < bindings.size(); i++)
+	{
+		bindings[i].binding = i;
+		bindings[i].descriptorCount = 1;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].pImmutableSamplers = nullptr;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create cluster culling descriptor set layout!");
+	}
+}
+
+void ClusterCuller::CreateDescriptorPool()
+{
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = m_framesInFlight * 3;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	poolInfo.maxSets = m_framesInFlight;
+
+	if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create cluster culling descriptor pool!");
+	}
+}
+
+void ClusterCuller::CreateFrameBuffers()
+{
+	GraphicsBuffer::BufferCreateInfo instanceBufferCreateInfo{};
+	instanceBufferCreateInfo.allocator = m_allocator;
+	instanceBufferCreateInfo.size = sizeof(CullInstance) * kMaxInstances;
+	instanceBufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	instanceBufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	instanceBufferCreateInfo.device = m_device;
+	instanceBufferCreateInfo.commandPool = m_commandPool;
+	instanceBufferCreateInfo.graphicsQueue = m_graphicsQueue;
+
+	//only ever written by the culling pass
+	GraphicsBuffer::BufferCreateInfo commandBufferCreateInfo = instanceBufferCreateInfo;
+	commandBufferCreateInfo.size = static_cast<VkDeviceSize>(kCommandStride) * kMaxCommands;
+	commandBufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+	commandBufferCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	m_instanceBuffers.resize(m_framesInFlight);
+	m_commandBuffers.resize(m_framesInFlight);
+
+	for (uint32_t i = 0; i < m_framesInFlight; i++)
+	{
+		m_instanceBuffers[i] = std::make_shared<GraphicsBuffer>(instanceBufferCreateInfo);
+		m_commandBuffers[i] = std::make_shared<GraphicsBuffer>(commandBufferCreateInfo);
+	}
+}
+
+void ClusterCuller::CreateDescriptorSets()
+{
+	std::vector<VkDescriptorSetLayout> layouts(m_framesInFlight, m_descriptorSetLayout);
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_descriptorPool;
+	allocInfo.descriptorSetCount = m_framesInFlight;
+	allocInfo.pSetLayouts = layouts.data();
+
+	m_descriptorSets.resize(m_framesInFlight);
+	if (vkAllocateDescriptorSets(m_device, &allocInfo, m_descriptorSets.data()) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate cluster culling descriptor sets!");
+	}
+
+	for (uint32_t i = 0; i < m_framesInFlight; i++)
+	{
+		VkDescriptorBufferInfo instanceInfo{};
+		instanceInfo.buffer = m_instanceBuffers[i]->GetVkBuffer();
+		instanceInfo.offset = 0;
+		instanceInfo.range = VK_WHOLE_SIZE;
+
+		VkDescriptorBufferInfo commandInfo{};
+		commandInfo.buffer = m_commandBuffers[i]->GetVkBuffer();
+		commandInfo.offset = 0;
+		commandInfo.range = VK_WHOLE_SIZE;
+
+		std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+
+		for (size_t j = 0; j < descriptorWrites.size(); j++)
+		{
+			descriptorWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[j].dstSet = m_descriptorSets[i];
+			descriptorWrites[j].dstArrayElement = 0;
+			descriptorWrites[j].descriptorCount = 1;
+			descriptorWrites[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+
+		descriptorWrites[0].dstBinding = 1;
+		descriptorWrites[0].pBufferInfo = &instanceInfo;
+
+		descriptorWrites[1].dstBinding = 2;
+		descriptorWrites[1].pBufferInfo = &commandInfo;
+
+		vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+	}
+
+	UpdateMeshletDescriptors();
+}
+
+void ClusterCuller::UpdateMeshletDescriptors()
+{
+	for (uint32_t i = 0; i < m_descriptorSets.size(); i++)
+	{
+		VkDescriptorBufferInfo meshletInfo{};
+		meshletInfo.buffer = m_meshletBuffer->GetVkBuffer();
+		meshletInfo.offset = 0;
+		meshletInfo.range = VK_WHOLE_SIZE;
+
+		VkWriteDescriptorSet descriptorWrite{};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = m_descriptorSets[i];
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.dstArrayElement = 0;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrite.pBufferInfo = &meshletInfo;
+
+		vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+	}
+}
+
+void ClusterCuller::AddMesh(const std::string& meshName, const std::vector<VulkanCommonFunctions::MeshletInfo>& meshlets)
+{
+	if (HasMesh(meshName) || meshlets.empty())
+	{
+		return;
+	}
+
+	size_t firstNewMeshlet = m_meshlets.size();
+
+	m_meshFirstMeshlets[meshName] = static_cast<uint32_t>(firstNewMeshlet);
+	m_meshlets.insert(m_meshlets.end(), meshlets.begin(), meshlets.end());
+
+	//while the meshlets fit only the new ones are uploaded, after the ones frames are already reading
+	bool growBuffer = m_meshlets.size() > m_meshletCapacity;
+	size_t firstUploadedMeshlet = growBuffer ? 0 : firstNewMeshlet;
+
+	VkDeviceSize uploadSize = sizeof(VulkanCommonFunctions::MeshletInfo) * (m_meshlets.size() - firstUploadedMeshlet);
+	VkDeviceSize uploadOffset = sizeof(VulkanCommonFunctions::MeshletInfo) * firstUploadedMeshlet;
+
+	GraphicsBuffer::BufferCreateInfo stagingBufferCreateInfo{};
+	stagingBufferCreateInfo.allocator = m_allocator;
+	stagingBufferCreateInfo.size = uploadSize;
+	stagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	stagingBufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	stagingBufferCreateInfo.device = m_device;
+	stagingBufferCreateInfo.commandPool = m_commandPool;
+	stagingBufferCreateInfo.graphicsQueue = m_graphicsQueue;
+
+	std::shared_ptr<GraphicsBuffer> stagingBuffer = std::make_shared<GraphicsBuffer>(stagingBufferCreateInfo);
+	stagingBuffer->LoadData(m_meshlets.data() + firstUploadedMeshlet, (size_t)uploadSize);
+
+	if (!growBuffer)
+	{
+		stagingBuffer->CopyBuffer(m_meshletBuffer, uploadSize, uploadOffset);
+		stagingBuffer->DestroyBuffer();
+		return;
+	}
+
+	m_meshletCapacity = std::max(m_meshlets.size(), m_meshletCapacity * 2);
+
+	GraphicsBuffer::BufferCreateInfo meshletBufferCreateInfo = stagingBufferCreateInfo;
+	meshletBufferCreateInfo.size = sizeof(VulkanCommonFunctions::MeshletInfo) * m_meshletCapacity;
+	meshletBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	meshletBufferCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	std::shared_ptr<GraphicsBuffer> meshletBuffer = std::make_shared<GraphicsBuffer>(meshletBufferCreateInfo);
+
+	//the copy waits for the queue to go idle, so no frame still reads the old buffer after it
+	stagingBuffer->CopyBuffer(meshletBuffer, uploadSize);
+	stagingBuffer->DestroyBuffer();
+
+	if (m_meshletBuffer != nullptr)
+	{
+		m_meshletBuffer->DestroyBuffer();
+	}
+
+	m_meshletBuffer = meshletBuffer;
+
+	UpdateMeshletDescriptors();
+}
+
+void ClusterCuller::BeginFrame(uint32_t frameIndex)
+{
+	m_currentFrame = frameIndex;
+	m_instances.clear();
+	m_commandCount = 0;
+}
+
+uint32_t ClusterCuller::AddInstance(const std::string& meshName, const VulkanCommonFunctions::LodLevel& level, const VulkanCommonFunctions::InstanceInfo& instance, uint32_t instanceIndex, glm::vec3 cameraPosition)
+{
+	auto mesh = m_meshFirstMeshlets.find(meshName);
+
+	if (mesh == m_meshFirstMeshlets.end() || level.meshletCount == 0 || m_instances.size() >= kMaxInstances || m_commandCount + level.meshletCount > kMaxCommands)
+	{
+		return UINT32_MAX;
+	}
+
+	CullInstance cullInstance{};
+	cullInstance.modelMatrix = instance.modelMatrix;
+	cullInstance.firstMeshlet = mesh->second + level.firstMeshlet;
+	cullInstance.meshletCount = level.meshletCount;
+	cullInstance.instanceIndex = instanceIndex;
+	cullInstance.firstCommand = m_commandCount;
+
+	float largestScale = std::max(instance.scale.x, std::max(instance.scale.y, instance.scale.z));
+	float smallestScale = std::min(instance.scale.x, std::min(instance.scale.y, instance.scale.z));
+
+	cullInstance.cameraPosition = glm::vec4(glm::vec3(instance.modelMatrixInverse * glm::vec4(cameraPosition, 1.0f)), largestScale);
+
+	//billboards face the camera no matter what their model matrix says, and stretching a mesh bends its normal cones
+	if ((instance.materialVariant & VulkanCommonFunctions::MATERIAL_VARIANT_BILLBOARDED) != 0)
+	{
+		cullInstance.cullMode = 0;
+	}
+	else if (largestScale - smallestScale > largestScale * 0.001f)
+	{
+		cullInstance.cullMode = 1;
+	}
+	else {
+		cullInstance.cullMode = 2;
+	}
+
+	m_instances.push_back(cullInstance);
+
+	uint32_t firstCommand = m_commandCount;
+	m_commandCount += level.meshletCount;
+
+	return firstCommand;
+}
+
+void ClusterCuller::RecordCulling(VkCommandBuffer commandBuffer, const glm::mat4& viewProjection)
+{
+	if (m_instances.empty())
+	{
+		return;
+	}
+
+	m_instanceBuffers[m_currentFrame]->LoadData(m_instances.data(), sizeof(CullInstance) * m_instances.size());
+
+	//planes point into the frustum, taken from the rows of the matrix with a 0 to 1 depth range
+	CullConstants constants{};
+	glm::mat4 rows = glm::transpose(viewProjection);
+
+	constants.frustumPlanes[0] = rows[3] + rows[0];
+	constants.frustumPlanes[1] = rows[3] - rows[0];
+	constants.frustumPlanes[2] = rows[3] + rows[1];
+	constants.frustumPlanes[3] = rows[3] - rows[1];
+	constants.frustumPlanes[4] = rows[2];
+	constants.frustumPlanes[5] = rows[3] - rows[2];
+
+	for (int i = 0; i < 6; i++)
+	{
+		constants.frustumPlanes[i] /= glm::length(glm::vec3(constants.frustumPlanes[i]));
+	}
+
+	constants.instanceCount = static_cast<uint32_t>(m_instances.size());
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline->GetVkPipeline());
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline->GetVkPipelineLayout(), 0, 1, &m_descriptorSets[m_currentFrame], 0, nullptr);
+	vkCmdPushConstants(commandBuffer, m_cullPipeline->GetVkPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &constants);
+
+	//one group per instance, its threads stride over the instance's clusters
+	vkCmdDispatch(commandBuffer, constants.instanceCount, 1, 1);
+
+	//each frame in flight has its own commands, so only the draws after this have to wait for them
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void ClusterCuller::Destroy()
+{
+	m_cullPipeline->DestroyPipeline();
+
+	vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, nullptr);
+
+	m_meshletBuffer->DestroyBuffer();
+
+	for (uint32_t i = 0; i < m_framesInFlight; i++)
+	{
+		m_instanceBuffers[i]->DestroyBuffer();
+		m_commandBuffers[i]->DestroyBuffer();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+#include "source/Vulkan Interface/GraphicsBuffer.h"
+#include "source/Vulkan Interface/ComputePipeline.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//culls the clusters of meshes split into meshlets against the view frustum and their normal cones in a compute pass
+//every instance gets one indirect draw per cluster of its level, the ones that can't be seen are written with no instances
+class ClusterCuller {
+public:
+	struct ClusterCullerCreateInfo {
+		uint32_t framesInFlight;
+
+		VmaAllocator allocator;
+		VkDevice device;
+		VkCommandPool commandPool;
+		VkQueue graphicsQueue;
+	};
+
+	ClusterCuller(ClusterCullerCreateInfo createInfo);
+
+	//several draws per indirect call, and draws that start past the first instance
+	static bool IsSupported(VkPhysicalDevice physicalDevice);
+
+	//uploads the mesh's meshlets next to the ones already added, waits for the queue so it has to run between frames
+	//the buffer grows geometrically, so it is only reallocated when the meshlets no longer fit
+	void AddMesh(const std::string& meshName, const std::vector<VulkanCommonFunctions::MeshletInfo>& meshlets);
+	bool HasMesh(const std::string& meshName) { return m_meshFirstMeshlets.contains(meshName); }
+
+	void BeginFrame(uint32_t frameIndex);
+
+	//queues the clusters of one level for culling, instanceIndex is where the instance sits in the mesh's instance buffer
+	//returns the first of the level's meshletCount commands, or UINT32_MAX when the frame's command buffer is full
+	uint32_t AddInstance(const std::string& meshName, const VulkanCommonFunctions::LodLevel& level, const VulkanCommonFunctions::InstanceInfo& instance, uint32_t instanceIndex, glm::vec3 cameraPosition);
+
+	//recorded outside of any render pass, before the draws that read the commands
+	void RecordCulling(VkCommandBuffer commandBuffer, const glm::mat4& viewProjection);
+
+	VkBuffer GetCommandBuffer() { return m_commandBuffers[m_currentFrame]->GetVkBuffer(); }
+	static constexpr uint32_t kCommandStride = sizeof(VkDrawIndexedIndirectCommand);
+
+	void Destroy();
+
+	//devices with multi draw indirect allow at least this many draws per call
+	static constexpr uint32_t kMaxCommands = 65535;
+	static constexpr uint32_t kMaxInstances = 4096;
+
+private:
+	//matches CullInstance in ClusterCulling.hlsl
+	struct alignas(16) CullInstance {
+		glm::mat4 modelMatrix;
+
+		//xyz the camera in the mesh's own space, w the largest scale
+		glm::vec4 cameraPosition;
+
+		uint32_t firstMeshlet;
+		uint32_t meshletCount;
+		uint32_t instanceIndex;
+		uint32_t firstCommand;
+
+		//0 draws every cluster, 1 tests the frustum, 2 also tests the normal cone
+		uint32_t cullMode;
+		uint32_t padding[3];
+	};
+
+	struct CullConstants {
+		glm::vec4 frustumPlanes[6];
+		uint32_t instanceCount;
+	};
+
+	void CreateDescriptorSetLayout();
+	void CreateDescriptorPool();
+	void CreateDescriptorSets();
+	void CreateFrameBuffers();
+	void UpdateMeshletDescriptors();
+
+	uint32_t m_framesInFlight;
+	uint32_t m_currentFrame = 0;
+
+	std::vector<VulkanCommonFunctions::MeshletInfo> m_meshlets;
+	std::map<std::string, uint32_t> m_meshFirstMeshlets;
+	std::shared_ptr<GraphicsBuffer> m_meshletBuffer;
+	size_t m_meshletCapacity = 0;
+
+	std::vector<CullInstance> m_instances;
+	uint32_t m_commandCount = 0;
+
+	std::vector<std::shared_ptr<GraphicsBuffer>> m_instanceBuffers;
+	std::vector<std::shared_ptr<GraphicsBuffer>> m_commandBuffers;
+
+	VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+	std::vector<VkDescriptorSet> m_descriptorSets;
+
+	std::shared_ptr<ComputePipeline> m_cullPipeline;
+
+	VmaAllocator m_allocator;
+	VkDevice m_device;
+	VkCommandPool m_commandPool;
+	VkQueue m_graphicsQueue;
+};
\ No newline at end of file
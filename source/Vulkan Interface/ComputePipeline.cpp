@@ -0,0 +1,79 @@
+#include "ComputePipeline.h"
+
+#include <stdexcept>
+
+ComputePipeline::ComputePipeline(ComputePipelineCreateInfo pipelineCreateInfo)
+{
+	m_computeShaderFilePath = pipelineCreateInfo.computeShaderFilePath;
+	m_descriptorSetLayout = pipelineCreateInfo.descriptorSetLayout;
+	m_device = pipelineCreateInfo.device;
+	m_pushConstantSize = pipelineCreateInfo.pushConstantSize;
+	CreatePipeline();
+}
+
+void ComputePipeline::CreatePipeline()
+{
+    if (m_computePipeline != VK_NULL_HANDLE || m_pipelineLayout != VK_NULL_HANDLE)
+    {
+        DestroyPipeline();
+    }
+
+    CreatePipelineLayout();
+
+    auto computeShaderCode = VulkanCommonFunctions::ReadShaderFile(m_computeShaderFilePath);
+    VkShaderModule computeShaderModule = VulkanCommonFunctions::CreateShaderModule(m_device, computeShaderCode);
+
+    VkPipelineShaderStageCreateInfo computeShaderStageInfo{};
+    computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeShaderStageInfo.module = computeShaderModule;
+    computeShaderStageInfo.pName = "CSMain";
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = computeShaderStageInfo;
+    pipelineInfo.layout = m_pipelineLayout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    if (vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_computePipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create compute pipeline!");
+    }
+
+    vkDestroyShaderModule(m_device, computeShaderModule, nullptr);
+}
+
+void ComputePipeline::CreatePipelineLayout()
+{
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = (m_descriptorSetLayout != VK_NULL_HANDLE) ? 1 : 0;
+    pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = m_pushConstantSize;
+
+    pipelineLayoutInfo.pushConstantRangeCount = (m_pushConstantSize > 0) ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = (m_pushConstantSize > 0) ? &pushConstantRange : nullptr;
+
+    if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+}
+
+void ComputePipeline::DestroyPipeline()
+{
+    if (m_computePipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(m_device, m_computePipeline, nullptr);
+        m_computePipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_pipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
+    }
+}
\ No newline at end of file
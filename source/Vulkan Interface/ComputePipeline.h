@@ -0,0 +1,39 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <string>
+
+struct ComputePipelineCreateInfo {
+	std::string computeShaderFilePath;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDevice device;
+
+	//size of the compute stage push constant block, 0 for none
+	uint32_t pushConstantSize = 0;
+};
+
+class ComputePipeline {
+public:
+	ComputePipeline(ComputePipelineCreateInfo pipelineCreateInfo);
+
+	void CreatePipeline();
+	void DestroyPipeline();
+
+	void SetDescriptorSetLayout(VkDescriptorSetLayout descriptorSetLayout) { m_descriptorSetLayout = descriptorSetLayout; }
+
+	VkPipeline GetVkPipeline() { return m_computePipeline; }
+	VkPipelineLayout GetVkPipelineLayout() { return m_pipelineLayout; }
+
+private:
+	void CreatePipelineLayout();
+
+	VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+	VkPipeline m_computePipeline = VK_NULL_HANDLE;
+	VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+	VkDevice m_device = VK_NULL_HANDLE;
+
+	std::string m_computeShaderFilePath;
+
+	uint32_t m_pushConstantSize = 0;
+};
\ No newline at end of file
@@ -0,0 +1,555 @@
+#include "DeferredRenderer.h"
+#include "source/Vulkan Interface/VulkanWindow.h"
+#include "source/Vulkan Interface/ShaderReflection.h"
+
+DeferredRenderer::DeferredRenderer(DeferredRendererCreateInfo createInfo)
+{
+	m_framesInFlight = createInfo.framesInFlight;
+	m_depthFormat = createInfo.depthFormat;
+	m_frameRing = createInfo.frameRing;
+	m_lightInfoBufferSize = createInfo.lightInfoBufferSize;
+	m_shadowAtlas = createInfo.shadowAtlas;
+	m_allocator = createInfo.allocator;
+	m_device = createInfo.device;
+	m_commandPool = createInfo.commandPool;
+	m_graphicsQueue = createInfo.graphicsQueue;
+	m_vulkanWindow = createInfo.vulkanWindow;
+
+	CreateRenderPass();
+	CreateDescriptorSetLayout();
+	CreateDescriptorPool();
+	CreateDeferredInfoBuffers();
+	CreateDescriptorSets();
+	CreatePipelines();
+}
+
+bool DeferredRenderer::IsSupported(VkPhysicalDevice physicalDevice)
+{
+	const VkFormatFeatureFlags targetFeatures = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+
+	std::array<std::pair<VkFormat, VkFormatFeatureFlags>, 5> requirements = { {
+		{ kAlbedoFormat, targetFeatures },
+		{ kAmbientFormat, targetFeatures },
+		{ kNormalFormat, targetFeatures },
+		{ kSpecularFormat, targetFeatures },
+		{ kLitFormat, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT }
+	} };
+
+	for (size_t i = 0; i < requirements.size(); i++)
+	{
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, requirements[i].first, &properties);
+
+		if ((properties.optimalTilingFeatures & requirements[i].second) != requirements[i].second)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void DeferredRenderer::CreateRenderPass()
+{
+	std::array<VkFormat, TargetCount> targetFormats = { kAlbedoFormat, kAmbientFormat, kNormalFormat, kSpecularFormat };
+	std::array<VkAttachmentDescription, TargetCount + 1> attachments{};
+	std::array<VkAttachmentReference, TargetCount> colorAttachmentReferences{};
+
+	for (uint32_t i = 0; i < TargetCount; i++)
+	{
+		attachments[i].format = targetFormats[i];
+		attachments[i].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachments[i].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachments[i].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		attachments[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[i].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachments[i].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		colorAttachmentReferences[i].attachment = i;
+		colorAttachmentReferences[i].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	}
+
+	VkAttachmentDescription& depthAttachment = attachments[TargetCount];
+	depthAttachment.format = m_depthFormat;
+	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkAttachmentReference depthAttachmentReference{};
+	depthAttachmentReference.attachment = TargetCount;
+	depthAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentReferences.size());
+	subpass.pColorAttachments = colorAttachmentReferences.data();
+	subpass.pDepthStencilAttachment = &depthAttachmentReference;
+
+	std::array<VkSubpassDependency, 2> dependencies{};
+
+	//the previous frame's lighting and composite passes read the targets before they are cleared
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	//and this frame's read what was just written
+	dependencies[1].srcSubpass = 0;
+	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	VkRenderPassCreateInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	renderPassInfo.pAttachments = attachments.data();
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+	renderPassInfo.pDependencies = dependencies.data();
+
+	if (vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_gBufferRenderPass) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create g-buffer render pass!");
+	}
+}
+
+void DeferredRenderer::CreateDescriptorSetLayout()
+{
+	//reflected from the lighting and composite shaders, 0 to 4 are the same resources the forward pipelines use, so Lighting.hlsli works in both
+	std::vector<VkDescriptorSetLayoutBinding> bindings = ShaderReflection::GetLayoutBindings({ kLightingComputeShaderFilePath, kCompositeVertexShaderFilePath, kCompositePixelShaderFilePath });
+
+	//the global, light and shadow info are bound at this frame's offset in the ring
+	ShaderReflection::SetDynamic(bindings, 0);
+	ShaderReflection::SetDynamic(bindings, 1);
+	ShaderReflection::SetDynamic(bindings, 3);
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create deferred descriptor set layout!");
+	}
+}
+
+void DeferredRenderer::CreateDescriptorPool()
+{
+	std::array<VkDescriptorPoolSize, 6> poolSizes{};
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSizes[0].descriptorCount = m_framesInFlight;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[1].descriptorCount = m_framesInFlight;
+	poolSizes[2].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	poolSizes[2].descriptorCount = m_framesInFlight * (TargetCount + 2);
+	poolSizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	poolSizes[3].descriptorCount = m_framesInFlight;
+	poolSizes[4].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	poolSizes[4].descriptorCount = m_framesInFlight;
+	poolSizes[5].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	poolSizes[5].descriptorCount = m_framesInFlight * 2;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolInfo.maxSets = m_framesInFlight;
+
+	if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create deferred descriptor pool!");
+	}
+}
+
+void DeferredRenderer::CreateDeferredInfoBuffers()
+{
+	GraphicsBuffer::BufferCreateInfo bufferCreateInfo{};
+	bufferCreateInfo.allocator = m_allocator;
+	bufferCreateInfo.size = sizeof(VulkanCommonFunctions::DeferredInfo);
+	bufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+	bufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	bufferCreateInfo.device = m_device;
+	bufferCreateInfo.commandPool = m_commandPool;
+	bufferCreateInfo.graphicsQueue = m_graphicsQueue;
+
+	m_deferredInfoBuffers.resize(m_framesInFlight);
+
+	for (uint32_t i = 0; i < m_framesInFlight; i++)
+	{
+		m_deferredInfoBuffers[i] = std::make_shared<GraphicsBuffer>(bufferCreateInfo);
+	}
+}
+
+void DeferredRenderer::CreateDescriptorSets()
+{
+	std::vector<VkDescriptorSetLayout> layouts(m_framesInFlight, m_descriptorSetLayout);
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_descriptorPool;
+	allocInfo.descriptorSetCount = m_framesInFlight;
+	allocInfo.pSetLayouts = layouts.data();
+
+	m_descriptorSets.resize(m_framesInFlight);
+	if (vkAllocateDescriptorSets(m_device, &allocInfo, m_descriptorSets.data()) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate deferred descriptor sets!");
+	}
+
+	//the ring's buffer is written again when it grows, the images once the swap chain size is known
+	for (uint32_t i = 0; i < m_framesInFlight; i++)
+	{
+		VkDescriptorImageInfo shadowAtlasInfo{};
+		shadowAtlasInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		shadowAtlasInfo.imageView = m_shadowAtlas->GetImageView();
+		shadowAtlasInfo.sampler = m_shadowAtlas->GetSampler();
+
+		VkDescriptorBufferInfo deferredInfo{};
+		deferredInfo.buffer = m_deferredInfoBuffers[i]->GetVkBuffer();
+		deferredInfo.offset = 0;
+		deferredInfo.range = sizeof(VulkanCommonFunctions::DeferredInfo);
+
+		std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+
+		for (size_t j = 0; j < descriptorWrites.size(); j++)
+		{
+			descriptorWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[j].dstSet = m_descriptorSets[i];
+			descriptorWrites[j].dstArrayElement = 0;
+			descriptorWrites[j].descriptorCount = 1;
+		}
+
+		descriptorWrites[0].dstBinding = 4;
+		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descriptorWrites[0].pImageInfo = &shadowAtlasInfo;
+
+		descriptorWrites[1].dstBinding = 12;
+		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		descriptorWrites[1].pBufferInfo = &deferredInfo;
+
+		vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+		UpdateFrameRingDescriptors(i);
+	}
+}
+
+void DeferredRenderer::UpdateFrameRingDescriptors(uint32_t frameIndex)
+{
+	VkDescriptorBufferInfo globalInfo{};
+	globalInfo.buffer = m_frameRing->GetBuffer()->GetVkBuffer();
+	globalInfo.offset = 0;
+	globalInfo.range = sizeof(VulkanCommonFunctions::GlobalInfo);
+
+	VkDescriptorBufferInfo lightInfo{};
+	lightInfo.buffer = m_frameRing->GetBuffer()->GetVkBuffer();
+	lightInfo.offset = 0;
+	lightInfo.range = m_lightInfoBufferSize;
+
+	VkDescriptorBufferInfo shadowInfo{};
+	shadowInfo.buffer = m_frameRing->GetBuffer()->GetVkBuffer();
+	shadowInfo.offset = 0;
+	shadowInfo.range = m_shadowAtlas->GetShadowInfoBufferSize();
+
+	std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+
+	for (size_t i = 0; i < descriptorWrites.size(); i++)
+	{
+		descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[i].dstSet = m_descriptorSets[frameIndex];
+		descriptorWrites[i].dstArrayElement = 0;
+		descriptorWrites[i].descriptorCount = 1;
+	}
+
+	descriptorWrites[0].dstBinding = 0;
+	descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	descriptorWrites[0].pBufferInfo = &globalInfo;
+
+	descriptorWrites[1].dstBinding = 1;
+	descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	descriptorWrites[1].pBufferInfo = &lightInfo;
+
+	descriptorWrites[2].dstBinding = 3;
+	descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	descriptorWrites[2].pBufferInfo = &shadowInfo;
+
+	vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void DeferredRenderer::CreatePipelines()
+{
+	ComputePipelineCreateInfo lightingCreateInfo{};
+	lightingCreateInfo.computeShaderFilePath = kLightingComputeShaderFilePath;
+	lightingCreateInfo.descriptorSetLayout = m_descriptorSetLayout;
+	lightingCreateInfo.device = m_device;
+
+	m_lightingPipeline = std::make_shared<ComputePipeline>(lightingCreateInfo);
+
+	//the composite writes depth for every covered pixel so it always passes the test
+	GraphicsPipelineCreateInfo compositeCreateInfo{};
+	compositeCreateInfo.vertexShaderFilePath = kCompositeVertexShaderFilePath;
+	compositeCreateInfo.fragmentShaderFilePath = kCompositePixelShaderFilePath;
+	compositeCreateInfo.descriptorSetLayout = m_descriptorSetLayout;
+	compositeCreateInfo.device = m_device;
+	compositeCreateInfo.vulkanWindow = m_vulkanWindow;
+	compositeCreateInfo.uiBasedPipeline = false;
+	compositeCreateInfo.cullMode = VK_CULL_MODE_NONE;
+	compositeCreateInfo.noVertexInput = true;
+	compositeCreateInfo.blendEnable = false;
+	compositeCreateInfo.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+
+	m_compositePipeline = std::make_shared<GraphicsPipeline>(compositeCreateInfo);
+}
+
+std::shared_ptr<GraphicsImage> DeferredRenderer::CreateTarget(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect)
+{
+	GraphicsImage::GraphicsImageCreateInfo imageCreateInfo{};
+	imageCreateInfo.imageSize = { m_width, m_height };
+	imageCreateInfo.format = format;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.usage = usage;
+	imageCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	imageCreateInfo.allocator = m_allocator;
+	imageCreateInfo.device = m_device;
+	imageCreateInfo.commandPool = m_commandPool;
+	imageCreateInfo.graphicsQueue = m_graphicsQueue;
+
+	std::shared_ptr<GraphicsImage> image = std::make_shared<GraphicsImage>(imageCreateInfo);
+	image->CreateImageView(aspect);
+
+	return image;
+}
+
+void DeferredRenderer::CreateSizeDependentResources(uint32_t width, uint32_t height)
+{
+	m_width = width;
+	m_height = height;
+
+	std::array<VkFormat, TargetCount> targetFormats = { kAlbedoFormat, kAmbientFormat, kNormalFormat, kSpecularFormat };
+
+	for (uint32_t i = 0; i < TargetCount; i++)
+	{
+		m_targets[i] = CreateTarget(targetFormats[i], VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	}
+
+	m_depthImage = CreateTarget(m_depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+	//the lit image stays in the general layout, compute writes it and the composite samples it
+	m_litImage = CreateTarget(kLitFormat, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	m_litImage->TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+
+	std::array<VkImageView, TargetCount + 1> attachments;
+	for (uint32_t i = 0; i < TargetCount; i++)
+	{
+		attachments[i] = m_targets[i]->GetImageView();
+	}
+	attachments[TargetCount] = m_depthImage->GetImageView();
+
+	VkFramebufferCreateInfo framebufferInfo{};
+	framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebufferInfo.renderPass = m_gBufferRenderPass;
+	framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	framebufferInfo.pAttachments = attachments.data();
+	framebufferInfo.width = m_width;
+	framebufferInfo.height = m_height;
+	framebufferInfo.layers = 1;
+
+	if (vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &m_gBufferFramebuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create g-buffer framebuffer!");
+	}
+
+	UpdateDescriptorSets();
+}
+
+void DeferredRenderer::UpdateDescriptorSets()
+{
+	std::array<VkDescriptorImageInfo, TargetCount + 1> gBufferInfos{};
+	for (uint32_t i = 0; i < TargetCount; i++)
+	{
+		gBufferInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		gBufferInfos[i].imageView = m_targets[i]->GetImageView();
+		gBufferInfos[i].sampler = VK_NULL_HANDLE;
+	}
+
+	gBufferInfos[TargetCount].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	gBufferInfos[TargetCount].imageView = m_depthImage->GetImageView();
+	gBufferInfos[TargetCount].sampler = VK_NULL_HANDLE;
+
+	VkDescriptorImageInfo litImageInfo{};
+	litImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	litImageInfo.imageView = m_litImage->GetImageView();
+	litImageInfo.sampler = VK_NULL_HANDLE;
+
+	for (uint32_t i = 0; i < m_framesInFlight; i++)
+	{
+		std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+
+		//albedo, ambient, normal, specular and depth sit in consecutive bindings
+		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[0].dstSet = m_descriptorSets[i];
+		descriptorWrites[0].dstBinding = 5;
+		descriptorWrites[0].dstArrayElement = 0;
+		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		descriptorWrites[0].descriptorCount = static_cast<uint32_t>(gBufferInfos.size());
+		descriptorWrites[0].pImageInfo = gBufferInfos.data();
+
+		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[1].dstSet = m_descriptorSets[i];
+		descriptorWrites[1].dstBinding = 10;
+		descriptorWrites[1].dstArrayElement = 0;
+		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		descriptorWrites[1].descriptorCount = 1;
+		descriptorWrites[1].pImageInfo = &litImageInfo;
+
+		descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[2].dstSet = m_descriptorSets[i];
+		descriptorWrites[2].dstBinding = 11;
+		descriptorWrites[2].dstArrayElement = 0;
+		descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		descriptorWrites[2].descriptorCount = 1;
+		descriptorWrites[2].pImageInfo = &litImageInfo;
+
+		vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+	}
+}
+
+void DeferredRenderer::DestroySizeDependentResources()
+{
+	if (m_gBufferFramebuffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	vkDestroyFramebuffer(m_device, m_gBufferFramebuffer, nullptr);
+	m_gBufferFramebuffer = VK_NULL_HANDLE;
+
+	for (uint32_t i = 0; i < TargetCount; i++)
+	{
+		m_targets[i]->DestroyImage();
+		m_targets[i] = nullptr;
+	}
+
+	m_depthImage->DestroyImage();
+	m_depthImage = nullptr;
+
+	m_litImage->DestroyImage();
+	m_litImage = nullptr;
+}
+
+void DeferredRenderer::BeginGBufferPass(VkCommandBuffer commandBuffer, VkSubpassContents contents)
+{
+	std::array<VkClearValue, TargetCount + 1> clearValues{};
+	for (uint32_t i = 0; i < TargetCount; i++)
+	{
+		clearValues[i].color = { {0.0f, 0.0f, 0.0f, 0.0f} };
+	}
+	clearValues[TargetCount].depthStencil = { 1.0f, 0 };
+
+	VkRenderPassBeginInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = m_gBufferRenderPass;
+	renderPassInfo.framebuffer = m_gBufferFramebuffer;
+	renderPassInfo.renderArea.offset = { 0, 0 };
+	renderPassInfo.renderArea.extent = { m_width, m_height };
+	renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+	renderPassInfo.pClearValues = clearValues.data();
+
+	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+
+	if (contents == VK_SUBPASS_CONTENTS_INLINE)
+	{
+		SetGBufferViewport(commandBuffer);
+	}
+}
+
+void DeferredRenderer::SetGBufferViewport(VkCommandBuffer commandBuffer)
+{
+	VkViewport viewport{};
+	viewport.x = 0.0f;
+	viewport.y = 0.0f;
+	viewport.width = static_cast<float>(m_width);
+	viewport.height = static_cast<float>(m_height);
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+	VkRect2D scissor{};
+	scissor.offset = { 0, 0 };
+	scissor.extent = { m_width, m_height };
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void DeferredRenderer::EndGBufferPass(VkCommandBuffer commandBuffer)
+{
+	vkCmdEndRenderPass(commandBuffer);
+}
+
+void DeferredRenderer::RecordLightingPass(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t globalInfoOffset, uint32_t lightInfoOffset, uint32_t shadowInfoOffset, const glm::mat4& view, const glm::mat4& projection)
+{
+	VulkanCommonFunctions::DeferredInfo deferredInfo{};
+	deferredInfo.inverseView = glm::inverse(view);
+	deferredInfo.inverseProjection = glm::inverse(projection);
+	deferredInfo.screenWidth = m_width;
+	deferredInfo.screenHeight = m_height;
+
+	m_deferredInfoBuffers[frameIndex]->LoadData(&deferredInfo, sizeof(deferredInfo));
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = m_litImage->GetVkImage();
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	//the previous frame's composite has to finish reading before the image is overwritten
+	barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_lightingPipeline->GetVkPipeline());
+	std::array<uint32_t, 3> dynamicOffsets = { globalInfoOffset, lightInfoOffset, shadowInfoOffset };
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_lightingPipeline->GetVkPipelineLayout(), 0, 1, &m_descriptorSets[frameIndex], static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+	vkCmdDispatch(commandBuffer, (m_width + kTileSize - 1) / kTileSize, (m_height + kTileSize - 1) / kTileSize, 1);
+
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void DeferredRenderer::DrawComposite(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t globalInfoOffset, uint32_t lightInfoOffset, uint32_t shadowInfoOffset)
+{
+	std::array<uint32_t, 3> dynamicOffsets = { globalInfoOffset, lightInfoOffset, shadowInfoOffset };
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_compositePipeline->GetVkPipeline());
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_compositePipeline->GetVkPipelineLayout(), 0, 1, &m_descriptorSets[frameIndex], static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+	vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+}
+
+void DeferredRenderer::Destroy()
+{
+	DestroySizeDependentResources();
+
+	m_lightingPipeline->DestroyPipeline();
+	m_compositePipeline->DestroyPipeline();
+
+	vkDestroyRenderPass(m_device, m_gBufferRenderPass, nullptr);
+
+	vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, nullptr);
+
+	for (size_t i = 0; i < m_deferredInfoBuffers.size(); i++)
+	{
+		m_deferredInfoBuffers[i]->DestroyBuffer();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+#include "source/Vulkan Interface/GraphicsBuffer.h"
+#include "source/Vulkan Interface/GraphicsImage.h"
+#include "source/Vulkan Interface/GraphicsPipeline.h"
+#include "source/Vulkan Interface/ComputePipeline.h"
+#include "source/Vulkan Interface/ShadowAtlas.h"
+#include "source/Vulkan Interface/FrameRingBuffer.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+class VulkanWindow;
+
+//opaque objects write their material into a g-buffer, a tiled compute pass lights it and the result is copied into the window's pass
+//lighting then costs one evaluation per visible pixel per nearby light, no matter how many objects overlap
+class DeferredRenderer {
+public:
+	struct DeferredRendererCreateInfo {
+		uint32_t framesInFlight;
+
+		//has to be sampleable, the lighting pass rebuilds positions from it
+		VkFormat depthFormat;
+
+		//shared with the forward pipelines so both paths light from the same data, the globals and lights are in the frame ring
+		std::shared_ptr<FrameRingBuffer> frameRing;
+		VkDeviceSize lightInfoBufferSize;
+		std::shared_ptr<ShadowAtlas> shadowAtlas;
+
+		VmaAllocator allocator;
+		VkDevice device;
+		VkCommandPool commandPool;
+		VkQueue graphicsQueue;
+		VulkanWindow* vulkanWindow;
+	};
+
+	DeferredRenderer(DeferredRendererCreateInfo createInfo);
+
+	//every g-buffer format has to be renderable and sampleable, and the lit image has to be writable from compute
+	static bool IsSupported(VkPhysicalDevice physicalDevice);
+
+	//the g-buffer follows the swap chain size, call again after the swap chain is recreated
+	void CreateSizeDependentResources(uint32_t width, uint32_t height);
+	void DestroySizeDependentResources();
+
+	VkRenderPass GetGBufferRenderPass() { return m_gBufferRenderPass; }
+	VkFramebuffer GetGBufferFramebuffer() { return m_gBufferFramebuffer; }
+
+	//with secondary contents the viewport is left to the secondaries, they set it with SetGBufferViewport
+	void BeginGBufferPass(VkCommandBuffer commandBuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+	void SetGBufferViewport(VkCommandBuffer commandBuffer);
+	void EndGBufferPass(VkCommandBuffer commandBuffer);
+
+	//points the frame's set at the ring's current buffer, only while the frame isn't in flight
+	void UpdateFrameRingDescriptors(uint32_t frameIndex);
+
+	//recorded outside of any render pass, after the g-buffer pass and before the window's pass
+	void RecordLightingPass(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t globalInfoOffset, uint32_t lightInfoOffset, uint32_t shadowInfoOffset, const glm::mat4& view, const glm::mat4& projection);
+
+	//draws the lit image and the g-buffer depth into the window's pass, transparent objects go on top of it
+	void DrawComposite(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t globalInfoOffset, uint32_t lightInfoOffset, uint32_t shadowInfoOffset);
+
+	void Destroy();
+
+	static constexpr uint32_t kTileSize = 16;
+
+private:
+	enum GBufferTarget {
+		Albedo = 0,
+		Ambient,
+		Normal,
+		Specular,
+		TargetCount
+	};
+
+	void CreateRenderPass();
+	void CreateDescriptorSetLayout();
+	void CreateDescriptorPool();
+	void CreateDescriptorSets();
+	void CreateDeferredInfoBuffers();
+	void CreatePipelines();
+
+	std::shared_ptr<GraphicsImage> CreateTarget(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect);
+	void UpdateDescriptorSets();
+
+	static constexpr VkFormat kAlbedoFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	static constexpr VkFormat kAmbientFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	static constexpr VkFormat kNormalFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	static constexpr VkFormat kSpecularFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	static constexpr VkFormat kLitFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+	static constexpr const char* kLightingComputeShaderFilePath = "shaders/HLSL/DeferredLightingComputeShader.spv";
+	static constexpr const char* kCompositeVertexShaderFilePath = "shaders/HLSL/DeferredVertexShader.spv";
+	static constexpr const char* kCompositePixelShaderFilePath = "shaders/HLSL/DeferredPixelShader.spv";
+
+	uint32_t m_framesInFlight;
+	VkFormat m_depthFormat;
+
+	uint32_t m_width = 0;
+	uint32_t m_height = 0;
+
+	std::shared_ptr<FrameRingBuffer> m_frameRing;
+	VkDeviceSize m_lightInfoBufferSize;
+	std::shared_ptr<ShadowAtlas> m_shadowAtlas;
+
+	std::array<std::shared_ptr<GraphicsImage>, TargetCount> m_targets;
+	std::shared_ptr<GraphicsImage> m_depthImage;
+	std::shared_ptr<GraphicsImage> m_litImage;
+
+	VkRenderPass m_gBufferRenderPass = VK_NULL_HANDLE;
+	VkFramebuffer m_gBufferFramebuffer = VK_NULL_HANDLE;
+
+	VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+	std::vector<VkDescriptorSet> m_descriptorSets;
+
+	std::vector<std::shared_ptr<GraphicsBuffer>> m_deferredInfoBuffers;
+
+	std::shared_ptr<ComputePipeline> m_lightingPipeline;
+	std::shared_ptr<GraphicsPipeline> m_compositePipeline;
+
+	VmaAllocator m_allocator;
+	VkDevice m_device;
+	VkCommandPool m_commandPool;
+	VkQueue m_graphicsQueue;
+	VulkanWindow* m_vulkanWindow;
+};
\ No newline at end of file
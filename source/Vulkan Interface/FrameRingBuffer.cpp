@@ -0,0 +1,97 @@
+#include "FrameRingBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+FrameRingBuffer::FrameRingBuffer(FrameRingBufferCreateInfo createInfo)
+{
+	m_framesInFlight = createInfo.framesInFlight;
+	m_allocator = createInfo.allocator;
+	m_device = createInfo.device;
+	m_commandPool = createInfo.commandPool;
+	m_graphicsQueue = createInfo.graphicsQueue;
+
+	//dynamic offsets have to be multiples of these, both are powers of two so the largest covers the others
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(createInfo.physicalDevice, &properties);
+	m_alignment = std::max({ m_alignment, properties.limits.minUniformBufferOffsetAlignment, properties.limits.minStorageBufferOffsetAlignment });
+
+	m_frameCapacity = AlignUp(createInfo.frameCapacity);
+
+	CreateBuffer();
+}
+
+void FrameRingBuffer::CreateBuffer()
+{
+	GraphicsBuffer::BufferCreateInfo bufferCreateInfo{};
+	bufferCreateInfo.allocator = m_allocator;
+	bufferCreateInfo.size = m_frameCapacity * m_framesInFlight;
+	bufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+	bufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	bufferCreateInfo.device = m_device;
+	bufferCreateInfo.commandPool = m_commandPool;
+	bufferCreateInfo.graphicsQueue = m_graphicsQueue;
+
+	m_buffer = std::make_shared<GraphicsBuffer>(bufferCreateInfo);
+}
+
+std::shared_ptr<GraphicsBuffer> FrameRingBuffer::BeginFrame(uint32_t frameIndex, VkDeviceSize requiredSize)
+{
+	std::shared_ptr<GraphicsBuffer> replacedBuffer = nullptr;
+
+	if (requiredSize > m_frameCapacity)
+	{
+		//doubling keeps a frame that slowly grows its data from replacing the buffer every frame
+		while (m_frameCapacity < requiredSize)
+		{
+			m_frameCapacity *= 2;
+		}
+
+		replacedBuffer = m_buffer;
+		CreateBuffer();
+	}
+
+	m_frameStart = m_frameCapacity * frameIndex;
+	m_frameEnd = m_frameStart + m_frameCapacity;
+	m_head = m_frameStart;
+
+	return replacedBuffer;
+}
+
+uint32_t FrameRingBuffer::Allocate(VkDeviceSize size)
+{
+	VkDeviceSize allocationSize = AlignUp(size);
+
+	if (m_head + allocationSize > m_frameEnd)
+	{
+		throw std::runtime_error("Frame ring buffer allocation exceeds the size reserved for the frame!");
+	}
+
+	VkDeviceSize offset = m_head;
+	m_head += allocationSize;
+
+	return static_cast<uint32_t>(offset);
+}
+
+void FrameRingBuffer::Write(uint32_t offset, const void* data, VkDeviceSize size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	m_buffer->LoadData(const_cast<void*>(data), static_cast<size_t>(size), offset);
+}
+
+uint32_t FrameRingBuffer::Push(const void* data, VkDeviceSize size)
+{
+	uint32_t offset = Allocate(size);
+	Write(offset, data, size);
+
+	return offset;
+}
+
+void FrameRingBuffer::Destroy()
+{
+	m_buffer->DestroyBuffer();
+}
\ No newline at end of file
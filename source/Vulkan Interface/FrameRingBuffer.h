@@ -0,0 +1,63 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+#include "source/Vulkan Interface/GraphicsBuffer.h"
+
+#include <cstdint>
+#include <memory>
+
+//one persistently mapped buffer split into a region per frame in flight, suballocated linearly for the frame's transient data
+//descriptors point at the whole buffer and are bound with the offsets handed out here, so nothing is allocated per frame
+class FrameRingBuffer {
+public:
+	struct FrameRingBufferCreateInfo {
+		uint32_t framesInFlight;
+
+		//bytes each frame starts with, the regions grow when a frame needs more
+		VkDeviceSize frameCapacity;
+
+		VkPhysicalDevice physicalDevice;
+		VmaAllocator allocator;
+		VkDevice device;
+		VkCommandPool commandPool;
+		VkQueue graphicsQueue;
+	};
+
+	FrameRingBuffer(FrameRingBufferCreateInfo createInfo);
+
+	//starts the frame's region over, its previous contents are no longer read by the GPU
+	//when requiredSize doesn't fit, the buffer is replaced by a larger one and the old one is returned to be retired once the frames using it finish
+	std::shared_ptr<GraphicsBuffer> BeginFrame(uint32_t frameIndex, VkDeviceSize requiredSize);
+
+	//offsets are aligned for uniform, storage and vertex use, throws when the frame asks for more than BeginFrame reserved
+	uint32_t Allocate(VkDeviceSize size);
+	void Write(uint32_t offset, const void* data, VkDeviceSize size);
+	uint32_t Push(const void* data, VkDeviceSize size);
+
+	//what an allocation of size takes from the frame's region, for adding up requiredSize
+	VkDeviceSize GetAllocationSize(VkDeviceSize size) { return AlignUp(size); }
+
+	std::shared_ptr<GraphicsBuffer> GetBuffer() { return m_buffer; }
+	VkDeviceSize GetFrameCapacity() { return m_frameCapacity; }
+
+	void Destroy();
+
+private:
+	VkDeviceSize AlignUp(VkDeviceSize size) { return (size + m_alignment - 1) / m_alignment * m_alignment; }
+	void CreateBuffer();
+
+	std::shared_ptr<GraphicsBuffer> m_buffer = nullptr;
+
+	uint32_t m_framesInFlight;
+	VkDeviceSize m_frameCapacity;
+	VkDeviceSize m_alignment = 16;
+
+	VkDeviceSize m_frameStart = 0;
+	VkDeviceSize m_frameEnd = 0;
+	VkDeviceSize m_head = 0;
+
+	VmaAllocator m_allocator;
+	VkDevice m_device;
+	VkCommandPool m_commandPool;
+	VkQueue m_graphicsQueue;
+};
\ No newline at end of file
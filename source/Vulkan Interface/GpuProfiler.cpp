@@ -0,0 +1,199 @@
+#include "GpuProfiler.h"
+
+#include <cstdint>
+#include <iomanip>
+#include <stdexcept>
+
+GpuProfiler::GpuProfiler(GpuProfilerCreateInfo createInfo)
+{
+	m_framesInFlight = createInfo.framesInFlight;
+	m_device = createInfo.device;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(createInfo.physicalDevice, &properties);
+	m_timestampPeriod = properties.limits.timestampPeriod;
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(createInfo.physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(createInfo.physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	uint32_t validBits = queueFamilies[createInfo.queueFamilyIndex].timestampValidBits;
+	m_timestampMask = (validBits >= 64) ? ~0ull : ((1ull << validBits) - 1);
+
+	VkQueryPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	poolInfo.queryCount = kMaxScopes * 2;
+
+	m_queryPools.resize(m_framesInFlight);
+	m_frameScopes.resize(m_framesInFlight);
+	m_frameQueryCounts.resize(m_framesInFlight, 0);
+	m_results.resize(kMaxScopes * 2);
+
+	for (uint32_t i = 0; i < m_framesInFlight; i++)
+	{
+		if (vkCreateQueryPool(m_device, &poolInfo, nullptr, &m_queryPools[i]) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create timestamp query pool!");
+		}
+	}
+}
+
+bool GpuProfiler::IsSupported(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	if (properties.limits.timestampComputeAndGraphics != VK_TRUE)
+	{
+		return false;
+	}
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	return queueFamilyIndex < queueFamilyCount && queueFamilies[queueFamilyIndex].timestampValidBits > 0;
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	ReadResults(frameIndex);
+
+	m_currentFrame = frameIndex;
+	m_frameScopes[frameIndex].clear();
+	m_frameQueryCounts[frameIndex] = 0;
+	m_openScopes.clear();
+
+	vkCmdResetQueryPool(commandBuffer, m_queryPools[frameIndex], 0, kMaxScopes * 2);
+}
+
+void GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char* name)
+{
+	std::vector<Scope>& scopes = m_frameScopes[m_currentFrame];
+
+	//the scope is still pushed so EndScope stays balanced, it just writes nothing
+	if (scopes.size() >= kMaxScopes)
+	{
+		m_openScopes.push_back(SIZE_MAX);
+		return;
+	}
+
+	Scope scope;
+	scope.name = name;
+	scope.beginQuery = m_frameQueryCounts[m_currentFrame]++;
+
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPools[m_currentFrame], scope.beginQuery);
+
+	m_openScopes.push_back(scopes.size());
+	scopes.push_back(scope);
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer commandBuffer)
+{
+	if (m_openScopes.empty())
+	{
+		return;
+	}
+
+	size_t scopeIndex = m_openScopes.back();
+	m_openScopes.pop_back();
+
+	if (scopeIndex == SIZE_MAX)
+	{
+		return;
+	}
+
+	Scope& scope = m_frameScopes[m_currentFrame][scopeIndex];
+	scope.endQuery = m_frameQueryCounts[m_currentFrame]++;
+
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPools[m_currentFrame], scope.endQuery);
+}
+
+void GpuProfiler::ReadResults(uint32_t frameIndex)
+{
+	const std::vector<Scope>& scopes = m_frameScopes[frameIndex];
+	uint32_t queryCount = m_frameQueryCounts[frameIndex];
+
+	if (scopes.empty() || queryCount == 0)
+	{
+		return;
+	}
+
+	VkResult result = vkGetQueryPoolResults(m_device, m_queryPools[frameIndex], 0, queryCount, queryCount * sizeof(uint64_t), m_results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+	if (result != VK_SUCCESS)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < scopes.size(); i++)
+	{
+		uint64_t ticks = (m_results[scopes[i].endQuery] - m_results[scopes[i].beginQuery]) & m_timestampMask;
+		GetStatistics(scopes[i].name).AddFrame(static_cast<double>(ticks) * m_timestampPeriod / 1000000.0);
+	}
+}
+
+FrameTimeStatistics& GpuProfiler::GetStatistics(const char* name)
+{
+	for (size_t i = 0; i < m_statistics.size(); i++)
+	{
+		if (m_statistics[i].first == name)
+		{
+			return m_statistics[i].second;
+		}
+	}
+
+	m_statistics.emplace_back(name, FrameTimeStatistics());
+	return m_statistics.back().second;
+}
+
+void GpuProfiler::Print(std::ostream& stream, const std::string& label)
+{
+	if (m_statistics.empty())
+	{
+		return;
+	}
+
+	stream << "GPU times " << label << " (ms):" << std::endl;
+
+	stream << std::fixed << std::setprecision(3);
+
+	for (size_t i = 0; i < m_statistics.size(); i++)
+	{
+		FrameTimeStatistics& statistics = m_statistics[i].second;
+
+		stream << "  " << m_statistics[i].first << " over " << statistics.GetFrameCount() << " frames:"
+			<< " avg " << statistics.GetAverage()
+			<< " p50 " << statistics.GetPercentile(50.0)
+			<< " p99 " << statistics.GetPercentile(99.0)
+			<< " max " << statistics.GetPercentile(100.0)
+			<< std::endl;
+	}
+
+	stream << std::defaultfloat;
+}
+
+void GpuProfiler::Clear()
+{
+	m_statistics.clear();
+
+	//frames still in flight were recorded before the clear, their results would count towards what comes after it
+	for (uint32_t i = 0; i < m_framesInFlight; i++)
+	{
+		m_frameScopes[i].clear();
+		m_frameQueryCounts[i] = 0;
+	}
+}
+
+void GpuProfiler::Destroy()
+{
+	for (size_t i = 0; i < m_queryPools.size(); i++)
+	{
+		vkDestroyQueryPool(m_device, m_queryPools[i], nullptr);
+	}
+
+	m_queryPools.clear();
+}
\ No newline at end of file
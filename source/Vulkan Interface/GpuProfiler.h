@@ -0,0 +1,71 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+#include "source/Management/FrameTimeStatistics.h"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+//times passes on the GPU with timestamp queries, one query pool per frame in flight
+//results are read back the next time a frame index comes around and never waited on, a frame that isn't done yet is skipped
+class GpuProfiler {
+public:
+	struct GpuProfilerCreateInfo {
+		uint32_t framesInFlight;
+		uint32_t queueFamilyIndex;
+
+		VkPhysicalDevice physicalDevice;
+		VkDevice device;
+	};
+
+	GpuProfiler(GpuProfilerCreateInfo createInfo);
+
+	//the queue has to write timestamps and the device has to allow them in graphics and compute work
+	static bool IsSupported(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex);
+
+	//has to be recorded outside of any render pass, before the frame's first scope
+	void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+	//scopes can nest, a scope that runs out of queries is left out of that frame
+	void BeginScope(VkCommandBuffer commandBuffer, const char* name);
+	void EndScope(VkCommandBuffer commandBuffer);
+
+	void Print(std::ostream& stream, const std::string& label);
+
+	//also drops the results of frames still in flight, call it between frames when what is being measured changes
+	void Clear();
+
+	void Destroy();
+
+	static constexpr uint32_t kMaxScopes = 16;
+
+private:
+	struct Scope {
+		const char* name = nullptr;
+		uint32_t beginQuery = 0;
+		uint32_t endQuery = 0;
+	};
+
+	void ReadResults(uint32_t frameIndex);
+	FrameTimeStatistics& GetStatistics(const char* name);
+
+	uint32_t m_framesInFlight;
+	uint32_t m_currentFrame = 0;
+
+	//nanoseconds per timestamp tick
+	float m_timestampPeriod = 1.0f;
+	uint64_t m_timestampMask = ~0ull;
+
+	std::vector<VkQueryPool> m_queryPools;
+	std::vector<std::vector<Scope>> m_frameScopes;
+	std::vector<uint32_t> m_frameQueryCounts;
+	std::vector<size_t> m_openScopes;
+	std::vector<uint64_t> m_results;
+
+	//kept in the order scopes were first seen so the printout follows the frame
+	std::vector<std::pair<std::string, FrameTimeStatistics>> m_statistics;
+
+	VkDevice m_device;
+};
\ No newline at end of file
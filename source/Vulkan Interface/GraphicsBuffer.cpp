@@ -28,27 +28,27 @@ GraphicsBuffer::GraphicsBuffer(BufferCreateInfo createInfo)
 	m_mappedData = allocationResult.pMappedData;
 }
 
-void GraphicsBuffer::CopyBuffer(std::shared_ptr<GraphicsBuffer> destintationBuffer, VkDeviceSize copySize)
+void GraphicsBuffer::CopyBuffer(std::shared_ptr<GraphicsBuffer> destintationBuffer, VkDeviceSize copySize, VkDeviceSize destinationOffset)
 {
     VkCommandBuffer commandBuffer = VulkanCommonFunctions::BeginSingleTimeCommands(m_device, m_commandPool);
 
     VkBufferCopy copyRegion{};
     copyRegion.size = copySize;
     copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = 0;
+    copyRegion.dstOffset = destinationOffset;
     vkCmdCopyBuffer(commandBuffer, m_buffer, destintationBuffer->GetVkBuffer(), 1, &copyRegion);
 
     VulkanCommonFunctions::EndSingleTimeCommands(commandBuffer, m_device, m_commandPool, m_graphicsQueue);
 }
 
-void GraphicsBuffer::LoadData(void* data, size_t memorySize)
+void GraphicsBuffer::LoadData(void* data, size_t memorySize, size_t offset)
 {
-    if (memorySize > m_maxSize)
+    if (offset + memorySize > m_maxSize)
     {
 		throw std::runtime_error("Data size exceeds buffer size!");
     }
 
-    memcpy(m_mappedData, data, memorySize);
+    memcpy(static_cast<char*>(m_mappedData) + offset, data, memorySize);
 
 	bool hostCoherent = m_properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
     if (!hostCoherent)
@@ -24,8 +24,8 @@ public:
 
 	VkBuffer GetVkBuffer() { return m_buffer; }
 
-	void CopyBuffer(std::shared_ptr<GraphicsBuffer> destintationBuffer, VkDeviceSize copySize);
-	void LoadData(void* data, size_t memorySize);
+	void CopyBuffer(std::shared_ptr<GraphicsBuffer> destintationBuffer, VkDeviceSize copySize, VkDeviceSize destinationOffset = 0);
+	void LoadData(void* data, size_t memorySize, size_t offset = 0);
 	void DestroyBuffer();
 
 private:
@@ -1,5 +1,7 @@
 #include "GraphicsImage.h"
 
+#include <algorithm>
+
 GraphicsImage::GraphicsImage(GraphicsImageCreateInfo imageCreateInfo)
 {
     VkImageCreateInfo imageInfo{};
@@ -8,7 +10,7 @@ GraphicsImage::GraphicsImage(GraphicsImageCreateInfo imageCreateInfo)
     imageInfo.extent.width = imageCreateInfo.imageSize.first;
     imageInfo.extent.height = imageCreateInfo.imageSize.second;
     imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = imageCreateInfo.mipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.format = imageCreateInfo.format;
     imageInfo.tiling = imageCreateInfo.tiling;
@@ -27,6 +29,7 @@ GraphicsImage::GraphicsImage(GraphicsImageCreateInfo imageCreateInfo)
 	m_commandPool = imageCreateInfo.commandPool;
 	m_graphicsQueue = imageCreateInfo.graphicsQueue;
 	m_imageFormat = imageCreateInfo.format;
+	m_mipLevels = imageCreateInfo.mipLevels;
 
     if (vmaCreateImage(m_allocator, &imageInfo, &allocationInfo, &m_image, &m_imageMemory, nullptr) != VK_SUCCESS)
     {
@@ -47,6 +50,20 @@ GraphicsImage::GraphicsImage(GraphicsImageCreateInfo imageCreateInfo, VkImage ra
 	m_imageMemory = nullptr;
 }
 
+VkDeviceSize GraphicsImage::GetMemorySize()
+{
+    //images wrapped from elsewhere, like the swap chain's, weren't allocated here
+    if (m_imageMemory == nullptr)
+    {
+        return 0;
+    }
+
+    VmaAllocationInfo allocationInfo;
+    vmaGetAllocationInfo(m_allocator, m_imageMemory, &allocationInfo);
+
+    return allocationInfo.size;
+}
+
 void GraphicsImage::CreateImageView(VkImageAspectFlags aspectFlags)
 {
     VkImageViewCreateInfo viewInfo{};
@@ -56,7 +73,7 @@ void GraphicsImage::CreateImageView(VkImageAspectFlags aspectFlags)
     viewInfo.format = m_imageFormat;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = m_mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
@@ -100,6 +117,46 @@ void GraphicsImage::CopyFromBuffer(GraphicsBuffer* buffer)
     VulkanCommonFunctions::EndSingleTimeCommands(commandBuffer, m_device, m_commandPool, m_graphicsQueue);
 }
 
+void GraphicsImage::CopyMipsFromBuffer(GraphicsBuffer* buffer, const std::vector<VkDeviceSize>& levelOffsets)
+{
+    VkCommandBuffer commandBuffer = VulkanCommonFunctions::BeginSingleTimeCommands(m_device, m_commandPool);
+
+    std::vector<VkBufferImageCopy> regions;
+
+    for (uint32_t i = 0; i < levelOffsets.size() && i < m_mipLevels; i++)
+    {
+        VkBufferImageCopy region{};
+        region.bufferOffset = levelOffsets[i];
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = i;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = {
+            std::max((uint32_t)m_imageSize.first >> i, 1u),
+            std::max((uint32_t)m_imageSize.second >> i, 1u),
+            1
+        };
+
+        regions.push_back(region);
+    }
+
+    vkCmdCopyBufferToImage(
+        commandBuffer,
+        buffer->GetVkBuffer(),
+        m_image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()),
+        regions.data()
+    );
+
+    VulkanCommonFunctions::EndSingleTimeCommands(commandBuffer, m_device, m_commandPool, m_graphicsQueue);
+}
+
 void GraphicsImage::TransitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout)
 {
     VkCommandBuffer commandBuffer = VulkanCommonFunctions::BeginSingleTimeCommands(m_device, m_commandPool);
@@ -113,7 +170,7 @@ void GraphicsImage::TransitionImageLayout(VkImageLayout oldLayout, VkImageLayout
     barrier.image = m_image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = m_mipLevels;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
     barrier.srcAccessMask = 0;
@@ -122,7 +179,7 @@ void GraphicsImage::TransitionImageLayout(VkImageLayout oldLayout, VkImageLayout
     VkPipelineStageFlags sourceStage;
     VkPipelineStageFlags destinationStage;
 
-    if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
+    if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL || VulkanCommonFunctions::IsDepthFormat(m_imageFormat)) {
         barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
 
         if (VulkanCommonFunctions::HasStencilComponent(m_imageFormat)) {
@@ -154,6 +211,20 @@ void GraphicsImage::TransitionImageLayout(VkImageLayout oldLayout, VkImageLayout
         sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
         destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
     }
+    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL) {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        destinationStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
     else {
         throw std::invalid_argument("unsupported layout transition!");
     }
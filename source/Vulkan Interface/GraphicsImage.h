@@ -15,6 +15,9 @@ public:
 		VkDevice device;
 		VkCommandPool commandPool;
 		VkQueue graphicsQueue;
+
+		//levels after the first are left undefined, textures fill them with GenerateMipmaps or CopyMipsFromBuffer
+		uint32_t mipLevels = 1;
 	};
 
 	GraphicsImage(GraphicsImageCreateInfo imageCreateInfo);
@@ -22,9 +25,15 @@ public:
 
 	VkImageView GetImageView() { return (m_createdImageView) ? m_imageView : VK_NULL_HANDLE; }
 	VkFormat GetImageFormat() { return m_imageFormat; }
+	uint32_t GetMipLevels() { return m_mipLevels; }
+	std::pair<size_t, size_t> GetImageSize() { return m_imageSize; }
+	VkDeviceSize GetMemorySize();
 
 	void CreateImageView(VkImageAspectFlags aspectFlags);
 	void CopyFromBuffer(GraphicsBuffer* buffer);
+
+	//one tightly packed level at each offset, starting with the first level
+	void CopyMipsFromBuffer(GraphicsBuffer* buffer, const std::vector<VkDeviceSize>& levelOffsets);
 	void TransitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout);
 	VkImage GetVkImage() { return m_image; }
 	void DestroyImage();
@@ -45,4 +54,5 @@ protected:
 	bool m_createdImageView = false;
 
 	std::pair<size_t, size_t> m_imageSize;
+	uint32_t m_mipLevels = 1;
 };
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "GraphicsPipeline.h"
 #include "source/Vulkan Interface/VulkanWindow.h"
+#include "source/Vulkan Interface/ShaderReflection.h"
+
+#include <algorithm>
+#include <stdexcept>
 
 GraphicsPipeline::GraphicsPipeline(GraphicsPipelineCreateInfo pipelineCreateInfo)
 {
@@ -9,6 +13,22 @@ GraphicsPipeline::GraphicsPipeline(GraphicsPipelineCreateInfo pipelineCreateInfo
 	m_device = pipelineCreateInfo.device;
 	m_vulkanWindow = pipelineCreateInfo.vulkanWindow;
 	m_uiBasedPipeline = pipelineCreateInfo.uiBasedPipeline;
+	m_renderPass = pipelineCreateInfo.renderPass;
+	m_cullMode = pipelineCreateInfo.cullMode;
+	m_depthBiasEnable = pipelineCreateInfo.depthBiasEnable;
+	m_depthBiasConstantFactor = pipelineCreateInfo.depthBiasConstantFactor;
+	m_depthBiasSlopeFactor = pipelineCreateInfo.depthBiasSlopeFactor;
+	m_pushConstantSize = pipelineCreateInfo.pushConstantSize;
+	m_noVertexInput = pipelineCreateInfo.noVertexInput;
+	m_positionOnlyVertexInput = pipelineCreateInfo.positionOnlyVertexInput;
+	m_colorAttachmentCount = pipelineCreateInfo.colorAttachmentCount;
+	m_blendEnable = pipelineCreateInfo.blendEnable;
+	m_additiveBlend = pipelineCreateInfo.additiveBlend;
+	m_colorWriteMask = pipelineCreateInfo.colorWriteMask;
+	m_depthCompareOp = pipelineCreateInfo.depthCompareOp;
+	m_depthWriteEnable = pipelineCreateInfo.depthWriteEnable;
+	m_specializationConstants = pipelineCreateInfo.specializationConstants;
+	m_pipelineCache = pipelineCreateInfo.pipelineCache;
 	CreatePipeline();
 }
 
@@ -21,11 +41,25 @@ void GraphicsPipeline::CreatePipeline()
 
     CreatePipelineLayout();
 
-    auto vertShaderCode = ReadFile(m_vertexShaderFilePath);
-    auto fragShaderCode = ReadFile(m_fragmentShaderFilePath);
+    bool depthOnly = m_fragmentShaderFilePath.empty();
+
+    auto vertShaderCode = VulkanCommonFunctions::ReadShaderFile(m_vertexShaderFilePath);
+
+    //checked before anything else is created, a shader that doesn't match its layout throws here
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+    if (!m_noVertexInput)
+    {
+        attributeDescriptions = GetShaderAttributeDescriptions(vertShaderCode);
+    }
 
-    VkShaderModule vertexShaderModule = CreateShaderModule(vertShaderCode);
-    VkShaderModule fragmentShaderModule = CreateShaderModule(fragShaderCode);
+    VkShaderModule vertexShaderModule = VulkanCommonFunctions::CreateShaderModule(m_device, vertShaderCode);
+    VkShaderModule fragmentShaderModule = VK_NULL_HANDLE;
+
+    if (!depthOnly)
+    {
+        auto fragShaderCode = VulkanCommonFunctions::ReadShaderFile(m_fragmentShaderFilePath);
+        fragmentShaderModule = VulkanCommonFunctions::CreateShaderModule(m_device, fragShaderCode);
+    }
 
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -39,33 +73,49 @@ void GraphicsPipeline::CreatePipeline()
     fragShaderStageInfo.module = fragmentShaderModule;
     fragShaderStageInfo.pName = "PSMain";
 
+    std::vector<VkSpecializationMapEntry> specializationEntries(m_specializationConstants.size());
+    for (uint32_t i = 0; i < specializationEntries.size(); i++)
+    {
+        specializationEntries[i].constantID = i;
+        specializationEntries[i].offset = i * sizeof(uint32_t);
+        specializationEntries[i].size = sizeof(uint32_t);
+    }
+
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+    specializationInfo.pMapEntries = specializationEntries.data();
+    specializationInfo.dataSize = m_specializationConstants.size() * sizeof(uint32_t);
+    specializationInfo.pData = m_specializationConstants.data();
+
+    if (!m_specializationConstants.empty())
+    {
+        vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
+        fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
+    }
+
     VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-	auto primaryBindingDescription = VulkanCommonFunctions::Vertex::GetBindingDescriptions();
-	auto primaryAttributeDescriptions = VulkanCommonFunctions::Vertex::GetAttributeDescriptions();
-
-	auto uiBindingDescription = VulkanCommonFunctions::UIVertex::GetBindingDescriptions();
-	auto uiAttributeDescriptions = VulkanCommonFunctions::UIVertex::GetAttributeDescriptions();
+    std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = VulkanCommonFunctions::Vertex::GetBindingDescriptions();
 
     if (m_uiBasedPipeline)
     {
-        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(uiAttributeDescriptions.size());
-
-        vertexInputInfo.pVertexBindingDescriptions = uiBindingDescription.data();
-        vertexInputInfo.pVertexAttributeDescriptions = uiAttributeDescriptions.data();
+        bindingDescriptions = VulkanCommonFunctions::UIVertex::GetBindingDescriptions();
     }
-    else {
-        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(primaryAttributeDescriptions.size());
-
-        vertexInputInfo.pVertexBindingDescriptions = primaryBindingDescription.data();
-        vertexInputInfo.pVertexAttributeDescriptions = primaryAttributeDescriptions.data();
+    else if (m_positionOnlyVertexInput)
+    {
+        bindingDescriptions = VulkanCommonFunctions::PositionVertex::GetBindingDescriptions();
     }
 
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-
-    vertexInputInfo.vertexBindingDescriptionCount = 2;
+    if (!m_noVertexInput)
+    {
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+        vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+        vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+    }
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -93,12 +143,12 @@ void GraphicsPipeline::CreatePipeline()
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
     rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
     rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.cullMode = m_cullMode;
     rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-    rasterizer.depthBiasConstantFactor = 0.0f; // Optional
+    rasterizer.depthBiasEnable = m_depthBiasEnable ? VK_TRUE : VK_FALSE;
+    rasterizer.depthBiasConstantFactor = m_depthBiasConstantFactor;
     rasterizer.depthBiasClamp = 0.0f; // Optional
-    rasterizer.depthBiasSlopeFactor = 0.0f; // Optional
+    rasterizer.depthBiasSlopeFactor = m_depthBiasSlopeFactor;
 
     VkPipelineMultisampleStateCreateInfo multisampling{};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
@@ -110,8 +160,8 @@ void GraphicsPipeline::CreatePipeline()
     multisampling.alphaToOneEnable = VK_FALSE; // Optional
 
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.colorWriteMask = m_colorWriteMask;
+    colorBlendAttachment.blendEnable = m_blendEnable ? VK_TRUE : VK_FALSE;
     colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
     colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
@@ -119,12 +169,21 @@ void GraphicsPipeline::CreatePipeline()
     colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
     colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
+    if (m_additiveBlend)
+    {
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    }
+
+    std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments(m_colorAttachmentCount, colorBlendAttachment);
+
     VkPipelineColorBlendStateCreateInfo colorBlending{};
     colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
     colorBlending.logicOpEnable = VK_FALSE;
     colorBlending.logicOp = VK_LOGIC_OP_COPY; // Optional
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
+    colorBlending.attachmentCount = depthOnly ? 0 : m_colorAttachmentCount;
+    colorBlending.pAttachments = colorBlendAttachments.data();
     colorBlending.blendConstants[0] = 0.0f; // Optional
     colorBlending.blendConstants[1] = 0.0f; // Optional
     colorBlending.blendConstants[2] = 0.0f; // Optional
@@ -132,7 +191,7 @@ void GraphicsPipeline::CreatePipeline()
 
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
+    pipelineInfo.stageCount = depthOnly ? 1 : 2;
     pipelineInfo.pStages = shaderStages;
     pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
@@ -143,7 +202,7 @@ void GraphicsPipeline::CreatePipeline()
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = m_pipelineLayout;
-    pipelineInfo.renderPass = m_vulkanWindow->defaultRenderPass();
+    pipelineInfo.renderPass = (m_renderPass != VK_NULL_HANDLE) ? m_renderPass : m_vulkanWindow->defaultRenderPass();
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
     pipelineInfo.basePipelineIndex = -1; // Optional
@@ -151,8 +210,8 @@ void GraphicsPipeline::CreatePipeline()
     VkPipelineDepthStencilStateCreateInfo depthStencil{};
     depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthWriteEnable = m_depthWriteEnable ? VK_TRUE : VK_FALSE;
+    depthStencil.depthCompareOp = m_depthCompareOp;
     depthStencil.depthBoundsTestEnable = VK_FALSE;
     depthStencil.minDepthBounds = 0.0f; // Optional
     depthStencil.maxDepthBounds = 1.0f; // Optional
@@ -162,11 +221,15 @@ void GraphicsPipeline::CreatePipeline()
 
     pipelineInfo.pDepthStencilState = &depthStencil;
 
-    if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
 
-    vkDestroyShaderModule(m_device, fragmentShaderModule, nullptr);
+    if (fragmentShaderModule != VK_NULL_HANDLE)
+    {
+        vkDestroyShaderModule(m_device, fragmentShaderModule, nullptr);
+    }
+
     vkDestroyShaderModule(m_device, vertexShaderModule, nullptr);
 }
 
@@ -174,46 +237,20 @@ void GraphicsPipeline::CreatePipelineLayout()
 {
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.setLayoutCount = (m_descriptorSetLayout != VK_NULL_HANDLE) ? 1 : 0;
     pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-    pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
 
-    if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
-}
-
-std::vector<char> GraphicsPipeline::ReadFile(const std::string& filename) {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open()) {
-        throw std::runtime_error("failed to open file!");
-    }
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = m_pushConstantSize;
 
-    size_t fileSize = (size_t)file.tellg();
-    std::vector<char> buffer(fileSize);
-
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-
-    file.close();
-
-    return buffer;
-}
+    pipelineLayoutInfo.pushConstantRangeCount = (m_pushConstantSize > 0) ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = (m_pushConstantSize > 0) ? &pushConstantRange : nullptr;
 
-VkShaderModule GraphicsPipeline::CreateShaderModule(const std::vector<char>& code) {
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-
-    VkShaderModule shaderModule;
-    if (vkCreateShaderModule(m_device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create shader module!");
+    if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
     }
-
-    return shaderModule;
 }
 
 void GraphicsPipeline::DestroyPipeline()
@@ -229,4 +266,48 @@ void GraphicsPipeline::DestroyPipeline()
         vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
         m_pipelineLayout = VK_NULL_HANDLE;
     }
+}
+
+std::vector<VkVertexInputAttributeDescription> GraphicsPipeline::GetShaderAttributeDescriptions(const std::vector<char>& vertexShaderCode)
+{
+    std::vector<VkVertexInputAttributeDescription> layoutAttributes;
+
+    if (m_uiBasedPipeline)
+    {
+        auto uiAttributeDescriptions = VulkanCommonFunctions::UIVertex::GetAttributeDescriptions();
+        layoutAttributes.assign(uiAttributeDescriptions.begin(), uiAttributeDescriptions.end());
+    }
+    else if (m_positionOnlyVertexInput)
+    {
+        auto positionAttributeDescriptions = VulkanCommonFunctions::PositionVertex::GetAttributeDescriptions();
+        layoutAttributes.assign(positionAttributeDescriptions.begin(), positionAttributeDescriptions.end());
+    }
+    else {
+        auto primaryAttributeDescriptions = VulkanCommonFunctions::Vertex::GetAttributeDescriptions();
+        layoutAttributes.assign(primaryAttributeDescriptions.begin(), primaryAttributeDescriptions.end());
+    }
+
+    ShaderReflection reflection(vertexShaderCode, m_vertexShaderFilePath);
+
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+
+    //only the locations the shader reads, so a layout and a shader that drifted apart fail here instead of reading garbage
+    for (const ShaderReflection::VertexInput& input : reflection.GetVertexInputs())
+    {
+        auto attribute = std::find_if(layoutAttributes.begin(), layoutAttributes.end(), [&input](const VkVertexInputAttributeDescription& description) { return description.location == input.location; });
+
+        if (attribute == layoutAttributes.end())
+        {
+            throw std::runtime_error(m_vertexShaderFilePath + " reads vertex input location " + std::to_string(input.location) + ", which its vertex layout doesn't have!");
+        }
+
+        if (!ShaderReflection::HasSameNumericType(attribute->format, input.format))
+        {
+            throw std::runtime_error(m_vertexShaderFilePath + " reads vertex input location " + std::to_string(input.location) + " as a different type than its vertex layout gives it!");
+        }
+
+        attributeDescriptions.push_back(*attribute);
+    }
+
+    return attributeDescriptions;
 }
\ No newline at end of file
@@ -13,6 +13,43 @@ struct GraphicsPipelineCreateInfo {
 	VkDevice device;
 	VulkanWindow* vulkanWindow;
 	bool uiBasedPipeline = false;
+
+	//the window's render pass when left null
+	VkRenderPass renderPass = VK_NULL_HANDLE;
+	VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+
+	//for depth only passes, an empty fragment shader path also means there are no color attachments
+	bool depthBiasEnable = false;
+	float depthBiasConstantFactor = 0.0f;
+	float depthBiasSlopeFactor = 0.0f;
+
+	//size of the vertex stage push constant block, 0 for none
+	uint32_t pushConstantSize = 0;
+
+	//fullscreen passes build their vertices from the vertex index and bind no vertex buffers
+	bool noVertexInput = false;
+
+	//depth pre-passes read each mesh's position stream instead of its full vertices
+	bool positionOnlyVertexInput = false;
+
+	//g-buffer passes write several targets that are overwritten rather than blended
+	uint32_t colorAttachmentCount = 1;
+	bool blendEnable = true;
+
+	//sums into every target instead of blending over it, for weighted blended transparency
+	bool additiveBlend = false;
+
+	//0 keeps the color targets as they are, for passes that only need the depth of objects
+	VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+	bool depthWriteEnable = true;
+
+	//the constant with id i takes the i-th value in both stages, a stage without that constant ignores it
+	std::vector<uint32_t> specializationConstants;
+
+	//the driver's cache to create through, it isn't part of the pipeline's state
+	VkPipelineCache pipelineCache = VK_NULL_HANDLE;
 };
 
 class GraphicsPipeline {
@@ -29,8 +66,9 @@ public:
 
 private:
 	void CreatePipelineLayout();
-	VkShaderModule CreateShaderModule(const std::vector<char>& code);
-	std::vector<char> ReadFile(const std::string& filename);
+
+	//the vertex layout's attributes at the locations the shader reads, checked against the types it reads them as
+	std::vector<VkVertexInputAttributeDescription> GetShaderAttributeDescriptions(const std::vector<char>& vertexShaderCode);
 
 	VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
 	VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
@@ -42,5 +80,27 @@ private:
 
 	bool m_uiBasedPipeline = false;
 
+	VkRenderPass m_renderPass = VK_NULL_HANDLE;
+	VkCullModeFlags m_cullMode = VK_CULL_MODE_BACK_BIT;
+
+	bool m_depthBiasEnable = false;
+	float m_depthBiasConstantFactor = 0.0f;
+	float m_depthBiasSlopeFactor = 0.0f;
+
+	uint32_t m_pushConstantSize = 0;
+
+	bool m_noVertexInput = false;
+	bool m_positionOnlyVertexInput = false;
+	uint32_t m_colorAttachmentCount = 1;
+	bool m_blendEnable = true;
+	bool m_additiveBlend = false;
+	VkColorComponentFlags m_colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	VkCompareOp m_depthCompareOp = VK_COMPARE_OP_LESS;
+	bool m_depthWriteEnable = true;
+
+	std::vector<uint32_t> m_specializationConstants;
+	VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+
 	VulkanWindow* m_vulkanWindow;
 };
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include "OrderIndependentTransparency.h"
+#include "source/Vulkan Interface/VulkanWindow.h"
+#include "source/Vulkan Interface/ShaderReflection.h"
+
+OrderIndependentTransparency::OrderIndependentTransparency(OrderIndependentTransparencyCreateInfo createInfo)
+{
+	m_depthFormat = createInfo.depthFormat;
+	m_allocator = createInfo.allocator;
+	m_device = createInfo.device;
+	m_commandPool = createInfo.commandPool;
+	m_graphicsQueue = createInfo.graphicsQueue;
+	m_vulkanWindow = createInfo.vulkanWindow;
+
+	CreateRenderPass();
+	CreateDescriptorSetLayout();
+	CreateDescriptorPool();
+	CreatePipeline();
+}
+
+bool OrderIndependentTransparency::IsSupported(VkPhysicalDevice physicalDevice)
+{
+	const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+
+	std::array<VkFormat, 2> formats = { kAccumulationFormat, kRevealageFormat };
+
+	for (size_t i = 0; i < formats.size(); i++)
+	{
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, formats[i], &properties);
+
+		if ((properties.optimalTilingFeatures & requiredFeatures) != requiredFeatures)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void OrderIndependentTransparency::CreateRenderPass()
+{
+	std::array<VkAttachmentDescription, 3> attachments{};
+	std::array<VkFormat, 2> colorFormats = { kAccumulationFormat, kRevealageFormat };
+	std::array<VkAttachmentReference, 2> colorAttachmentReferences{};
+
+	for (uint32_t i = 0; i < colorFormats.size(); i++)
+	{
+		attachments[i].format = colorFormats[i];
+		attachments[i].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachments[i].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachments[i].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		attachments[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[i].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachments[i].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		colorAttachmentReferences[i].attachment = i;
+		colorAttachmentReferences[i].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	}
+
+	//depth is only needed while the pass runs
+	VkAttachmentDescription& depthAttachment = attachments[2];
+	depthAttachment.format = m_depthFormat;
+	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference depthAttachmentReference{};
+	depthAttachmentReference.attachment = 2;
+	depthAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentReferences.size());
+	subpass.pColorAttachments = colorAttachmentReferences.data();
+	subpass.pDepthStencilAttachment = &depthAttachmentReference;
+
+	std::array<VkSubpassDependency, 2> dependencies{};
+
+	//the previous frame's composite reads the targets before they are cleared
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	//and this frame's composite reads what was just written
+	dependencies[1].srcSubpass = 0;
+	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	VkRenderPassCreateInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	renderPassInfo.pAttachments = attachments.data();
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+	renderPassInfo.pDependencies = dependencies.data();
+
+	if (vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create transparency render pass!");
+	}
+}
+
+void OrderIndependentTransparency::CreateDescriptorSetLayout()
+{
+	//the accumulation and revealage targets, as the composite shaders declare them
+	std::vector<VkDescriptorSetLayoutBinding> bindings = ShaderReflection::GetLayoutBindings({ kCompositeVertexShaderFilePath, kCompositePixelShaderFilePath });
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create transparency descriptor set layout!");
+	}
+}
+
+void OrderIndependentTransparency::CreateDescriptorPool()
+{
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	poolSize.descriptorCount = 2;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	poolInfo.maxSets = 1;
+
+	if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create transparency descriptor pool!");
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_descriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &m_descriptorSetLayout;
+
+	if (vkAllocateDescriptorSets(m_device, &allocInfo, &m_descriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate transparency descriptor set!");
+	}
+}
+
+void OrderIndependentTransparency::CreatePipeline()
+{
+	//the default blend puts the resolved color over the scene with its coverage as alpha
+	GraphicsPipelineCreateInfo compositeCreateInfo{};
+	compositeCreateInfo.vertexShaderFilePath = kCompositeVertexShaderFilePath;
+	compositeCreateInfo.fragmentShaderFilePath = kCompositePixelShaderFilePath;
+	compositeCreateInfo.descriptorSetLayout = m_descriptorSetLayout;
+	compositeCreateInfo.device = m_device;
+	compositeCreateInfo.vulkanWindow = m_vulkanWindow;
+	compositeCreateInfo.uiBasedPipeline = false;
+	compositeCreateInfo.cullMode = VK_CULL_MODE_NONE;
+	compositeCreateInfo.noVertexInput = true;
+	compositeCreateInfo.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+	compositeCreateInfo.depthWriteEnable = false;
+
+	m_compositePipeline = std::make_shared<GraphicsPipeline>(compositeCreateInfo);
+}
+
+std::shared_ptr<GraphicsImage> OrderIndependentTransparency::CreateTarget(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect)
+{
+	GraphicsImage::GraphicsImageCreateInfo imageCreateInfo{};
+	imageCreateInfo.imageSize = { m_width, m_height };
+	imageCreateInfo.format = format;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.usage = usage;
+	imageCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	imageCreateInfo.allocator = m_allocator;
+	imageCreateInfo.device = m_device;
+	imageCreateInfo.commandPool = m_commandPool;
+	imageCreateInfo.graphicsQueue = m_graphicsQueue;
+
+	std::shared_ptr<GraphicsImage> image = std::make_shared<GraphicsImage>(imageCreateInfo);
+	image->CreateImageView(aspect);
+
+	return image;
+}
+
+void OrderIndependentTransparency::CreateSizeDependentResources(uint32_t width, uint32_t height)
+{
+	m_width = width;
+	m_height = height;
+
+	m_accumulationImage = CreateTarget(kAccumulationFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	m_revealageImage = CreateTarget(kRevealageFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	m_depthImage = CreateTarget(m_depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+	std::array<VkImageView, 3> attachments = { m_accumulationImage->GetImageView(), m_revealageImage->GetImageView(), m_depthImage->GetImageView() };
+
+	VkFramebufferCreateInfo framebufferInfo{};
+	framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebufferInfo.renderPass = m_renderPass;
+	framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	framebufferInfo.pAttachments = attachments.data();
+	framebufferInfo.width = m_width;
+	framebufferInfo.height = m_height;
+	framebufferInfo.layers = 1;
+
+	if (vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &m_framebuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create transparency framebuffer!");
+	}
+
+	std::array<VkDescriptorImageInfo, 2> imageInfos{};
+	imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfos[0].imageView = m_accumulationImage->GetImageView();
+	imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfos[1].imageView = m_revealageImage->GetImageView();
+
+	VkWriteDescriptorSet descriptorWrite{};
+	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet = m_descriptorSet;
+	descriptorWrite.dstBinding = 0;
+	descriptorWrite.dstArrayElement = 0;
+	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	descriptorWrite.descriptorCount = static_cast<uint32_t>(imageInfos.size());
+	descriptorWrite.pImageInfo = imageInfos.data();
+
+	vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+}
+
+void OrderIndependentTransparency::DestroySizeDependentResources()
+{
+	if (m_framebuffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	vkDestroyFramebuffer(m_device, m_framebuffer, nullptr);
+	m_framebuffer = VK_NULL_HANDLE;
+
+	m_accumulationImage->DestroyImage();
+	m_revealageImage->DestroyImage();
+	m_depthImage->DestroyImage();
+
+	m_accumulationImage = nullptr;
+	m_revealageImage = nullptr;
+	m_depthImage = nullptr;
+}
+
+void OrderIndependentTransparency::BeginAccumulationPass(VkCommandBuffer commandBuffer)
+{
+	//nothing accumulated yet, revealage starts at 0 because it's summed in log space
+	std::array<VkClearValue, 3> clearValues{};
+	clearValues[0].color = { {0.0f, 0.0f, 0.0f, 0.0f} };
+	clearValues[1].color = { {0.0f, 0.0f, 0.0f, 0.0f} };
+	clearValues[2].depthStencil = { 1.0f, 0 };
+
+	VkRenderPassBeginInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = m_renderPass;
+	renderPassInfo.framebuffer = m_framebuffer;
+	renderPassInfo.renderArea.offset = { 0, 0 };
+	renderPassInfo.renderArea.extent = { m_width, m_height };
+	renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+	renderPassInfo.pClearValues = clearValues.data();
+
+	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+	VkViewport viewport{};
+	viewport.x = 0.0f;
+	viewport.y = 0.0f;
+	viewport.width = static_cast<float>(m_width);
+	viewport.height = static_cast<float>(m_height);
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+	VkRect2D scissor{};
+	scissor.offset = { 0, 0 };
+	scissor.extent = { m_width, m_height };
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void OrderIndependentTransparency::EndAccumulationPass(VkCommandBuffer commandBuffer)
+{
+	vkCmdEndRenderPass(commandBuffer);
+}
+
+void OrderIndependentTransparency::DrawComposite(VkCommandBuffer commandBuffer)
+{
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_compositePipeline->GetVkPipeline());
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_compositePipeline->GetVkPipelineLayout(), 0, 1, &m_descriptorSet, 0, nullptr);
+	vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+}
+
+void OrderIndependentTransparency::Destroy()
+{
+	DestroySizeDependentResources();
+
+	m_compositePipeline->DestroyPipeline();
+
+	vkDestroyRenderPass(m_device, m_renderPass, nullptr);
+	vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, nullptr);
+}
\ No newline at end of file
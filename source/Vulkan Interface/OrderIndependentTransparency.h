@@ -0,0 +1,86 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+#include "source/Vulkan Interface/GraphicsImage.h"
+#include "source/Vulkan Interface/GraphicsPipeline.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+class VulkanWindow;
+
+//weighted blended transparency, transparent objects are summed into two targets in any order and resolved over the opaque scene
+//nothing has to be sorted, the weights favour surfaces near the camera so the result is close to sorted blending
+class OrderIndependentTransparency {
+public:
+	struct OrderIndependentTransparencyCreateInfo {
+		VkFormat depthFormat;
+
+		VmaAllocator allocator;
+		VkDevice device;
+		VkCommandPool commandPool;
+		VkQueue graphicsQueue;
+		VulkanWindow* vulkanWindow;
+	};
+
+	OrderIndependentTransparency(OrderIndependentTransparencyCreateInfo createInfo);
+
+	static bool IsSupported(VkPhysicalDevice physicalDevice);
+
+	//the targets follow the swap chain size, call again after the swap chain is recreated
+	void CreateSizeDependentResources(uint32_t width, uint32_t height);
+	void DestroySizeDependentResources();
+
+	//opaque objects are drawn into the pass's depth first so they hide the transparent ones behind them
+	VkRenderPass GetRenderPass() { return m_renderPass; }
+
+	void BeginAccumulationPass(VkCommandBuffer commandBuffer);
+	void EndAccumulationPass(VkCommandBuffer commandBuffer);
+
+	//blends the resolved transparent color over the window's pass
+	void DrawComposite(VkCommandBuffer commandBuffer);
+
+	void Destroy();
+
+private:
+	void CreateRenderPass();
+	void CreateDescriptorSetLayout();
+	void CreateDescriptorPool();
+	void CreatePipeline();
+
+	std::shared_ptr<GraphicsImage> CreateTarget(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect);
+
+	//accumulation holds the weighted premultiplied color and alpha
+	//revealage holds the sum of -log(1 - alpha), both targets can then share the same additive blend
+	static constexpr VkFormat kAccumulationFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	static constexpr VkFormat kRevealageFormat = VK_FORMAT_R16_SFLOAT;
+
+	static constexpr const char* kCompositeVertexShaderFilePath = "shaders/HLSL/TransparencyCompositeVertexShader.spv";
+	static constexpr const char* kCompositePixelShaderFilePath = "shaders/HLSL/TransparencyCompositePixelShader.spv";
+
+	VkFormat m_depthFormat;
+
+	uint32_t m_width = 0;
+	uint32_t m_height = 0;
+
+	std::shared_ptr<GraphicsImage> m_accumulationImage;
+	std::shared_ptr<GraphicsImage> m_revealageImage;
+	std::shared_ptr<GraphicsImage> m_depthImage;
+
+	VkRenderPass m_renderPass = VK_NULL_HANDLE;
+	VkFramebuffer m_framebuffer = VK_NULL_HANDLE;
+
+	//the targets are only rewritten after the device is idle, so one set serves every frame in flight
+	VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+
+	std::shared_ptr<GraphicsPipeline> m_compositePipeline;
+
+	VmaAllocator m_allocator;
+	VkDevice m_device;
+	VkCommandPool m_commandPool;
+	VkQueue m_graphicsQueue;
+	VulkanWindow* m_vulkanWindow;
+};
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "ParallelCommandRecorder.h"
+
+#include <stdexcept>
+
+ParallelCommandRecorder::ParallelCommandRecorder(ParallelCommandRecorderCreateInfo createInfo)
+{
+	m_threadCount = createInfo.threadCount;
+	m_framesInFlight = createInfo.framesInFlight;
+	m_device = createInfo.device;
+
+	//the buffers are rerecorded every time their frame comes around, so whole pools are reset instead of single buffers
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = createInfo.queueFamilyIndex;
+
+	m_threadPools.resize(m_threadCount + 1);
+	for (size_t i = 0; i < m_threadPools.size(); i++)
+	{
+		ThreadPools& threadPools = m_threadPools[i];
+		threadPools.pools.resize(m_framesInFlight, VK_NULL_HANDLE);
+		threadPools.commandBuffers.resize(m_framesInFlight);
+		threadPools.usedCounts.resize(m_framesInFlight, 0);
+
+		for (uint32_t frameIndex = 0; frameIndex < m_framesInFlight; frameIndex++)
+		{
+			if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &threadPools.pools[frameIndex]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to create recording command pool!");
+			}
+		}
+	}
+
+	m_finishedThreads = m_threadCount;
+
+	for (uint32_t i = 0; i < m_threadCount; i++)
+	{
+		m_threads.emplace_back(&ParallelCommandRecorder::Work, this, i);
+	}
+}
+
+void ParallelCommandRecorder::BeginFrame(uint32_t frameIndex)
+{
+	m_currentFrame = frameIndex;
+
+	for (size_t i = 0; i < m_threadPools.size(); i++)
+	{
+		vkResetCommandPool(m_device, m_threadPools[i].pools[frameIndex], 0);
+		m_threadPools[i].usedCounts[frameIndex] = 0;
+	}
+}
+
+void ParallelCommandRecorder::Dispatch(VkRenderPass renderPass, VkFramebuffer framebuffer, uint32_t sliceCount, RecordFunction record)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_renderPass = renderPass;
+	m_framebuffer = framebuffer;
+	m_sliceCount = sliceCount;
+	m_record = std::move(record);
+	m_sliceCommandBuffers.assign(sliceCount, VK_NULL_HANDLE);
+
+	m_nextSlice = 0;
+	m_finishedThreads = 0;
+	m_jobId++;
+
+	m_jobAvailable.notify_all();
+}
+
+const std::vector<VkCommandBuffer>& ParallelCommandRecorder::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobFinished.wait(lock, [this]() { return m_finishedThreads == m_threadCount; });
+
+	//the function's captures only live as long as the frame
+	m_record = nullptr;
+
+	if (m_exception != nullptr)
+	{
+		std::exception_ptr exception = m_exception;
+		m_exception = nullptr;
+		std::rethrow_exception(exception);
+	}
+
+	return m_sliceCommandBuffers;
+}
+
+VkCommandBuffer ParallelCommandRecorder::BeginSecondary(VkRenderPass renderPass, VkFramebuffer framebuffer)
+{
+	return BeginCommandBuffer(m_threadCount, renderPass, framebuffer);
+}
+
+void ParallelCommandRecorder::EndSecondary(VkCommandBuffer commandBuffer)
+{
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to record secondary command buffer!");
+	}
+}
+
+void ParallelCommandRecorder::Work(uint32_t threadIndex)
+{
+	uint64_t lastJobId = 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_jobAvailable.wait(lock, [this, lastJobId]() { return m_stopping || m_jobId != lastJobId; });
+
+		if (m_stopping)
+		{
+			return;
+		}
+
+		lastJobId = m_jobId;
+
+		//slices are taken one at a time, so a thread that gets cheap slices picks up more of them
+		while (m_nextSlice < m_sliceCount)
+		{
+			uint32_t slice = m_nextSlice++;
+			lock.unlock();
+
+			try
+			{
+				VkCommandBuffer commandBuffer = BeginCommandBuffer(threadIndex, m_renderPass, m_framebuffer);
+				m_record(commandBuffer, slice);
+				EndSecondary(commandBuffer);
+
+				m_sliceCommandBuffers[slice] = commandBuffer;
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> exceptionLock(m_mutex);
+				if (m_exception == nullptr)
+				{
+					m_exception = std::current_exception();
+				}
+			}
+
+			lock.lock();
+		}
+
+		m_finishedThreads++;
+		if (m_finishedThreads == m_threadCount)
+		{
+			m_jobFinished.notify_one();
+		}
+	}
+}
+
+VkCommandBuffer ParallelCommandRecorder::BeginCommandBuffer(uint32_t threadIndex, VkRenderPass renderPass, VkFramebuffer framebuffer)
+{
+	ThreadPools& threadPools = m_threadPools[threadIndex];
+	std::vector<VkCommandBuffer>& commandBuffers = threadPools.commandBuffers[m_currentFrame];
+	size_t& usedCount = threadPools.usedCounts[m_currentFrame];
+
+	//buffers outlive the pool resets, a frame only allocates when it records more than any frame before it
+	if (usedCount == commandBuffers.size())
+	{
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = threadPools.pools[m_currentFrame];
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer newCommandBuffer;
+		if (vkAllocateCommandBuffers(m_device, &allocInfo, &newCommandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate secondary command buffer!");
+		}
+
+		commandBuffers.push_back(newCommandBuffer);
+	}
+
+	VkCommandBuffer commandBuffer = commandBuffers[usedCount];
+	usedCount++;
+
+	VkCommandBufferInheritanceInfo inheritanceInfo{};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.renderPass = renderPass;
+	inheritanceInfo.subpass = 0;
+	inheritanceInfo.framebuffer = framebuffer;
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to begin secondary command buffer!");
+	}
+
+	return commandBuffer;
+}
+
+void ParallelCommandRecorder::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_jobAvailable.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+
+	//destroying a pool frees its command buffers
+	for (size_t i = 0; i < m_threadPools.size(); i++)
+	{
+		for (uint32_t frameIndex = 0; frameIndex < m_framesInFlight; frameIndex++)
+		{
+			vkDestroyCommandPool(m_device, m_threadPools[i].pools[frameIndex], nullptr);
+		}
+	}
+	m_threadPools.clear();
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//records secondary command buffers for one subpass on a set of worker threads
+//every thread, and the render thread, has its own command pool per frame in flight, so no pool is ever shared between threads
+class ParallelCommandRecorder {
+public:
+	struct ParallelCommandRecorderCreateInfo {
+		uint32_t threadCount;
+		uint32_t framesInFlight;
+		uint32_t queueFamilyIndex;
+
+		VkDevice device;
+	};
+
+	//called once per slice on a worker thread, the command buffer is already begun inside the subpass
+	//nothing is inherited from the primary, so it has to set its own viewport, pipeline and descriptor sets
+	using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t slice)>;
+
+	ParallelCommandRecorder(ParallelCommandRecorderCreateInfo createInfo);
+
+	//resets the frame's pools, the GPU has finished with everything recorded from them the last time the frame index came around
+	void BeginFrame(uint32_t frameIndex);
+
+	//hands sliceCount slices to the workers and returns straight away, the render thread can record its own secondaries meanwhile
+	void Dispatch(VkRenderPass renderPass, VkFramebuffer framebuffer, uint32_t sliceCount, RecordFunction record);
+
+	//waits for the dispatched slices and returns their command buffers in slice order, rethrows the first exception a slice threw
+	const std::vector<VkCommandBuffer>& Wait();
+
+	//a secondary from the render thread's own pool, begun inside the subpass, render thread only
+	VkCommandBuffer BeginSecondary(VkRenderPass renderPass, VkFramebuffer framebuffer);
+	void EndSecondary(VkCommandBuffer commandBuffer);
+
+	uint32_t GetThreadCount() { return m_threadCount; }
+
+	void Destroy();
+
+private:
+	struct ThreadPools {
+		std::vector<VkCommandPool> pools;
+		std::vector<std::vector<VkCommandBuffer>> commandBuffers;
+		std::vector<size_t> usedCounts;
+	};
+
+	void Work(uint32_t threadIndex);
+
+	//the next unused command buffer of the thread's pool for the current frame, begun inside the subpass
+	VkCommandBuffer BeginCommandBuffer(uint32_t threadIndex, VkRenderPass renderPass, VkFramebuffer framebuffer);
+
+	uint32_t m_threadCount;
+	uint32_t m_framesInFlight;
+	uint32_t m_currentFrame = 0;
+
+	//one per worker, the last one is the render thread's
+	std::vector<ThreadPools> m_threadPools;
+	std::vector<std::thread> m_threads;
+
+	//the dispatched job, only written while no worker is running one
+	VkRenderPass m_renderPass = VK_NULL_HANDLE;
+	VkFramebuffer m_framebuffer = VK_NULL_HANDLE;
+	uint32_t m_sliceCount = 0;
+	RecordFunction m_record;
+	std::vector<VkCommandBuffer> m_sliceCommandBuffers;
+	std::exception_ptr m_exception;
+
+	std::mutex m_mutex;
+	std::condition_variable m_jobAvailable;
+	std::condition_variable m_jobFinished;
+	uint64_t m_jobId = 0;
+	uint32_t m_nextSlice = 0;
+	uint32_t m_finishedThreads = 0;
+	bool m_stopping = false;
+
+	VkDevice m_device;
+};
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include "PipelineCache.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace {
+	constexpr uint64_t kHashSeed = 14695981039346656037ull;
+	constexpr uint64_t kHashPrime = 1099511628211ull;
+
+	uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= kHashPrime;
+		}
+
+		return hash;
+	}
+
+	template<typename T>
+	uint64_t HashField(uint64_t hash, const T& value)
+	{
+		return HashBytes(hash, &value, sizeof(value));
+	}
+
+	//the length goes in too, so neighbouring strings and lists can't trade elements and hash the same
+	uint64_t HashField(uint64_t hash, const std::string& value)
+	{
+		hash = HashField(hash, value.size());
+		return HashBytes(hash, value.data(), value.size());
+	}
+
+	uint64_t HashField(uint64_t hash, const std::vector<uint32_t>& value)
+	{
+		hash = HashField(hash, value.size());
+		return HashBytes(hash, value.data(), value.size() * sizeof(uint32_t));
+	}
+
+	//every field that changes the pipeline that gets created, the hash and the comparison both go through this
+	auto StateFields(const GraphicsPipelineCreateInfo& state)
+	{
+		return std::tie(state.vertexShaderFilePath, state.fragmentShaderFilePath, state.descriptorSetLayout, state.uiBasedPipeline,
+			state.renderPass, state.cullMode, state.depthBiasEnable, state.depthBiasConstantFactor, state.depthBiasSlopeFactor,
+			state.pushConstantSize, state.noVertexInput, state.positionOnlyVertexInput, state.colorAttachmentCount, state.blendEnable,
+			state.additiveBlend, state.colorWriteMask, state.depthCompareOp, state.depthWriteEnable, state.specializationConstants);
+	}
+}
+
+size_t PipelineCache::StateHash::operator()(const GraphicsPipelineCreateInfo& state) const
+{
+	uint64_t hash = kHashSeed;
+
+	std::apply([&hash](const auto&... fields) {
+		((hash = HashField(hash, fields)), ...);
+	}, StateFields(state));
+
+	return static_cast<size_t>(hash);
+}
+
+bool PipelineCache::StateEqual::operator()(const GraphicsPipelineCreateInfo& a, const GraphicsPipelineCreateInfo& b) const
+{
+	return StateFields(a) == StateFields(b);
+}
+
+PipelineCache::PipelineCache(PipelineCacheCreateInfo createInfo)
+{
+	m_device = createInfo.device;
+
+	VkPipelineCacheCreateInfo cacheInfo{};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+	if (vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_vkPipelineCache) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create pipeline cache!");
+	}
+
+	m_thread = std::thread(&PipelineCache::Work, this);
+}
+
+std::shared_ptr<GraphicsPipeline> PipelineCache::GetPipeline(const GraphicsPipelineCreateInfo& state)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		Entry& entry = m_pipelines[state];
+
+		if (entry.pipeline != nullptr)
+		{
+			return entry.pipeline;
+		}
+
+		if (!entry.creating)
+		{
+			entry.creating = true;
+			return CreatePipeline(lock, state);
+		}
+
+		//the entry stays put while it is being created, Clear waits for every creation before it erases anything
+		//if the other thread failed the loop comes back around and tries itself
+		m_changed.wait(lock, [&entry]() { return !entry.creating; });
+	}
+}
+
+void PipelineCache::Precompile(const std::vector<GraphicsPipelineCreateInfo>& states)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_precompileQueue.insert(m_precompileQueue.end(), states.begin(), states.end());
+	}
+
+	m_changed.notify_all();
+}
+
+std::set<std::string> PipelineCache::Reload(const std::set<std::string>& shaderFilePaths)
+{
+	std::set<std::string> usedFilePaths;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		//ones still being created may have read the old files, so they are reloaded as well
+		for (auto it = m_pipelines.begin(); it != m_pipelines.end(); it++)
+		{
+			bool vertexChanged = shaderFilePaths.count(it->first.vertexShaderFilePath) > 0;
+			bool fragmentChanged = shaderFilePaths.count(it->first.fragmentShaderFilePath) > 0;
+
+			if ((!vertexChanged && !fragmentChanged) || (it->second.pipeline == nullptr && !it->second.creating))
+			{
+				continue;
+			}
+
+			if (vertexChanged)
+			{
+				usedFilePaths.insert(it->first.vertexShaderFilePath);
+			}
+
+			if (fragmentChanged)
+			{
+				usedFilePaths.insert(it->first.fragmentShaderFilePath);
+			}
+
+			m_reloadQueue.push_back(it->first);
+		}
+	}
+
+	m_changed.notify_all();
+
+	return usedFilePaths;
+}
+
+std::vector<std::shared_ptr<GraphicsPipeline>> PipelineCache::SwapReloaded()
+{
+	std::vector<std::shared_ptr<GraphicsPipeline>> replacedPipelines;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (size_t i = 0; i < m_reloaded.size(); i++)
+	{
+		Entry& entry = m_pipelines[m_reloaded[i].state];
+
+		//an entry still being created has its creator write it, the reload is swapped in over that on a later frame
+		if (entry.creating)
+		{
+			continue;
+		}
+
+		if (entry.pipeline != nullptr)
+		{
+			replacedPipelines.push_back(entry.pipeline);
+		}
+
+		entry.pipeline = m_reloaded[i].pipeline;
+		m_reloaded[i].pipeline = nullptr;
+	}
+
+	m_reloaded.erase(std::remove_if(m_reloaded.begin(), m_reloaded.end(), [](const ReloadedPipeline& reloaded) { return reloaded.pipeline == nullptr; }), m_reloaded.end());
+
+	return replacedPipelines;
+}
+
+void PipelineCache::Work()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_changed.wait(lock, [this]() { return m_stopping || !m_reloadQueue.empty() || !m_precompileQueue.empty(); });
+
+		if (m_stopping)
+		{
+			return;
+		}
+
+		if (!m_reloadQueue.empty())
+		{
+			GraphicsPipelineCreateInfo state = m_reloadQueue.front();
+			m_reloadQueue.pop_front();
+
+			try
+			{
+				ReloadedPipeline reloaded;
+				reloaded.state = state;
+				reloaded.pipeline = CreateUnlocked(lock, state);
+
+				m_reloaded.push_back(reloaded);
+			}
+			catch (const std::exception& exception)
+			{
+				std::cout << "Warning: failed to reload pipeline for " << state.vertexShaderFilePath << ", keeping the old one, " << exception.what() << std::endl;
+			}
+
+			continue;
+		}
+
+		GraphicsPipelineCreateInfo state = m_precompileQueue.front();
+		m_precompileQueue.pop_front();
+
+		Entry& entry = m_pipelines[state];
+		if (entry.pipeline != nullptr || entry.creating)
+		{
+			continue;
+		}
+
+		entry.creating = true;
+
+		try
+		{
+			CreatePipeline(lock, state);
+		}
+		catch (const std::exception& exception)
+		{
+			//the render thread gets the same error if it ever asks for the state itself
+			std::cout << "Warning: failed to precompile pipeline for " << state.vertexShaderFilePath << ", " << exception.what() << std::endl;
+		}
+	}
+}
+
+std::shared_ptr<GraphicsPipeline> PipelineCache::CreatePipeline(std::unique_lock<std::mutex>& lock, const GraphicsPipelineCreateInfo& state)
+{
+	std::shared_ptr<GraphicsPipeline> pipeline = nullptr;
+
+	try
+	{
+		pipeline = CreateUnlocked(lock, state);
+	}
+	catch (...)
+	{
+		//a failed entry goes back to empty, so the next thread to ask tries again and sees the error
+		m_pipelines[state].creating = false;
+		m_changed.notify_all();
+		throw;
+	}
+
+	Entry& entry = m_pipelines[state];
+	entry.pipeline = pipeline;
+	entry.creating = false;
+
+	m_changed.notify_all();
+
+	return pipeline;
+}
+
+std::shared_ptr<GraphicsPipeline> PipelineCache::CreateUnlocked(std::unique_lock<std::mutex>& lock, const GraphicsPipelineCreateInfo& state)
+{
+	m_creatingCount++;
+	lock.unlock();
+
+	GraphicsPipelineCreateInfo createInfo = state;
+	createInfo.pipelineCache = m_vkPipelineCache;
+
+	std::shared_ptr<GraphicsPipeline> pipeline = nullptr;
+	std::exception_ptr exception = nullptr;
+
+	try
+	{
+		pipeline = std::make_shared<GraphicsPipeline>(createInfo);
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
+
+	lock.lock();
+	m_creatingCount--;
+
+	//Clear waits for this to reach 0
+	m_changed.notify_all();
+
+	if (exception != nullptr)
+	{
+		std::rethrow_exception(exception);
+	}
+
+	return pipeline;
+}
+
+std::vector<std::shared_ptr<GraphicsPipeline>> PipelineCache::Clear()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	m_precompileQueue.clear();
+	m_reloadQueue.clear();
+	m_changed.wait(lock, [this]() { return m_creatingCount == 0; });
+
+	//never swapped in, so nothing was recorded with them
+	for (size_t i = 0; i < m_reloaded.size(); i++)
+	{
+		m_reloaded[i].pipeline->DestroyPipeline();
+	}
+	m_reloaded.clear();
+
+	std::vector<std::shared_ptr<GraphicsPipeline>> clearedPipelines;
+	for (auto it = m_pipelines.begin(); it != m_pipelines.end(); it++)
+	{
+		if (it->second.pipeline != nullptr)
+		{
+			clearedPipelines.push_back(it->second.pipeline);
+		}
+	}
+
+	m_pipelines.clear();
+
+	return clearedPipelines;
+}
+
+void PipelineCache::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_changed.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	//the device is idle by now
+	std::vector<std::shared_ptr<GraphicsPipeline>> clearedPipelines = Clear();
+	for (size_t i = 0; i < clearedPipelines.size(); i++)
+	{
+		clearedPipelines[i]->DestroyPipeline();
+	}
+
+	vkDestroyPipelineCache(m_device, m_vkPipelineCache, nullptr);
+}
\ No newline at end of file
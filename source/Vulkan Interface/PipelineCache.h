@@ -0,0 +1,94 @@
+#pragma once
+
+#include "source/Vulkan Interface/GraphicsPipeline.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//graphics pipelines keyed by a hash of their whole state, each one is created the first time it is asked for
+//states can be queued ahead of time, a background thread creates them so the first frame that needs one doesn't stall on it
+class PipelineCache {
+public:
+	struct PipelineCacheCreateInfo {
+		VkDevice device;
+	};
+
+	PipelineCache(PipelineCacheCreateInfo createInfo);
+
+	//creates the pipeline on the calling thread when nothing has yet, waits for it when another thread is creating it
+	//safe to call from several recording threads at once
+	std::shared_ptr<GraphicsPipeline> GetPipeline(const GraphicsPipelineCreateInfo& state);
+
+	//queues states for the background thread, ones that exist by the time it gets to them are skipped
+	void Precompile(const std::vector<GraphicsPipelineCreateInfo>& states);
+
+	//recreates every pipeline made from one of the shader files on the background thread, the old ones stay in use until SwapReloaded
+	//returns the files at least one existing pipeline was made from
+	std::set<std::string> Reload(const std::set<std::string>& shaderFilePaths);
+
+	//puts the pipelines Reload has finished in place of the old ones, render thread only, between frames
+	//returns the replaced pipelines, the caller destroys them once no frame in flight uses them
+	std::vector<std::shared_ptr<GraphicsPipeline>> SwapReloaded();
+
+	//empties the cache, for when the layouts the pipelines were created with are replaced
+	//waits for any pipeline being created, returns the old pipelines for the caller to destroy once no frame in flight uses them
+	std::vector<std::shared_ptr<GraphicsPipeline>> Clear();
+
+	void Destroy();
+
+private:
+	//only the fields that end up in the pipeline, the device, window and driver cache are the same for every state
+	struct StateHash {
+		size_t operator()(const GraphicsPipelineCreateInfo& state) const;
+	};
+
+	struct StateEqual {
+		bool operator()(const GraphicsPipelineCreateInfo& a, const GraphicsPipelineCreateInfo& b) const;
+	};
+
+	struct Entry {
+		std::shared_ptr<GraphicsPipeline> pipeline;
+
+		//set while a thread creates the pipeline, others asking for it wait instead of creating it twice
+		bool creating = false;
+	};
+
+	struct ReloadedPipeline {
+		GraphicsPipelineCreateInfo state;
+		std::shared_ptr<GraphicsPipeline> pipeline;
+	};
+
+	void Work();
+
+	//creates the state's pipeline with the lock released, the entry has to be marked as creating first
+	std::shared_ptr<GraphicsPipeline> CreatePipeline(std::unique_lock<std::mutex>& lock, const GraphicsPipelineCreateInfo& state);
+
+	//creates the pipeline with the lock released without touching its entry, rethrows what creating it threw
+	std::shared_ptr<GraphicsPipeline> CreateUnlocked(std::unique_lock<std::mutex>& lock, const GraphicsPipelineCreateInfo& state);
+
+	std::unordered_map<GraphicsPipelineCreateInfo, Entry, StateHash, StateEqual> m_pipelines;
+	std::deque<GraphicsPipelineCreateInfo> m_precompileQueue;
+
+	//reloads go before precompiles, the finished ones wait here for the render thread to swap them in
+	std::deque<GraphicsPipelineCreateInfo> m_reloadQueue;
+	std::vector<ReloadedPipeline> m_reloaded;
+	uint32_t m_creatingCount = 0;
+
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	std::thread m_thread;
+	bool m_stopping = false;
+
+	//the driver's cache lets variants that share shader stages skip most of the compile, it is internally synchronized
+	VkPipelineCache m_vkPipelineCache = VK_NULL_HANDLE;
+
+	VkDevice m_device;
+};
\ No newline at end of file
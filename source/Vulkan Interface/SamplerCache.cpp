@@ -0,0 +1,64 @@
+#include "SamplerCache.h"
+
+#include <stdexcept>
+
+SamplerCache::SamplerCache(SamplerCacheCreateInfo createInfo)
+{
+	m_device = createInfo.device;
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(createInfo.physicalDevice, &properties);
+	m_maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+
+	GetSamplerId(SamplerState{});
+}
+
+uint32_t SamplerCache::GetSamplerId(const SamplerState& state)
+{
+	auto it = m_samplerIds.find(state);
+	if (it != m_samplerIds.end())
+	{
+		return it->second;
+	}
+
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = state.filter;
+	samplerInfo.minFilter = state.filter;
+	samplerInfo.addressModeU = state.addressMode;
+	samplerInfo.addressModeV = state.addressMode;
+	samplerInfo.addressModeW = state.addressMode;
+	samplerInfo.anisotropyEnable = state.anisotropic ? VK_TRUE : VK_FALSE;
+	samplerInfo.maxAnisotropy = state.anisotropic ? m_maxAnisotropy : 1.0f;
+	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	samplerInfo.unnormalizedCoordinates = VK_FALSE;
+	samplerInfo.compareEnable = VK_FALSE;
+	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	samplerInfo.mipmapMode = (state.filter == VK_FILTER_LINEAR) ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.mipLodBias = 0.0f;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+	VkSampler sampler;
+	if (vkCreateSampler(m_device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create texture sampler!");
+	}
+
+	uint32_t samplerId = static_cast<uint32_t>(m_samplers.size());
+	m_samplers.push_back(sampler);
+	m_samplerIds[state] = samplerId;
+
+	return samplerId;
+}
+
+void SamplerCache::Destroy()
+{
+	for (size_t i = 0; i < m_samplers.size(); i++)
+	{
+		vkDestroySampler(m_device, m_samplers[i], nullptr);
+	}
+
+	m_samplers.clear();
+	m_samplerIds.clear();
+}
\ No newline at end of file
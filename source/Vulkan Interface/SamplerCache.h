@@ -0,0 +1,47 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+//one VkSampler per distinct sampler state, textures refer to them by id instead of owning one each
+//the samplers are bound as an immutable array and the shaders look a texture's id up by its index
+class SamplerCache {
+public:
+	struct SamplerCacheCreateInfo {
+		VkPhysicalDevice physicalDevice;
+		VkDevice device;
+	};
+
+	//samplers clamp to every level an image has, so the mip count isn't part of the state
+	struct SamplerState {
+		VkFilter filter = VK_FILTER_LINEAR;
+		VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		bool anisotropic = true;
+
+		auto operator<=>(const SamplerState&) const = default;
+	};
+
+	//the default state always has id 0, so the sampler array is never empty
+	SamplerCache(SamplerCacheCreateInfo createInfo);
+
+	//creates the sampler the first time a state is asked for
+	uint32_t GetSamplerId(const SamplerState& state);
+	VkSampler GetSampler(uint32_t samplerId) { return m_samplers[samplerId]; }
+
+	//in id order, descriptor set layouts take these as their immutable samplers
+	const std::vector<VkSampler>& GetSamplers() { return m_samplers; }
+
+	void Destroy();
+
+private:
+	std::map<SamplerState, uint32_t> m_samplerIds;
+	std::vector<VkSampler> m_samplers;
+
+	float m_maxAnisotropy = 1.0f;
+
+	VkDevice m_device;
+};
\ No newline at end of file
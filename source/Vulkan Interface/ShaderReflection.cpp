@@ -0,0 +1,480 @@
+#include "ShaderReflection.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+	constexpr uint32_t kSpirvMagic = 0x07230203;
+	constexpr size_t kHeaderWordCount = 5;
+
+	//the few opcodes, decorations and storage classes the reflection needs, numbered as in the SPIR-V specification
+	enum Opcode : uint32_t {
+		OpEntryPoint = 15,
+		OpTypeInt = 21,
+		OpTypeFloat = 22,
+		OpTypeVector = 23,
+		OpTypeMatrix = 24,
+		OpTypeImage = 25,
+		OpTypeSampler = 26,
+		OpTypeSampledImage = 27,
+		OpTypeArray = 28,
+		OpTypeRuntimeArray = 29,
+		OpTypeStruct = 30,
+		OpTypePointer = 32,
+		OpConstant = 43,
+		OpVariable = 59,
+		OpDecorate = 71
+	};
+
+	enum Decoration : uint32_t {
+		DecorationBlock = 2,
+		DecorationBufferBlock = 3,
+		DecorationBuiltIn = 11,
+		DecorationLocation = 30,
+		DecorationBinding = 33,
+		DecorationDescriptorSet = 34
+	};
+
+	enum StorageClass : uint32_t {
+		StorageClassUniformConstant = 0,
+		StorageClassInput = 1,
+		StorageClassUniform = 2,
+		StorageClassStorageBuffer = 12
+	};
+
+	enum ExecutionModel : uint32_t {
+		ExecutionModelVertex = 0,
+		ExecutionModelFragment = 4,
+		ExecutionModelGLCompute = 5
+	};
+
+	constexpr uint32_t kDimBuffer = 5;
+	constexpr uint32_t kImageStorage = 2;
+
+	enum class NumericType {
+		Float,
+		Signed,
+		Unsigned,
+		Other
+	};
+
+	NumericType GetNumericType(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_R32G32_SFLOAT:
+		case VK_FORMAT_R32G32B32_SFLOAT:
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return NumericType::Float;
+		case VK_FORMAT_R32_SINT:
+		case VK_FORMAT_R32G32_SINT:
+		case VK_FORMAT_R32G32B32_SINT:
+		case VK_FORMAT_R32G32B32A32_SINT:
+			return NumericType::Signed;
+		case VK_FORMAT_R32_UINT:
+		case VK_FORMAT_R32G32_UINT:
+		case VK_FORMAT_R32G32B32_UINT:
+		case VK_FORMAT_R32G32B32A32_UINT:
+			return NumericType::Unsigned;
+		default:
+			return NumericType::Other;
+		}
+	}
+
+	//what the shader sees of a binding, it can't tell whether the buffer is bound at an offset
+	VkDescriptorType GetStaticType(VkDescriptorType type)
+	{
+		switch (type)
+		{
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+			return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		default:
+			return type;
+		}
+	}
+}
+
+ShaderReflection::ShaderReflection(const std::vector<char>& code, const std::string& filePath)
+{
+	m_filePath = filePath;
+
+	if (code.size() % sizeof(uint32_t) != 0 || code.size() < kHeaderWordCount * sizeof(uint32_t))
+	{
+		throw std::runtime_error(filePath + " isn't SPIR-V!");
+	}
+
+	std::vector<uint32_t> words(code.size() / sizeof(uint32_t));
+	std::copy(code.begin(), code.end(), reinterpret_cast<char*>(words.data()));
+
+	if (words[0] != kSpirvMagic)
+	{
+		throw std::runtime_error(filePath + " isn't SPIR-V!");
+	}
+
+	Parse(words.data(), words.size());
+}
+
+void ShaderReflection::Parse(const uint32_t* words, size_t wordCount)
+{
+	struct Variable {
+		uint32_t id;
+		uint32_t pointerTypeId;
+		uint32_t storageClass;
+	};
+
+	std::vector<Variable> variables;
+
+	size_t offset = kHeaderWordCount;
+	while (offset < wordCount)
+	{
+		uint32_t opcode = words[offset] & 0xFFFF;
+		uint32_t instructionWordCount = words[offset] >> 16;
+
+		if (instructionWordCount == 0 || offset + instructionWordCount > wordCount)
+		{
+			throw std::runtime_error(m_filePath + " has a malformed instruction!");
+		}
+
+		const uint32_t* operands = words + offset + 1;
+		uint32_t operandCount = instructionWordCount - 1;
+
+		switch (opcode)
+		{
+		case OpEntryPoint:
+			if (operands[0] == ExecutionModelVertex)
+			{
+				m_stage = VK_SHADER_STAGE_VERTEX_BIT;
+			}
+			else if (operands[0] == ExecutionModelFragment)
+			{
+				m_stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+			}
+			else if (operands[0] == ExecutionModelGLCompute)
+			{
+				m_stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			}
+			break;
+		case OpDecorate:
+		{
+			Decorations& decorations = m_decorations[operands[0]];
+
+			if (operands[1] == DecorationLocation)
+			{
+				decorations.hasLocation = true;
+				decorations.location = operands[2];
+			}
+			else if (operands[1] == DecorationBinding)
+			{
+				decorations.hasBinding = true;
+				decorations.binding = operands[2];
+			}
+			else if (operands[1] == DecorationDescriptorSet)
+			{
+				decorations.set = operands[2];
+			}
+			else if (operands[1] == DecorationBuiltIn)
+			{
+				decorations.builtIn = true;
+			}
+			else if (operands[1] == DecorationBlock)
+			{
+				decorations.block = true;
+			}
+			else if (operands[1] == DecorationBufferBlock)
+			{
+				decorations.bufferBlock = true;
+			}
+			break;
+		}
+		case OpTypeInt:
+		case OpTypeFloat:
+		case OpTypeVector:
+		case OpTypeMatrix:
+		case OpTypeImage:
+		case OpTypeSampler:
+		case OpTypeSampledImage:
+		case OpTypeArray:
+		case OpTypeRuntimeArray:
+		case OpTypeStruct:
+		case OpTypePointer:
+			m_typeOpcodes[operands[0]] = opcode;
+			m_typeOperands[operands[0]] = std::vector<uint32_t>(operands + 1, operands + operandCount);
+			break;
+		case OpConstant:
+			//array lengths, they are 32 bit so the first word is the whole value
+			m_constants[operands[1]] = operands[2];
+			break;
+		case OpVariable:
+			variables.push_back({ operands[1], operands[0], operands[2] });
+			break;
+		default:
+			break;
+		}
+
+		offset += instructionWordCount;
+	}
+
+	for (size_t i = 0; i < variables.size(); i++)
+	{
+		const Decorations& decorations = m_decorations[variables[i].id];
+
+		//the pointer's operands are its storage class and the type it points to
+		uint32_t typeId = GetType(variables[i].pointerTypeId)[1];
+
+		if (variables[i].storageClass == StorageClassInput && m_stage == VK_SHADER_STAGE_VERTEX_BIT)
+		{
+			if (decorations.hasLocation && !decorations.builtIn)
+			{
+				AddVertexInput(decorations.location, typeId);
+			}
+		}
+		else if (variables[i].storageClass == StorageClassUniformConstant || variables[i].storageClass == StorageClassUniform || variables[i].storageClass == StorageClassStorageBuffer)
+		{
+			if (decorations.hasBinding)
+			{
+				AddBinding(variables[i].id, typeId, variables[i].storageClass);
+			}
+		}
+	}
+
+	std::sort(m_vertexInputs.begin(), m_vertexInputs.end(), [](const VertexInput& a, const VertexInput& b) { return a.location < b.location; });
+}
+
+void ShaderReflection::AddVertexInput(uint32_t location, uint32_t typeId)
+{
+	//matrices and arrays take one location for each column or element
+	uint32_t locationCount = 1;
+	uint32_t elementTypeId = typeId;
+
+	if (m_typeOpcodes[typeId] == OpTypeMatrix)
+	{
+		elementTypeId = GetType(typeId)[0];
+		locationCount = GetType(typeId)[1];
+	}
+	else if (m_typeOpcodes[typeId] == OpTypeArray)
+	{
+		elementTypeId = GetType(typeId)[0];
+		locationCount = m_constants[GetType(typeId)[1]];
+	}
+
+	VkFormat format = GetFormat(elementTypeId);
+
+	for (uint32_t i = 0; i < locationCount; i++)
+	{
+		VertexInput input;
+		input.location = location + i;
+		input.format = format;
+
+		m_vertexInputs.push_back(input);
+	}
+}
+
+void ShaderReflection::AddBinding(uint32_t variableId, uint32_t typeId, uint32_t storageClass)
+{
+	const Decorations& decorations = m_decorations[variableId];
+
+	Binding binding;
+	binding.set = decorations.set;
+	binding.binding = decorations.binding;
+
+	if (m_typeOpcodes[typeId] == OpTypeArray)
+	{
+		binding.count = m_constants[GetType(typeId)[1]];
+		typeId = GetType(typeId)[0];
+	}
+	else if (m_typeOpcodes[typeId] == OpTypeRuntimeArray)
+	{
+		binding.count = 0;
+		typeId = GetType(typeId)[0];
+	}
+
+	switch (m_typeOpcodes[typeId])
+	{
+	case OpTypeSampler:
+		binding.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+		break;
+	case OpTypeSampledImage:
+		binding.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		break;
+	case OpTypeImage:
+	{
+		//the operands after the sampled type are dim, depth, arrayed, multisampled and sampled
+		const std::vector<uint32_t>& image = GetType(typeId);
+		bool storage = image[5] == kImageStorage;
+
+		if (image[1] == kDimBuffer)
+		{
+			binding.type = storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+		}
+		else {
+			binding.type = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		}
+		break;
+	}
+	case OpTypeStruct:
+		//structured buffers come out of dxc as uniform blocks decorated BufferBlock
+		if (storageClass == StorageClassStorageBuffer || m_decorations[typeId].bufferBlock)
+		{
+			binding.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+		else {
+			binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		}
+		break;
+	default:
+		throw std::runtime_error(m_filePath + " has a resource at binding " + std::to_string(binding.binding) + " of a type that can't be reflected!");
+	}
+
+	m_bindings.push_back(binding);
+}
+
+VkFormat ShaderReflection::GetFormat(uint32_t typeId)
+{
+	uint32_t componentCount = 1;
+	uint32_t componentTypeId = typeId;
+
+	if (m_typeOpcodes[typeId] == OpTypeVector)
+	{
+		componentTypeId = GetType(typeId)[0];
+		componentCount = GetType(typeId)[1];
+	}
+
+	const std::vector<uint32_t>& componentType = GetType(componentTypeId);
+
+	if (componentType.empty() || componentType[0] != 32 || componentCount > 4)
+	{
+		throw std::runtime_error(m_filePath + " has a vertex input that isn't made of up to four 32 bit components!");
+	}
+
+	static const VkFormat kFloatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+	static const VkFormat kSignedFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+	static const VkFormat kUnsignedFormats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+	if (m_typeOpcodes[componentTypeId] == OpTypeFloat)
+	{
+		return kFloatFormats[componentCount - 1];
+	}
+
+	//an integer's operands are its width and whether it is signed
+	return (componentType[1] != 0) ? kSignedFormats[componentCount - 1] : kUnsignedFormats[componentCount - 1];
+}
+
+const std::vector<uint32_t>& ShaderReflection::GetType(uint32_t typeId)
+{
+	auto it = m_typeOperands.find(typeId);
+
+	if (it == m_typeOperands.end())
+	{
+		throw std::runtime_error(m_filePath + " uses a type it never declares!");
+	}
+
+	return it->second;
+}
+
+std::vector<VkDescriptorSetLayoutBinding> ShaderReflection::GetLayoutBindings(const std::vector<std::string>& shaderFilePaths, uint32_t set)
+{
+	std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+
+	for (size_t i = 0; i < shaderFilePaths.size(); i++)
+	{
+		ShaderReflection reflection(VulkanCommonFunctions::ReadShaderFile(shaderFilePaths[i]), shaderFilePaths[i]);
+
+		for (const Binding& binding : reflection.GetBindings())
+		{
+			if (binding.set != set)
+			{
+				continue;
+			}
+
+			auto existing = std::find_if(layoutBindings.begin(), layoutBindings.end(), [&binding](const VkDescriptorSetLayoutBinding& layoutBinding) { return layoutBinding.binding == binding.binding; });
+
+			if (existing == layoutBindings.end())
+			{
+				VkDescriptorSetLayoutBinding layoutBinding{};
+				layoutBinding.binding = binding.binding;
+				layoutBinding.descriptorType = binding.type;
+				layoutBinding.descriptorCount = binding.count;
+				layoutBinding.pImmutableSamplers = nullptr;
+				layoutBinding.stageFlags = reflection.GetStage();
+
+				layoutBindings.push_back(layoutBinding);
+				continue;
+			}
+
+			existing->stageFlags |= reflection.GetStage();
+
+			bool imageAndSampler = (existing->descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE && binding.type == VK_DESCRIPTOR_TYPE_SAMPLER) ||
+				(existing->descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER && binding.type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+
+			if (imageAndSampler)
+			{
+				existing->descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			}
+			else if (existing->descriptorType != binding.type && existing->descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+			{
+				throw std::runtime_error(shaderFilePaths[i] + " uses binding " + std::to_string(binding.binding) + " as a different type than the other shaders of its layout!");
+			}
+		}
+	}
+
+	std::sort(layoutBindings.begin(), layoutBindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) { return a.binding < b.binding; });
+
+	return layoutBindings;
+}
+
+void ShaderReflection::SetDynamic(std::vector<VkDescriptorSetLayoutBinding>& layoutBindings, uint32_t binding)
+{
+	for (size_t i = 0; i < layoutBindings.size(); i++)
+	{
+		if (layoutBindings[i].binding != binding)
+		{
+			continue;
+		}
+
+		if (layoutBindings[i].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+		{
+			layoutBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		}
+		else if (layoutBindings[i].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+		{
+			layoutBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+		}
+	}
+}
+
+void ShaderReflection::CheckLayoutBindings(const std::vector<std::string>& shaderFilePaths, const std::vector<VkDescriptorSetLayoutBinding>& layoutBindings, uint32_t set)
+{
+	for (size_t i = 0; i < shaderFilePaths.size(); i++)
+	{
+		std::vector<VkDescriptorSetLayoutBinding> shaderBindings = GetLayoutBindings({ shaderFilePaths[i] }, set);
+
+		for (const VkDescriptorSetLayoutBinding& shaderBinding : shaderBindings)
+		{
+			auto layoutBinding = std::find_if(layoutBindings.begin(), layoutBindings.end(), [&shaderBinding](const VkDescriptorSetLayoutBinding& binding) { return binding.binding == shaderBinding.binding; });
+
+			if (layoutBinding == layoutBindings.end())
+			{
+				throw std::runtime_error(shaderFilePaths[i] + " uses binding " + std::to_string(shaderBinding.binding) + ", which isn't in its descriptor set layout!");
+			}
+
+			if (GetStaticType(layoutBinding->descriptorType) != shaderBinding.descriptorType)
+			{
+				throw std::runtime_error(shaderFilePaths[i] + " uses binding " + std::to_string(shaderBinding.binding) + " as a different type than its descriptor set layout!");
+			}
+
+			//runtime sized arrays take whatever the layout gives them
+			if (shaderBinding.descriptorCount != 0 && layoutBinding->descriptorCount < shaderBinding.descriptorCount)
+			{
+				throw std::runtime_error(shaderFilePaths[i] + " uses more descriptors at binding " + std::to_string(shaderBinding.binding) + " than its descriptor set layout has!");
+			}
+		}
+	}
+}
+
+bool ShaderReflection::HasSameNumericType(VkFormat a, VkFormat b)
+{
+	return GetNumericType(a) == GetNumericType(b) && GetNumericType(a) != NumericType::Other;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//reads the interface of a compiled shader straight from its SPIR-V, so layouts on the CPU side can be built from it or checked against it
+//only decorations are read, which the release shader build keeps when it strips the debug info
+class ShaderReflection {
+public:
+	struct VertexInput {
+		uint32_t location = 0;
+
+		//the 32 bit format matching the type the shader reads, a matrix takes one location per column
+		VkFormat format = VK_FORMAT_UNDEFINED;
+	};
+
+	struct Binding {
+		uint32_t set = 0;
+		uint32_t binding = 0;
+		VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+
+		//0 for runtime sized arrays, the caller decides how many descriptors they get
+		uint32_t count = 1;
+	};
+
+	//the file path is only used in error messages
+	ShaderReflection(const std::vector<char>& code, const std::string& filePath);
+
+	VkShaderStageFlagBits GetStage() const { return m_stage; }
+	const std::vector<VertexInput>& GetVertexInputs() const { return m_vertexInputs; }
+	const std::vector<Binding>& GetBindings() const { return m_bindings; }
+
+	//every binding of the set the shaders use, with the stages that use it
+	//a separate image and sampler at the same binding become one combined image sampler, like the shadow atlas
+	//SPIR-V has no dynamic buffers, callers that bind at offsets switch those bindings with SetDynamic
+	static std::vector<VkDescriptorSetLayoutBinding> GetLayoutBindings(const std::vector<std::string>& shaderFilePaths, uint32_t set = 0);
+	static void SetDynamic(std::vector<VkDescriptorSetLayoutBinding>& layoutBindings, uint32_t binding);
+
+	//for layouts built by hand, throws when one of the shaders uses a binding the layout doesn't have, or has it as another type or with fewer descriptors
+	//dynamic buffers match their plain type, stages aren't compared since dxc keeps resources an entry point never reads
+	static void CheckLayoutBindings(const std::vector<std::string>& shaderFilePaths, const std::vector<VkDescriptorSetLayoutBinding>& layoutBindings, uint32_t set = 0);
+
+	//float, signed and unsigned, vertex attributes only have to agree on this with the shader, not on the component count
+	static bool HasSameNumericType(VkFormat a, VkFormat b);
+
+private:
+	struct Decorations {
+		bool hasLocation = false;
+		uint32_t location = 0;
+
+		bool hasBinding = false;
+		uint32_t binding = 0;
+		uint32_t set = 0;
+
+		bool builtIn = false;
+		bool block = false;
+		bool bufferBlock = false;
+	};
+
+	void Parse(const uint32_t* words, size_t wordCount);
+	void AddVertexInput(uint32_t location, uint32_t typeId);
+	void AddBinding(uint32_t variableId, uint32_t typeId, uint32_t storageClass);
+
+	VkFormat GetFormat(uint32_t typeId);
+
+	//the instruction that declared the id, without its opcode word
+	const std::vector<uint32_t>& GetType(uint32_t typeId);
+
+	std::string m_filePath;
+
+	VkShaderStageFlagBits m_stage = VK_SHADER_STAGE_ALL;
+	std::vector<VertexInput> m_vertexInputs;
+	std::vector<Binding> m_bindings;
+
+	//by result id, the opcode is kept next to its operands
+	std::unordered_map<uint32_t, uint32_t> m_typeOpcodes;
+	std::unordered_map<uint32_t, std::vector<uint32_t>> m_typeOperands;
+	std::unordered_map<uint32_t, uint32_t> m_constants;
+	std::unordered_map<uint32_t, Decorations> m_decorations;
+};
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "ShadowAtlas.h"
+#include "source/Vulkan Interface/VulkanWindow.h"
+
+ShadowAtlas::ShadowAtlas(ShadowAtlasCreateInfo createInfo) : m_cache(createInfo.atlasSize, createInfo.selectionSettings.minTileSize)
+{
+	m_atlasSize = createInfo.atlasSize;
+	m_settings = createInfo.selectionSettings;
+	m_depthFormat = createInfo.depthFormat;
+	m_allocator = createInfo.allocator;
+	m_device = createInfo.device;
+	m_commandPool = createInfo.commandPool;
+	m_graphicsQueue = createInfo.graphicsQueue;
+	m_vulkanWindow = createInfo.vulkanWindow;
+
+	CreateAtlasImage();
+	CreateRenderPass();
+	CreateFramebuffer();
+	CreateSampler();
+	CreatePipeline();
+}
+
+void ShadowAtlas::CreateAtlasImage()
+{
+	GraphicsImage::GraphicsImageCreateInfo imageCreateInfo{};
+	imageCreateInfo.imageSize = { m_atlasSize, m_atlasSize };
+	imageCreateInfo.format = m_depthFormat;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	imageCreateInfo.allocator = m_allocator;
+	imageCreateInfo.device = m_device;
+	imageCreateInfo.commandPool = m_commandPool;
+	imageCreateInfo.graphicsQueue = m_graphicsQueue;
+
+	m_atlasImage = std::make_shared<GraphicsImage>(imageCreateInfo);
+	m_atlasImage->CreateImageView(VK_IMAGE_ASPECT_DEPTH_BIT);
+
+	//the atlas lives in the sampled layout between shadow passes, tiles are cleared before they are first drawn
+	m_atlasImage->TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void ShadowAtlas::CreateRenderPass()
+{
+	VkAttachmentDescription depthAttachment{};
+	depthAttachment.format = m_depthFormat;
+	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkAttachmentReference depthAttachmentReference{};
+	depthAttachmentReference.attachment = 0;
+	depthAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 0;
+	subpass.pDepthStencilAttachment = &depthAttachmentReference;
+
+	std::array<VkSubpassDependency, 2> dependencies{};
+
+	//earlier frames sample the atlas before this pass overwrites tiles, from the deferred lighting pass too
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	//and the main pass samples what was just written
+	dependencies[1].srcSubpass = 0;
+	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	VkRenderPassCreateInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = 1;
+	renderPassInfo.pAttachments = &depthAttachment;
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+	renderPassInfo.pDependencies = dependencies.data();
+
+	if (vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create shadow render pass!");
+	}
+}
+
+void ShadowAtlas::CreateFramebuffer()
+{
+	VkImageView attachment = m_atlasImage->GetImageView();
+
+	VkFramebufferCreateInfo framebufferInfo{};
+	framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebufferInfo.renderPass = m_renderPass;
+	framebufferInfo.attachmentCount = 1;
+	framebufferInfo.pAttachments = &attachment;
+	framebufferInfo.width = m_atlasSize;
+	framebufferInfo.height = m_atlasSize;
+	framebufferInfo.layers = 1;
+
+	if (vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &m_framebuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create shadow framebuffer!");
+	}
+}
+
+void ShadowAtlas::CreateSampler()
+{
+	//comparison with linear filtering gives 2x2 pcf from every lookup
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = VK_FILTER_LINEAR;
+	samplerInfo.minFilter = VK_FILTER_LINEAR;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.anisotropyEnable = VK_FALSE;
+	samplerInfo.maxAnisotropy = 1.0f;
+	samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	samplerInfo.unnormalizedCoordinates = VK_FALSE;
+	samplerInfo.compareEnable = VK_TRUE;
+	samplerInfo.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.mipLodBias = 0.0f;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = 0.0f;
+
+	if (vkCreateSampler(m_device, &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create shadow sampler!");
+	}
+}
+
+void ShadowAtlas::CreatePipeline()
+{
+	//the faces aren't y flipped like the main camera so their winding is reversed, nothing is culled and the slope bias handles acne
+	GraphicsPipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.vertexShaderFilePath = "shaders/HLSL/ShadowVertexShader.spv";
+	pipelineCreateInfo.fragmentShaderFilePath = "";
+	pipelineCreateInfo.descriptorSetLayout = VK_NULL_HANDLE;
+	pipelineCreateInfo.device = m_device;
+	pipelineCreateInfo.vulkanWindow = m_vulkanWindow;
+	pipelineCreateInfo.uiBasedPipeline = false;
+	pipelineCreateInfo.renderPass = m_renderPass;
+	pipelineCreateInfo.cullMode = VK_CULL_MODE_NONE;
+	pipelineCreateInfo.depthBiasEnable = true;
+	pipelineCreateInfo.depthBiasConstantFactor = 1.25f;
+	pipelineCreateInfo.depthBiasSlopeFactor = 1.75f;
+	pipelineCreateInfo.pushConstantSize = sizeof(glm::mat4);
+
+	m_pipeline = std::make_shared<GraphicsPipeline>(pipelineCreateInfo);
+}
+
+void ShadowAtlas::SelectLights(const ShadowLightSelector::ViewInfo& view, const std::vector<RenderSnapshot::LightSnapshot>& lightSnapshots, std::vector<VulkanCommonFunctions::LightInfo>& lights)
+{
+	m_candidates.clear();
+
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		lights[i].shadowIndex = -1;
+
+		if (i >= lightSnapshots.size())
+		{
+			continue;
+		}
+
+		ShadowLightSelector::Light candidate;
+		candidate.lightIndex = i;
+		candidate.lightKey = lightSnapshots[i].handle;
+		candidate.position = glm::vec3(lights[i].lightPosition);
+		candidate.range = lights[i].maxLightDistance;
+
+		m_candidates.push_back(candidate);
+	}
+
+	ShadowLightSelector::Select(view, m_candidates, m_settings, m_selections);
+	m_cache.BeginFrame(m_selections);
+
+	const std::vector<ShadowMapCache::Entry>& entries = m_cache.GetEntries();
+	m_shadowInfos.resize(entries.size());
+
+	float texelSize = 1.0f / m_atlasSize;
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const ShadowMapCache::Entry& entry = entries[i];
+		VulkanCommonFunctions::ShadowInfo& shadowInfo = m_shadowInfos[i];
+
+		for (uint32_t face = 0; face < ShadowMapCache::kFaceCount; face++)
+		{
+			const ShadowAtlasAllocator::Tile& tile = entry.faces[face];
+
+			shadowInfo.faceViewProjection[face] = ShadowMapCache::GetFaceViewProjection(entry.light.position, face, ShadowMapCache::kNearPlane, entry.light.range);
+			shadowInfo.faceRects[face] = glm::vec4(tile.x * texelSize, tile.y * texelSize, tile.size * texelSize, tile.size * texelSize);
+		}
+
+		shadowInfo.parameters = glm::vec4(texelSize, kNormalOffset, 0.0f, 0.0f);
+
+		lights[entry.light.lightIndex].shadowIndex = static_cast<int32_t>(i);
+	}
+}
+
+void ShadowAtlas::AddCasters(const std::vector<VulkanCommonFunctions::InstanceInfo>& instances)
+{
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		AddCaster(instances[i]);
+	}
+}
+
+void ShadowAtlas::AddCaster(const VulkanCommonFunctions::InstanceInfo& instance)
+{
+	if (!CastsShadow(instance.materialVariant))
+	{
+		return;
+	}
+
+	//meshes are modelled around a unit cube, the scale's length bounds them with room to spare
+	m_cache.AddCaster(instance.modelMatrix, glm::length(instance.scale));
+}
+
+void ShadowAtlas::RecordShadowPass(VkCommandBuffer commandBuffer, const std::function<void(VkCommandBuffer)>& drawCasters)
+{
+	m_cache.EndFrame();
+
+	//everything is cached, the atlas stays as it is
+	if (m_cache.GetRenderedLightCount() == 0)
+	{
+		return;
+	}
+
+	VkRenderPassBeginInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = m_renderPass;
+	renderPassInfo.framebuffer = m_framebuffer;
+	renderPassInfo.renderArea.offset = { 0, 0 };
+	renderPassInfo.renderArea.extent = { m_atlasSize, m_atlasSize };
+	renderPassInfo.clearValueCount = 0;
+	renderPassInfo.pClearValues = nullptr;
+
+	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->GetVkPipeline());
+
+	const std::vector<ShadowMapCache::Entry>& entries = m_cache.GetEntries();
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (!entries[i].needsRender)
+		{
+			continue;
+		}
+
+		for (uint32_t face = 0; face < ShadowMapCache::kFaceCount; face++)
+		{
+			const ShadowAtlasAllocator::Tile& tile = entries[i].faces[face];
+
+			VkViewport viewport{};
+			viewport.x = static_cast<float>(tile.x);
+			viewport.y = static_cast<float>(tile.y);
+			viewport.width = static_cast<float>(tile.size);
+			viewport.height = static_cast<float>(tile.size);
+			viewport.minDepth = 0.0f;
+			viewport.maxDepth = 1.0f;
+			vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+			VkRect2D scissor{};
+			scissor.offset = { static_cast<int32_t>(tile.x), static_cast<int32_t>(tile.y) };
+			scissor.extent = { tile.size, tile.size };
+			vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+			VkClearAttachment clearAttachment{};
+			clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+			clearAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+			VkClearRect clearRect{};
+			clearRect.rect = scissor;
+			clearRect.baseArrayLayer = 0;
+			clearRect.layerCount = 1;
+
+			vkCmdClearAttachments(commandBuffer, 1, &clearAttachment, 1, &clearRect);
+
+			vkCmdPushConstants(commandBuffer, m_pipeline->GetVkPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &m_shadowInfos[i].faceViewProjection[face]);
+
+			drawCasters(commandBuffer);
+		}
+	}
+
+	vkCmdEndRenderPass(commandBuffer);
+}
+
+void ShadowAtlas::Destroy()
+{
+	m_pipeline->DestroyPipeline();
+
+	vkDestroyFramebuffer(m_device, m_framebuffer, nullptr);
+	vkDestroyRenderPass(m_device, m_renderPass, nullptr);
+	vkDestroySampler(m_device, m_sampler, nullptr);
+
+	m_atlasImage->DestroyImage();
+}
\ No newline at end of file
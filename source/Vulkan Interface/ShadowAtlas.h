@@ -0,0 +1,89 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+#include "source/Vulkan Interface/GraphicsImage.h"
+#include "source/Vulkan Interface/GraphicsPipeline.h"
+#include "source/Management/RenderSnapshot.h"
+#include "source/Lighting/ShadowMapCache.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class VulkanWindow;
+
+//one depth image shared by every shadowed point light, each light renders its six cube faces into tiles of it
+//faces are only drawn again when the cache says the light or something near it moved
+class ShadowAtlas {
+public:
+	struct ShadowAtlasCreateInfo {
+		uint32_t atlasSize = 4096;
+		ShadowLightSelector::Settings selectionSettings;
+
+		VkFormat depthFormat;
+
+		VmaAllocator allocator;
+		VkDevice device;
+		VkCommandPool commandPool;
+		VkQueue graphicsQueue;
+		VulkanWindow* vulkanWindow;
+	};
+
+	ShadowAtlas(ShadowAtlasCreateInfo createInfo);
+
+	//picks the shadowed lights, sets their shadow index and fills the frame's shadow info
+	//light snapshots give the handles that identify a light between frames, they line up with lights
+	void SelectLights(const ShadowLightSelector::ViewInfo& view, const std::vector<RenderSnapshot::LightSnapshot>& lightSnapshots, std::vector<VulkanCommonFunctions::LightInfo>& lights);
+
+	//every instance that will be drawn this frame, in the same order each frame so unchanged scenes hash the same
+	void AddCasters(const std::vector<VulkanCommonFunctions::InstanceInfo>& instances);
+	void AddCaster(const VulkanCommonFunctions::InstanceInfo& instance);
+
+	//draws the out of date faces, recorded outside of any render pass, drawCasters is called once per face
+	void RecordShadowPass(VkCommandBuffer commandBuffer, const std::function<void(VkCommandBuffer)>& drawCasters);
+
+	//indexed by the lights' shadow index, the renderer copies them into its frame ring
+	const std::vector<VulkanCommonFunctions::ShadowInfo>& GetShadowInfos() { return m_shadowInfos; }
+	VkDeviceSize GetShadowInfoBufferSize() { return sizeof(VulkanCommonFunctions::ShadowInfo) * m_settings.maxShadowedLights; }
+
+	VkImageView GetImageView() { return m_atlasImage->GetImageView(); }
+	VkSampler GetSampler() { return m_sampler; }
+
+	void Destroy();
+
+	//unlit and billboarded objects don't cast, the renderer skips their variants when drawing the shadow pass
+	static bool CastsShadow(uint32_t materialVariant) { return (materialVariant & VulkanCommonFunctions::MATERIAL_VARIANT_LIT) != 0 && (materialVariant & VulkanCommonFunctions::MATERIAL_VARIANT_BILLBOARDED) == 0; }
+
+private:
+	void CreateAtlasImage();
+	void CreateRenderPass();
+	void CreateFramebuffer();
+	void CreateSampler();
+	void CreatePipeline();
+
+	//receivers are moved this far along their normal before the lookup to hide acne
+	static constexpr float kNormalOffset = 0.05f;
+
+	uint32_t m_atlasSize;
+	ShadowLightSelector::Settings m_settings;
+
+	ShadowMapCache m_cache;
+
+	std::vector<ShadowLightSelector::Light> m_candidates;
+	std::vector<ShadowLightSelector::Selection> m_selections;
+	std::vector<VulkanCommonFunctions::ShadowInfo> m_shadowInfos;
+
+	VkFormat m_depthFormat;
+
+	std::shared_ptr<GraphicsImage> m_atlasImage;
+	VkRenderPass m_renderPass = VK_NULL_HANDLE;
+	VkFramebuffer m_framebuffer = VK_NULL_HANDLE;
+	VkSampler m_sampler = VK_NULL_HANDLE;
+	std::shared_ptr<GraphicsPipeline> m_pipeline;
+
+	VmaAllocator m_allocator;
+	VkDevice m_device;
+	VkCommandPool m_commandPool;
+	VkQueue m_graphicsQueue;
+	VulkanWindow* m_vulkanWindow;
+};
\ No newline at end of file
@@ -6,11 +6,12 @@ class TextureImage : public GraphicsImage {
 public:
 	TextureImage(GraphicsImageCreateInfo imageCreateInfo) : GraphicsImage(imageCreateInfo) {};
 
-	void CreateTextureSampler(float maxAnisotropy);
-	VkSampler GetTextureSampler() { return m_textureSampler; }
+	//blitting between levels needs the format to support linear filtering with optimal tiling
+	static bool CanBlitMipmaps(VkPhysicalDevice physicalDevice, VkFormat format);
 
-	void DestroyTextureImage();
+	//fills every level from the first by halving it with blits, the image needs transfer source usage
+	//expects every level in transfer destination layout and leaves them all ready to be sampled
+	void GenerateMipmaps();
 
-private:
-	VkSampler m_textureSampler = VK_NULL_HANDLE;
+	void DestroyTextureImage();
 };
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "TextureResidency.h"
+
+TextureResidency::TextureResidency(TextureResidencyCreateInfo createInfo)
+{
+	m_allocator = createInfo.allocator;
+}
+
+void TextureResidency::AddTexture(size_t textureIndex, const std::string& filePath, VkFormat format, bool mipmapped, uint32_t skippedLevels, uint32_t topLevelSize, VkDeviceSize memorySize, bool pinned)
+{
+	if (textureIndex >= m_entries.size())
+	{
+		m_entries.resize(textureIndex + 1);
+	}
+
+	Entry& entry = m_entries[textureIndex];
+	entry.filePath = filePath;
+	entry.format = format;
+	entry.mipmapped = mipmapped;
+	entry.pinned = pinned;
+	entry.resident = true;
+	entry.loading = false;
+	entry.skippedLevels = skippedLevels;
+	entry.baseSkippedLevels = skippedLevels;
+	entry.topLevelSize = topLevelSize;
+	entry.memorySize = memorySize;
+}
+
+void TextureResidency::MarkUsed(size_t textureIndex, uint64_t frameNumber)
+{
+	if (textureIndex < m_entries.size())
+	{
+		m_entries[textureIndex].lastUsedFrame = frameNumber;
+	}
+}
+
+void TextureResidency::UpdateBudget()
+{
+	if (m_textureBudget > 0)
+	{
+		m_usage = 0.0;
+		for (size_t i = 0; i < m_entries.size(); i++)
+		{
+			m_usage += m_entries[i].resident ? m_entries[i].memorySize : 0;
+		}
+
+		m_budget = static_cast<double>(m_textureBudget);
+		return;
+	}
+
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+	vmaGetHeapBudgets(m_allocator, budgets);
+
+	const VkPhysicalDeviceMemoryProperties* memoryProperties;
+	vmaGetMemoryProperties(m_allocator, &memoryProperties);
+
+	//integrated GPUs only have one heap and it is device local, so this still sees the memory textures compete for
+	m_usage = 0.0;
+	m_budget = 0.0;
+
+	for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++)
+	{
+		if (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			m_usage += budgets[i].usage;
+			m_budget += budgets[i].budget;
+		}
+	}
+}
+
+size_t TextureResidency::FindEvictionCandidate(uint64_t frameNumber)
+{
+	size_t candidate = SIZE_MAX;
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		const Entry& entry = m_entries[i];
+
+		if (entry.pinned || !entry.resident || entry.loading || entry.lastUsedFrame + kRestoreWindow >= frameNumber)
+		{
+			continue;
+		}
+
+		if (candidate == SIZE_MAX || entry.lastUsedFrame < m_entries[candidate].lastUsedFrame)
+		{
+			candidate = i;
+		}
+	}
+
+	return candidate;
+}
+
+size_t TextureResidency::FindReductionCandidate()
+{
+	size_t candidate = SIZE_MAX;
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		const Entry& entry = m_entries[i];
+
+		if (entry.pinned || !entry.resident || entry.loading || !entry.mipmapped || entry.topLevelSize <= kMinReducedSize)
+		{
+			continue;
+		}
+
+		if (candidate == SIZE_MAX || entry.lastUsedFrame < m_entries[candidate].lastUsedFrame)
+		{
+			candidate = i;
+		}
+	}
+
+	return candidate;
+}
+
+std::vector<size_t> TextureResidency::FindRestoreCandidates(uint64_t frameNumber)
+{
+	std::vector<size_t> candidates;
+	bool headroom = HasHeadroom();
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		const Entry& entry = m_entries[i];
+
+		if (entry.loading || entry.lastUsedFrame + kRestoreWindow < frameNumber)
+		{
+			continue;
+		}
+
+		//an absent texture is drawn with the fallback, which is worth fixing even under pressure, the next eviction makes room
+		if (!entry.resident || (headroom && entry.skippedLevels > entry.baseSkippedLevels))
+		{
+			candidates.push_back(i);
+		}
+	}
+
+	return candidates;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "source/Vulkan Interface/VulkanCommonFunctions.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//decides which textures stay on the device, by when each texture index was last drawn with and how full device memory is
+//it only keeps the books, VulkanInterface does the loading and releasing it asks for between frames
+class TextureResidency {
+public:
+	struct TextureResidencyCreateInfo {
+		VmaAllocator allocator;
+	};
+
+	struct Entry {
+		std::string filePath;
+		VkFormat format = VK_FORMAT_UNDEFINED;
+
+		//pinned textures are never released, the fallback has to stay for absent textures to point at
+		bool pinned = false;
+
+		//atlases keep only their first level, so they are evicted whole rather than reduced
+		bool mipmapped = true;
+
+		bool resident = true;
+		bool loading = false;
+
+		//how many of the largest levels the resident image leaves out, and how many the texture is loaded with normally
+		uint32_t skippedLevels = 0;
+		uint32_t baseSkippedLevels = 0;
+
+		//the resident image's largest side, a texture isn't reduced below kMinReducedSize
+		uint32_t topLevelSize = 0;
+		VkDeviceSize memorySize = 0;
+
+		uint64_t lastUsedFrame = 0;
+	};
+
+	TextureResidency(TextureResidencyCreateInfo createInfo);
+
+	void AddTexture(size_t textureIndex, const std::string& filePath, VkFormat format, bool mipmapped, uint32_t skippedLevels, uint32_t topLevelSize, VkDeviceSize memorySize, bool pinned);
+	Entry& GetEntry(size_t textureIndex) { return m_entries[textureIndex]; }
+	size_t GetTextureCount() { return m_entries.size(); }
+
+	void MarkUsed(size_t textureIndex, uint64_t frameNumber);
+
+	//0 uses the heap budgets VMA reports for device local memory, otherwise only textures count against this many bytes
+	void SetTextureBudget(VkDeviceSize budget) { m_textureBudget = budget; }
+
+	//reads the budgets once per frame, the two thresholds keep textures from being dropped and restored back and forth
+	void UpdateBudget();
+	bool IsOverBudget() { return m_usage > m_budget * kEvictThreshold; }
+	bool HasHeadroom() { return m_usage < m_budget * kRestoreThreshold; }
+
+	//the least recently used texture that hasn't been drawn within kRestoreWindow frames, SIZE_MAX when there is none
+	size_t FindEvictionCandidate(uint64_t frameNumber);
+
+	//the least recently used texture still larger than kMinReducedSize, textures in use can lose levels without being absent
+	size_t FindReductionCandidate();
+
+	//textures drawn since their images were dropped or reduced, reduced ones only come back when there is headroom
+	std::vector<size_t> FindRestoreCandidates(uint64_t frameNumber);
+
+	static constexpr uint32_t kMinReducedSize = 64;
+
+	//textures drawn within this many frames count as in use, they aren't evicted and absent ones are loaded back
+	static constexpr uint64_t kRestoreWindow = 4;
+
+private:
+	static constexpr double kEvictThreshold = 0.9;
+	static constexpr double kRestoreThreshold = 0.75;
+
+	std::vector<Entry> m_entries;
+
+	VmaAllocator m_allocator;
+
+	VkDeviceSize m_textureBudget = 0;
+	double m_usage = 0.0;
+	double m_budget = 1.0;
+};
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "VulkanCommonFunctions.h"
 
+#include <fstream>
+#include <stdexcept>
+
 namespace VulkanCommonFunctions {
     VkCommandBuffer BeginSingleTimeCommands(VkDevice device, VkCommandPool commandPool) {
         VkCommandBufferAllocateInfo allocInfo{};
@@ -38,6 +41,10 @@ namespace VulkanCommonFunctions {
         return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
     }
 
+    bool IsDepthFormat(VkFormat format) {
+        return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D32_SFLOAT || HasStencilComponent(format);
+    }
+
     QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface) {
         QueueFamilyIndices indices;
 
@@ -71,4 +78,44 @@ namespace VulkanCommonFunctions {
 
         return indices;
     }
+
+    std::vector<char> ReadShaderFile(const std::string& filename) {
+        std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open " + filename + ", build the project or run with --build-shaders to compile the shaders!");
+        }
+
+        size_t fileSize = (size_t)file.tellg();
+        std::vector<char> buffer(fileSize);
+
+        file.seekg(0);
+        file.read(buffer.data(), fileSize);
+
+        file.close();
+
+        return buffer;
+    }
+
+    VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& code) {
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = code.size();
+        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+        VkShaderModule shaderModule;
+        if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module!");
+        }
+
+        return shaderModule;
+    }
+
+    std::vector<uint32_t> GetMaterialSpecializationConstants(uint32_t materialVariant) {
+        return {
+            (materialVariant & MATERIAL_VARIANT_LIT) ? 1u : 0u,
+            (materialVariant & MATERIAL_VARIANT_TEXTURED) ? 1u : 0u,
+            (materialVariant & MATERIAL_VARIANT_BILLBOARDED) ? 1u : 0u
+        };
+    }
 }
\ No newline at end of file
@@ -10,13 +10,51 @@
 #include "glm.hpp"
 
 #include <optional>
+#include <string>
 #include <vector>
 #include <array>
 
 namespace VulkanCommonFunctions {
     using ObjectHandle = size_t;
     static const VulkanCommonFunctions::ObjectHandle INVALID_OBJECT_HANDLE = 0;
-    static const size_t MAX_OBJECTS = 10000;
+    static const size_t MAX_OBJECTS = 32768;
+    //instance buffers are sized for this many instances of one mesh, custom meshes each draw on their own and don't count
+    static const size_t MAX_MESH_INSTANCES = 10000;
+    static const uint32_t MAX_LOD_LEVELS = 8;
+
+    //the object shaders are specialized per variant instead of branching on these flags, bit i is specialization constant i
+    static const uint32_t MATERIAL_VARIANT_LIT = 1;
+    static const uint32_t MATERIAL_VARIANT_TEXTURED = 2;
+    static const uint32_t MATERIAL_VARIANT_BILLBOARDED = 4;
+    static const uint32_t MATERIAL_VARIANT_COUNT = 8;
+
+    //one level of detail of a mesh, every level indexes the same vertices
+    struct LodLevel {
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+
+        //furthest the level strays from the full mesh, as a fraction of the mesh's bounding radius
+        float error = 0.0f;
+
+        //the level's clusters, meshletCount 0 when the mesh was never split into them
+        uint32_t firstMeshlet = 0;
+        uint32_t meshletCount = 0;
+    };
+
+    //a cluster of a mesh's triangles, its indices are contiguous so a single indexed draw covers it
+    //matches MeshletInfo in ClusterCulling.hlsl
+    struct alignas(16) MeshletInfo {
+        //xyz center, w radius, in the mesh's own space
+        glm::vec4 boundingSphere = glm::vec4(0.0f);
+
+        //xyz the average facing of the triangles, w the cutoff past which the camera sees none of their fronts
+        glm::vec4 cone = glm::vec4(0.0f);
+
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        uint32_t vertexCount = 0;
+        uint32_t padding = 0;
+    };
     
     struct alignas(16) GlobalInfo {
         glm::mat4 view;
@@ -34,6 +72,29 @@ namespace VulkanCommonFunctions {
         glm::vec4 lightSpecular;
 
         alignas(4) float maxLightDistance;
+
+        //index into the shadow info buffer, -1 when the light doesn't cast shadows this frame
+        alignas(4) int32_t shadowIndex = -1;
+    };
+
+    //one shadowed point light, a cube face per tile of the shadow atlas
+    struct alignas(16) ShadowInfo {
+        glm::mat4 faceViewProjection[6];
+
+        //xy is the tile's offset and zw its size, both in atlas uv
+        glm::vec4 faceRects[6];
+
+        //x is the size of an atlas texel in uv, y how far receivers are pushed along their normal
+        glm::vec4 parameters;
+    };
+
+    //what the tiled lighting pass needs to rebuild world positions from the g-buffer depth
+    struct alignas(16) DeferredInfo {
+        glm::mat4 inverseView;
+        glm::mat4 inverseProjection;
+
+        alignas(4) uint32_t screenWidth;
+        alignas(4) uint32_t screenHeight;
     };
 
     struct alignas(16) UIGlobalInfo {
@@ -52,12 +113,10 @@ namespace VulkanCommonFunctions {
         alignas(16) glm::vec3 specular;
         alignas(4) float opacity;
         alignas(4) float shininess;
-        alignas(4) uint32_t lit;
-
-        alignas(4) uint32_t textured;
         alignas(4) uint32_t textureIndex;
 
-        alignas(4) uint32_t isBillboarded;
+        //MATERIAL_VARIANT bits, only read on the CPU to pick the pipeline, it sits in what would otherwise be padding
+        alignas(4) uint32_t materialVariant;
     };
 
     struct alignas(16) Vertex {
@@ -79,8 +138,8 @@ namespace VulkanCommonFunctions {
             return result;
         }
 
-        static std::array<VkVertexInputAttributeDescription, 21> GetAttributeDescriptions() {
-            std::array<VkVertexInputAttributeDescription, 21> attributeDescriptions{};
+        static std::array<VkVertexInputAttributeDescription, 18> GetAttributeDescriptions() {
+            std::array<VkVertexInputAttributeDescription, 18> attributeDescriptions{};
 
             attributeDescriptions[0].binding = 0;
             attributeDescriptions[0].location = 0;
@@ -134,25 +193,41 @@ namespace VulkanCommonFunctions {
             attributeDescriptions[16].format = VK_FORMAT_R32_SFLOAT;
             attributeDescriptions[16].offset = offsetof(InstanceInfo, shininess);
 
+            //the lit, textured and billboarded flags that used locations 17, 18 and 20 are specialization constants now
             attributeDescriptions[17].binding = 1;
-            attributeDescriptions[17].location = 17;
+            attributeDescriptions[17].location = 19;
             attributeDescriptions[17].format = VK_FORMAT_R32_UINT;
-            attributeDescriptions[17].offset = offsetof(InstanceInfo, lit);
+            attributeDescriptions[17].offset = offsetof(InstanceInfo, textureIndex);
 
-            attributeDescriptions[18].binding = 1;
-            attributeDescriptions[18].location = 18;
-            attributeDescriptions[18].format = VK_FORMAT_R32_UINT;
-            attributeDescriptions[18].offset = offsetof(InstanceInfo, textured);
+            return attributeDescriptions;
+        }
+    };
 
-            attributeDescriptions[19].binding = 1;
-            attributeDescriptions[19].location = 19;
-            attributeDescriptions[19].format = VK_FORMAT_R32_UINT;
-            attributeDescriptions[19].offset = offsetof(InstanceInfo, textureIndex);
+    //only what a depth pre-pass reads, each mesh keeps a copy of its positions in this layout
+    struct alignas(16) PositionVertex {
+        alignas(16) glm::vec3 pos;
 
-            attributeDescriptions[20].binding = 1;
-            attributeDescriptions[20].location = 20;
-            attributeDescriptions[20].format = VK_FORMAT_R32_UINT;
-            attributeDescriptions[20].offset = offsetof(InstanceInfo, isBillboarded);
+        static std::array<VkVertexInputBindingDescription, 2> GetBindingDescriptions() {
+            std::array<VkVertexInputBindingDescription, 2> result = Vertex::GetBindingDescriptions();
+            result[0].stride = sizeof(PositionVertex);
+
+            return result;
+        }
+
+        //position, model matrix and scale, the locations match Vertex so both layouts feed the same shader
+        static std::array<VkVertexInputAttributeDescription, 6> GetAttributeDescriptions() {
+            std::array<VkVertexInputAttributeDescription, 18> vertexAttributes = Vertex::GetAttributeDescriptions();
+            std::array<VkVertexInputAttributeDescription, 6> attributeDescriptions{};
+
+            attributeDescriptions[0] = vertexAttributes[0];
+            attributeDescriptions[0].offset = offsetof(PositionVertex, pos);
+
+            for (uint32_t i = 3; i < 7; i++)
+            {
+                attributeDescriptions[i - 2] = vertexAttributes[i];
+            }
+
+            attributeDescriptions[5] = vertexAttributes[11];
 
             return attributeDescriptions;
         }
@@ -169,6 +244,17 @@ namespace VulkanCommonFunctions {
         alignas(4) uint32_t textured;
         alignas(4) uint32_t textureIndex;
         alignas(4) uint32_t isTextCharacter;
+
+        //distance field text, textRenderMode matches Font::AtlasType
+        alignas(16) glm::vec4 outlineColor;
+        alignas(16) glm::vec4 shadowColor;
+        alignas(8) glm::vec2 distanceRange;
+        alignas(8) glm::vec2 shadowOffset;
+        alignas(4) float outlineWidth;
+        alignas(4) uint32_t textRenderMode;
+
+        //images sample this part of their texture, offset in xy and size in zw, the whole texture unless they are in an atlas
+        alignas(16) glm::vec4 uvRect;
     };
 
     struct alignas(16) UIVertex {
@@ -189,8 +275,8 @@ namespace VulkanCommonFunctions {
             return result;
         }
 
-        static std::array<VkVertexInputAttributeDescription, 12> GetAttributeDescriptions() {
-            std::array<VkVertexInputAttributeDescription, 12> attributeDescriptions{};
+        static std::array<VkVertexInputAttributeDescription, 19> GetAttributeDescriptions() {
+            std::array<VkVertexInputAttributeDescription, 19> attributeDescriptions{};
 
             attributeDescriptions[0].binding = 0;
             attributeDescriptions[0].location = 0;
@@ -252,6 +338,41 @@ namespace VulkanCommonFunctions {
             attributeDescriptions[11].format = VK_FORMAT_R32_UINT;
             attributeDescriptions[11].offset = offsetof(UIInstanceInfo, isTextCharacter);
 
+            attributeDescriptions[12].binding = 1;
+            attributeDescriptions[12].location = 12;
+            attributeDescriptions[12].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            attributeDescriptions[12].offset = offsetof(UIInstanceInfo, outlineColor);
+
+            attributeDescriptions[13].binding = 1;
+            attributeDescriptions[13].location = 13;
+            attributeDescriptions[13].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            attributeDescriptions[13].offset = offsetof(UIInstanceInfo, shadowColor);
+
+            attributeDescriptions[14].binding = 1;
+            attributeDescriptions[14].location = 14;
+            attributeDescriptions[14].format = VK_FORMAT_R32G32_SFLOAT;
+            attributeDescriptions[14].offset = offsetof(UIInstanceInfo, distanceRange);
+
+            attributeDescriptions[15].binding = 1;
+            attributeDescriptions[15].location = 15;
+            attributeDescriptions[15].format = VK_FORMAT_R32G32_SFLOAT;
+            attributeDescriptions[15].offset = offsetof(UIInstanceInfo, shadowOffset);
+
+            attributeDescriptions[16].binding = 1;
+            attributeDescriptions[16].location = 16;
+            attributeDescriptions[16].format = VK_FORMAT_R32_SFLOAT;
+            attributeDescriptions[16].offset = offsetof(UIInstanceInfo, outlineWidth);
+
+            attributeDescriptions[17].binding = 1;
+            attributeDescriptions[17].location = 17;
+            attributeDescriptions[17].format = VK_FORMAT_R32_UINT;
+            attributeDescriptions[17].offset = offsetof(UIInstanceInfo, textRenderMode);
+
+            attributeDescriptions[18].binding = 1;
+            attributeDescriptions[18].location = 18;
+            attributeDescriptions[18].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            attributeDescriptions[18].offset = offsetof(UIInstanceInfo, uvRect);
+
             return attributeDescriptions;
         }
     };
@@ -268,7 +389,12 @@ namespace VulkanCommonFunctions {
     VkCommandBuffer BeginSingleTimeCommands(VkDevice device, VkCommandPool commandPool);
     void EndSingleTimeCommands(VkCommandBuffer commandBuffer, VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue);
     bool HasStencilComponent(VkFormat format);
+    bool IsDepthFormat(VkFormat format);
     QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface);
+    std::vector<char> ReadShaderFile(const std::string& filename);
+    VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& code);
+    //one value per variant bit, in constant id order
+    std::vector<uint32_t> GetMaterialSpecializationConstants(uint32_t materialVariant);
 }
 
 #endif
\ No newline at end of file
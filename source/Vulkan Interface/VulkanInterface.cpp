@@ -1,9 +1,16 @@
 #include "VulkanInterface.h"
 #include "source/Vulkan Interface/VulkanWindow.h"
+#include "source/Vulkan Interface/ShaderReflection.h"
 #include "source/Management/WindowManager.h"
+#include "source/Management/HandlePool.h"
+#include "source/Management/MipChainBuilder.h"
+#include "source/Management/TextureConverter.h"
 
 #include "stb_image.h"
 
+#include <chrono>
+#include <filesystem>
+
 VulkanInterface::VulkanInterface(WindowManager* windowManager)
 {
     m_windowManager = windowManager;
@@ -20,22 +27,25 @@ void VulkanInterface::InitializeVulkan()
     commandPool = m_vulkanWindow->graphicsCommandPool();
     graphicsQueue = m_vulkanWindow->graphicsQueue();
     CreateVMAAllocator();
+    CreateTextureResidency();
+    CreateHotReloader();
+    CreateSamplerCache();
 	UpdateTextureResources(kDefaultTexturePath, false);
     CreateDescriptorSetLayouts();
+    CreateFrameRingBuffer();
+    CreateUIQuadBuffers();
+    CreateShadowAtlas();
+    CreateDeferredRenderer();
+    CreateOrderIndependentTransparency();
+    CreateGpuProfiler();
+    CreateClusterCuller();
+    CreateParallelCommandRecorder();
+    CreatePipelineCache();
     CreateGraphicsPipelines();
-    CreateUniformBuffers();
     CreateDescriptorPools();
     CreateAllDescriptorSets();
 }
 
-void VulkanInterface::CreateTextureSampler(std::string textureFilePath)
-{
-    VkPhysicalDeviceProperties properties{};
-    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-
-	textureImages[textureFilePath]->CreateTextureSampler(properties.limits.maxSamplerAnisotropy);
-}
-
 void VulkanInterface::CreateTextureImageView(std::string textureFilePath) {
 	textureImages[textureFilePath]->CreateImageView(VK_IMAGE_ASPECT_COLOR_BIT);
 }
@@ -58,6 +68,16 @@ void VulkanInterface::CreateDepthResources() {
 	depthImage->CreateImageView(VK_IMAGE_ASPECT_DEPTH_BIT);
 
 	depthImage->TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+    if (m_deferredRenderer != nullptr)
+    {
+        m_deferredRenderer->CreateSizeDependentResources(m_vulkanWindow->swapChainImageSize().width(), m_vulkanWindow->swapChainImageSize().height());
+    }
+
+    if (m_orderIndependentTransparency != nullptr)
+    {
+        m_orderIndependentTransparency->CreateSizeDependentResources(m_vulkanWindow->swapChainImageSize().width(), m_vulkanWindow->swapChainImageSize().height());
+    }
 }
 
 VkFormat VulkanInterface::FindDepthFormat() {
@@ -70,13 +90,7 @@ VkFormat VulkanInterface::FindDepthFormat() {
 
 VkFormat VulkanInterface::FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) {
     for (VkFormat format : candidates) {
-        VkFormatProperties props;
-        vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
-
-        if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features) {
-            return format;
-        }
-        else if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features) {
+        if (IsFormatSupported(format, tiling, features)) {
             return format;
         }
     }
@@ -84,71 +98,792 @@ VkFormat VulkanInterface::FindSupportedFormat(const std::vector<VkFormat>& candi
     throw std::runtime_error("failed to find supported format!");
 }
 
-void VulkanInterface::CreateTextureImage(std::string textureFilePath) {
+bool VulkanInterface::IsFormatSupported(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features) {
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+
+    if (tiling == VK_IMAGE_TILING_LINEAR) {
+        return (props.linearTilingFeatures & features) == features;
+    }
+
+    return (props.optimalTilingFeatures & features) == features;
+}
+
+void VulkanInterface::CreateShadowAtlas()
+{
+    ShadowAtlas::ShadowAtlasCreateInfo shadowAtlasCreateInfo{};
+    shadowAtlasCreateInfo.depthFormat = FindSupportedFormat(
+        { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM },
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT
+    );
+    shadowAtlasCreateInfo.allocator = allocator;
+    shadowAtlasCreateInfo.device = device;
+    shadowAtlasCreateInfo.commandPool = commandPool;
+    shadowAtlasCreateInfo.graphicsQueue = graphicsQueue;
+    shadowAtlasCreateInfo.vulkanWindow = m_vulkanWindow;
+
+    m_shadowAtlas = std::make_shared<ShadowAtlas>(shadowAtlasCreateInfo);
+}
+
+void VulkanInterface::CreateDeferredRenderer()
+{
+    if (m_renderPath != RenderPath::Deferred)
+    {
+        return;
+    }
+
+    if (!DeferredRenderer::IsSupported(physicalDevice))
+    {
+        std::cout << "Warning: Deferred rendering isn't supported by this device, falling back to forward rendering." << std::endl;
+        m_renderPath = RenderPath::Forward;
+        return;
+    }
+
+    DeferredRenderer::DeferredRendererCreateInfo deferredCreateInfo{};
+    deferredCreateInfo.framesInFlight = MAX_FRAMES_IN_FLIGHT;
+    deferredCreateInfo.depthFormat = FindSupportedFormat(
+        { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM },
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT
+    );
+    deferredCreateInfo.frameRing = m_frameRing;
+    deferredCreateInfo.lightInfoBufferSize = sizeof(VulkanCommonFunctions::LightInfo) * maxLightCount;
+    deferredCreateInfo.shadowAtlas = m_shadowAtlas;
+    deferredCreateInfo.allocator = allocator;
+    deferredCreateInfo.device = device;
+    deferredCreateInfo.commandPool = commandPool;
+    deferredCreateInfo.graphicsQueue = graphicsQueue;
+    deferredCreateInfo.vulkanWindow = m_vulkanWindow;
+
+    m_deferredRenderer = std::make_shared<DeferredRenderer>(deferredCreateInfo);
+}
+
+void VulkanInterface::CreateGpuProfiler()
+{
+    if (!GpuProfiler::IsSupported(physicalDevice, m_vulkanWindow->graphicsQueueFamilyIndex()))
+    {
+        std::cout << "Warning: This device can't write timestamps, GPU pass times won't be measured." << std::endl;
+        return;
+    }
+
+    GpuProfiler::GpuProfilerCreateInfo profilerCreateInfo{};
+    profilerCreateInfo.framesInFlight = MAX_FRAMES_IN_FLIGHT;
+    profilerCreateInfo.queueFamilyIndex = m_vulkanWindow->graphicsQueueFamilyIndex();
+    profilerCreateInfo.physicalDevice = physicalDevice;
+    profilerCreateInfo.device = device;
+
+    m_gpuProfiler = std::make_shared<GpuProfiler>(profilerCreateInfo);
+}
+
+void VulkanInterface::CreateClusterCuller()
+{
+    if (!ClusterCuller::IsSupported(physicalDevice))
+    {
+        std::cout << "Warning: This device can't draw several indirect draws at once, meshlets won't be culled." << std::endl;
+        return;
+    }
+
+    ClusterCuller::ClusterCullerCreateInfo cullerCreateInfo{};
+    cullerCreateInfo.framesInFlight = MAX_FRAMES_IN_FLIGHT;
+    cullerCreateInfo.allocator = allocator;
+    cullerCreateInfo.device = device;
+    cullerCreateInfo.commandPool = commandPool;
+    cullerCreateInfo.graphicsQueue = graphicsQueue;
+
+    m_clusterCuller = std::make_shared<ClusterCuller>(cullerCreateInfo);
+}
+
+void VulkanInterface::CreateParallelCommandRecorder()
+{
+    if (m_recordingThreadCount <= 1)
+    {
+        return;
+    }
+
+    ParallelCommandRecorder::ParallelCommandRecorderCreateInfo recorderCreateInfo{};
+    recorderCreateInfo.threadCount = m_recordingThreadCount;
+    recorderCreateInfo.framesInFlight = MAX_FRAMES_IN_FLIGHT;
+    recorderCreateInfo.queueFamilyIndex = m_vulkanWindow->graphicsQueueFamilyIndex();
+    recorderCreateInfo.device = device;
+
+    m_commandRecorder = std::make_shared<ParallelCommandRecorder>(recorderCreateInfo);
+}
+
+void VulkanInterface::CreatePipelineCache()
+{
+    PipelineCache::PipelineCacheCreateInfo pipelineCacheCreateInfo{};
+    pipelineCacheCreateInfo.device = device;
+
+    m_pipelineCache = std::make_shared<PipelineCache>(pipelineCacheCreateInfo);
+}
+
+void VulkanInterface::CreateHotReloader()
+{
+    if (!m_hotReloadEnabled)
+    {
+        return;
+    }
+
+    HotReloader::HotReloaderCreateInfo hotReloaderCreateInfo{};
+    hotReloaderCreateInfo.shaderDirectory = "shaders/HLSL";
+
+    m_hotReloader = std::make_shared<HotReloader>(hotReloaderCreateInfo);
+}
+
+void VulkanInterface::CreateSamplerCache()
+{
+    SamplerCache::SamplerCacheCreateInfo samplerCacheCreateInfo{};
+    samplerCacheCreateInfo.physicalDevice = physicalDevice;
+    samplerCacheCreateInfo.device = device;
+
+    m_samplerCache = std::make_shared<SamplerCache>(samplerCacheCreateInfo);
+}
+
+void VulkanInterface::CreateTextureSamplerIdBuffer()
+{
+    //only replaced when a texture is added, frames still in flight keep reading the old one
+    if (m_textureSamplerIdBuffer != nullptr)
+    {
+        DeferDestruction(m_textureSamplerIdBuffer);
+    }
+
+    GraphicsBuffer::BufferCreateInfo samplerIdBufferCreateInfo{};
+    samplerIdBufferCreateInfo.allocator = allocator;
+    samplerIdBufferCreateInfo.size = sizeof(uint32_t) * m_textureSamplerIds.size();
+    samplerIdBufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    samplerIdBufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    samplerIdBufferCreateInfo.device = device;
+    samplerIdBufferCreateInfo.commandPool = commandPool;
+    samplerIdBufferCreateInfo.graphicsQueue = graphicsQueue;
+
+    m_textureSamplerIdBuffer = std::make_shared<GraphicsBuffer>(samplerIdBufferCreateInfo);
+    m_textureSamplerIdBuffer->LoadData(m_textureSamplerIds.data(), sizeof(uint32_t) * m_textureSamplerIds.size());
+}
+
+void VulkanInterface::CreateTextureResidency()
+{
+    TextureResidency::TextureResidencyCreateInfo residencyCreateInfo{};
+    residencyCreateInfo.allocator = allocator;
+
+    m_textureResidency = std::make_shared<TextureResidency>(residencyCreateInfo);
+    m_textureResidency->SetTextureBudget(m_textureMemoryBudget);
+}
+
+void VulkanInterface::CreateOrderIndependentTransparency()
+{
+    if (m_transparencyMode != TransparencyMode::WeightedBlended)
+    {
+        return;
+    }
+
+    if (!OrderIndependentTransparency::IsSupported(physicalDevice))
+    {
+        std::cout << "Warning: Weighted blended transparency isn't supported by this device, falling back to sorted transparency." << std::endl;
+        m_transparencyMode = TransparencyMode::Sorted;
+        return;
+    }
+
+    OrderIndependentTransparency::OrderIndependentTransparencyCreateInfo transparencyCreateInfo{};
+    transparencyCreateInfo.depthFormat = FindDepthFormat();
+    transparencyCreateInfo.allocator = allocator;
+    transparencyCreateInfo.device = device;
+    transparencyCreateInfo.commandPool = commandPool;
+    transparencyCreateInfo.graphicsQueue = graphicsQueue;
+    transparencyCreateInfo.vulkanWindow = m_vulkanWindow;
+
+    m_orderIndependentTransparency = std::make_shared<OrderIndependentTransparency>(transparencyCreateInfo);
+}
+
+void VulkanInterface::CreateTextureImage(std::string textureFilePath, VkFormat textureFormat, bool mipmapped) {
+    textureImages[textureFilePath] = UploadTextureImage(LoadTextureData(textureFilePath, textureFormat, mipmapped, mipmapped ? m_textureMipSkip : 0));
+}
+
+Ktx2File::Texture VulkanInterface::LoadTextureData(const std::string& textureFilePath, VkFormat textureFormat, bool mipmapped, uint32_t skippedLevels)
+{
+    Ktx2File::Texture texture;
+
+    if (LoadCompressedTextureData(textureFilePath, textureFormat, texture))
+    {
+        Ktx2File::SkipLevels(texture, skippedLevels);
+
+        if (!mipmapped)
+        {
+            Ktx2File::KeepLevels(texture, 1);
+        }
+
+        return texture;
+    }
+
     int texWidth, texHeight, texChannels;
     stbi_uc* pixels = stbi_load(textureFilePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
 
     if (!pixels) {
         throw std::runtime_error("failed to load texture image: " + textureFilePath);
     }
 
+    //blits are quicker, but can only build the chain down from a full size first level that is kept
+    if (!mipmapped || (skippedLevels == 0 && TextureImage::CanBlitMipmaps(physicalDevice, textureFormat)))
+    {
+        size_t imageSize = static_cast<size_t>(texWidth) * texHeight * 4;
+
+        texture.format = textureFormat;
+        texture.width = texWidth;
+        texture.height = texHeight;
+        texture.data.assign(pixels, pixels + imageSize);
+        texture.levelOffsets.push_back(0);
+        texture.levelSizes.push_back(imageSize);
+        texture.generateMipmaps = mipmapped;
+    }
+    else {
+        texture = TextureConverter::Convert(pixels, texWidth, texHeight, TextureConverter::Format::Rgba8, textureFormat == VK_FORMAT_R8G8B8A8_SRGB);
+        Ktx2File::SkipLevels(texture, skippedLevels);
+    }
+
+    stbi_image_free(pixels);
+
+    return texture;
+}
+
+const std::vector<std::pair<std::string, VkFormat>>& VulkanInterface::GetCompressedVariants(VkFormat textureFormat)
+{
+    static const std::vector<std::pair<std::string, VkFormat>> kSrgbVariants = {
+        { ".bc7.ktx2", VK_FORMAT_BC7_SRGB_BLOCK },
+        { ".astc.ktx2", VK_FORMAT_ASTC_4x4_SRGB_BLOCK },
+        { TextureConverter::GetVariantExtension(TextureConverter::Format::Bc1), VK_FORMAT_BC1_RGB_SRGB_BLOCK },
+        { TextureConverter::GetVariantExtension(TextureConverter::Format::Rgba8), VK_FORMAT_R8G8B8A8_SRGB }
+    };
+
+    static const std::vector<std::pair<std::string, VkFormat>> kUnormVariants = {
+        { ".bc7.ktx2", VK_FORMAT_BC7_UNORM_BLOCK },
+        { ".astc.ktx2", VK_FORMAT_ASTC_4x4_UNORM_BLOCK },
+        { TextureConverter::GetVariantExtension(TextureConverter::Format::Bc1), VK_FORMAT_BC1_RGB_UNORM_BLOCK },
+        { TextureConverter::GetVariantExtension(TextureConverter::Format::Rgba8), VK_FORMAT_R8G8B8A8_UNORM }
+    };
+
+    return Ktx2File::IsSrgb(textureFormat) ? kSrgbVariants : kUnormVariants;
+}
+
+bool VulkanInterface::LoadCompressedTextureData(const std::string& textureFilePath, VkFormat textureFormat, Ktx2File::Texture& texture)
+{
+    bool srgb = Ktx2File::IsSrgb(textureFormat);
+
+    const VkFormatFeatureFlags sampledFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+
+    std::string basePath = std::filesystem::path(textureFilePath).replace_extension().string();
+    std::string decodablePath;
+
+    //a texture can ship several of these next to its image, the first one the device can sample is used
+    for (const auto& variant : GetCompressedVariants(textureFormat))
+    {
+        std::string variantPath = basePath + variant.first;
+
+        if (!std::filesystem::exists(variantPath))
+        {
+            continue;
+        }
+
+        //the converter writes srgb files, the same blocks are sampled as linear when the texture asks for it
+        if (IsFormatSupported(variant.second, VK_IMAGE_TILING_OPTIMAL, sampledFeatures))
+        {
+            texture = Ktx2File::Read(variantPath);
+            texture.format = Ktx2File::WithColorSpace(texture.format, srgb);
+            return true;
+        }
+
+        if (variant.second == Ktx2File::WithColorSpace(VK_FORMAT_BC1_RGB_SRGB_BLOCK, srgb))
+        {
+            decodablePath = variantPath;
+        }
+    }
+
+    //BC1 is the only block format decoded on the CPU, textures only shipped as BC7 or ASTC fall back to their image
+    if (!decodablePath.empty())
+    {
+        std::cout << "Warning: This device can't sample BC1 textures, " << decodablePath << " is decoded on the CPU." << std::endl;
+        texture = TextureConverter::DecodeBc1(Ktx2File::Read(decodablePath));
+        texture.format = Ktx2File::WithColorSpace(texture.format, srgb);
+        return true;
+    }
+
+    return false;
+}
+
+std::shared_ptr<TextureImage> VulkanInterface::UploadTextureImage(const Ktx2File::Texture& texture)
+{
+    bool generateMipmaps = texture.generateMipmaps && TextureImage::CanBlitMipmaps(physicalDevice, texture.format);
+
+    std::vector<VkDeviceSize> levelOffsets(texture.levelOffsets.begin(), texture.levelOffsets.end());
+    VkDeviceSize imageSize = texture.data.size();
+
     GraphicsBuffer::BufferCreateInfo stagingBufferCreateInfo{};
-	stagingBufferCreateInfo.allocator = allocator;
-	stagingBufferCreateInfo.size = imageSize;
-	stagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-	stagingBufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-	stagingBufferCreateInfo.device = device;
-	stagingBufferCreateInfo.commandPool = commandPool;
-	stagingBufferCreateInfo.graphicsQueue = graphicsQueue;
-	std::unique_ptr<GraphicsBuffer> stagingBuffer = std::make_unique<GraphicsBuffer>(stagingBufferCreateInfo);
+    stagingBufferCreateInfo.allocator = allocator;
+    stagingBufferCreateInfo.size = imageSize;
+    stagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    stagingBufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    stagingBufferCreateInfo.device = device;
+    stagingBufferCreateInfo.commandPool = commandPool;
+    stagingBufferCreateInfo.graphicsQueue = graphicsQueue;
+    std::unique_ptr<GraphicsBuffer> stagingBuffer = std::make_unique<GraphicsBuffer>(stagingBufferCreateInfo);
 
-	stagingBuffer->LoadData(pixels, static_cast<size_t>(imageSize));
+    stagingBuffer->LoadData((void*)texture.data.data(), static_cast<size_t>(imageSize));
 
-    stbi_image_free(pixels);
+    GraphicsImage::GraphicsImageCreateInfo textureImageCreateInfo{};
+    textureImageCreateInfo.imageSize = { texture.width, texture.height };
+    textureImageCreateInfo.format = texture.format;
+    textureImageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    textureImageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (generateMipmaps ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+    textureImageCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    textureImageCreateInfo.allocator = allocator;
+    textureImageCreateInfo.device = device;
+    textureImageCreateInfo.commandPool = commandPool;
+    textureImageCreateInfo.graphicsQueue = graphicsQueue;
+    textureImageCreateInfo.mipLevels = generateMipmaps ? MipChainBuilder::GetMipLevelCount(texture.width, texture.height) : static_cast<uint32_t>(levelOffsets.size());
+
+    std::shared_ptr<TextureImage> currentImage = std::make_shared<TextureImage>(textureImageCreateInfo);
 
-	GraphicsImage::GraphicsImageCreateInfo textureImageCreateInfo{};
-	textureImageCreateInfo.imageSize = { static_cast<size_t>(texWidth), static_cast<size_t>(texHeight) };
-	textureImageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-	textureImageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-	textureImageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-	textureImageCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-	textureImageCreateInfo.allocator = allocator;
-	textureImageCreateInfo.device = device;
-	textureImageCreateInfo.commandPool = commandPool;
-	textureImageCreateInfo.graphicsQueue = graphicsQueue;
+    currentImage->TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-	std::shared_ptr<TextureImage> currentImage = std::make_shared<TextureImage>(textureImageCreateInfo);
-	textureImages[textureFilePath] = currentImage;
+    if (generateMipmaps)
+    {
+        currentImage->CopyFromBuffer(stagingBuffer.get());
+        currentImage->GenerateMipmaps();
+    }
+    else {
+        currentImage->CopyMipsFromBuffer(stagingBuffer.get(), levelOffsets);
+        currentImage->TransitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
 
-	currentImage->TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	currentImage->CopyFromBuffer(stagingBuffer.get());
-	currentImage->TransitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    stagingBuffer->DestroyBuffer();
 
-	stagingBuffer->DestroyBuffer();
+    return currentImage;
 }
 
-void VulkanInterface::UpdateTextureResources(std::string textureFilePath, bool alreadyInitialized)
+void VulkanInterface::UpdateTextureResources(std::string textureFilePath, bool alreadyInitialized, VkFormat textureFormat, SamplerCache::SamplerState samplerState, bool mipmapped)
 {
-	textureFilePaths.push_back(textureFilePath);
+    {
+        std::lock_guard<std::mutex> lock(m_textureFilePathMutex);
+	    textureFilePaths.push_back(textureFilePath);
+    }
 	texturePathToIndex[textureFilePath] = textureFilePaths.size() - 1;
-	CreateTextureImage(textureFilePath);
-
-    CreateTextureSampler(textureFilePath);
+	CreateTextureImage(textureFilePath, textureFormat, mipmapped);
 	CreateTextureImageView(textureFilePath);
 
-    if (alreadyInitialized)
+    //a new sampler state adds an immutable sampler, which is part of the layouts
+    size_t samplerCount = m_samplerCache->GetSamplers().size();
+    m_textureSamplerIds.push_back(m_samplerCache->GetSamplerId(samplerState));
+    CreateTextureSamplerIdBuffer();
+
+    bool layoutsChanged = m_samplerCache->GetSamplers().size() != samplerCount;
+    if (textureFilePaths.size() > m_textureDescriptorCapacity)
+    {
+        m_textureDescriptorCapacity = std::max(m_textureDescriptorCapacity * 2, kMinTextureDescriptorCapacity);
+        layoutsChanged = true;
+    }
+
+    //the first texture is the fallback absent textures are drawn with, so it is never evicted
+    std::shared_ptr<TextureImage> textureImage = textureImages[textureFilePath];
+    uint32_t topLevelSize = static_cast<uint32_t>(std::max(textureImage->GetImageSize().first, textureImage->GetImageSize().second));
+    m_textureResidency->AddTexture(texturePathToIndex[textureFilePath], textureFilePath, textureFormat, mipmapped, mipmapped ? m_textureMipSkip : 0, topLevelSize, textureImage->GetMemorySize(), texturePathToIndex[textureFilePath] == 0);
+
+    if (m_hotReloader != nullptr)
+    {
+        WatchTexture(textureFilePath);
+    }
+
+    if (!alreadyInitialized)
+    {
+        return;
+    }
+
+    if (layoutsChanged)
     {
         CreateDescriptorPools();
         CreateDescriptorSetLayouts();
         CreateAllDescriptorSets();
         CreateGraphicsPipelines();
     }
+    else {
+        //the new texture takes a slot that held the fallback, each frame's sets are rewritten when it comes around
+        m_textureDescriptorsDirty.fill(true);
+    }
+}
+
+std::vector<VkDescriptorImageInfo> VulkanInterface::GetTextureImageInfos()
+{
+    std::shared_ptr<TextureImage> fallbackImage = textureImages[textureFilePaths[0]];
+    std::vector<VkDescriptorImageInfo> imageInfos;
+
+    for (auto it = textureFilePaths.begin(); it != textureFilePaths.end(); it++)
+    {
+        std::shared_ptr<TextureImage> textureImage = (textureImages[*it] != nullptr) ? textureImages[*it] : fallbackImage;
+
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = textureImage->GetImageView();
+
+        imageInfos.push_back(imageInfo);
+    }
+
+    //every slot of the array is written, the ones no texture has yet are never indexed by an instance
+    VkDescriptorImageInfo fallbackInfo{};
+    fallbackInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    fallbackInfo.imageView = fallbackImage->GetImageView();
+
+    imageInfos.resize(m_textureDescriptorCapacity, fallbackInfo);
+
+    return imageInfos;
+}
+
+void VulkanInterface::UpdateTextureDescriptors(uint32_t frameIndex)
+{
+    std::vector<VkDescriptorImageInfo> imageInfos = GetTextureImageInfos();
+
+    //the sampler id buffer is replaced whenever a texture is added
+    VkDescriptorBufferInfo samplerIdBufferInfo{};
+    samplerIdBufferInfo.buffer = m_textureSamplerIdBuffer->GetVkBuffer();
+    samplerIdBufferInfo.offset = 0;
+    samplerIdBufferInfo.range = sizeof(uint32_t) * m_textureSamplerIds.size();
+
+    std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+
+    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[0].dstSet = primaryDescriptorSets[frameIndex];
+    descriptorWrites[0].dstBinding = 2;
+    descriptorWrites[0].dstArrayElement = 0;
+    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    descriptorWrites[0].descriptorCount = imageInfos.size();
+    descriptorWrites[0].pImageInfo = imageInfos.data();
+
+    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[1].dstSet = uiDescriptorSets[frameIndex];
+    descriptorWrites[1].dstBinding = 1;
+    descriptorWrites[1].dstArrayElement = 0;
+    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    descriptorWrites[1].descriptorCount = imageInfos.size();
+    descriptorWrites[1].pImageInfo = imageInfos.data();
+
+    descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[2].dstSet = primaryDescriptorSets[frameIndex];
+    descriptorWrites[2].dstBinding = 6;
+    descriptorWrites[2].dstArrayElement = 0;
+    descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[2].descriptorCount = 1;
+    descriptorWrites[2].pBufferInfo = &samplerIdBufferInfo;
+
+    descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[3].dstSet = uiDescriptorSets[frameIndex];
+    descriptorWrites[3].dstBinding = 3;
+    descriptorWrites[3].dstArrayElement = 0;
+    descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[3].descriptorCount = 1;
+    descriptorWrites[3].pBufferInfo = &samplerIdBufferInfo;
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+    m_textureDescriptorsDirty[frameIndex] = false;
+}
+
+void VulkanInterface::UpdateTextureResidency()
+{
+    //uploads block the render thread like textures loaded at startup, only reading and decoding the files runs in the background
+    for (auto it = m_textureLoads.begin(); it != m_textureLoads.end();)
+    {
+        if (it->second.texture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            it++;
+            continue;
+        }
+
+        //the file changed while it was being read, what was read is dropped and the new file is read instead
+        if (it->second.reloadRequested)
+        {
+            size_t textureIndex = it->first;
+            uint32_t skippedLevels = it->second.skippedLevels;
+
+            it = m_textureLoads.erase(it);
+            RequestTextureLoad(textureIndex, skippedLevels);
+            continue;
+        }
+
+        TextureResidency::Entry& entry = m_textureResidency->GetEntry(it->first);
+        entry.loading = false;
+
+        try
+        {
+            std::shared_ptr<TextureImage> textureImage = UploadTextureImage(it->second.texture.get());
+
+            if (textureImages[entry.filePath] != nullptr)
+            {
+                DeferDestruction(textureImages[entry.filePath]);
+            }
+
+            textureImages[entry.filePath] = textureImage;
+            CreateTextureImageView(entry.filePath);
+
+            entry.resident = true;
+            entry.skippedLevels = it->second.skippedLevels;
+            entry.topLevelSize = static_cast<uint32_t>(std::max(textureImage->GetImageSize().first, textureImage->GetImageSize().second));
+            entry.memorySize = textureImage->GetMemorySize();
+
+            m_textureDescriptorsDirty.fill(true);
+        }
+        catch (const std::exception& exception)
+        {
+            std::cout << "Warning: Couldn't load " << entry.filePath << " back in, " << exception.what() << std::endl;
+        }
+
+        it = m_textureLoads.erase(it);
+    }
+
+    m_textureResidency->UpdateBudget();
+
+    //one texture per frame, the budget VMA reports only catches up once the release has happened
+    if (m_textureResidency->IsOverBudget())
+    {
+        size_t evictedTexture = m_textureResidency->FindEvictionCandidate(m_frameNumber);
+
+        if (evictedTexture != SIZE_MAX)
+        {
+            EvictTexture(evictedTexture);
+        }
+        else {
+            //everything left is in use, so the least recent texture is loaded again without its largest level
+            size_t reducedTexture = m_textureResidency->FindReductionCandidate();
+
+            if (reducedTexture != SIZE_MAX)
+            {
+                RequestTextureLoad(reducedTexture, m_textureResidency->GetEntry(reducedTexture).skippedLevels + 1);
+            }
+        }
+    }
+
+    std::vector<size_t> restoredTextures = m_textureResidency->FindRestoreCandidates(m_frameNumber);
+    for (size_t i = 0; i < restoredTextures.size(); i++)
+    {
+        RequestTextureLoad(restoredTextures[i], m_textureResidency->GetEntry(restoredTextures[i]).baseSkippedLevels);
+    }
+
+    if (m_textureDescriptorsDirty[currentFrame])
+    {
+        UpdateTextureDescriptors(currentFrame);
+    }
+}
+
+void VulkanInterface::ApplyHotReload()
+{
+    if (m_hotReloader == nullptr)
+    {
+        return;
+    }
+
+    //swapped in at the start of the frame, the frames in flight keep the pipelines they were recorded with
+    std::vector<std::shared_ptr<GraphicsPipeline>> replacedPipelines = m_pipelineCache->SwapReloaded();
+
+    if (!replacedPipelines.empty())
+    {
+        for (size_t i = 0; i < replacedPipelines.size(); i++)
+        {
+            DeferDestruction(replacedPipelines[i]);
+        }
+
+        //the cache hands back the swapped in pipeline for the same state
+        CreateUIGraphicsPipeline();
+
+        std::cout << "Reloaded " << replacedPipelines.size() << " pipelines" << std::endl;
+    }
+
+    HotReloader::Changes changes = m_hotReloader->TakeChanges();
+
+    if (!changes.shaderFilePaths.empty())
+    {
+        std::set<std::string> usedFilePaths = m_pipelineCache->Reload(changes.shaderFilePaths);
+
+        for (auto it = changes.shaderFilePaths.begin(); it != changes.shaderFilePaths.end(); it++)
+        {
+            if (usedFilePaths.count(*it) == 0)
+            {
+                std::cout << "Warning: no cached pipeline uses " << *it << ", the shadow, deferred, composite and culling pipelines only pick it up after a restart" << std::endl;
+            }
+        }
+    }
+
+    for (auto it = changes.textureFilePaths.begin(); it != changes.textureFilePaths.end(); it++)
+    {
+        auto textureIndex = texturePathToIndex.find(*it);
+
+        if (textureIndex == texturePathToIndex.end())
+        {
+            continue;
+        }
+
+        TextureResidency::Entry& entry = m_textureResidency->GetEntry(textureIndex->second);
+
+        //absent textures read the new file whenever they are restored, a load already under way is started again with the same levels once it finishes
+        if (entry.loading)
+        {
+            RequestTextureLoad(textureIndex->second, m_textureLoads.at(textureIndex->second).skippedLevels);
+        }
+        else if (entry.resident)
+        {
+            RequestTextureLoad(textureIndex->second, entry.skippedLevels);
+        }
+    }
+}
+
+void VulkanInterface::WatchTexture(const std::string& textureFilePath)
+{
+    std::vector<std::string> filePaths = { textureFilePath };
+
+    //the variants' file names are the same in either color space
+    std::string basePath = std::filesystem::path(textureFilePath).replace_extension().string();
+    for (const auto& variant : GetCompressedVariants(VK_FORMAT_R8G8B8A8_SRGB))
+    {
+        filePaths.push_back(basePath + variant.first);
+    }
+
+    m_hotReloader->WatchTexture(textureFilePath, filePaths);
+}
+
+void VulkanInterface::RequestTextureLoad(size_t textureIndex, uint32_t skippedLevels)
+{
+    //destroying a future from std::async waits for it, so a running load is only marked and started again once it finishes
+    auto runningLoad = m_textureLoads.find(textureIndex);
+
+    if (runningLoad != m_textureLoads.end())
+    {
+        runningLoad->second.skippedLevels = skippedLevels;
+        runningLoad->second.reloadRequested = true;
+        return;
+    }
+
+    TextureResidency::Entry& entry = m_textureResidency->GetEntry(textureIndex);
+    entry.loading = true;
+
+    PendingTextureLoad pendingLoad;
+    pendingLoad.skippedLevels = skippedLevels;
+    pendingLoad.texture = std::async(std::launch::async, &VulkanInterface::LoadTextureData, this, entry.filePath, entry.format, entry.mipmapped, skippedLevels);
+
+    m_textureLoads[textureIndex] = std::move(pendingLoad);
+}
+
+void VulkanInterface::EvictTexture(size_t textureIndex)
+{
+    TextureResidency::Entry& entry = m_textureResidency->GetEntry(textureIndex);
+
+    DeferDestruction(textureImages[entry.filePath]);
+    textureImages[entry.filePath] = nullptr;
+
+    entry.resident = false;
+    entry.memorySize = 0;
+
+    m_textureDescriptorsDirty.fill(true);
 }
 
 void VulkanInterface::CreateAllDescriptorSets() {
     CreatePrimaryDescriptorSets();
     CreateUIDescriptorSets();
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        WriteFrameRingDescriptors(i);
+    }
+}
+
+void VulkanInterface::WriteFrameRingDescriptors(uint32_t frameIndex)
+{
+    //the offsets are given when the sets are bound, so these only change when the ring's buffer does
+    VkDescriptorBufferInfo globalBufferInfo{};
+    globalBufferInfo.buffer = m_frameRing->GetBuffer()->GetVkBuffer();
+    globalBufferInfo.offset = 0;
+    globalBufferInfo.range = sizeof(VulkanCommonFunctions::GlobalInfo);
+
+    VkDescriptorBufferInfo lightBufferInfo{};
+    lightBufferInfo.buffer = m_frameRing->GetBuffer()->GetVkBuffer();
+    lightBufferInfo.offset = 0;
+    lightBufferInfo.range = sizeof(VulkanCommonFunctions::LightInfo) * maxLightCount;
+
+    VkDescriptorBufferInfo shadowBufferInfo{};
+    shadowBufferInfo.buffer = m_frameRing->GetBuffer()->GetVkBuffer();
+    shadowBufferInfo.offset = 0;
+    shadowBufferInfo.range = m_shadowAtlas->GetShadowInfoBufferSize();
+
+    VkDescriptorBufferInfo uiGlobalBufferInfo{};
+    uiGlobalBufferInfo.buffer = m_frameRing->GetBuffer()->GetVkBuffer();
+    uiGlobalBufferInfo.offset = 0;
+    uiGlobalBufferInfo.range = sizeof(VulkanCommonFunctions::UIGlobalInfo);
+
+    std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+
+    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[0].dstSet = primaryDescriptorSets[frameIndex];
+    descriptorWrites[0].dstBinding = 0;
+    descriptorWrites[0].dstArrayElement = 0;
+    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    descriptorWrites[0].descriptorCount = 1;
+    descriptorWrites[0].pBufferInfo = &globalBufferInfo;
+
+    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[1].dstSet = primaryDescriptorSets[frameIndex];
+    descriptorWrites[1].dstBinding = 1;
+    descriptorWrites[1].dstArrayElement = 0;
+    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    descriptorWrites[1].descriptorCount = 1;
+    descriptorWrites[1].pBufferInfo = &lightBufferInfo;
+
+    descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[2].dstSet = primaryDescriptorSets[frameIndex];
+    descriptorWrites[2].dstBinding = 3;
+    descriptorWrites[2].dstArrayElement = 0;
+    descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    descriptorWrites[2].descriptorCount = 1;
+    descriptorWrites[2].pBufferInfo = &shadowBufferInfo;
+
+    descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[3].dstSet = uiDescriptorSets[frameIndex];
+    descriptorWrites[3].dstBinding = 0;
+    descriptorWrites[3].dstArrayElement = 0;
+    descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    descriptorWrites[3].descriptorCount = 1;
+    descriptorWrites[3].pBufferInfo = &uiGlobalBufferInfo;
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void VulkanInterface::UpdateFrameRingDescriptors(uint32_t frameIndex)
+{
+    WriteFrameRingDescriptors(frameIndex);
+
+    if (m_deferredRenderer != nullptr)
+    {
+        m_deferredRenderer->UpdateFrameRingDescriptors(frameIndex);
+    }
+
+    m_frameRingDescriptorsDirty[frameIndex] = false;
+}
+
+void VulkanInterface::BeginFrameRing(size_t customMeshCount, size_t uiObjectCount)
+{
+    //everything the frame can allocate, so the ring only ever grows before anything is recorded
+    VkDeviceSize requiredSize = m_frameRing->GetAllocationSize(sizeof(VulkanCommonFunctions::GlobalInfo));
+    requiredSize += m_frameRing->GetAllocationSize(sizeof(VulkanCommonFunctions::LightInfo) * maxLightCount);
+    requiredSize += m_frameRing->GetAllocationSize(m_shadowAtlas->GetShadowInfoBufferSize());
+    requiredSize += m_frameRing->GetAllocationSize(sizeof(VulkanCommonFunctions::InstanceInfo) * customMeshCount);
+    requiredSize += m_frameRing->GetAllocationSize(sizeof(VulkanCommonFunctions::UIGlobalInfo));
+    requiredSize += m_frameRing->GetAllocationSize(sizeof(VulkanCommonFunctions::UIInstanceInfo) * uiObjectCount);
+
+    std::shared_ptr<GraphicsBuffer> replacedBuffer = m_frameRing->BeginFrame(currentFrame, requiredSize);
+    if (replacedBuffer != nullptr)
+    {
+        DeferDestruction(replacedBuffer);
+        m_frameRingDescriptorsDirty.fill(true);
+    }
+
+    //the other frames' sets may still be in use, each is pointed at the new buffer when its frame comes around
+    if (m_frameRingDescriptorsDirty[currentFrame])
+    {
+        UpdateFrameRingDescriptors(currentFrame);
+    }
 }
 
 void VulkanInterface::CreatePrimaryDescriptorSets() {
@@ -165,53 +900,45 @@ void VulkanInterface::CreatePrimaryDescriptorSets() {
     }
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        VkDescriptorBufferInfo bufferInfo{};
-        bufferInfo.buffer = uniformBuffers[i]->GetVkBuffer();
-        bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(VulkanCommonFunctions::GlobalInfo);
-
-        VkDescriptorBufferInfo lightBufferInfo{};
-        lightBufferInfo.buffer = lightInfoBuffers[i]->GetVkBuffer();
-        lightBufferInfo.offset = 0;
-        lightBufferInfo.range = sizeof(VulkanCommonFunctions::LightInfo) * maxLightCount;
+        std::vector<VkDescriptorImageInfo> imageInfos = GetTextureImageInfos();
 
-        std::vector<VkDescriptorImageInfo> imageInfos;
+        VkDescriptorImageInfo shadowAtlasInfo{};
+        shadowAtlasInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        shadowAtlasInfo.imageView = m_shadowAtlas->GetImageView();
+        shadowAtlasInfo.sampler = m_shadowAtlas->GetSampler();
 
-        for (auto it = textureFilePaths.begin(); it != textureFilePaths.end(); it++)
-        {
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = textureImages[*it]->GetImageView();
-            imageInfo.sampler = textureImages[*it]->GetTextureSampler();
-
-            imageInfos.push_back(imageInfo);
-        }
+        VkDescriptorBufferInfo samplerIdBufferInfo{};
+        samplerIdBufferInfo.buffer = m_textureSamplerIdBuffer->GetVkBuffer();
+        samplerIdBufferInfo.offset = 0;
+        samplerIdBufferInfo.range = sizeof(uint32_t) * m_textureSamplerIds.size();
 
         std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
 
         descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptorWrites[0].dstSet = primaryDescriptorSets[i];
-        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].dstBinding = 2;
         descriptorWrites[0].dstArrayElement = 0;
-        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        descriptorWrites[0].descriptorCount = 1;
-        descriptorWrites[0].pBufferInfo = &bufferInfo;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        descriptorWrites[0].descriptorCount = imageInfos.size();
+        descriptorWrites[0].pImageInfo = imageInfos.data();
 
+        //the frame ring's bindings 0, 1 and 3 are written with WriteFrameRingDescriptors
         descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptorWrites[1].dstSet = primaryDescriptorSets[i];
-        descriptorWrites[1].dstBinding = 1;
+        descriptorWrites[1].dstBinding = 4;
         descriptorWrites[1].dstArrayElement = 0;
-        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         descriptorWrites[1].descriptorCount = 1;
-        descriptorWrites[1].pBufferInfo = &lightBufferInfo;
+        descriptorWrites[1].pImageInfo = &shadowAtlasInfo;
 
+        //binding 5 holds the immutable samplers and isn't written
         descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptorWrites[2].dstSet = primaryDescriptorSets[i];
-        descriptorWrites[2].dstBinding = 2;
+        descriptorWrites[2].dstBinding = 6;
         descriptorWrites[2].dstArrayElement = 0;
-        descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        descriptorWrites[2].descriptorCount = imageInfos.size();
-        descriptorWrites[2].pImageInfo = imageInfos.data();
+        descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[2].descriptorCount = 1;
+        descriptorWrites[2].pBufferInfo = &samplerIdBufferInfo;
 
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
     }
@@ -232,40 +959,31 @@ void VulkanInterface::CreateUIDescriptorSets()
     }
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        std::vector<VkDescriptorImageInfo> imageInfos;
-
-        VkDescriptorBufferInfo globalBufferInfo{};
-        globalBufferInfo.buffer = uiUniformBuffers[i]->GetVkBuffer();
-        globalBufferInfo.offset = 0;
-        globalBufferInfo.range = sizeof(VulkanCommonFunctions::UIGlobalInfo);
-
-        for (auto it = textureFilePaths.begin(); it != textureFilePaths.end(); it++)
-        {
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = textureImages[*it]->GetImageView();
-            imageInfo.sampler = textureImages[*it]->GetTextureSampler();
+        std::vector<VkDescriptorImageInfo> imageInfos = GetTextureImageInfos();
 
-            imageInfos.push_back(imageInfo);
-        }
+        VkDescriptorBufferInfo samplerIdBufferInfo{};
+        samplerIdBufferInfo.buffer = m_textureSamplerIdBuffer->GetVkBuffer();
+        samplerIdBufferInfo.offset = 0;
+        samplerIdBufferInfo.range = sizeof(uint32_t) * m_textureSamplerIds.size();
 
         std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
 
         descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptorWrites[0].dstSet = uiDescriptorSets[i];
-        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].dstBinding = 1;
         descriptorWrites[0].dstArrayElement = 0;
-        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        descriptorWrites[0].descriptorCount = 1;
-        descriptorWrites[0].pBufferInfo = &globalBufferInfo;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        descriptorWrites[0].descriptorCount = imageInfos.size();
+        descriptorWrites[0].pImageInfo = imageInfos.data();
 
+        //binding 2 holds the immutable samplers and isn't written
         descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptorWrites[1].dstSet = uiDescriptorSets[i];
-        descriptorWrites[1].dstBinding = 1;
+        descriptorWrites[1].dstBinding = 3;
         descriptorWrites[1].dstArrayElement = 0;
-        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        descriptorWrites[1].descriptorCount = imageInfos.size();
-        descriptorWrites[1].pImageInfo = imageInfos.data();
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pBufferInfo = &samplerIdBufferInfo;
 
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
     }
@@ -277,18 +995,25 @@ void VulkanInterface::CreateDescriptorPools() {
 }
 
 void VulkanInterface::CreatePrimaryDescriptorPool() {
+    //frames in flight are still bound with sets from the old pool
     if (m_primaryDescriptorPool != VK_NULL_HANDLE)
     {
-		vkDestroyDescriptorPool(device, m_primaryDescriptorPool, nullptr);
+		DeferDescriptorPoolDestruction(m_primaryDescriptorPool);
     }
     
-    std::array<VkDescriptorPoolSize, 3> poolSizes{};
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    std::array<VkDescriptorPoolSize, 6> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-    poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[2].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * textureFilePaths.size();
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 2;
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[2].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSizes[3].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[3].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSizes[4].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    poolSizes[4].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * m_textureDescriptorCapacity;
+    poolSizes[5].type = VK_DESCRIPTOR_TYPE_SAMPLER;
+    poolSizes[5].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * m_samplerCache->GetSamplers().size());
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -304,12 +1029,18 @@ void VulkanInterface::CreatePrimaryDescriptorPool() {
 void VulkanInterface::CreateUIDescriptorPool() {
     if (m_uiDescriptorPool != VK_NULL_HANDLE)
     {
-        vkDestroyDescriptorPool(device, m_uiDescriptorPool, nullptr);
+        DeferDescriptorPoolDestruction(m_uiDescriptorPool);
     }
 
-    std::array<VkDescriptorPoolSize, 1> poolSizes{};
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * textureFilePaths.size();
+    std::array<VkDescriptorPoolSize, 4> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    poolSizes[2].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * m_textureDescriptorCapacity;
+    poolSizes[3].type = VK_DESCRIPTOR_TYPE_SAMPLER;
+    poolSizes[3].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * m_samplerCache->GetSamplers().size());
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -322,52 +1053,24 @@ void VulkanInterface::CreateUIDescriptorPool() {
     }
 }
 
-void VulkanInterface::CreateUniformBuffers() {
-    VkDeviceSize uniformBufferSize = sizeof(VulkanCommonFunctions::GlobalInfo);
-    uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-
-    VkDeviceSize lightBufferSize = sizeof(VulkanCommonFunctions::LightInfo) * maxLightCount;
-    lightInfoBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-
-	VkDeviceSize uiUniformBufferSize = sizeof(VulkanCommonFunctions::UIGlobalInfo);
-	uiUniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-
-	GraphicsBuffer::BufferCreateInfo uniformBufferCreateInfo{};
-	uniformBufferCreateInfo.allocator = allocator;
-	uniformBufferCreateInfo.size = uniformBufferSize;
-	uniformBufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-	uniformBufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-	uniformBufferCreateInfo.device = device;
-	uniformBufferCreateInfo.commandPool = commandPool;
-	uniformBufferCreateInfo.graphicsQueue = graphicsQueue;
-
-	GraphicsBuffer::BufferCreateInfo lightBufferCreateInfo{};
-	lightBufferCreateInfo.allocator = allocator;
-	lightBufferCreateInfo.size = lightBufferSize;
-	lightBufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-	lightBufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-	lightBufferCreateInfo.device = device;
-	lightBufferCreateInfo.commandPool = commandPool;
-	lightBufferCreateInfo.graphicsQueue = graphicsQueue;
-
-    GraphicsBuffer::BufferCreateInfo uiUniformBufferCreateInfo{};
-    uiUniformBufferCreateInfo.allocator = allocator;
-    uiUniformBufferCreateInfo.size = uiUniformBufferSize;
-    uiUniformBufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    uiUniformBufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    uiUniformBufferCreateInfo.device = device;
-    uiUniformBufferCreateInfo.commandPool = commandPool;
-    uiUniformBufferCreateInfo.graphicsQueue = graphicsQueue;
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        std::shared_ptr<GraphicsBuffer> uniformBuffer = std::make_shared<GraphicsBuffer>(uniformBufferCreateInfo);
-        std::shared_ptr<GraphicsBuffer> lightBuffer = std::make_shared<GraphicsBuffer>(lightBufferCreateInfo);
-        std::shared_ptr<GraphicsBuffer> uiUniformBuffer = std::make_shared<GraphicsBuffer>(uiUniformBufferCreateInfo);
+void VulkanInterface::CreateFrameRingBuffer() {
+    FrameRingBuffer::FrameRingBufferCreateInfo ringCreateInfo{};
+    ringCreateInfo.framesInFlight = MAX_FRAMES_IN_FLIGHT;
+    ringCreateInfo.frameCapacity = kFrameRingCapacity;
+    ringCreateInfo.physicalDevice = physicalDevice;
+    ringCreateInfo.allocator = allocator;
+    ringCreateInfo.device = device;
+    ringCreateInfo.commandPool = commandPool;
+    ringCreateInfo.graphicsQueue = graphicsQueue;
+
+    m_frameRing = std::make_shared<FrameRingBuffer>(ringCreateInfo);
+}
 
-		uniformBuffers[i] = uniformBuffer;
-		lightInfoBuffers[i] = lightBuffer;
-		uiUniformBuffers[i] = uiUniformBuffer;
-    }
+void VulkanInterface::CreateUIQuadBuffers()
+{
+    m_uiQuad = std::make_shared<UIImage>();
+    m_uiQuadVertexBuffer = CreateUIVertexBuffer(m_uiQuad);
+    m_uiQuadIndexBuffer = CreateUIIndexBuffer(m_uiQuad);
 }
 
 void VulkanInterface::CreateDescriptorSetLayouts() {
@@ -378,31 +1081,65 @@ void VulkanInterface::CreateDescriptorSetLayouts() {
 void VulkanInterface::CreatePrimaryDescriptorSetLayout() {
     if (m_primaryDescriptorSetLayout != VK_NULL_HANDLE)
     {
-		vkDestroyDescriptorSetLayout(device, m_primaryDescriptorSetLayout, nullptr);
+		DeferDescriptorSetLayoutDestruction(m_primaryDescriptorSetLayout);
     }
     
     VkDescriptorSetLayoutBinding globalInfoLayoutBinding{};
     globalInfoLayoutBinding.binding = 0;
     globalInfoLayoutBinding.descriptorCount = 1;
-    globalInfoLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    globalInfoLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     globalInfoLayoutBinding.pImmutableSamplers = nullptr;
     globalInfoLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
     VkDescriptorSetLayoutBinding lightInfoBinding{};
     lightInfoBinding.binding = 1;
     lightInfoBinding.descriptorCount = 1;
-    lightInfoBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    lightInfoBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
     lightInfoBinding.pImmutableSamplers = nullptr;
     lightInfoBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
+    VkDescriptorSetLayoutBinding textureLayoutBinding{};
+    textureLayoutBinding.binding = 2;
+    textureLayoutBinding.descriptorCount = m_textureDescriptorCapacity;
+    textureLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    textureLayoutBinding.pImmutableSamplers = nullptr;
+    textureLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutBinding shadowInfoBinding{};
+    shadowInfoBinding.binding = 3;
+    shadowInfoBinding.descriptorCount = 1;
+    shadowInfoBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    shadowInfoBinding.pImmutableSamplers = nullptr;
+    shadowInfoBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutBinding shadowAtlasBinding{};
+    shadowAtlasBinding.binding = 4;
+    shadowAtlasBinding.descriptorCount = 1;
+    shadowAtlasBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    shadowAtlasBinding.pImmutableSamplers = nullptr;
+    shadowAtlasBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    const std::vector<VkSampler>& samplers = m_samplerCache->GetSamplers();
+
     VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-    samplerLayoutBinding.binding = 2;
-    samplerLayoutBinding.descriptorCount = textureFilePaths.size();
-    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.pImmutableSamplers = nullptr;
+    samplerLayoutBinding.binding = 5;
+    samplerLayoutBinding.descriptorCount = static_cast<uint32_t>(samplers.size());
+    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    samplerLayoutBinding.pImmutableSamplers = samplers.data();
     samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-    std::array<VkDescriptorSetLayoutBinding, 3> bindings = { globalInfoLayoutBinding, lightInfoBinding, samplerLayoutBinding };
+    VkDescriptorSetLayoutBinding samplerIdBinding{};
+    samplerIdBinding.binding = 6;
+    samplerIdBinding.descriptorCount = 1;
+    samplerIdBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    samplerIdBinding.pImmutableSamplers = nullptr;
+    samplerIdBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    std::array<VkDescriptorSetLayoutBinding, 7> bindings = { globalInfoLayoutBinding, lightInfoBinding, textureLayoutBinding, shadowInfoBinding, shadowAtlasBinding, samplerLayoutBinding, samplerIdBinding };
+
+    //built by hand since the shaders can't say which buffers are dynamic or how long the texture arrays are, so they're only checked against it
+    ShaderReflection::CheckLayoutBindings({ "shaders/HLSL/VertexShader.spv", "shaders/HLSL/PixelShader.spv", "shaders/HLSL/GBufferPixelShader.spv", "shaders/HLSL/TransparencyAccumulatePixelShader.spv", "shaders/HLSL/DepthOnlyPixelShader.spv", "shaders/HLSL/DepthPrepassVertexShader.spv" }, std::vector<VkDescriptorSetLayoutBinding>(bindings.begin(), bindings.end()));
+
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -417,119 +1154,479 @@ void VulkanInterface::CreateUIDescriptorSetLayout()
 {
     if (m_uiDescriptorSetLayout != VK_NULL_HANDLE)
     {
-        vkDestroyDescriptorSetLayout(device, m_uiDescriptorSetLayout, nullptr);
+        DeferDescriptorSetLayoutDestruction(m_uiDescriptorSetLayout);
     }
 
     VkDescriptorSetLayoutBinding globalInfoLayoutBinding{};
     globalInfoLayoutBinding.binding = 0;
     globalInfoLayoutBinding.descriptorCount = 1;
-    globalInfoLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    globalInfoLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     globalInfoLayoutBinding.pImmutableSamplers = nullptr;
     globalInfoLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
+    VkDescriptorSetLayoutBinding textureLayoutBinding{};
+    textureLayoutBinding.binding = 1;
+    textureLayoutBinding.descriptorCount = m_textureDescriptorCapacity;
+    textureLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    textureLayoutBinding.pImmutableSamplers = nullptr;
+    textureLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    const std::vector<VkSampler>& samplers = m_samplerCache->GetSamplers();
+
     VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-    samplerLayoutBinding.binding = 1;
-    samplerLayoutBinding.descriptorCount = textureFilePaths.size();
-    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.pImmutableSamplers = nullptr;
+    samplerLayoutBinding.binding = 2;
+    samplerLayoutBinding.descriptorCount = static_cast<uint32_t>(samplers.size());
+    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    samplerLayoutBinding.pImmutableSamplers = samplers.data();
     samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = { globalInfoLayoutBinding, samplerLayoutBinding };
+    VkDescriptorSetLayoutBinding samplerIdBinding{};
+    samplerIdBinding.binding = 3;
+    samplerIdBinding.descriptorCount = 1;
+    samplerIdBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    samplerIdBinding.pImmutableSamplers = nullptr;
+    samplerIdBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings = { globalInfoLayoutBinding, textureLayoutBinding, samplerLayoutBinding, samplerIdBinding };
+
+    ShaderReflection::CheckLayoutBindings({ "shaders/HLSL/UIVertexShader.spv", "shaders/HLSL/UIPixelShader.spv" }, std::vector<VkDescriptorSetLayoutBinding>(bindings.begin(), bindings.end()));
+
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
     layoutInfo.pBindings = bindings.data();
 
-    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_uiDescriptorSetLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create descriptor set layout!");
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_uiDescriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+}
+
+void VulkanInterface::BeginDrawFrameCommandBuffer(VkCommandBuffer commandBuffer, VkSubpassContents contents)
+{
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    //renderPassInfo.renderPass = renderPass;
+    renderPassInfo.renderPass = m_vulkanWindow->defaultRenderPass();
+    renderPassInfo.framebuffer = m_vulkanWindow->currentFramebuffer();
+    renderPassInfo.renderArea.offset = { 0, 0 };
+    renderPassInfo.renderArea.extent = { (uint)m_vulkanWindow->swapChainImageSize().width(), (uint)m_vulkanWindow->swapChainImageSize().height()};
+
+    std::array<VkClearValue, 2> clearValues{};
+
+    //clearValues[0].color = { {0.345098039f, 0.52156862f, 0.6862745098039216f, 1.0f} };
+    clearValues[0].color = { {0.1f, 0.1f, 0.1f, 1.0f} };
+    clearValues[1].depthStencil = { 1.0f, 0 };
+
+    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    renderPassInfo.pClearValues = clearValues.data();
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+
+    if (contents == VK_SUBPASS_CONTENTS_INLINE)
+    {
+        SetMainPassViewport(commandBuffer);
+    }
+}
+
+void VulkanInterface::SetMainPassViewport(VkCommandBuffer commandBuffer)
+{
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float)m_vulkanWindow->swapChainImageSize().width();
+    viewport.height = (float)m_vulkanWindow->swapChainImageSize().height();
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = { 0, 0 };
+    scissor.extent = { (uint)m_vulkanWindow->swapChainImageSize().width(), (uint)m_vulkanWindow->swapChainImageSize().height() };
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void VulkanInterface::BindScenePipeline(VkCommandBuffer commandBuffer, std::shared_ptr<GraphicsPipeline> pipeline)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetVkPipeline());
+
+    //in binding order, the globals, the lights then the shadows
+    std::array<uint32_t, 3> dynamicOffsets = { m_globalInfoOffset, m_lightInfoOffset, m_shadowInfoOffset };
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetVkPipelineLayout(), 0, 1, &primaryDescriptorSets[currentFrame], static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+}
+
+std::shared_ptr<GraphicsPipeline> VulkanInterface::GetScenePipeline(ScenePass pass, uint32_t materialVariant)
+{
+    const std::optional<GraphicsPipelineCreateInfo>& passState = m_scenePassStates[static_cast<size_t>(pass)];
+
+    //passes the chosen paths don't have are left empty, recording one of them is a bug in the caller
+    if (!passState.has_value())
+    {
+        throw std::runtime_error("scene pass " + std::to_string(static_cast<size_t>(pass)) + " has no pipeline state for the chosen rendering paths!");
+    }
+
+    //a copy, recording threads ask at the same time, the states only change between frames on the render thread
+    GraphicsPipelineCreateInfo state = *passState;
+    state.specializationConstants = VulkanCommonFunctions::GetMaterialSpecializationConstants(materialVariant & GetScenePassVariantMask(pass));
+
+    return m_pipelineCache->GetPipeline(state);
+}
+
+uint32_t VulkanInterface::GetScenePassVariantMask(ScenePass pass)
+{
+    switch (pass)
+    {
+    case ScenePass::DepthOnly:
+    case ScenePass::DepthPrepass:
+    case ScenePass::CustomMeshDepthPrepass:
+        return VulkanCommonFunctions::MATERIAL_VARIANT_BILLBOARDED;
+    default:
+        return VulkanCommonFunctions::MATERIAL_VARIANT_COUNT - 1;
+    }
+}
+
+//the recording functions look meshes up with at(), unlike operator[] it never inserts, so slices can record at the same time
+void VulkanInterface::BindInstancedObjectBuffers(VkCommandBuffer commandBuffer, const std::string& objectName, bool positionsOnly)
+{
+    std::shared_ptr<GraphicsBuffer> vertexBuffer = positionsOnly ? positionBuffers.at(objectName) : vertexBuffers.at(objectName);
+
+    VkBuffer objectVertexBuffer[] = { vertexBuffer->GetVkBuffer(), instanceBuffers[currentFrame].at(objectName)->GetVkBuffer()};
+    VkDeviceSize offsets[] = { 0, 0 };
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, objectVertexBuffer, offsets);
+
+    if (indexBufferSizes.at(objectName) > 0)
+    {
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffers.at(objectName)->GetVkBuffer(), 0, VK_INDEX_TYPE_UINT16);
+    }
+}
+
+void VulkanInterface::DrawInstancedObjectCommandBuffer(VkCommandBuffer commandBuffer, std::string objectName, size_t objectCount, size_t firstInstance, uint32_t lod, bool positionsOnly) {
+    if (objectCount <= 0)
+        return;
+    
+    BindInstancedObjectBuffers(commandBuffer, objectName, positionsOnly);
+
+    if (indexBufferSizes.at(objectName) > 0)
+    {
+        const VulkanCommonFunctions::LodLevel& level = m_meshLods.at(objectName).levels[lod];
+        vkCmdDrawIndexed(commandBuffer, level.indexCount, objectCount, level.firstIndex, 0, firstInstance);
+        //vkCmdDrawIndexed(commandBuffer, indexBufferSizes[objectName], meshNameToObjectMap[objectName].size(), 0, 0, 0);
+    }
+    else {
+        vkCmdDraw(commandBuffer, vertexBufferSizes.at(objectName), objectCount, 0, firstInstance);
+    }
+}
+
+void VulkanInterface::DrawClusteredObjectCommandBuffer(VkCommandBuffer commandBuffer, const std::string& objectName, size_t objectCount, uint32_t firstCommand, uint32_t lod, bool positionsOnly)
+{
+    if (objectCount <= 0)
+        return;
+
+    BindInstancedObjectBuffers(commandBuffer, objectName, positionsOnly);
+
+    //culled meshlets were written with no instances, so they cost a command read but no vertices
+    uint32_t drawCount = static_cast<uint32_t>(objectCount) * m_meshLods.at(objectName).levels[lod].meshletCount;
+    vkCmdDrawIndexedIndirect(commandBuffer, m_clusterCuller->GetCommandBuffer(), static_cast<VkDeviceSize>(firstCommand) * ClusterCuller::kCommandStride, drawCount, ClusterCuller::kCommandStride);
+}
+
+void VulkanInterface::DrawSingleObjectCommandBuffer(VkCommandBuffer commandBuffer, const RenderSnapshot::CustomMeshSnapshot& customMesh, uint32_t instanceIndex) {
+    //every custom mesh's instance sits in the frame ring, firstInstance picks this one's out of the frame's array
+    VkBuffer objectVertexBuffer[] = { customMesh.vertexBuffer->GetVkBuffer(), m_frameRing->GetBuffer()->GetVkBuffer()};
+    VkDeviceSize offsets[] = { 0, m_customMeshInstanceOffset };
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, objectVertexBuffer, offsets);
+
+    if (customMesh.indexed)
+    {
+        vkCmdBindIndexBuffer(commandBuffer, customMesh.indexBuffer->GetVkBuffer(), 0, VK_INDEX_TYPE_UINT16);
+
+        vkCmdDrawIndexed(commandBuffer, customMesh.indexCount, 1, 0, 0, instanceIndex);
+    }
+    else {
+        vkCmdDraw(commandBuffer, customMesh.vertexCount, 1, 0, instanceIndex);
+    }
+}
+
+void VulkanInterface::DrawSceneGeometry(VkCommandBuffer commandBuffer)
+{
+    //together these draw every instance once, at the level of detail picked for the camera
+    DrawOpaqueGeometry(commandBuffer, ScenePass::Shadow, false);
+    DrawTransparentGeometry(commandBuffer, ScenePass::Shadow);
+}
+
+void VulkanInterface::DrawOpaqueGeometry(VkCommandBuffer commandBuffer, ScenePass pass, bool cameraView)
+{
+    DrawOpaqueDraws(commandBuffer, 0, m_opaqueDraws.size(), cameraView, false, pass);
+}
+
+void VulkanInterface::DrawOpaqueDraws(VkCommandBuffer commandBuffer, size_t first, size_t last, bool cameraView, bool positionsOnly, ScenePass pass)
+{
+    uint32_t variantMask = GetScenePassVariantMask(pass);
+    uint32_t boundVariant = VulkanCommonFunctions::MATERIAL_VARIANT_COUNT;
+
+    for (size_t i = first; i < last; i++)
+    {
+        const OpaqueDraw& draw = m_opaqueDraws[i];
+
+        if (pass == ScenePass::Shadow)
+        {
+            if (!ShadowAtlas::CastsShadow(draw.materialVariant))
+            {
+                continue;
+            }
+        }
+        else if ((draw.materialVariant & variantMask) != boundVariant)
+        {
+            BindScenePipeline(commandBuffer, GetScenePipeline(pass, draw.materialVariant));
+            boundVariant = draw.materialVariant & variantMask;
+        }
+
+        if (draw.customMesh != nullptr)
+        {
+            DrawSingleObjectCommandBuffer(commandBuffer, *draw.customMesh, draw.firstInstance);
+        }
+        else if (cameraView && draw.clusterCulled)
+        {
+            DrawClusteredObjectCommandBuffer(commandBuffer, *draw.objectName, draw.instanceCount, draw.firstCommand, draw.lod, positionsOnly);
+        }
+        else {
+            DrawInstancedObjectCommandBuffer(commandBuffer, *draw.objectName, draw.instanceCount, draw.firstInstance, draw.lod, positionsOnly);
+        }
+    }
+}
+
+void VulkanInterface::BuildOpaqueDraws(const std::map<std::string, MeshInstanceRanges>& instanceRanges, const RenderSnapshot* currentSnapshot)
+{
+    m_opaqueDraws.clear();
+
+    //variant by variant across every mesh, so each pass binds every variant's pipeline once
+    for (uint32_t materialVariant = 0; materialVariant < VulkanCommonFunctions::MATERIAL_VARIANT_COUNT; materialVariant++)
+    {
+        for (auto it = instanceRanges.begin(); it != instanceRanges.end(); it++)
+        {
+            uint32_t firstGroup = materialVariant * VulkanCommonFunctions::MAX_LOD_LEVELS;
+            uint32_t firstInstance = 0;
+
+            for (uint32_t group = 0; group < firstGroup; group++)
+            {
+                firstInstance += static_cast<uint32_t>(it->second.opaqueGroupCounts[group]);
+            }
+
+            for (uint32_t lod = 0; lod < VulkanCommonFunctions::MAX_LOD_LEVELS; lod++)
+            {
+                uint32_t instanceCount = static_cast<uint32_t>(it->second.opaqueGroupCounts[firstGroup + lod]);
+
+                if (instanceCount > 0)
+                {
+                    OpaqueDraw draw;
+                    draw.objectName = &it->first;
+                    draw.firstInstance = firstInstance;
+                    draw.instanceCount = instanceCount;
+                    draw.lod = lod;
+                    draw.materialVariant = materialVariant;
+                    draw.clusterCulled = it->second.clusterCulled;
+                    draw.firstCommand = it->second.opaqueGroupFirstCommands[firstGroup + lod];
+
+                    m_opaqueDraws.push_back(draw);
+                }
+
+                firstInstance += instanceCount;
+            }
+        }
+    }
+
+    //custom meshes go last, so a pre-pass slice switches to their pipeline at most once
+    m_firstCustomMeshDraw = m_opaqueDraws.size();
+
+    for (uint32_t materialVariant = 0; materialVariant < VulkanCommonFunctions::MATERIAL_VARIANT_COUNT; materialVariant++)
+    {
+        for (size_t i = 0; i < currentSnapshot->customMeshes.size(); i++)
+        {
+            if (m_customMeshInstances[i].opacity < 1.0f || m_customMeshInstances[i].materialVariant != materialVariant)
+            {
+                continue;
+            }
+
+            OpaqueDraw draw;
+            draw.customMesh = &currentSnapshot->customMeshes[i];
+            draw.firstInstance = static_cast<uint32_t>(i);
+            draw.instanceCount = 1;
+            draw.materialVariant = materialVariant;
+
+            m_opaqueDraws.push_back(draw);
+        }
+    }
+}
+
+void VulkanInterface::DrawDepthPrepass(VkCommandBuffer commandBuffer, size_t first, size_t last)
+{
+    DrawOpaqueDraws(commandBuffer, first, std::min(last, m_firstCustomMeshDraw), true, true, ScenePass::DepthPrepass);
+
+    size_t firstCustomMesh = std::max(first, m_firstCustomMeshDraw);
+    if (firstCustomMesh < last)
+    {
+        DrawOpaqueDraws(commandBuffer, firstCustomMesh, last, true, true, ScenePass::CustomMeshDepthPrepass);
     }
 }
 
-void VulkanInterface::BeginDrawFrameCommandBuffer(VkCommandBuffer commandBuffer)
+uint32_t VulkanInterface::GetOpaqueSliceCount()
 {
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    //renderPassInfo.renderPass = renderPass;
-    renderPassInfo.renderPass = m_vulkanWindow->defaultRenderPass();
-    renderPassInfo.framebuffer = m_vulkanWindow->currentFramebuffer();
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = { (uint)m_vulkanWindow->swapChainImageSize().width(), (uint)m_vulkanWindow->swapChainImageSize().height()};
+    if (m_commandRecorder == nullptr)
+    {
+        return 1;
+    }
 
-    std::array<VkClearValue, 2> clearValues{};
+    size_t sliceCount = std::min<size_t>(m_commandRecorder->GetThreadCount(), m_opaqueDraws.size() / kMinDrawsPerSlice);
+    return static_cast<uint32_t>(std::max<size_t>(sliceCount, 1));
+}
 
-    //clearValues[0].color = { {0.345098039f, 0.52156862f, 0.6862745098039216f, 1.0f} };
-    clearValues[0].color = { {0.1f, 0.1f, 0.1f, 1.0f} };
-    clearValues[1].depthStencil = { 1.0f, 0 };
+void VulkanInterface::GetOpaqueSliceRange(uint32_t slice, uint32_t sliceCount, size_t& first, size_t& last)
+{
+    first = m_opaqueDraws.size() * slice / sliceCount;
+    last = m_opaqueDraws.size() * (slice + 1) / sliceCount;
+}
 
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
+void VulkanInterface::RecordMainPassInParallel(VkCommandBuffer commandBuffer, uint32_t sliceCount, bool depthPrepass, bool accumulateTransparency, std::shared_ptr<FontManager> fontManager)
+{
+    VkRenderPass renderPass = m_vulkanWindow->defaultRenderPass();
+    VkFramebuffer framebuffer = m_vulkanWindow->currentFramebuffer();
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_mainGraphicsPipeline->GetVkPipeline());
+    //every pre-pass slice is executed before the first opaque one, so the opaque draws test against the finished depth
+    uint32_t dispatchedSlices = depthPrepass ? sliceCount * 2 : sliceCount;
 
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)m_vulkanWindow->swapChainImageSize().width();
-    viewport.height = (float)m_vulkanWindow->swapChainImageSize().height();
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    m_commandRecorder->Dispatch(renderPass, framebuffer, dispatchedSlices, [this, sliceCount, depthPrepass](VkCommandBuffer sliceCommandBuffer, uint32_t slice) {
+        SetMainPassViewport(sliceCommandBuffer);
 
-    VkRect2D scissor{};
-    scissor.offset = { 0, 0 };
-    scissor.extent = { (uint)m_vulkanWindow->swapChainImageSize().width(), (uint)m_vulkanWindow->swapChainImageSize().height() };
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        size_t first;
+        size_t last;
+        GetOpaqueSliceRange(slice % sliceCount, sliceCount, first, last);
+
+        if (depthPrepass && slice < sliceCount)
+        {
+            DrawDepthPrepass(sliceCommandBuffer, first, last);
+            return;
+        }
+
+        DrawOpaqueDraws(sliceCommandBuffer, first, last, true, false, depthPrepass ? ScenePass::DepthEqual : ScenePass::Main);
+    });
+
+    VkCommandBuffer overlayCommandBuffer = m_commandRecorder->BeginSecondary(renderPass, framebuffer);
+    SetMainPassViewport(overlayCommandBuffer);
+    DrawTransparentPass(overlayCommandBuffer, accumulateTransparency);
+    DrawUIPass(overlayCommandBuffer, fontManager);
+    m_commandRecorder->EndSecondary(overlayCommandBuffer);
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_mainGraphicsPipeline->GetVkPipelineLayout(), 0, 1, &primaryDescriptorSets[currentFrame], 0, nullptr);
+    const std::vector<VkCommandBuffer>& sliceCommandBuffers = m_commandRecorder->Wait();
+
+    BeginDrawFrameCommandBuffer(commandBuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(sliceCommandBuffers.size()), sliceCommandBuffers.data());
+    vkCmdExecuteCommands(commandBuffer, 1, &overlayCommandBuffer);
 }
 
-void VulkanInterface::DrawInstancedObjectCommandBuffer(VkCommandBuffer commandBuffer, std::string objectName, size_t objectCount) {
-    if (objectCount <= 0)
-        return;
-    
-    VkBuffer objectVertexBuffer[] = { vertexBuffers[objectName]->GetVkBuffer(), instanceBuffers[currentFrame][objectName]->GetVkBuffer()};
-    VkDeviceSize offsets[] = { 0, 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 2, objectVertexBuffer, offsets);
+void VulkanInterface::RecordGBufferPassInParallel(VkCommandBuffer commandBuffer, uint32_t sliceCount)
+{
+    m_commandRecorder->Dispatch(m_deferredRenderer->GetGBufferRenderPass(), m_deferredRenderer->GetGBufferFramebuffer(), sliceCount, [this, sliceCount](VkCommandBuffer sliceCommandBuffer, uint32_t slice) {
+        m_deferredRenderer->SetGBufferViewport(sliceCommandBuffer);
 
-    if (indexBufferSizes[objectName] > 0)
-    {
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffers[objectName]->GetVkBuffer(), 0, VK_INDEX_TYPE_UINT16);
+        size_t first;
+        size_t last;
+        GetOpaqueSliceRange(slice, sliceCount, first, last);
 
-        vkCmdDrawIndexed(commandBuffer, indexBufferSizes[objectName], objectCount, 0, 0, 0);
-        //vkCmdDrawIndexed(commandBuffer, indexBufferSizes[objectName], meshNameToObjectMap[objectName].size(), 0, 0, 0);
+        DrawOpaqueDraws(sliceCommandBuffer, first, last, true, false, ScenePass::GBuffer);
+    });
+
+    const std::vector<VkCommandBuffer>& sliceCommandBuffers = m_commandRecorder->Wait();
+
+    m_deferredRenderer->BeginGBufferPass(commandBuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(sliceCommandBuffers.size()), sliceCommandBuffers.data());
+    m_deferredRenderer->EndGBufferPass(commandBuffer);
+}
+
+void VulkanInterface::BeginGpuScope(VkCommandBuffer commandBuffer, const char* name)
+{
+    if (m_gpuProfiler != nullptr)
+    {
+        m_gpuProfiler->BeginScope(commandBuffer, name);
     }
-    else {
-        vkCmdDraw(commandBuffer, vertexBufferSizes[objectName], objectCount, 0, 0);
+}
+
+void VulkanInterface::EndGpuScope(VkCommandBuffer commandBuffer)
+{
+    if (m_gpuProfiler != nullptr)
+    {
+        m_gpuProfiler->EndScope(commandBuffer);
     }
 }
 
-void VulkanInterface::DrawSingleObjectCommandBuffer(VkCommandBuffer commandBuffer, std::shared_ptr<RenderObject> renderObject) {
-	std::shared_ptr<MeshRenderer> meshComponent = renderObject->GetComponent<MeshRenderer>();
+void VulkanInterface::DrawTransparentGeometry(VkCommandBuffer commandBuffer, ScenePass pass)
+{
+    uint32_t variantMask = GetScenePassVariantMask(pass);
+    uint32_t boundVariant = VulkanCommonFunctions::MATERIAL_VARIANT_COUNT;
 
-    if (meshComponent == nullptr)
+    for (size_t i = 0; i < m_transparentDraws.size(); i++)
     {
-        return;
+        const TransparentDraw& draw = m_transparentDraws[i];
+
+        if (pass == ScenePass::Shadow)
+        {
+            if (!ShadowAtlas::CastsShadow(draw.materialVariant))
+            {
+                continue;
+            }
+        }
+        else if ((draw.materialVariant & variantMask) != boundVariant)
+        {
+            BindScenePipeline(commandBuffer, GetScenePipeline(pass, draw.materialVariant));
+            boundVariant = draw.materialVariant & variantMask;
+        }
+
+        if (draw.customMesh != nullptr)
+        {
+            DrawSingleObjectCommandBuffer(commandBuffer, *draw.customMesh, draw.firstInstance);
+        }
+        else {
+            DrawInstancedObjectCommandBuffer(commandBuffer, *draw.objectName, draw.instanceCount, draw.firstInstance, draw.lod);
+        }
     }
+}
 
-    if (meshComponent->GetMeshName() != MeshRenderer::kCustomMeshName)
+void VulkanInterface::DrawTransparentPass(VkCommandBuffer commandBuffer, bool accumulateTransparency)
+{
+    if (accumulateTransparency)
     {
-        return;
+        m_orderIndependentTransparency->DrawComposite(commandBuffer);
+    }
+    else {
+        DrawTransparentGeometry(commandBuffer, ScenePass::Transparent);
     }
+}
 
-    VkBuffer objectVertexBuffer[] = { meshComponent->GetVertexBuffer()->GetVkBuffer(), renderObject->GetInstanceBuffer(textureFilePaths)->GetVkBuffer()};
-    VkDeviceSize offsets[] = { 0, 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 2, objectVertexBuffer, offsets);
+void VulkanInterface::DrawUIPass(VkCommandBuffer commandBuffer, std::shared_ptr<FontManager> fontManager)
+{
+    SwitchToUIPipeline(commandBuffer);
+    DrawUIElements(commandBuffer, fontManager);
+}
 
-    if (meshComponent->IsIndexed())
+void VulkanInterface::BuildTransparentDraws()
+{
+    m_transparentDraws.clear();
+    m_instanceSorter.Sort(m_transparentKeys, m_sortOrder);
+
+    //each mesh's transparent instances were uploaded in this same order, so neighbours from one mesh share a draw
+    for (size_t i = 0; i < m_sortOrder.size(); i++)
     {
-        vkCmdBindIndexBuffer(commandBuffer, meshComponent->GetIndexBuffer()->GetVkBuffer(), 0, VK_INDEX_TYPE_UINT16);
+        const TransparentDraw& instance = m_transparentInstances[m_sortOrder[i]];
 
-        vkCmdDrawIndexed(commandBuffer, meshComponent->GetIndexBufferSize(), 1, 0, 0, 0);
-        //vkCmdDrawIndexed(commandBuffer, indexBufferSizes[objectName], meshNameToObjectMap[objectName].size(), 0, 0, 0);
-    }
-    else {
-        vkCmdDraw(commandBuffer, meshComponent->GetVertexBufferSize(), 1, 0, 0);
+        if (!m_transparentDraws.empty())
+        {
+            TransparentDraw& previous = m_transparentDraws.back();
+
+            if (instance.objectName != nullptr && previous.objectName == instance.objectName && previous.lod == instance.lod && previous.materialVariant == instance.materialVariant && previous.firstInstance + previous.instanceCount == instance.firstInstance)
+            {
+                previous.instanceCount++;
+                continue;
+            }
+        }
+
+        m_transparentDraws.push_back(instance);
     }
 }
 
@@ -540,19 +1637,53 @@ void VulkanInterface::EndDrawFrameCommandBuffer(VkCommandBuffer commandBuffer)
 
 void VulkanInterface::CreateGraphicsPipelines() 
 {
+    //called again when the descriptor set layouts are replaced, every pipeline made with the old ones goes once the frames in flight are done with it
+    std::vector<std::shared_ptr<GraphicsPipeline>> clearedPipelines = m_pipelineCache->Clear();
+    for (size_t i = 0; i < clearedPipelines.size(); i++)
+    {
+        DeferDestruction(clearedPipelines[i]);
+    }
+
+    m_scenePassStates.fill(std::nullopt);
+
     CreatePrimaryGraphicsPipeline();
     CreateUIGraphicsPipeline();
-}
+    CreateDeferredGraphicsPipelines();
+    CreateTransparencyGraphicsPipelines();
+    CreateDepthPrepassGraphicsPipelines();
 
-void VulkanInterface::CreatePrimaryGraphicsPipeline() 
-{
-    if (m_mainGraphicsPipeline != VK_NULL_HANDLE)
+    //in pass order, so the main pass's variants are usually ready before the first frame asks for them
+    std::vector<GraphicsPipelineCreateInfo> variantStates;
+
+    for (size_t pass = 0; pass < m_scenePassStates.size(); pass++)
     {
-        m_mainGraphicsPipeline->SetDescriptorSetLayout(m_primaryDescriptorSetLayout);
-        m_mainGraphicsPipeline->CreatePipeline();
-        return;
+        if (!m_scenePassStates[pass].has_value())
+        {
+            continue;
+        }
+
+        uint32_t variantMask = GetScenePassVariantMask(static_cast<ScenePass>(pass));
+
+        for (uint32_t materialVariant = 0; materialVariant < VulkanCommonFunctions::MATERIAL_VARIANT_COUNT; materialVariant++)
+        {
+            //variants that only differ in bits the pass ignores share the first one's pipeline
+            if ((materialVariant & variantMask) != materialVariant)
+            {
+                continue;
+            }
+
+            GraphicsPipelineCreateInfo variantState = *m_scenePassStates[pass];
+            variantState.specializationConstants = VulkanCommonFunctions::GetMaterialSpecializationConstants(materialVariant);
+
+            variantStates.push_back(variantState);
+        }
     }
 
+    m_pipelineCache->Precompile(variantStates);
+}
+
+void VulkanInterface::CreatePrimaryGraphicsPipeline() 
+{
 	GraphicsPipelineCreateInfo pipelineCreateInfo{};
 	pipelineCreateInfo.vertexShaderFilePath = "shaders/HLSL/VertexShader.spv";
 	pipelineCreateInfo.fragmentShaderFilePath = "shaders/HLSL/PixelShader.spv";
@@ -560,18 +1691,11 @@ void VulkanInterface::CreatePrimaryGraphicsPipeline()
 	pipelineCreateInfo.device = device;
 	pipelineCreateInfo.vulkanWindow = m_vulkanWindow;
     pipelineCreateInfo.uiBasedPipeline = false;
-	m_mainGraphicsPipeline = std::make_shared<GraphicsPipeline>(pipelineCreateInfo);
+	m_scenePassStates[static_cast<size_t>(ScenePass::Main)] = pipelineCreateInfo;
 }
 
 void VulkanInterface::CreateUIGraphicsPipeline()
 {
-    if (m_uiGraphicsPipeline != VK_NULL_HANDLE)
-    {
-        m_uiGraphicsPipeline->SetDescriptorSetLayout(m_uiDescriptorSetLayout);
-        m_uiGraphicsPipeline->CreatePipeline();
-        return;
-    }
-
     GraphicsPipelineCreateInfo pipelineCreateInfo{};
     pipelineCreateInfo.vertexShaderFilePath = "shaders/HLSL/UIVertexShader.spv";
     pipelineCreateInfo.fragmentShaderFilePath = "shaders/HLSL/UIPixelShader.spv";
@@ -579,7 +1703,104 @@ void VulkanInterface::CreateUIGraphicsPipeline()
     pipelineCreateInfo.device = device;
     pipelineCreateInfo.vulkanWindow = m_vulkanWindow;
 	pipelineCreateInfo.uiBasedPipeline = true;
-    m_uiGraphicsPipeline = std::make_shared<GraphicsPipeline>(pipelineCreateInfo);
+    m_uiGraphicsPipeline = m_pipelineCache->GetPipeline(pipelineCreateInfo);
+}
+
+void VulkanInterface::CreateDeferredGraphicsPipelines()
+{
+    if (m_deferredRenderer == nullptr)
+    {
+        return;
+    }
+
+    //g-buffer targets are overwritten, transparent objects never reach them
+    GraphicsPipelineCreateInfo gBufferCreateInfo{};
+    gBufferCreateInfo.vertexShaderFilePath = "shaders/HLSL/VertexShader.spv";
+    gBufferCreateInfo.fragmentShaderFilePath = "shaders/HLSL/GBufferPixelShader.spv";
+    gBufferCreateInfo.descriptorSetLayout = m_primaryDescriptorSetLayout;
+    gBufferCreateInfo.device = device;
+    gBufferCreateInfo.vulkanWindow = m_vulkanWindow;
+    gBufferCreateInfo.uiBasedPipeline = false;
+    gBufferCreateInfo.renderPass = m_deferredRenderer->GetGBufferRenderPass();
+    gBufferCreateInfo.colorAttachmentCount = 4;
+    gBufferCreateInfo.blendEnable = false;
+    m_scenePassStates[static_cast<size_t>(ScenePass::GBuffer)] = gBufferCreateInfo;
+}
+
+void VulkanInterface::CreateTransparencyGraphicsPipelines()
+{
+    //sorted transparent objects are tested against the opaque depth but don't write it, so they can't hide each other
+    GraphicsPipelineCreateInfo transparentCreateInfo{};
+    transparentCreateInfo.vertexShaderFilePath = "shaders/HLSL/VertexShader.spv";
+    transparentCreateInfo.fragmentShaderFilePath = "shaders/HLSL/PixelShader.spv";
+    transparentCreateInfo.descriptorSetLayout = m_primaryDescriptorSetLayout;
+    transparentCreateInfo.device = device;
+    transparentCreateInfo.vulkanWindow = m_vulkanWindow;
+    transparentCreateInfo.uiBasedPipeline = false;
+    transparentCreateInfo.depthWriteEnable = false;
+    m_scenePassStates[static_cast<size_t>(ScenePass::Transparent)] = transparentCreateInfo;
+
+    if (m_orderIndependentTransparency == nullptr)
+    {
+        return;
+    }
+
+    GraphicsPipelineCreateInfo depthOnlyCreateInfo{};
+    depthOnlyCreateInfo.vertexShaderFilePath = "shaders/HLSL/VertexShader.spv";
+    depthOnlyCreateInfo.fragmentShaderFilePath = "shaders/HLSL/DepthOnlyPixelShader.spv";
+    depthOnlyCreateInfo.descriptorSetLayout = m_primaryDescriptorSetLayout;
+    depthOnlyCreateInfo.device = device;
+    depthOnlyCreateInfo.vulkanWindow = m_vulkanWindow;
+    depthOnlyCreateInfo.uiBasedPipeline = false;
+    depthOnlyCreateInfo.renderPass = m_orderIndependentTransparency->GetRenderPass();
+    depthOnlyCreateInfo.colorAttachmentCount = 2;
+    depthOnlyCreateInfo.blendEnable = false;
+    depthOnlyCreateInfo.colorWriteMask = 0;
+    m_scenePassStates[static_cast<size_t>(ScenePass::DepthOnly)] = depthOnlyCreateInfo;
+
+    GraphicsPipelineCreateInfo accumulateCreateInfo{};
+    accumulateCreateInfo.vertexShaderFilePath = "shaders/HLSL/VertexShader.spv";
+    accumulateCreateInfo.fragmentShaderFilePath = "shaders/HLSL/TransparencyAccumulatePixelShader.spv";
+    accumulateCreateInfo.descriptorSetLayout = m_primaryDescriptorSetLayout;
+    accumulateCreateInfo.device = device;
+    accumulateCreateInfo.vulkanWindow = m_vulkanWindow;
+    accumulateCreateInfo.uiBasedPipeline = false;
+    accumulateCreateInfo.renderPass = m_orderIndependentTransparency->GetRenderPass();
+    accumulateCreateInfo.colorAttachmentCount = 2;
+    accumulateCreateInfo.additiveBlend = true;
+    accumulateCreateInfo.depthWriteEnable = false;
+    m_scenePassStates[static_cast<size_t>(ScenePass::Accumulate)] = accumulateCreateInfo;
+}
+
+void VulkanInterface::CreateDepthPrepassGraphicsPipelines()
+{
+    //the window's pass has a color target, so the pre-pass keeps a fragment shader and masks the writes off
+    GraphicsPipelineCreateInfo prepassCreateInfo{};
+    prepassCreateInfo.vertexShaderFilePath = "shaders/HLSL/DepthPrepassVertexShader.spv";
+    prepassCreateInfo.fragmentShaderFilePath = "shaders/HLSL/DepthOnlyPixelShader.spv";
+    prepassCreateInfo.descriptorSetLayout = m_primaryDescriptorSetLayout;
+    prepassCreateInfo.device = device;
+    prepassCreateInfo.vulkanWindow = m_vulkanWindow;
+    prepassCreateInfo.uiBasedPipeline = false;
+    prepassCreateInfo.positionOnlyVertexInput = true;
+    prepassCreateInfo.blendEnable = false;
+    prepassCreateInfo.colorWriteMask = 0;
+    m_scenePassStates[static_cast<size_t>(ScenePass::DepthPrepass)] = prepassCreateInfo;
+
+    GraphicsPipelineCreateInfo customMeshPrepassCreateInfo = prepassCreateInfo;
+    customMeshPrepassCreateInfo.positionOnlyVertexInput = false;
+    m_scenePassStates[static_cast<size_t>(ScenePass::CustomMeshDepthPrepass)] = customMeshPrepassCreateInfo;
+
+    GraphicsPipelineCreateInfo depthEqualCreateInfo{};
+    depthEqualCreateInfo.vertexShaderFilePath = "shaders/HLSL/VertexShader.spv";
+    depthEqualCreateInfo.fragmentShaderFilePath = "shaders/HLSL/PixelShader.spv";
+    depthEqualCreateInfo.descriptorSetLayout = m_primaryDescriptorSetLayout;
+    depthEqualCreateInfo.device = device;
+    depthEqualCreateInfo.vulkanWindow = m_vulkanWindow;
+    depthEqualCreateInfo.uiBasedPipeline = false;
+    depthEqualCreateInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+    depthEqualCreateInfo.depthWriteEnable = false;
+    m_scenePassStates[static_cast<size_t>(ScenePass::DepthEqual)] = depthEqualCreateInfo;
 }
 
 void VulkanInterface::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) {
@@ -710,6 +1931,26 @@ void VulkanInterface::UpdateObjectBuffers(std::shared_ptr<MeshRenderer> objectMe
     vertexBuffers[objectMesh->GetMeshName()] = vertexBuffer;
     vertexBufferSizes[objectMesh->GetMeshName()] = static_cast<uint16_t>(objectMesh->GetVertices().size());
 
+    positionBuffers[objectMesh->GetMeshName()] = CreatePositionBuffer(objectMesh);
+
+    MeshLods meshLods;
+    meshLods.levels = objectMesh->GetLodLevels();
+    meshLods.boundingRadius = MeshSimplifier::GetBoundingRadius(objectMesh->GetVertices());
+
+    if (meshLods.levels.empty())
+    {
+        VulkanCommonFunctions::LodLevel fullLevel;
+        fullLevel.indexCount = static_cast<uint32_t>(objectMesh->GetIndices().size());
+        meshLods.levels.push_back(fullLevel);
+    }
+
+    m_meshLods[objectMesh->GetMeshName()] = meshLods;
+
+    if (m_clusterCuller != nullptr && !objectMesh->GetMeshlets().empty())
+    {
+        m_clusterCuller->AddMesh(objectMesh->GetMeshName(), objectMesh->GetMeshlets());
+    }
+
     CreateInstanceBuffer(objectMesh);
 }
 
@@ -778,114 +2019,358 @@ std::shared_ptr<GraphicsBuffer> VulkanInterface::CreateIndexBuffer(std::shared_p
 
 	stagingBuffer->CopyBuffer(indexBuffer, bufferSize);
 
-	stagingBuffer->DestroyBuffer();
+	stagingBuffer->DestroyBuffer();
+
+	return indexBuffer;
+}
+
+std::shared_ptr<GraphicsBuffer> VulkanInterface::CreatePositionBuffer(std::shared_ptr<MeshRenderer> meshInfo) {
+    const std::vector<VulkanCommonFunctions::Vertex>& vertices = meshInfo->GetVertices();
+
+    std::vector<VulkanCommonFunctions::PositionVertex> positions(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        positions[i].pos = vertices[i].pos;
+    }
+
+    VkDeviceSize bufferSize = sizeof(VulkanCommonFunctions::PositionVertex) * positions.size();
+
+    GraphicsBuffer::BufferCreateInfo stagingBufferCreateInfo = {};
+    stagingBufferCreateInfo.size = bufferSize;
+    stagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    stagingBufferCreateInfo.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    stagingBufferCreateInfo.allocator = allocator;
+    stagingBufferCreateInfo.commandPool = commandPool;
+    stagingBufferCreateInfo.graphicsQueue = graphicsQueue;
+    stagingBufferCreateInfo.device = device;
+
+    std::shared_ptr<GraphicsBuffer> stagingBuffer = std::make_shared<GraphicsBuffer>(stagingBufferCreateInfo);
+    stagingBuffer->LoadData((void*)positions.data(), (size_t)bufferSize);
+
+    GraphicsBuffer::BufferCreateInfo positionBufferCreateInfo = {};
+    positionBufferCreateInfo.size = bufferSize;
+    positionBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    positionBufferCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    positionBufferCreateInfo.allocator = allocator;
+    positionBufferCreateInfo.commandPool = commandPool;
+    positionBufferCreateInfo.graphicsQueue = graphicsQueue;
+    positionBufferCreateInfo.device = device;
+
+    std::shared_ptr<GraphicsBuffer> positionBuffer = std::make_shared<GraphicsBuffer>(positionBufferCreateInfo);
+
+    stagingBuffer->CopyBuffer(positionBuffer, bufferSize);
+    stagingBuffer->DestroyBuffer();
+
+    return positionBuffer;
+}
+
+void VulkanInterface::CreateVMAAllocator()
+{
+    VmaVulkanFunctions vulkanFunctions = {};
+    vulkanFunctions.vkGetInstanceProcAddr = &vkGetInstanceProcAddr;
+    vulkanFunctions.vkGetDeviceProcAddr = &vkGetDeviceProcAddr;
+
+    VmaAllocatorCreateInfo allocatorCreateInfo = {};
+    allocatorCreateInfo.flags = VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    allocatorCreateInfo.vulkanApiVersion = VK_API_VERSION_1_3;
+    allocatorCreateInfo.physicalDevice = physicalDevice;
+    allocatorCreateInfo.device = device;
+    allocatorCreateInfo.instance = instance;
+    allocatorCreateInfo.pVulkanFunctions = &vulkanFunctions;
+
+    vmaCreateAllocator(&allocatorCreateInfo, &allocator);
+}
+
+void VulkanInterface::CreateInstanceBuffer(std::shared_ptr<MeshRenderer> object)
+{
+    if (object->GetMeshName() == MeshRenderer::kCustomMeshName)
+    {
+        return;
+    }
+
+    for (uint32_t frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+    {
+        std::shared_ptr<GraphicsBuffer> instanceBuffer = CreateInstanceBuffer(VulkanCommonFunctions::MAX_MESH_INSTANCES);
+		instanceBuffers[frameIndex][object->GetMeshName()] = instanceBuffer;
+    }
+}
+
+std::shared_ptr<GraphicsBuffer> VulkanInterface::CreateInstanceBuffer(size_t maxObjects)
+{
+    VkDeviceSize bufferSize = sizeof(VulkanCommonFunctions::InstanceInfo) * maxObjects;
+
+    GraphicsBuffer::BufferCreateInfo instanceBufferCreateInfo = {};
+    instanceBufferCreateInfo.size = bufferSize;
+    instanceBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    instanceBufferCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    instanceBufferCreateInfo.allocator = allocator;
+    instanceBufferCreateInfo.commandPool = commandPool;
+    instanceBufferCreateInfo.graphicsQueue = graphicsQueue;
+    instanceBufferCreateInfo.device = device;
+
+    std::shared_ptr<GraphicsBuffer> instanceBuffer = std::make_shared<GraphicsBuffer>(instanceBufferCreateInfo);
+    return instanceBuffer;
+}
+
+void VulkanInterface::DeferDestruction(std::shared_ptr<GraphicsBuffer> buffer)
+{
+    RetiredBuffer retiredBuffer;
+    retiredBuffer.buffer = buffer;
+    retiredBuffer.retiredFrame = m_frameNumber;
+
+    m_retiredBuffers.push_back(retiredBuffer);
+}
+
+void VulkanInterface::ReleaseRetiredBuffers()
+{
+    //qt waits on the fence of a frame slot before reusing it, so this many frames back is done on the gpu
+    while (!m_retiredBuffers.empty() && m_retiredBuffers.front().retiredFrame + MAX_FRAMES_IN_FLIGHT <= m_frameNumber)
+    {
+        m_retiredBuffers.front().buffer->DestroyBuffer();
+        m_retiredBuffers.pop_front();
+    }
+
+    while (!m_retiredTextures.empty() && m_retiredTextures.front().retiredFrame + MAX_FRAMES_IN_FLIGHT <= m_frameNumber)
+    {
+        m_retiredTextures.front().texture->DestroyTextureImage();
+        m_retiredTextures.pop_front();
+    }
+
+    while (!m_retiredPipelines.empty() && m_retiredPipelines.front().retiredFrame + MAX_FRAMES_IN_FLIGHT <= m_frameNumber)
+    {
+        m_retiredPipelines.front().pipeline->DestroyPipeline();
+        m_retiredPipelines.pop_front();
+    }
+
+    while (!m_retiredDescriptorPools.empty() && m_retiredDescriptorPools.front().retiredFrame + MAX_FRAMES_IN_FLIGHT <= m_frameNumber)
+    {
+        vkDestroyDescriptorPool(device, m_retiredDescriptorPools.front().descriptorPool, nullptr);
+        m_retiredDescriptorPools.pop_front();
+    }
+
+    while (!m_retiredDescriptorSetLayouts.empty() && m_retiredDescriptorSetLayouts.front().retiredFrame + MAX_FRAMES_IN_FLIGHT <= m_frameNumber)
+    {
+        vkDestroyDescriptorSetLayout(device, m_retiredDescriptorSetLayouts.front().descriptorSetLayout, nullptr);
+        m_retiredDescriptorSetLayouts.pop_front();
+    }
+}
+
+uint32_t VulkanInterface::GetAllocationCount()
+{
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(allocator, budgets);
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+
+    uint32_t allocationCount = 0;
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++)
+    {
+        allocationCount += budgets[i].statistics.allocationCount;
+    }
+
+    return allocationCount;
+}
+
+void VulkanInterface::DeferDestruction(std::shared_ptr<TextureImage> texture)
+{
+    RetiredTexture retiredTexture;
+    retiredTexture.texture = texture;
+    retiredTexture.retiredFrame = m_frameNumber;
+
+    m_retiredTextures.push_back(retiredTexture);
+}
+
+void VulkanInterface::DeferDestruction(std::shared_ptr<GraphicsPipeline> pipeline)
+{
+    RetiredPipeline retiredPipeline;
+    retiredPipeline.pipeline = pipeline;
+    retiredPipeline.retiredFrame = m_frameNumber;
 
-	return indexBuffer;
+    m_retiredPipelines.push_back(retiredPipeline);
 }
 
-void VulkanInterface::CreateVMAAllocator()
+void VulkanInterface::DeferDescriptorPoolDestruction(VkDescriptorPool descriptorPool)
 {
-    VmaVulkanFunctions vulkanFunctions = {};
-    vulkanFunctions.vkGetInstanceProcAddr = &vkGetInstanceProcAddr;
-    vulkanFunctions.vkGetDeviceProcAddr = &vkGetDeviceProcAddr;
+    RetiredDescriptorPool retiredDescriptorPool;
+    retiredDescriptorPool.descriptorPool = descriptorPool;
+    retiredDescriptorPool.retiredFrame = m_frameNumber;
 
-    VmaAllocatorCreateInfo allocatorCreateInfo = {};
-    allocatorCreateInfo.flags = VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
-    allocatorCreateInfo.vulkanApiVersion = VK_API_VERSION_1_3;
-    allocatorCreateInfo.physicalDevice = physicalDevice;
-    allocatorCreateInfo.device = device;
-    allocatorCreateInfo.instance = instance;
-    allocatorCreateInfo.pVulkanFunctions = &vulkanFunctions;
+    m_retiredDescriptorPools.push_back(retiredDescriptorPool);
+}
 
-    vmaCreateAllocator(&allocatorCreateInfo, &allocator);
+void VulkanInterface::DeferDescriptorSetLayoutDestruction(VkDescriptorSetLayout descriptorSetLayout)
+{
+    RetiredDescriptorSetLayout retiredDescriptorSetLayout;
+    retiredDescriptorSetLayout.descriptorSetLayout = descriptorSetLayout;
+    retiredDescriptorSetLayout.retiredFrame = m_frameNumber;
+
+    m_retiredDescriptorSetLayouts.push_back(retiredDescriptorSetLayout);
 }
 
-void VulkanInterface::CreateInstanceBuffer(std::shared_ptr<MeshRenderer> object)
+VulkanInterface::MeshInstanceRanges VulkanInterface::UpdateInstanceBuffer(const std::string& objectName, const std::vector<RenderSnapshot::InstanceSnapshot>* previousInstances, const std::vector<RenderSnapshot::InstanceSnapshot>& currentInstances, float interpolation)
 {
-    if (object->GetMeshName() == MeshRenderer::kCustomMeshName)
+    MeshInstanceRanges ranges;
+
+    //buffers for a new mesh are created on the render thread, it may not have happened yet
+    if (!instanceBuffers[currentFrame].contains(objectName) || !vertexBuffers.contains(objectName))
     {
-        return;
+        return ranges;
     }
 
-    for (uint32_t frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+    RenderSnapshot::InterpolateInstances(previousInstances, currentInstances, interpolation, m_interpolatedInstances);
+
+    if (m_interpolatedInstances.size() == 0)
     {
-        std::shared_ptr<GraphicsBuffer> instanceBuffer = CreateInstanceBuffer(VulkanCommonFunctions::MAX_OBJECTS);
-		instanceBuffers[frameIndex][object->GetMeshName()] = instanceBuffer;
+        return ranges;
     }
-}
-
-std::shared_ptr<GraphicsBuffer> VulkanInterface::CreateInstanceBuffer(size_t maxObjects)
-{
-    VkDeviceSize bufferSize = sizeof(VulkanCommonFunctions::InstanceInfo) * maxObjects;
 
-    GraphicsBuffer::BufferCreateInfo instanceBufferCreateInfo = {};
-    instanceBufferCreateInfo.size = bufferSize;
-    instanceBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-    instanceBufferCreateInfo.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    instanceBufferCreateInfo.allocator = allocator;
-    instanceBufferCreateInfo.commandPool = commandPool;
-    instanceBufferCreateInfo.graphicsQueue = graphicsQueue;
-    instanceBufferCreateInfo.device = device;
+    size_t instanceCount = std::min(m_interpolatedInstances.size(), VulkanCommonFunctions::MAX_MESH_INSTANCES);
 
-    std::shared_ptr<GraphicsBuffer> instanceBuffer = std::make_shared<GraphicsBuffer>(instanceBufferCreateInfo);
-    return instanceBuffer;
-}
+    //opaque instances nearest first so early depth testing rejects what's behind them, transparent ones farthest first
+    m_opaqueKeys.clear();
+    m_opaqueIndices.clear();
+    m_meshTransparentKeys.clear();
+    m_meshTransparentIndices.clear();
+    m_meshTransparentLods.clear();
 
-void VulkanInterface::UpdateInstanceBuffer(std::string objectName, std::set<VulkanCommonFunctions::ObjectHandle> objectHandles, std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> objects)
-{
-    std::vector<VulkanCommonFunctions::InstanceInfo> objectInfo;
+    const MeshLods& meshLods = m_meshLods[objectName];
 
-    for (auto it = objectHandles.begin(); it != objectHandles.end(); it++)
+    for (size_t i = 0; i < instanceCount; i++)
     {
-        VulkanCommonFunctions::ObjectHandle currentHandle = *it;
+        m_textureResidency->MarkUsed(m_interpolatedInstances[i].textureIndex, m_frameNumber);
 
-        if (currentHandle == VulkanCommonFunctions::INVALID_OBJECT_HANDLE || !objects.contains(currentHandle))
+        float viewDepth = GetViewDepth(m_interpolatedInstances[i]);
+        uint32_t depthKey = RadixSorter::FloatToKey(viewDepth);
+
+        uint32_t slot = HandlePool::GetSlot(currentInstances[i].handle);
+        if (slot >= m_instanceLods.size())
         {
-            continue;
+            m_instanceLods.resize(slot + 1, 0);
         }
 
-        std::shared_ptr<RenderObject> object = objects[currentHandle];
+        //a slot reused by a new object starts from whatever level the old one ended on, which only costs a frame or two of settling
+        uint32_t lod = SelectLod(meshLods, m_interpolatedInstances[i], viewDepth, m_instanceLods[slot]);
+        m_instanceLods[slot] = static_cast<uint8_t>(lod);
+
+        if (m_interpolatedInstances[i].opacity < 1.0f)
+        {
+            m_meshTransparentKeys.push_back(~depthKey);
+            m_meshTransparentIndices.push_back(static_cast<uint32_t>(i));
+            m_meshTransparentLods.push_back(lod);
+        }
+        else {
+            //the group goes in the top bits so one sort groups the instances by variant then level, still nearest first within each
+            uint32_t group = m_interpolatedInstances[i].materialVariant * VulkanCommonFunctions::MAX_LOD_LEVELS + lod;
+            m_opaqueKeys.push_back((group << kOpaqueGroupKeyShift) | (depthKey >> (32 - kOpaqueGroupKeyShift)));
+            m_opaqueIndices.push_back(static_cast<uint32_t>(i));
+            ranges.opaqueGroupCounts[group]++;
+        }
+    }
 
-		std::shared_ptr<MeshRenderer> meshRenderer = object->GetComponent<MeshRenderer>();
+    ranges.opaqueCount = m_opaqueIndices.size();
+    ranges.transparentCount = m_meshTransparentIndices.size();
+    m_sortedInstances.resize(instanceCount);
 
-        if (meshRenderer == nullptr)
-            continue;
+    m_instanceSorter.Sort(m_opaqueKeys, m_sortOrder);
+    for (size_t i = 0; i < m_sortOrder.size(); i++)
+    {
+        m_sortedInstances[i] = m_interpolatedInstances[m_opaqueIndices[m_sortOrder[i]]];
+    }
 
-        if (!meshRenderer->IsEnabled())
-            continue;
+    if (m_cullClusters && m_clusterCuller->HasMesh(objectName))
+    {
+        ranges.clusterCulled = true;
+        size_t instanceIndex = 0;
 
-        VulkanCommonFunctions::InstanceInfo info = object->GetInstanceInfo(textureFilePaths);
+        for (uint32_t group = 0; group < kOpaqueGroupCount && ranges.clusterCulled; group++)
+        {
+            uint32_t lod = group % VulkanCommonFunctions::MAX_LOD_LEVELS;
 
-        objectInfo.push_back(info);
+            for (size_t i = 0; i < ranges.opaqueGroupCounts[group]; i++, instanceIndex++)
+            {
+                uint32_t firstCommand = m_clusterCuller->AddInstance(objectName, meshLods.levels[lod], m_sortedInstances[instanceIndex], static_cast<uint32_t>(instanceIndex), m_frameCameraPosition);
+
+                //out of room, the whole mesh is drawn without culling this frame
+                if (firstCommand == UINT32_MAX)
+                {
+                    ranges.clusterCulled = false;
+                    break;
+                }
+
+                if (i == 0)
+                {
+                    ranges.opaqueGroupFirstCommands[group] = firstCommand;
+                }
+            }
+        }
     }
 
-    if (objectInfo.size() == 0)
+    m_instanceSorter.Sort(m_meshTransparentKeys, m_sortOrder);
+    for (size_t i = 0; i < m_sortOrder.size(); i++)
     {
-        return; 
+        m_sortedInstances[ranges.opaqueCount + i] = m_interpolatedInstances[m_meshTransparentIndices[m_sortOrder[i]]];
+
+        TransparentDraw transparentInstance;
+        transparentInstance.objectName = &objectName;
+        transparentInstance.firstInstance = static_cast<uint32_t>(ranges.opaqueCount + i);
+        transparentInstance.instanceCount = 1;
+        transparentInstance.lod = m_meshTransparentLods[m_sortOrder[i]];
+        transparentInstance.materialVariant = m_sortedInstances[ranges.opaqueCount + i].materialVariant;
+
+        m_transparentKeys.push_back(m_meshTransparentKeys[m_sortOrder[i]]);
+        m_transparentInstances.push_back(transparentInstance);
     }
 
-    VkDeviceSize bufferSize = objectHandles.size() * sizeof(VulkanCommonFunctions::InstanceInfo);
+    VkDeviceSize bufferSize = instanceCount * sizeof(VulkanCommonFunctions::InstanceInfo);
+
+	instanceBuffers[currentFrame][objectName]->LoadData(m_sortedInstances.data(), (size_t)bufferSize);
+    m_shadowAtlas->AddCasters(m_interpolatedInstances);
 
-	instanceBuffers[currentFrame][objectName]->LoadData(objectInfo.data(), (size_t)bufferSize);
+    return ranges;
 }
 
-void VulkanInterface::SwitchToUIPipeline(VkCommandBuffer commandBuffer)
+float VulkanInterface::GetViewDepth(const VulkanCommonFunctions::InstanceInfo& instance)
 {
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_uiGraphicsPipeline->GetVkPipeline());
-
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_uiGraphicsPipeline->GetVkPipelineLayout(), 0, 1, &uiDescriptorSets[currentFrame], 0, nullptr);
+    //the camera looks down -z in view space
+    glm::vec4 viewPosition = m_frameView * instance.modelMatrix[3];
+    return -viewPosition.z;
 }
 
-void VulkanInterface::DrawUIImageCommandBuffer(VkCommandBuffer commandBuffer, std::shared_ptr<RenderObject> currentObject)
+uint32_t VulkanInterface::SelectLod(const MeshLods& meshLods, const VulkanCommonFunctions::InstanceInfo& instance, float viewDepth, uint32_t previousLod)
 {
-    std::shared_ptr<UIImage> imageComponent = currentObject->GetComponent<UIImage>();
-    VkBuffer objectVertexBuffer[] = { imageComponent->GetVertexBuffer()->GetVkBuffer(), currentObject->GetUIInstanceBuffer(textureFilePaths)->GetVkBuffer() };
-    VkDeviceSize offsets[] = { 0, 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 2, objectVertexBuffer, offsets);
+    uint32_t lastLod = static_cast<uint32_t>(meshLods.levels.size()) - 1;
+    float worldRadius = meshLods.boundingRadius * std::max(instance.scale.x, std::max(instance.scale.y, instance.scale.z));
+
+    //close enough to be inside the bounds, or behind the camera for the shadow pass
+    if (lastLod == 0 || viewDepth <= worldRadius)
+    {
+        return 0;
+    }
+
+    //level errors are fractions of the bounding radius, so this is how many pixels a whole radius covers
+    float projectedRadius = worldRadius * m_lodPixelScale / viewDepth;
+
+    uint32_t lod = std::min(previousLod, lastLod);
+
+    while (lod > 0 && meshLods.levels[lod].error * projectedRadius > kLodPixelError * (1.0f + kLodHysteresis))
+    {
+        lod--;
+    }
+
+    while (lod < lastLod && meshLods.levels[lod + 1].error * projectedRadius < kLodPixelError * (1.0f - kLodHysteresis))
+    {
+        lod++;
+    }
+
+    return lod;
+}
 
-    vkCmdBindIndexBuffer(commandBuffer, imageComponent->GetIndexBuffer()->GetVkBuffer(), 0, VK_INDEX_TYPE_UINT16);
+void VulkanInterface::SwitchToUIPipeline(VkCommandBuffer commandBuffer)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_uiGraphicsPipeline->GetVkPipeline());
 
-    vkCmdDrawIndexed(commandBuffer, imageComponent->GetIndexBufferSize(), 1, 0, 0, 0);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_uiGraphicsPipeline->GetVkPipelineLayout(), 0, 1, &uiDescriptorSets[currentFrame], 1, &m_uiGlobalInfoOffset);
 }
 
 void VulkanInterface::DrawUITextCommandBuffer(VkCommandBuffer commandBuffer, std::shared_ptr<RenderObject> currentObject, std::shared_ptr<FontManager> fontManager)
@@ -914,6 +2399,7 @@ void VulkanInterface::DrawUITextCommandBuffer(VkCommandBuffer commandBuffer, std
     }
 
     size_t textureIndex = texturePathToIndex[atlasFilePath];
+    m_textureResidency->MarkUsed(textureIndex, m_frameNumber);
 
     textComponent->UpdateInstanceBuffer(screenSize, font, textureIndex, createInfo);
 
@@ -926,178 +2412,493 @@ void VulkanInterface::DrawUITextCommandBuffer(VkCommandBuffer commandBuffer, std
     vkCmdDrawIndexed(commandBuffer, textComponent->GetIndexBufferSize(), textComponent->GetTextString().size(), 0, 0, 0);
 }
 
-void VulkanInterface::DrawUIElementCommandBuffer(VkCommandBuffer commandBuffer, std::shared_ptr<RenderObject> currentObject, std::shared_ptr<FontManager> fontManager)
+void VulkanInterface::AddUIElement(std::shared_ptr<RenderObject> currentObject)
 {
     std::shared_ptr<UIImage> imageComponent = currentObject->GetComponent<UIImage>();
 
     if (imageComponent != nullptr)
     {
-        DrawUIImageCommandBuffer(commandBuffer, currentObject);
+        if (texturePathToIndex.contains(imageComponent->GetSampledTexturePath()))
+        {
+            m_textureResidency->MarkUsed(texturePathToIndex[imageComponent->GetSampledTexturePath()], m_frameNumber);
+        }
+
+        if (m_uiDraws.empty() || m_uiDraws.back().textObject != nullptr)
+        {
+            UIDraw newDraw;
+            newDraw.firstInstance = static_cast<uint32_t>(m_uiImageInstances.size());
+            m_uiDraws.push_back(newDraw);
+        }
+
+        m_uiImageInstances.push_back(currentObject->GetUIInstanceInfo(textureFilePaths));
+        m_uiDraws.back().instanceCount++;
     }
 
-    std::shared_ptr<Text> textComponent = currentObject->GetComponent<Text>();
-    
-    if (textComponent != nullptr)
+    if (currentObject->GetComponent<Text>() != nullptr)
     {
-        DrawUITextCommandBuffer(commandBuffer, currentObject, fontManager);
+        UIDraw newDraw;
+        newDraw.textObject = currentObject;
+        m_uiDraws.push_back(newDraw);
     }
 }
 
-void VulkanInterface::DrawFrame(float deltaTime, std::shared_ptr<Scene> scene, std::shared_ptr<FontManager> fontManager) {
-    std::map<std::string, std::set<VulkanCommonFunctions::ObjectHandle>> objectHandles = scene->GetMeshNameToObjectMap();
-    std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> objects = scene->GetObjects();
-    std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> uiObjects = scene->GetUIObjects();
-    
-	auto sizeX = m_vulkanWindow->swapChainImageSize().width();
-	auto sizeY = m_vulkanWindow->swapChainImageSize().height();
+void VulkanInterface::DrawUIElements(VkCommandBuffer commandBuffer, std::shared_ptr<FontManager> fontManager)
+{
+    uint32_t instanceOffset = m_frameRing->Push(m_uiImageInstances.data(), sizeof(VulkanCommonFunctions::UIInstanceInfo) * m_uiImageInstances.size());
 
-    for (auto it = objectHandles.begin(); it != objectHandles.end(); it++)
+    for (size_t i = 0; i < m_uiDraws.size(); i++)
     {
-        if (it->first != MeshRenderer::kCustomMeshName)
+        const UIDraw& draw = m_uiDraws[i];
+
+        if (draw.textObject != nullptr)
         {
-            UpdateInstanceBuffer(it->first, it->second, objects);
+            DrawUITextCommandBuffer(commandBuffer, draw.textObject, fontManager);
+            continue;
         }
+
+        //text binds its own buffers, so the quad is bound again for every run
+        VkBuffer objectVertexBuffer[] = { m_uiQuadVertexBuffer->GetVkBuffer(), m_frameRing->GetBuffer()->GetVkBuffer() };
+        VkDeviceSize offsets[] = { 0, instanceOffset };
+        vkCmdBindVertexBuffers(commandBuffer, 0, 2, objectVertexBuffer, offsets);
+
+        vkCmdBindIndexBuffer(commandBuffer, m_uiQuadIndexBuffer->GetVkBuffer(), 0, VK_INDEX_TYPE_UINT16);
+
+        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(m_uiQuad->GetIndices().size()), draw.instanceCount, 0, 0, draw.firstInstance);
     }
 
-    uint32_t imageIndex = m_vulkanWindow->currentSwapChainImageIndex();
+    m_uiImageInstances.clear();
+    m_uiDraws.clear();
+}
+
+void VulkanInterface::DrawFrame(const RenderSnapshot* previousSnapshot, const RenderSnapshot* currentSnapshot, float interpolation, std::shared_ptr<Scene> scene, std::shared_ptr<FontManager> fontManager) {
+    Scene::ObjectMap uiObjects = scene->GetUIObjects();
 
-    UpdateUniformBuffer(currentFrame, objects);
+    ReleaseRetiredBuffers();
+    ApplyHotReload();
+    UpdateTextureResidency();
 
     VkCommandBuffer commandBuffer = m_vulkanWindow->currentCommandBuffer();
-    VkFramebuffer frameBuffer = m_vulkanWindow->currentFramebuffer();
-    QSize extent = m_vulkanWindow->swapChainImageSize();
 
-    BeginDrawFrameCommandBuffer(commandBuffer);
+    //the simulation thread hasn't published anything yet, just clear the screen
+    if (currentSnapshot == nullptr)
+    {
+        BeginDrawFrameCommandBuffer(commandBuffer);
+        EndDrawFrameCommandBuffer(commandBuffer);
+
+        m_frameNumber++;
+
+        m_vulkanWindow->frameReady();
+        m_vulkanWindow->requestUpdate();
+        return;
+    }
+
+    auto recordStart = std::chrono::steady_clock::now();
+
+    BeginFrameRing(currentSnapshot->customMeshes.size(), uiObjects.size());
+
+    //picks the shadowed lights, which has to happen before casters are gathered from the instances
+    UpdateUniformBuffer(currentFrame, previousSnapshot, currentSnapshot, interpolation);
+
+    //the pre-pass and the main pass read the same commands, so it is decided once for the frame
+    m_cullClusters = m_clusterCuller != nullptr && m_clusterCullingEnabled;
+    if (m_cullClusters)
+    {
+        m_clusterCuller->BeginFrame(currentFrame);
+    }
+
+    std::map<std::string, MeshInstanceRanges> instanceRanges;
+    m_transparentKeys.clear();
+    m_transparentInstances.clear();
 
-    for (auto it = objectHandles.begin(); it != objectHandles.end(); it++)
+    for (auto it = currentSnapshot->meshInstances.begin(); it != currentSnapshot->meshInstances.end(); it++)
     {
-        if (it->first == MeshRenderer::kCustomMeshName)
+        if (it->second.empty())
+        {
+            continue;
+        }
+
+        const std::vector<RenderSnapshot::InstanceSnapshot>* previousInstances = nullptr;
+        if (previousSnapshot != nullptr)
         {
-            for (auto it2 = it->second.begin(); it2 != it->second.end(); it2++)
+            auto previousIt = previousSnapshot->meshInstances.find(it->first);
+            if (previousIt != previousSnapshot->meshInstances.end())
             {
-				VulkanCommonFunctions::ObjectHandle currentHandle = *it2;
-				DrawSingleObjectCommandBuffer(commandBuffer, objects[currentHandle]);
+                previousInstances = &previousIt->second;
             }
         }
-        else {
-            DrawInstancedObjectCommandBuffer(commandBuffer, it->first, it->second.size());
+
+        instanceRanges[it->first] = UpdateInstanceBuffer(it->first, previousInstances, it->second, interpolation);
+    }
+
+    //custom meshes are sorted by handle in both snapshots, walk them together to find the previous transform
+    m_customMeshInstances.clear();
+    size_t previousIndex = 0;
+    for (size_t i = 0; i < currentSnapshot->customMeshes.size(); i++)
+    {
+        const RenderSnapshot::CustomMeshSnapshot& customMesh = currentSnapshot->customMeshes[i];
+        const RenderSnapshot::InstanceSnapshot* previousInstance = nullptr;
+
+        if (previousSnapshot != nullptr)
+        {
+            const std::vector<RenderSnapshot::CustomMeshSnapshot>& previousMeshes = previousSnapshot->customMeshes;
+            while (previousIndex < previousMeshes.size() && previousMeshes[previousIndex].instance.handle < customMesh.instance.handle)
+            {
+                previousIndex++;
+            }
+
+            if (previousIndex < previousMeshes.size() && previousMeshes[previousIndex].instance.handle == customMesh.instance.handle)
+            {
+                previousInstance = &previousMeshes[previousIndex].instance;
+            }
+        }
+
+        m_customMeshInstances.push_back(RenderSnapshot::InterpolateInstance(previousInstance, customMesh.instance, interpolation));
+        m_textureResidency->MarkUsed(m_customMeshInstances.back().textureIndex, m_frameNumber);
+        m_shadowAtlas->AddCaster(m_customMeshInstances.back());
+
+        if (m_customMeshInstances.back().opacity < 1.0f)
+        {
+            TransparentDraw transparentMesh;
+            transparentMesh.customMesh = &customMesh;
+            transparentMesh.firstInstance = static_cast<uint32_t>(i);
+            transparentMesh.instanceCount = 1;
+            transparentMesh.materialVariant = m_customMeshInstances.back().materialVariant;
+
+            m_transparentKeys.push_back(~RadixSorter::FloatToKey(GetViewDepth(m_customMeshInstances.back())));
+            m_transparentInstances.push_back(transparentMesh);
         }
     }
 
-    //update to UI pipeline
-	SwitchToUIPipeline(commandBuffer);
+    //one write for all of them, instead of one per mesh into buffers of their own
+    m_customMeshInstanceOffset = m_frameRing->Push(m_customMeshInstances.data(), sizeof(VulkanCommonFunctions::InstanceInfo) * m_customMeshInstances.size());
+
+    BuildOpaqueDraws(instanceRanges, currentSnapshot);
+    BuildTransparentDraws();
 
-    //draw UI elements
+    //queued before anything is recorded, the UI may be recorded while the workers record the opaque slices
     for (auto it = uiObjects.begin(); it != uiObjects.end(); it++)
     {
-		DrawUIElementCommandBuffer(commandBuffer, it->second, fontManager);
+		AddUIElement(it->second);
     }
 
-    EndDrawFrameCommandBuffer(commandBuffer);
-
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
-    renderedFirstFrame = true;
+    uint32_t opaqueSliceCount = GetOpaqueSliceCount();
 
-    m_vulkanWindow->frameReady();
-    m_vulkanWindow->requestUpdate();
-}
+    //the pools of this frame index were last used MAX_FRAMES_IN_FLIGHT frames ago
+    if (m_commandRecorder != nullptr)
+    {
+        m_commandRecorder->BeginFrame(currentFrame);
+    }
 
-void VulkanInterface::UpdateUniformBuffer(uint32_t currentImage, std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> objects) {
-    VulkanCommonFunctions::GlobalInfo globalInfo;
-    float aspectRatio = (float)m_vulkanWindow->swapChainImageSize().width() / (float)m_vulkanWindow->swapChainImageSize().height();
+    //the deferred path's g-buffer pass is cheap to overdraw, the pre-pass only helps forward lighting
+    bool depthPrepass = m_depthPrepassEnabled && m_renderPath == RenderPath::Forward;
 
-	bool cameraFound = false;
-    for (auto it = objects.begin(); it != objects.end(); it++)
+    if (m_gpuProfiler != nullptr)
     {
-		std::shared_ptr<Camera> camera = it->second->GetComponent<Camera>();
-        if (camera == nullptr)
+        if (depthPrepass != m_profiledDepthPrepass)
         {
-            continue;
+            m_gpuProfiler->Print(std::cout, m_profiledDepthPrepass ? "with depth pre-pass" : "without depth pre-pass");
+            m_gpuProfiler->Clear();
+            m_profiledDepthPrepass = depthPrepass;
         }
 
-        if (!camera->IsMainCamera())
+        m_gpuProfiler->BeginFrame(commandBuffer, currentFrame);
+    }
+
+    BeginGpuScope(commandBuffer, "Frame");
+
+    if (m_cullClusters)
+    {
+        BeginGpuScope(commandBuffer, "Cluster culling");
+        m_clusterCuller->RecordCulling(commandBuffer, m_frameProjection * m_frameView);
+        EndGpuScope(commandBuffer);
+    }
+
+    BeginGpuScope(commandBuffer, "Shadows");
+    m_shadowAtlas->RecordShadowPass(commandBuffer, [&](VkCommandBuffer shadowCommandBuffer) {
+        DrawSceneGeometry(shadowCommandBuffer);
+    });
+    EndGpuScope(commandBuffer);
+
+    bool accumulateTransparency = m_orderIndependentTransparency != nullptr && !m_transparentDraws.empty();
+
+    if (accumulateTransparency)
+    {
+        BeginGpuScope(commandBuffer, "Transparency accumulation");
+        m_orderIndependentTransparency->BeginAccumulationPass(commandBuffer);
+        DrawOpaqueGeometry(commandBuffer, ScenePass::DepthOnly);
+        DrawTransparentGeometry(commandBuffer, ScenePass::Accumulate);
+        m_orderIndependentTransparency->EndAccumulationPass(commandBuffer);
+        EndGpuScope(commandBuffer);
+    }
+
+    if (m_renderPath == RenderPath::Deferred)
+    {
+        BeginGpuScope(commandBuffer, "G-buffer");
+        if (opaqueSliceCount > 1)
         {
-            continue;
+            RecordGBufferPassInParallel(commandBuffer, opaqueSliceCount);
+        }
+        else {
+            m_deferredRenderer->BeginGBufferPass(commandBuffer);
+            DrawOpaqueGeometry(commandBuffer, ScenePass::GBuffer);
+            m_deferredRenderer->EndGBufferPass(commandBuffer);
         }
+        EndGpuScope(commandBuffer);
 
-		globalInfo.view = camera->GetViewMatrix();
-		globalInfo.proj = glm::perspective(glm::radians(camera->GetFOV()), aspectRatio, camera->GetNearPlane(), camera->GetFarPlane());
-        globalInfo.proj[1][1] *= -1;
-		globalInfo.cameraPosition = glm::vec4(it->second->GetComponent<Transform>()->GetPosition(), 1.0f);
-		cameraFound = true;
-        break;
+        BeginGpuScope(commandBuffer, "Deferred lighting");
+        m_deferredRenderer->RecordLightingPass(commandBuffer, currentFrame, m_globalInfoOffset, m_lightInfoOffset, m_shadowInfoOffset, m_frameView, m_frameProjection);
+        EndGpuScope(commandBuffer);
+
+        //the composite fills in the opaque scene's depth, transparent objects are then blended over it
+        BeginDrawFrameCommandBuffer(commandBuffer);
+        BeginGpuScope(commandBuffer, "Opaque");
+        m_deferredRenderer->DrawComposite(commandBuffer, currentFrame, m_globalInfoOffset, m_lightInfoOffset, m_shadowInfoOffset);
+        EndGpuScope(commandBuffer);
+    }
+    else if (opaqueSliceCount > 1)
+    {
+        //timestamps can't be written between the secondaries, so the whole pass is one scope
+        BeginGpuScope(commandBuffer, "Main pass");
+        RecordMainPassInParallel(commandBuffer, opaqueSliceCount, depthPrepass, accumulateTransparency, fontManager);
+        EndDrawFrameCommandBuffer(commandBuffer);
+        EndGpuScope(commandBuffer);
+    }
+    else if (depthPrepass)
+    {
+        BeginDrawFrameCommandBuffer(commandBuffer);
+
+        BeginGpuScope(commandBuffer, "Depth pre-pass");
+        DrawDepthPrepass(commandBuffer, 0, m_opaqueDraws.size());
+        EndGpuScope(commandBuffer);
+
+        BeginGpuScope(commandBuffer, "Opaque");
+        DrawOpaqueGeometry(commandBuffer, ScenePass::DepthEqual);
+        EndGpuScope(commandBuffer);
+    }
+    else {
+        BeginDrawFrameCommandBuffer(commandBuffer);
+
+        BeginGpuScope(commandBuffer, "Opaque");
+        DrawOpaqueGeometry(commandBuffer, ScenePass::Main);
+        EndGpuScope(commandBuffer);
+    }
+
+    //the parallel main pass recorded these on the render thread while the opaque slices were recorded
+    if (m_renderPath == RenderPath::Deferred || opaqueSliceCount <= 1)
+    {
+        BeginGpuScope(commandBuffer, "Transparent");
+        DrawTransparentPass(commandBuffer, accumulateTransparency);
+        EndGpuScope(commandBuffer);
+
+        DrawUIPass(commandBuffer, fontManager);
+
+        EndDrawFrameCommandBuffer(commandBuffer);
     }
 
-    if (!cameraFound)
+    EndGpuScope(commandBuffer);
+
+    m_recordNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - recordStart).count();
+    m_recordedFrameCount++;
+
+    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    m_frameNumber++;
+    renderedFirstFrame = true;
+
+    m_vulkanWindow->frameReady();
+    m_vulkanWindow->requestUpdate();
+}
+
+void VulkanInterface::UpdateUniformBuffer(uint32_t currentImage, const RenderSnapshot* previousSnapshot, const RenderSnapshot* currentSnapshot, float interpolation) {
+    VulkanCommonFunctions::GlobalInfo globalInfo;
+    float aspectRatio = (float)m_vulkanWindow->swapChainImageSize().width() / (float)m_vulkanWindow->swapChainImageSize().height();
+
+    const RenderSnapshot* interpolateFrom = (previousSnapshot != nullptr) ? previousSnapshot : currentSnapshot;
+    RenderSnapshot::CameraSnapshot camera = RenderSnapshot::InterpolateCamera(interpolateFrom->camera, currentSnapshot->camera, interpolation);
+
+    if (!camera.valid)
     {
 		throw std::runtime_error("No camera found in the scene. Please add a camera to render the scene.");
     }
 
-    std::vector<VulkanCommonFunctions::LightInfo> lightInfos;
+	globalInfo.view = Camera::BuildViewMatrix(camera.position, camera.rotation);
+	globalInfo.proj = glm::perspective(glm::radians(camera.fov), aspectRatio, camera.nearPlane, camera.farPlane);
+    globalInfo.proj[1][1] *= -1;
+	globalInfo.cameraPosition = glm::vec4(camera.position, 1.0f);
 
-    for (auto it = objects.begin(); it != objects.end(); it++)
+    m_frameView = globalInfo.view;
+    m_frameProjection = globalInfo.proj;
+    m_frameCameraPosition = camera.position;
+    m_lodPixelScale = std::abs(globalInfo.proj[1][1]) * m_vulkanWindow->swapChainImageSize().height() * 0.5f;
+
+    RenderSnapshot::InterpolateLights(&interpolateFrom->lights, currentSnapshot->lights, interpolation, m_interpolatedLights);
+
+    //only lights whose range reaches into the view are uploaded, the brightest and closest first when there are too many
+    m_lightManager.BeginFrame();
+    for (size_t i = 0; i < m_interpolatedLights.size(); i++)
     {
-		std::shared_ptr<LightSource> light = it->second->GetComponent<LightSource>();
+        const VulkanCommonFunctions::LightInfo& light = m_interpolatedLights[i];
+        float intensity = std::max({ light.lightColor.x, light.lightColor.y, light.lightColor.z });
 
-        if (light == nullptr)
-        {
-            continue;
-        }
+        m_lightManager.SetLight(currentSnapshot->lights[i].handle, i, glm::vec3(light.lightPosition), light.maxLightDistance, intensity);
+    }
+    m_lightManager.EndFrame();
 
-        if (lightInfos.size() >= maxLightCount)
-        {
-			std::cout << "Warning: Maximum light count exceeded, additional lights will be ignored in rendering." << std::endl;
-            break;
-        }
+    LightManager::ViewInfo lightView;
+    lightView.position = camera.position;
+    lightView.forward = Transform::ForwardFromRotation(camera.rotation);
+    lightView.up = glm::vec3(globalInfo.view[0][1], globalInfo.view[1][1], globalInfo.view[2][1]);
+    lightView.fov = camera.fov;
+    lightView.aspectRatio = aspectRatio;
+    lightView.nearPlane = camera.nearPlane;
+    lightView.farPlane = camera.farPlane;
 
-        if (!light->IsEnabled())
-        {
-            continue;
-        }
+    size_t visibleLightCount = m_lightManager.SelectLights(lightView, maxLightCount, m_selectedLights);
+
+    if (visibleLightCount > maxLightCount && !m_lightCapWarningShown)
+    {
+		std::cout << "Warning: Maximum light count exceeded, the " << visibleLightCount - maxLightCount << " dimmest visible lights will be ignored in rendering." << std::endl;
+    }
+    m_lightCapWarningShown = visibleLightCount > maxLightCount;
 
-        VulkanCommonFunctions::LightInfo lightInfo = light->GetLightInfo();
-		lightInfos.push_back(lightInfo);
+    m_visibleLights.clear();
+    m_visibleLightSnapshots.clear();
+    for (size_t i = 0; i < m_selectedLights.size(); i++)
+    {
+        m_visibleLights.push_back(m_interpolatedLights[m_selectedLights[i].lightIndex]);
+        m_visibleLightSnapshots.push_back(currentSnapshot->lights[m_selectedLights[i].lightIndex]);
     }
 
-    globalInfo.lightCount = lightInfos.size();
+    globalInfo.lightCount = m_visibleLights.size();
+
+    ShadowLightSelector::ViewInfo shadowView;
+    shadowView.position = camera.position;
+    shadowView.forward = lightView.forward;
+    shadowView.fov = camera.fov;
+    shadowView.aspectRatio = aspectRatio;
+
+    m_shadowAtlas->SelectLights(shadowView, m_visibleLightSnapshots, m_visibleLights);
 
 	VulkanCommonFunctions::UIGlobalInfo uiGlobalInfo{};
 	uiGlobalInfo.screenWidth = m_vulkanWindow->swapChainImageSize().width();
 	uiGlobalInfo.screenHeight = m_vulkanWindow->swapChainImageSize().height();
 
-	lightInfoBuffers[currentImage]->LoadData(lightInfos.data(), lightInfos.size() * sizeof(VulkanCommonFunctions::LightInfo));
-	uniformBuffers[currentImage]->LoadData(&globalInfo, sizeof(globalInfo));
-	uiUniformBuffers[currentImage]->LoadData(&uiGlobalInfo, sizeof(uiGlobalInfo));
+    //the lights get the whole range their descriptor covers, only the visible ones are written
+    m_lightInfoOffset = m_frameRing->Allocate(sizeof(VulkanCommonFunctions::LightInfo) * maxLightCount);
+    m_frameRing->Write(m_lightInfoOffset, m_visibleLights.data(), m_visibleLights.size() * sizeof(VulkanCommonFunctions::LightInfo));
+
+    const std::vector<VulkanCommonFunctions::ShadowInfo>& shadowInfos = m_shadowAtlas->GetShadowInfos();
+    m_shadowInfoOffset = m_frameRing->Allocate(m_shadowAtlas->GetShadowInfoBufferSize());
+    m_frameRing->Write(m_shadowInfoOffset, shadowInfos.data(), shadowInfos.size() * sizeof(VulkanCommonFunctions::ShadowInfo));
+
+    m_globalInfoOffset = m_frameRing->Push(&globalInfo, sizeof(globalInfo));
+    m_uiGlobalInfoOffset = m_frameRing->Push(&uiGlobalInfo, sizeof(uiGlobalInfo));
 }
 
 void VulkanInterface::CleanupSwapChain() {
     vkDeviceWaitIdle(device);
 	depthImage->DestroyImage();
+
+    if (m_deferredRenderer != nullptr)
+    {
+        m_deferredRenderer->DestroySizeDependentResources();
+    }
+
+    if (m_orderIndependentTransparency != nullptr)
+    {
+        m_orderIndependentTransparency->DestroySizeDependentResources();
+    }
 }
 
 void VulkanInterface::Cleanup() {
     vkDeviceWaitIdle(device);
 
-	m_mainGraphicsPipeline->DestroyPipeline();
-    m_uiGraphicsPipeline->DestroyPipeline();
+    //stopped first, so nothing is handed to the pipeline cache while it is destroyed
+    if (m_hotReloader != nullptr)
+    {
+        m_hotReloader->Destroy();
+    }
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		uniformBuffers[i]->DestroyBuffer();
-		lightInfoBuffers[i]->DestroyBuffer();
-        uiUniformBuffers[i]->DestroyBuffer();
+    //the loads only read files, so they are waited on and their textures dropped
+    m_textureLoads.clear();
+
+    for (size_t i = 0; i < m_retiredPipelines.size(); i++)
+    {
+        m_retiredPipelines[i].pipeline->DestroyPipeline();
+    }
+    m_retiredPipelines.clear();
+
+    m_pipelineCache->Destroy();
+
+    if (m_gpuProfiler != nullptr)
+    {
+        m_gpuProfiler->Print(std::cout, m_profiledDepthPrepass ? "with depth pre-pass" : "without depth pre-pass");
+        m_gpuProfiler->Destroy();
+    }
+
+    if (m_clusterCuller != nullptr)
+    {
+        m_clusterCuller->Destroy();
+    }
+
+    if (m_commandRecorder != nullptr)
+    {
+        m_commandRecorder->Destroy();
+    }
+
+    if (m_deferredRenderer != nullptr)
+    {
+        m_deferredRenderer->Destroy();
+    }
+
+    if (m_orderIndependentTransparency != nullptr)
+    {
+        m_orderIndependentTransparency->Destroy();
     }
 
+    m_shadowAtlas->Destroy();
+
+    m_frameRing->Destroy();
+
+    m_uiQuadVertexBuffer->DestroyBuffer();
+    m_uiQuadIndexBuffer->DestroyBuffer();
+
     for (auto it = textureFilePaths.begin(); it != textureFilePaths.end(); it++)
     {
-		textureImages[*it]->DestroyTextureImage();
+        if (textureImages[*it] != nullptr)
+        {
+		    textureImages[*it]->DestroyTextureImage();
+        }
+    }
+
+    for (size_t i = 0; i < m_retiredTextures.size(); i++)
+    {
+        m_retiredTextures[i].texture->DestroyTextureImage();
     }
+    m_retiredTextures.clear();
+
+    m_textureSamplerIdBuffer->DestroyBuffer();
 
     vkDestroyDescriptorPool(device, m_primaryDescriptorPool, nullptr);
 	vkDestroyDescriptorPool(device, m_uiDescriptorPool, nullptr);
 
+    for (size_t i = 0; i < m_retiredDescriptorPools.size(); i++)
+    {
+        vkDestroyDescriptorPool(device, m_retiredDescriptorPools[i].descriptorPool, nullptr);
+    }
+    m_retiredDescriptorPools.clear();
+
     vkDestroyDescriptorSetLayout(device, m_primaryDescriptorSetLayout, nullptr);
     vkDestroyDescriptorSetLayout(device, m_uiDescriptorSetLayout, nullptr);
 
+    for (size_t i = 0; i < m_retiredDescriptorSetLayouts.size(); i++)
+    {
+        vkDestroyDescriptorSetLayout(device, m_retiredDescriptorSetLayouts[i].descriptorSetLayout, nullptr);
+    }
+    m_retiredDescriptorSetLayouts.clear();
+
+    //after the layouts, the samplers are immutable samplers of both
+    m_samplerCache->Destroy();
+
     for (auto it = indexBuffers.begin(); it != indexBuffers.end(); it++)
     {
 		it->second->DestroyBuffer();
@@ -1108,6 +2909,11 @@ void VulkanInterface::Cleanup() {
 		it->second->DestroyBuffer();
     }
 
+    for (auto it = positionBuffers.begin(); it != positionBuffers.end(); it++)
+    {
+        it->second->DestroyBuffer();
+    }
+
     for (uint32_t frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
     {
         for (auto it = instanceBuffers[frameIndex].begin(); it != instanceBuffers[frameIndex].end(); it++)
@@ -1116,5 +2922,11 @@ void VulkanInterface::Cleanup() {
         }
     }
 
+    for (size_t i = 0; i < m_retiredBuffers.size(); i++)
+    {
+        m_retiredBuffers[i].buffer->DestroyBuffer();
+    }
+    m_retiredBuffers.clear();
+
     vmaDestroyAllocator(allocator);
 }
\ No newline at end of file
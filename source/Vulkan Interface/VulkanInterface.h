@@ -8,9 +8,24 @@
 #include "source/Vulkan Interface/TextureImage.h"
 #include "source/Components/LightSource.h"
 #include "source/Vulkan Interface/GraphicsPipeline.h"
+#include "source/Vulkan Interface/PipelineCache.h"
+#include "source/Vulkan Interface/ShadowAtlas.h"
+#include "source/Vulkan Interface/DeferredRenderer.h"
+#include "source/Vulkan Interface/OrderIndependentTransparency.h"
+#include "source/Vulkan Interface/GpuProfiler.h"
+#include "source/Vulkan Interface/ClusterCuller.h"
+#include "source/Vulkan Interface/TextureResidency.h"
+#include "source/Vulkan Interface/SamplerCache.h"
+#include "source/Vulkan Interface/FrameRingBuffer.h"
+#include "source/Vulkan Interface/ParallelCommandRecorder.h"
+#include "source/Lighting/LightManager.h"
 #include "source/Components/UIImage.h"
 #include "source/Components/Text.h"
 #include "source/Text Rendering/FontManager.h"
+#include "source/Management/RenderSnapshot.h"
+#include "source/Management/RadixSort.h"
+#include "source/Management/Ktx2File.h"
+#include "source/Management/HotReloader.h"
 
 #include <map>
 #include <vector>
@@ -19,6 +34,11 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <future>
+#include <thread>
 
 class VulkanWindow;
 class WindowManager;
@@ -27,23 +47,87 @@ class VulkanInterface {
 public:
     VulkanInterface(WindowManager* windowManager);
 
-    void DrawFrame(float deltaTime, std::shared_ptr<Scene> scene, std::shared_ptr<FontManager> fontManager);
+    //deferred lights opaque objects in a tiled compute pass, transparent objects are still drawn forward on top
+    enum class RenderPath {
+        Forward,
+        Deferred
+    };
+
+    //has to be chosen before the window initializes Vulkan, falls back to forward when the device can't do deferred
+    void SetRenderPath(RenderPath renderPath) { m_renderPath = renderPath; }
+    RenderPath GetRenderPath() { return m_renderPath; }
+
+    //sorted draws transparent objects back to front, weighted blended sums them in any order and needs no sort
+    enum class TransparencyMode {
+        Sorted,
+        WeightedBlended
+    };
+
+    //like the render path this is read when Vulkan is initialized
+    void SetTransparencyMode(TransparencyMode transparencyMode) { m_transparencyMode = transparencyMode; }
+    TransparencyMode GetTransparencyMode() { return m_transparencyMode; }
+
+    //lays down the opaque depth from position only streams first, so forward lighting runs once per visible pixel
+    //can be switched from any thread while running, GPU pass times are printed for each setting when it changes
+    void SetDepthPrepassEnabled(bool enabled) { m_depthPrepassEnabled = enabled; }
+    bool IsDepthPrepassEnabled() { return m_depthPrepassEnabled; }
+
+    //meshes split into meshlets have their clusters culled on the GPU in the camera's passes, when the device can draw indirectly
+    //off, or on devices that can't, they are drawn whole like every other mesh
+    void SetClusterCullingEnabled(bool enabled) { m_clusterCullingEnabled = enabled; }
+    bool IsClusterCullingEnabled() { return m_clusterCullingEnabled; }
+
+    //drops this many of the largest mip levels of textures loaded afterwards to save memory, the smallest level is always kept
+    void SetTextureMipSkip(uint32_t levels) { m_textureMipSkip = levels; }
+    uint32_t GetTextureMipSkip() { return m_textureMipSkip; }
+
+    //0 keeps textures within the device local budget VMA reports, otherwise textures alone are kept within this many bytes
+    //read when Vulkan is initialized like the render path
+    void SetTextureMemoryBudget(VkDeviceSize budget) { m_textureMemoryBudget = budget; }
+
+    //threads that record the opaque geometry of the main pass, or of the g-buffer pass, into secondary command buffers
+    //1 records everything on the render thread, frames with few draws are always recorded there, read when Vulkan is initialized
+    void SetRecordingThreadCount(uint32_t threadCount) { m_recordingThreadCount = threadCount; }
+    uint32_t GetRecordingThreadCount() { return m_recordingThreadCount; }
+
+    //recompiles shaders when their sources change and rebuilds the pipelines made from them, and reloads textures whose files change
+    //only pipelines in the pipeline cache are rebuilt, read when Vulkan is initialized
+    void SetHotReloadEnabled(bool enabled) { m_hotReloadEnabled = enabled; }
+
+    //draws the world from the snapshots, interpolation 0 is the previous snapshot and 1 the current one
+    void DrawFrame(const RenderSnapshot* previousSnapshot, const RenderSnapshot* currentSnapshot, float interpolation, std::shared_ptr<Scene> scene, std::shared_ptr<FontManager> fontManager);
 
     bool HasRenderedFirstFrame() { return renderedFirstFrame; };
 
+    //cpu time spent filling and recording frames and how many were recorded, totals since startup so callers take differences
+    //can be read from any thread
+    uint64_t GetRecordedFrameCount() { return m_recordedFrameCount; }
+    uint64_t GetRecordNanoseconds() { return m_recordNanoseconds; }
+
+    //live VMA allocations across every heap, can be read from any thread
+    uint32_t GetAllocationCount();
+
     void Cleanup();
 
     std::shared_ptr<GraphicsBuffer> CreateVertexBuffer(std::shared_ptr<MeshRenderer> object);
     std::shared_ptr<GraphicsBuffer> CreateIndexBuffer(std::shared_ptr<MeshRenderer>  object);
+    std::shared_ptr<GraphicsBuffer> CreatePositionBuffer(std::shared_ptr<MeshRenderer> object);
 
     std::shared_ptr<GraphicsBuffer> CreateUIVertexBuffer(std::shared_ptr<UIMeshRenderer> imageObject);
     std::shared_ptr<GraphicsBuffer> CreateUIIndexBuffer(std::shared_ptr<UIMeshRenderer> imageObject);
 
     void CreateInstanceBuffer(std::shared_ptr<MeshRenderer> object);
 	std::shared_ptr<GraphicsBuffer> CreateInstanceBuffer(size_t maxObjects);
+    //frees the buffer once every frame in flight that could have used it has finished, render thread only
+    void DeferDestruction(std::shared_ptr<GraphicsBuffer> buffer);
     void UpdateObjectBuffers(std::shared_ptr<MeshRenderer> objectMesh);
-    bool HasTexture(std::string textureFilePath) { return std::find(textureFilePaths.begin(), textureFilePaths.end(), textureFilePath) != textureFilePaths.end(); };
-    void UpdateTextureResources(std::string newTextureFilePath, bool alreadyInitialized=true);
+    bool HasTexture(std::string textureFilePath) { std::lock_guard<std::mutex> lock(m_textureFilePathMutex); return std::find(textureFilePaths.begin(), textureFilePaths.end(), textureFilePath) != textureFilePaths.end(); };
+    //copy for other threads, the render thread is the only one that adds textures
+    std::vector<std::string> GetTextureFilePaths() { std::lock_guard<std::mutex> lock(m_textureFilePathMutex); return textureFilePaths; }
+    //distance field atlases hold linear data and must be loaded with a UNORM format
+    //textures with the same sampler state share one sampler
+    //atlases pass mipmapped false, smaller levels would blend neighbouring regions into each other
+    void UpdateTextureResources(std::string newTextureFilePath, bool alreadyInitialized=true, VkFormat textureFormat=VK_FORMAT_R8G8B8A8_SRGB, SamplerCache::SamplerState samplerState=SamplerCache::SamplerState(), bool mipmapped=true);
     void CreateDepthResources();
 
     void InitializeVulkan();
@@ -51,6 +135,67 @@ public:
     void CleanupSwapChain();
 
 private:
+    //the passes that draw scene geometry, each has one pipeline per material variant made from the pass's shared state
+    //Shadow draws with the atlas's own pipeline, which the caller binds, and skips the variants that cast no shadow
+    enum class ScenePass {
+        Shadow,
+        Main,
+        DepthEqual,
+        GBuffer,
+        Transparent,
+        Accumulate,
+        DepthOnly,
+        DepthPrepass,
+        CustomMeshDepthPrepass,
+        Count
+    };
+
+    //an opaque group is one level of detail of one material variant, indexed by variant * MAX_LOD_LEVELS + lod
+    static constexpr uint32_t kOpaqueGroupCount = VulkanCommonFunctions::MATERIAL_VARIANT_COUNT * VulkanCommonFunctions::MAX_LOD_LEVELS;
+    //the opaque sort keys keep the group above this bit and as much of the depth as fits below it
+    static constexpr uint32_t kOpaqueGroupKeyShift = 26;
+
+    //a mesh's instance buffer holds its opaque instances nearest first, then its transparent ones farthest first
+    //the opaque ones are grouped by material variant and then by level of detail, one draw per group
+    struct MeshInstanceRanges {
+        size_t opaqueCount = 0;
+        size_t transparentCount = 0;
+        std::array<size_t, kOpaqueGroupCount> opaqueGroupCounts{};
+
+        //each group's instances have one indirect draw per meshlet written by the culling pass, in instance order
+        bool clusterCulled = false;
+        std::array<uint32_t, kOpaqueGroupCount> opaqueGroupFirstCommands{};
+    };
+
+    //one opaque group of a mesh's instances, or one opaque custom mesh, in the order the camera's passes draw them
+    struct OpaqueDraw {
+        const std::string* objectName = nullptr;
+        const RenderSnapshot::CustomMeshSnapshot* customMesh = nullptr;
+        uint32_t firstInstance = 0;
+        uint32_t instanceCount = 0;
+        uint32_t lod = 0;
+        uint32_t materialVariant = 0;
+
+        bool clusterCulled = false;
+        uint32_t firstCommand = 0;
+    };
+
+    //consecutive transparent instances of one mesh, custom meshes are always drawn on their own
+    struct TransparentDraw {
+        const std::string* objectName = nullptr;
+        const RenderSnapshot::CustomMeshSnapshot* customMesh = nullptr;
+        uint32_t firstInstance = 0;
+        uint32_t instanceCount = 0;
+        uint32_t lod = 0;
+        uint32_t materialVariant = 0;
+    };
+
+    //a mesh without levels of detail gets a single level covering its whole index buffer
+    struct MeshLods {
+        std::vector<VulkanCommonFunctions::LodLevel> levels;
+        float boundingRadius = 0.0f;
+    };
+
     void CreateVMAAllocator();
 
 	void CreateDescriptorSetLayouts();
@@ -65,29 +210,119 @@ private:
 	void CreatePrimaryDescriptorSets();
 	void CreateUIDescriptorSets();
 
+    void CreatePipelineCache();
+    //the fixed pipelines are created straight away, every variant of the scene passes is queued for the background thread
     void CreateGraphicsPipelines();
     void CreatePrimaryGraphicsPipeline();
 	void CreateUIGraphicsPipeline();
-
-    void CreateTextureImage(std::string textureFilePath);
+	void CreateDeferredGraphicsPipelines();
+    void CreateTransparencyGraphicsPipelines();
+    void CreateDepthPrepassGraphicsPipelines();
+
+    void CreateTextureImage(std::string textureFilePath, VkFormat textureFormat, bool mipmapped);
+
+    //reads and decodes a texture without touching the device, so textures can be paged back in on another thread
+    Ktx2File::Texture LoadTextureData(const std::string& textureFilePath, VkFormat textureFormat, bool mipmapped, uint32_t skippedLevels);
+    //the preferred KTX2 file next to the texture's image that the device can sample, false when there is none
+    //the texture comes back in textureFormat's color space, linear data like distance fields must not be read as srgb
+    bool LoadCompressedTextureData(const std::string& textureFilePath, VkFormat textureFormat, Ktx2File::Texture& texture);
+    //the KTX2 files a texture can ship next to its image, in the order the loader prefers them, with the formats they're sampled as
+    static const std::vector<std::pair<std::string, VkFormat>>& GetCompressedVariants(VkFormat textureFormat);
+    std::shared_ptr<TextureImage> UploadTextureImage(const Ktx2File::Texture& texture);
     void CreateTextureImageView(std::string textureFilePath);
-    void CreateTextureSampler(std::string textureFilePath);
-    void CreateUniformBuffers();
+    void CreateFrameRingBuffer();
+    void CreateShadowAtlas();
+    void CreateDeferredRenderer();
+    void CreateOrderIndependentTransparency();
+    void CreateGpuProfiler();
+    void CreateClusterCuller();
+    void CreateParallelCommandRecorder();
+    void CreateTextureResidency();
+    void CreateHotReloader();
+    void CreateSamplerCache();
+    void CreateUIQuadBuffers();
+    void CreateTextureSamplerIdBuffer();
 
     VkFormat FindDepthFormat();
     VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
-    void BeginDrawFrameCommandBuffer(VkCommandBuffer commandBuffer);
-    void DrawInstancedObjectCommandBuffer(VkCommandBuffer commandBuffer, std::string objectName, size_t objectCount);
-    void DrawSingleObjectCommandBuffer(VkCommandBuffer commandBuffer, std::shared_ptr<RenderObject> currentObject);
+    bool IsFormatSupported(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features);
+    //with secondary contents the viewport isn't set, every secondary executed in the pass sets its own
+    void BeginDrawFrameCommandBuffer(VkCommandBuffer commandBuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+    void SetMainPassViewport(VkCommandBuffer commandBuffer);
+    //binds a pipeline that uses the primary descriptor set, the main, g-buffer and transparent pipelines all do
+    void BindScenePipeline(VkCommandBuffer commandBuffer, std::shared_ptr<GraphicsPipeline> pipeline);
+    //the pass's pipeline specialized for the variant, created on the calling thread if the background thread hasn't got to it yet
+    std::shared_ptr<GraphicsPipeline> GetScenePipeline(ScenePass pass, uint32_t materialVariant);
+    //the variant bits the pass's shaders read, depth only passes only care about billboarding, variants differing elsewhere share a pipeline
+    static uint32_t GetScenePassVariantMask(ScenePass pass);
+    void BindInstancedObjectBuffers(VkCommandBuffer commandBuffer, const std::string& objectName, bool positionsOnly);
+    void DrawInstancedObjectCommandBuffer(VkCommandBuffer commandBuffer, std::string objectName, size_t objectCount, size_t firstInstance = 0, uint32_t lod = 0, bool positionsOnly = false);
+    void DrawClusteredObjectCommandBuffer(VkCommandBuffer commandBuffer, const std::string& objectName, size_t objectCount, uint32_t firstCommand, uint32_t lod, bool positionsOnly = false);
+    void DrawSingleObjectCommandBuffer(VkCommandBuffer commandBuffer, const RenderSnapshot::CustomMeshSnapshot& customMesh, uint32_t instanceIndex);
+    //every world mesh that casts shadows, with the pipeline the caller bound
+    void DrawSceneGeometry(VkCommandBuffer commandBuffer);
+    //the culled clusters are only valid for the camera, passes from other views draw every instance whole
+    void DrawOpaqueGeometry(VkCommandBuffer commandBuffer, ScenePass pass, bool cameraView = true);
+    //draws [first, last) of the frame's opaque draws, so the camera's passes can be split between threads
+    //binds the pass's pipeline for each variant as it is reached, the draws are grouped by variant so that is only a few times
+    //only reads the renderer's state, several threads can call it at once while nothing else changes it
+    void DrawOpaqueDraws(VkCommandBuffer commandBuffer, size_t first, size_t last, bool cameraView, bool positionsOnly, ScenePass pass);
+    void BuildOpaqueDraws(const std::map<std::string, MeshInstanceRanges>& instanceRanges, const RenderSnapshot* currentSnapshot);
+    //binds its own pipelines, the opaque objects have to be drawn again with the depth equal pipeline afterwards
+    void DrawDepthPrepass(VkCommandBuffer commandBuffer, size_t first, size_t last);
+    //how many secondaries the frame's opaque draws are split into, 1 when they are recorded inline
+    uint32_t GetOpaqueSliceCount();
+    void GetOpaqueSliceRange(uint32_t slice, uint32_t sliceCount, size_t& first, size_t& last);
+    //the opaque slices are recorded by the workers while the render thread records the transparent objects and UI
+    void RecordMainPassInParallel(VkCommandBuffer commandBuffer, uint32_t sliceCount, bool depthPrepass, bool accumulateTransparency, std::shared_ptr<FontManager> fontManager);
+    void RecordGBufferPassInParallel(VkCommandBuffer commandBuffer, uint32_t sliceCount);
+    void BeginGpuScope(VkCommandBuffer commandBuffer, const char* name);
+    void EndGpuScope(VkCommandBuffer commandBuffer);
+    //in the order BuildTransparentDraws left them, back to front across every mesh, so the variant can change from draw to draw
+    void DrawTransparentGeometry(VkCommandBuffer commandBuffer, ScenePass pass);
+    //the transparent objects of the main pass, either composited from the accumulation pass or drawn sorted
+    void DrawTransparentPass(VkCommandBuffer commandBuffer, bool accumulateTransparency);
+    void DrawUIPass(VkCommandBuffer commandBuffer, std::shared_ptr<FontManager> fontManager);
+    void BuildTransparentDraws();
     void SwitchToUIPipeline(VkCommandBuffer commandBuffer);
-	void DrawUIElementCommandBuffer(VkCommandBuffer commandBuffer, std::shared_ptr<RenderObject> currentObject, std::shared_ptr<FontManager> fontManager);
+    //queues an object's image and text in draw order, consecutive images are merged into one run
+    void AddUIElement(std::shared_ptr<RenderObject> currentObject);
+    //uploads the queued image instances once, then draws every image run as one instanced draw of the shared quad
+    void DrawUIElements(VkCommandBuffer commandBuffer, std::shared_ptr<FontManager> fontManager);
     void EndDrawFrameCommandBuffer(VkCommandBuffer commandBuffer);
     void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
     static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData);
     bool CheckValidationLayerSupport();
-    void UpdateInstanceBuffer(std::string objectName, std::set<VulkanCommonFunctions::ObjectHandle> objectHandles, std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> objects);
-    void UpdateUniformBuffer(uint32_t currentImage, std::map<VulkanCommonFunctions::ObjectHandle, std::shared_ptr<RenderObject>> objects);
-    void DrawUIImageCommandBuffer(VkCommandBuffer commandBuffer, std::shared_ptr<RenderObject> currentObject);
+    MeshInstanceRanges UpdateInstanceBuffer(const std::string& objectName, const std::vector<RenderSnapshot::InstanceSnapshot>* previousInstances, const std::vector<RenderSnapshot::InstanceSnapshot>& currentInstances, float interpolation);
+    float GetViewDepth(const VulkanCommonFunctions::InstanceInfo& instance);
+    uint32_t SelectLod(const MeshLods& meshLods, const VulkanCommonFunctions::InstanceInfo& instance, float viewDepth, uint32_t previousLod);
+    void ReleaseRetiredBuffers();
+    void DeferDestruction(std::shared_ptr<TextureImage> texture);
+    void DeferDestruction(std::shared_ptr<GraphicsPipeline> pipeline);
+    //separate names, the handles are all the same integer type on 32 bit builds
+    void DeferDescriptorPoolDestruction(VkDescriptorPool descriptorPool);
+    void DeferDescriptorSetLayoutDestruction(VkDescriptorSetLayout descriptorSetLayout);
+
+    //swaps in the pipelines rebuilt since the last frame, then rebuilds the ones made from shaders that were just recompiled
+    //changed textures are loaded again in the background like restored ones, the swap happens in UpdateTextureResidency
+    void ApplyHotReload();
+    //the texture's image and every KTX2 file it could be loaded from instead
+    void WatchTexture(const std::string& textureFilePath);
+
+    //uploads textures that finished loading, then evicts, reduces or requests textures to stay within the budget
+    //runs at the start of a frame, when the frame's descriptor sets are no longer in use
+    void UpdateTextureResidency();
+    void RequestTextureLoad(size_t textureIndex, uint32_t skippedLevels);
+    void EvictTexture(size_t textureIndex);
+    //absent textures are pointed at the fallback, the first texture
+    std::vector<VkDescriptorImageInfo> GetTextureImageInfos();
+    void UpdateTextureDescriptors(uint32_t frameIndex);
+
+    //reserves the frame's transient data in the ring, growing it if needed, and points the frame's sets at the ring's buffer if it changed
+    void BeginFrameRing(size_t customMeshCount, size_t uiObjectCount);
+    void WriteFrameRingDescriptors(uint32_t frameIndex);
+    void UpdateFrameRingDescriptors(uint32_t frameIndex);
+    void UpdateUniformBuffer(uint32_t currentImage, const RenderSnapshot* previousSnapshot, const RenderSnapshot* currentSnapshot, float interpolation);
     void DrawUITextCommandBuffer(VkCommandBuffer commandBuffer, std::shared_ptr<RenderObject> currentObject, std::shared_ptr<FontManager> fontManager);
 
     static const int MAX_FRAMES_IN_FLIGHT = 3;
@@ -101,20 +336,67 @@ private:
     VkQueue presentQueue;
     VkCommandPool commandPool;
 
-    std::shared_ptr<GraphicsPipeline> m_mainGraphicsPipeline = VK_NULL_HANDLE;
+    //owns the UI pipeline and every scene pass variant, they are all destroyed with it
+    std::shared_ptr<PipelineCache> m_pipelineCache;
+
 	std::shared_ptr<GraphicsPipeline> m_uiGraphicsPipeline = VK_NULL_HANDLE;
 
+    //the state every variant of a scene pass shares, empty for passes the chosen paths don't have, GetScenePipeline throws for those
+    //the g-buffer pass only exists on the deferred path, the depth only and accumulation passes with weighted blended transparency
+    //the pre-pass writes depth from the position streams, custom meshes have no position stream and use their full vertices
+    //the depth equal pass shades only the fragment the pre-pass left, by testing for equal depth without writing it
+    std::array<std::optional<GraphicsPipelineCreateInfo>, static_cast<size_t>(ScenePass::Count)> m_scenePassStates;
+
+
     std::map<std::string, std::shared_ptr<GraphicsBuffer>> vertexBuffers;
     std::map<std::string, std::shared_ptr<GraphicsBuffer>> indexBuffers;
+    std::map<std::string, std::shared_ptr<GraphicsBuffer>> positionBuffers;
 
     std::map<std::string, uint16_t> vertexBufferSizes;
     std::map<std::string, uint16_t> indexBufferSizes;
+    std::map<std::string, MeshLods> m_meshLods;
+
+    //last level each object was drawn at, by handle slot, so a level only changes once it is clearly past the threshold
+    std::vector<uint8_t> m_instanceLods;
+
+    //turns an object's size over its distance into pixels on screen, updated with the camera every frame
+    float m_lodPixelScale = 1.0f;
+
+    //a level is good enough while its error covers less than this many pixels, and has to miss by the hysteresis fraction to change
+    static constexpr float kLodPixelError = 1.0f;
+    static constexpr float kLodHysteresis = 0.1f;
+
+    //the globals, lights, shadows, custom mesh instances, UI globals and UI image instances of every frame in flight, suballocated each frame
+    std::shared_ptr<FrameRingBuffer> m_frameRing = nullptr;
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> m_frameRingDescriptorsDirty{};
+    static constexpr VkDeviceSize kFrameRingCapacity = 256 * 1024;
+
+    //where this frame's data sits in the ring, given as dynamic offsets when the sets are bound
+    uint32_t m_globalInfoOffset = 0;
+    uint32_t m_lightInfoOffset = 0;
+    uint32_t m_shadowInfoOffset = 0;
+    uint32_t m_uiGlobalInfoOffset = 0;
+
+    //start of this frame's custom mesh instances, in the order of the snapshot's custom meshes
+    VkDeviceSize m_customMeshInstanceOffset = 0;
+
+    //every UI image is drawn from this quad, their instances are written to the ring in draw order
+    std::shared_ptr<UIImage> m_uiQuad = nullptr;
+    std::shared_ptr<GraphicsBuffer> m_uiQuadVertexBuffer = nullptr;
+    std::shared_ptr<GraphicsBuffer> m_uiQuadIndexBuffer = nullptr;
+
+    //a UI run is either a range of image instances or a single text object
+    struct UIDraw {
+        std::shared_ptr<RenderObject> textObject = nullptr;
+        uint32_t firstInstance = 0;
+        uint32_t instanceCount = 0;
+    };
 
-	std::vector<std::shared_ptr<GraphicsBuffer>> uniformBuffers;
-	std::vector<std::shared_ptr<GraphicsBuffer>> lightInfoBuffers;
-	std::vector<std::shared_ptr<GraphicsBuffer>> uiUniformBuffers;
+    std::vector<VulkanCommonFunctions::UIInstanceInfo> m_uiImageInstances;
+    std::vector<UIDraw> m_uiDraws;
 
     std::vector<std::string> textureFilePaths;
+    std::mutex m_textureFilePathMutex;
     std::map<std::string, size_t> texturePathToIndex;
     std::map<std::string, std::shared_ptr<TextureImage>> textureImages;
 
@@ -122,8 +404,107 @@ private:
 
     size_t maxLightCount = 200;
 
+    //culls lights against the view before upload, the warning is only printed when the cap is first exceeded
+    LightManager m_lightManager;
+    bool m_lightCapWarningShown = false;
+
+    //reused every frame so interpolating snapshots doesn't allocate
+    std::vector<VulkanCommonFunctions::InstanceInfo> m_interpolatedInstances;
+    std::vector<VulkanCommonFunctions::LightInfo> m_interpolatedLights;
+    std::vector<LightManager::Selection> m_selectedLights;
+    std::vector<VulkanCommonFunctions::LightInfo> m_visibleLights;
+    std::vector<RenderSnapshot::LightSnapshot> m_visibleLightSnapshots;
+    std::vector<VulkanCommonFunctions::InstanceInfo> m_customMeshInstances;
+
+    //instances are split and ordered by view depth every frame before upload
+    RadixSorter m_instanceSorter;
+    std::vector<uint32_t> m_opaqueKeys;
+    std::vector<uint32_t> m_opaqueIndices;
+    std::vector<uint32_t> m_meshTransparentKeys;
+    std::vector<uint32_t> m_meshTransparentIndices;
+    std::vector<uint32_t> m_meshTransparentLods;
+    std::vector<uint32_t> m_sortOrder;
+    std::vector<VulkanCommonFunctions::InstanceInfo> m_sortedInstances;
+
+    //opaque mesh draws first, then the custom meshes from m_firstCustomMeshDraw on, each grouped by variant
+    std::vector<OpaqueDraw> m_opaqueDraws;
+    size_t m_firstCustomMeshDraw = 0;
+
+    //one entry per transparent instance of the frame, merged into runs once sorted
+    std::vector<uint32_t> m_transparentKeys;
+    std::vector<TransparentDraw> m_transparentInstances;
+    std::vector<TransparentDraw> m_transparentDraws;
+
     uint32_t currentFrame = 0;
 
+    //counts every frame drawn, retired buffers are stamped with it
+    uint64_t m_frameNumber = 0;
+
+    struct RetiredBuffer {
+        std::shared_ptr<GraphicsBuffer> buffer = nullptr;
+        uint64_t retiredFrame = 0;
+    };
+
+    std::deque<RetiredBuffer> m_retiredBuffers;
+
+    struct RetiredTexture {
+        std::shared_ptr<TextureImage> texture = nullptr;
+        uint64_t retiredFrame = 0;
+    };
+
+    std::deque<RetiredTexture> m_retiredTextures;
+
+    struct RetiredPipeline {
+        std::shared_ptr<GraphicsPipeline> pipeline = nullptr;
+        uint64_t retiredFrame = 0;
+    };
+
+    std::deque<RetiredPipeline> m_retiredPipelines;
+
+    //replaced descriptor pools free the sets frames in flight are still bound with
+    struct RetiredDescriptorPool {
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        uint64_t retiredFrame = 0;
+    };
+
+    std::deque<RetiredDescriptorPool> m_retiredDescriptorPools;
+
+    struct RetiredDescriptorSetLayout {
+        VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+        uint64_t retiredFrame = 0;
+    };
+
+    std::deque<RetiredDescriptorSetLayout> m_retiredDescriptorSetLayouts;
+
+    //null unless hot reload is on
+    std::shared_ptr<HotReloader> m_hotReloader;
+    bool m_hotReloadEnabled = false;
+
+    struct PendingTextureLoad {
+        uint32_t skippedLevels = 0;
+        std::future<Ktx2File::Texture> texture;
+
+        //set when the load is asked for again before it finished, skippedLevels is then what the next load uses
+        bool reloadRequested = false;
+    };
+
+    std::shared_ptr<TextureResidency> m_textureResidency;
+    std::map<size_t, PendingTextureLoad> m_textureLoads;
+    VkDeviceSize m_textureMemoryBudget = 0;
+
+    //the texture array of each frame's descriptor sets is rewritten when that frame comes around again
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> m_textureDescriptorsDirty{};
+
+    //length of the texture arrays in the layouts, the slots past the last texture hold the fallback
+    //doubles when it runs out, so adding a texture usually only rewrites the descriptors instead of replacing the layouts and pipelines
+    static constexpr uint32_t kMinTextureDescriptorCapacity = 16;
+    uint32_t m_textureDescriptorCapacity = 0;
+
+    //each texture's sampler id by texture index, the shaders read it from the buffer to pick an immutable sampler
+    std::shared_ptr<SamplerCache> m_samplerCache;
+    std::vector<uint32_t> m_textureSamplerIds;
+    std::shared_ptr<GraphicsBuffer> m_textureSamplerIdBuffer;
+
     VkDescriptorSetLayout m_primaryDescriptorSetLayout = VK_NULL_HANDLE;
     VkDescriptorSetLayout m_uiDescriptorSetLayout = VK_NULL_HANDLE;
 
@@ -135,6 +516,42 @@ private:
 
     std::shared_ptr<GraphicsImage> depthImage;
 
+    std::shared_ptr<ShadowAtlas> m_shadowAtlas;
+
+    RenderPath m_renderPath = RenderPath::Forward;
+    std::shared_ptr<DeferredRenderer> m_deferredRenderer;
+
+    TransparencyMode m_transparencyMode = TransparencyMode::Sorted;
+    std::shared_ptr<OrderIndependentTransparency> m_orderIndependentTransparency;
+
+    std::atomic<bool> m_depthPrepassEnabled = false;
+
+    //null when the device can't draw indirectly, m_cullClusters is whether this frame's opaque draws use it
+    std::shared_ptr<ClusterCuller> m_clusterCuller;
+    std::atomic<bool> m_clusterCullingEnabled = true;
+    bool m_cullClusters = false;
+
+    std::atomic<uint32_t> m_textureMipSkip = 0;
+
+    //null when recording on the render thread alone
+    std::shared_ptr<ParallelCommandRecorder> m_commandRecorder;
+    uint32_t m_recordingThreadCount = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+
+    //below this many draws per slice, handing the slice to a thread costs more than recording it
+    static constexpr size_t kMinDrawsPerSlice = 256;
+
+    std::atomic<uint64_t> m_recordedFrameCount = 0;
+    std::atomic<uint64_t> m_recordNanoseconds = 0;
+
+    //null when the device can't write timestamps, the setting its results were gathered under is kept to label them
+    std::shared_ptr<GpuProfiler> m_gpuProfiler;
+    bool m_profiledDepthPrepass = false;
+
+    //camera matrices of the frame being drawn, the lighting pass reconstructs positions with their inverses
+    glm::mat4 m_frameView = glm::mat4(1.0f);
+    glm::mat4 m_frameProjection = glm::mat4(1.0f);
+    glm::vec3 m_frameCameraPosition = glm::vec3(0.0f);
+
     bool framebufferResized = false;
 
     std::array<std::map<std::string, std::shared_ptr<GraphicsBuffer>>, MAX_FRAMES_IN_FLIGHT> instanceBuffers;
@@ -49,6 +49,14 @@ void VulkanWindow::mouseMoveEvent(QMouseEvent* event)
 	}
 }
 
+void VulkanWindow::wheelEvent(QWheelEvent* event)
+{
+	//angleDelta is in eighths of a degree, one notch on most mice is 120
+	QPoint notches = event->angleDelta();
+
+	emit MouseScrolled(notches.x() / 120.0f, notches.y() / 120.0f);
+}
+
 void VulkanWindow::keyPressEvent(QKeyEvent* event)
 {
 	Qt::Key key = static_cast<Qt::Key>(event->key());
@@ -6,6 +6,7 @@
 
 #include <QKeyEvent>
 #include <QMouseEvent>
+#include <QWheelEvent>
 
 class VulkanInterface;
 class Scene;
@@ -22,6 +23,7 @@ public:
 	void mousePressEvent(QMouseEvent* event) override;
 	void mouseMoveEvent(QMouseEvent* event) override;
 	void mouseReleaseEvent(QMouseEvent* event) override;
+	void wheelEvent(QWheelEvent* event) override;
 
 	// Keyboard events
 	void keyPressEvent(QKeyEvent* event) override;
@@ -45,6 +47,7 @@ signals:
 	void MouseButtonUp(Qt::MouseButton releasedButton);
 
 	void MouseMoved(float x, float y);
+	void MouseScrolled(float xDelta, float yDelta);
 
 private:
 	std::shared_ptr<VulkanInterface> m_vulkanInterface;
@@ -15,6 +15,9 @@ void VulkanWindowRenderer::preInitResources()
 void VulkanWindowRenderer::initResources()
 {
 	m_vulkanInterface->InitializeVulkan();
+
+	//does nothing unless the scene was set up for a fixed timestep simulation thread
+	m_scene->StartSimulation();
 }
 
 void VulkanWindowRenderer::initSwapChainResources()
@@ -24,6 +27,7 @@ void VulkanWindowRenderer::initSwapChainResources()
 
 void VulkanWindowRenderer::releaseResources()
 {
+	m_scene->StopSimulation();
 	m_scene->Cleanup();
 	m_vulkanInterface->Cleanup();
 }
@@ -37,10 +41,20 @@ void VulkanWindowRenderer::startNextFrame()
 {
 	m_scene->Update();
 
+	const RenderSnapshot* previousSnapshot = nullptr;
+	const RenderSnapshot* currentSnapshot = nullptr;
+	float interpolation = 1.0f;
+	m_scene->AcquireRenderSnapshots(previousSnapshot, currentSnapshot, interpolation);
+
+	//work queued before the snapshot was published has to run before it's drawn
+	m_scene->ProcessRenderThreadWork();
+
 	if (!m_isShuttingDown)
 	{
-		m_vulkanInterface->DrawFrame(0.0f, m_scene, m_scene->GetFontManager());
+		m_vulkanInterface->DrawFrame(previousSnapshot, currentSnapshot, interpolation, m_scene, m_scene->GetFontManager());
 	}
+
+	m_scene->ReleaseRenderSnapshots();
 }
 
 void VulkanWindowRenderer::Shutdown()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QVulkanWindowRenderer>
+#include <atomic>
 #include "source/Management/Scene.h"
 
 class VulkanInterface;
@@ -22,5 +23,6 @@ private:
 	std::shared_ptr<VulkanInterface> m_vulkanInterface;
 	std::shared_ptr<Scene> m_scene;
 
-	bool m_isShuttingDown = false;
+	//set from whichever thread asks for shutdown
+	std::atomic<bool> m_isShuttingDown = false;
 };
\ No newline at end of file
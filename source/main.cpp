@@ -2,9 +2,20 @@
 #include <memory>
 
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QVulkanInstance>
 
 #include "source/Management/VoltEngine.h"
+#include "source/Benchmarks/ChurnBenchmark.h"
+#include "source/Benchmarks/CustomMeshBenchmark.h"
+#include "source/Benchmarks/SortBenchmark.h"
+#include "source/Benchmarks/TextureBenchmark.h"
+#include "source/Management/TextureConverter.h"
+#include "source/Management/UIAtlas.h"
+#include "source/Management/ShaderCompiler.h"
+#include "source/Tests/SelfTest.h"
+
+#include <filesystem>
 
 bool DebugFilter(QVulkanInstance::DebugMessageSeverityFlags severity, QVulkanInstance::DebugMessageTypeFlags type, const void* message)
 {
@@ -22,6 +33,104 @@ bool DebugFilter(QVulkanInstance::DebugMessageSeverityFlags severity, QVulkanIns
 int main(int argc, char* argv[]) {
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+
+    QCommandLineOption fixedTimestepOption("fixed-timestep", "Run the simulation on its own thread at a fixed timestep.");
+    QCommandLineOption recordOption("record", "Record input and frame times to <file>.", "file");
+    QCommandLineOption replayOption("replay", "Replay the input recorded in <file>, then print frame time statistics and exit.", "file");
+    QCommandLineOption seedOption("seed", "Seed for the scene's random numbers.", "seed");
+    QCommandLineOption churnBenchmarkOption("churn-benchmark", "Spawn and remove <rate> objects per second.", "rate", "10000");
+    QCommandLineOption customMeshBenchmarkOption("custom-mesh-benchmark", "Add <count> custom meshes and print the frame's recording time and VMA allocation count.", "count", "5000");
+    QCommandLineOption deferredOption("deferred", "Light opaque objects with the tiled deferred path instead of forward shading.");
+    QCommandLineOption oitOption("oit", "Blend transparent objects with weighted blended order independent transparency instead of sorting them.");
+    QCommandLineOption depthPrepassOption("depth-prepass", "Start with the depth pre-pass on, P switches it while running.");
+    QCommandLineOption spawnSpheresOption("spawn-spheres", "Mix spheres, which have LOD levels and meshlets, into the demo's spawned cubes and tetrahedrons.");
+    QCommandLineOption noClusterCullingOption("no-cluster-culling", "Draw meshes split into meshlets whole instead of culling their clusters on the GPU.");
+    QCommandLineOption textureMipSkipOption("texture-mip-skip", "Drop the <levels> largest mip levels of every texture to save memory.", "levels", "1");
+    QCommandLineOption textureBudgetOption("texture-budget", "Keep textures within <megabytes> of device memory instead of the budget the driver reports, evicting the least recently drawn ones.", "megabytes", "256");
+    QCommandLineOption recordingThreadsOption("recording-threads", "Record the opaque geometry of busy frames on <count> threads, 1 records everything on the render thread.", "count", "1");
+    QCommandLineOption hotReloadOption("hot-reload", "Recompile shaders and reload textures when their files change while running, compiling needs dxc.");
+    QCommandLineOption convertTextureOption("convert-texture", "Write <image> as a KTX2 texture with mips next to it, then exit.", "image");
+    QCommandLineOption textureFormatOption("texture-format", "Format --convert-texture writes, bc1 or rgba8.", "format", "bc1");
+    QCommandLineOption packUIAtlasOption("pack-ui-atlas", "Pack the small pngs in <directory> into UI atlas pages, print how full they are and exit.", "directory");
+    QCommandLineOption uiAtlasOption("ui-atlas", "Draw UI images listed in the atlas description <file> from its pages.", "file", "textures/ui_atlas.txt");
+    QCommandLineOption textureBenchmarkOption("texture-benchmark", "Compare loading the pngs in <directory> with loading them as BC1 KTX2 textures, print the results and exit.", "directory", "textures");
+    QCommandLineOption buildShadersOption("build-shaders", "Compile the shaders listed in <directory>'s shader_manifest.txt, then exit, needs dxc and spirv-opt.", "directory", "shaders/HLSL");
+    QCommandLineOption shaderConfigOption("shader-config", "Configuration --build-shaders compiles, release optimizes with spirv-opt and strips debug info, debug keeps it.", "config", "release");
+    QCommandLineOption shaderStatsOption("shader-stats", "Print the size and compile time of every shader --build-shaders compiles.");
+    QCommandLineOption sortBenchmarkOption("sort-benchmark", "Time sorting <count> instances by depth, print the results and exit.", "count", "100000");
+    QCommandLineOption selfTestOption("self-test", "Run the checks of the cpu side containers and builders, print any failures and exit.");
+
+    parser.addOption(fixedTimestepOption);
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(seedOption);
+    parser.addOption(churnBenchmarkOption);
+    parser.addOption(customMeshBenchmarkOption);
+    parser.addOption(deferredOption);
+    parser.addOption(oitOption);
+    parser.addOption(depthPrepassOption);
+    parser.addOption(spawnSpheresOption);
+    parser.addOption(noClusterCullingOption);
+    parser.addOption(textureMipSkipOption);
+    parser.addOption(textureBudgetOption);
+    parser.addOption(recordingThreadsOption);
+    parser.addOption(hotReloadOption);
+    parser.addOption(convertTextureOption);
+    parser.addOption(textureFormatOption);
+    parser.addOption(packUIAtlasOption);
+    parser.addOption(uiAtlasOption);
+    parser.addOption(textureBenchmarkOption);
+    parser.addOption(buildShadersOption);
+    parser.addOption(shaderConfigOption);
+    parser.addOption(shaderStatsOption);
+    parser.addOption(sortBenchmarkOption);
+    parser.addOption(selfTestOption);
+    parser.process(app);
+
+    if (parser.isSet(selfTestOption))
+    {
+        return SelfTest::Run() ? 0 : -1;
+    }
+
+    if (parser.isSet(sortBenchmarkOption))
+    {
+        uint32_t seed = parser.isSet(seedOption) ? parser.value(seedOption).toUInt() : 0;
+        SortBenchmark::Run(parser.value(sortBenchmarkOption).toULongLong(), seed);
+        return 0;
+    }
+
+    //the offline converter, runs on its own without a window like the benchmarks
+    if (parser.isSet(convertTextureOption))
+    {
+        TextureConverter::Format format = (parser.value(textureFormatOption) == "rgba8") ? TextureConverter::Format::Rgba8 : TextureConverter::Format::Bc1;
+        return TextureConverter::ConvertFile(parser.value(convertTextureOption).toStdString(), format) ? 0 : -1;
+    }
+
+    if (parser.isSet(buildShadersOption))
+    {
+        ShaderCompiler::Configuration configuration = (parser.value(shaderConfigOption) == "debug") ? ShaderCompiler::Configuration::Debug : ShaderCompiler::Configuration::Release;
+        return ShaderCompiler::BuildAll(parser.value(buildShadersOption).toStdString(), configuration, parser.isSet(shaderStatsOption)) ? 0 : -1;
+    }
+
+    if (parser.isSet(packUIAtlasOption))
+    {
+        return UIAtlas::Build(parser.value(packUIAtlasOption).toStdString()) ? 0 : -1;
+    }
+
+    if (parser.isSet(textureBenchmarkOption))
+    {
+        TextureBenchmark::Run(parser.value(textureBenchmarkOption).toStdString());
+        return 0;
+    }
+
+    if (parser.isSet(recordOption) && parser.isSet(replayOption))
+    {
+        qDebug() << "--record and --replay can't be used together";
+        return -1;
+    }
+
     QVulkanInstance instance;
     instance.setLayers({ "VK_LAYER_KHRONOS_validation" });
     instance.setApiVersion(QVersionNumber(1, 3, 0));
@@ -48,6 +157,79 @@ int main(int argc, char* argv[]) {
 
 	std::shared_ptr<Scene> sceneManager = renderingApp.GetCurrentScene();
 
+    //Vulkan is initialized when the window is shown, so the render path has to be picked before then
+    if (parser.isSet(deferredOption))
+    {
+        renderingApp.GetVulkanInterface()->SetRenderPath(VulkanInterface::RenderPath::Deferred);
+    }
+
+    if (parser.isSet(oitOption))
+    {
+        renderingApp.GetVulkanInterface()->SetTransparencyMode(VulkanInterface::TransparencyMode::WeightedBlended);
+    }
+
+    if (parser.isSet(depthPrepassOption))
+    {
+        renderingApp.GetVulkanInterface()->SetDepthPrepassEnabled(true);
+    }
+
+    if (parser.isSet(noClusterCullingOption))
+    {
+        renderingApp.GetVulkanInterface()->SetClusterCullingEnabled(false);
+    }
+
+    //textures are loaded when Vulkan is initialized, so this has to be set before then too
+    if (parser.isSet(textureMipSkipOption))
+    {
+        renderingApp.GetVulkanInterface()->SetTextureMipSkip(parser.value(textureMipSkipOption).toUInt());
+    }
+
+    if (parser.isSet(textureBudgetOption))
+    {
+        renderingApp.GetVulkanInterface()->SetTextureMemoryBudget(static_cast<VkDeviceSize>(parser.value(textureBudgetOption).toULongLong()) * 1024 * 1024);
+    }
+
+    if (parser.isSet(recordingThreadsOption))
+    {
+        renderingApp.GetVulkanInterface()->SetRecordingThreadCount(std::max(parser.value(recordingThreadsOption).toUInt(), 1u));
+    }
+
+    if (parser.isSet(hotReloadOption))
+    {
+        renderingApp.GetVulkanInterface()->SetHotReloadEnabled(true);
+    }
+
+    //run the simulation on its own thread at a fixed timestep instead of once per rendered frame
+    if (parser.isSet(fixedTimestepOption))
+    {
+        sceneManager->SetFixedTimestepSimulation(true);
+    }
+
+    if (parser.isSet(seedOption))
+    {
+        sceneManager->SetRandomSeed(parser.value(seedOption).toUInt());
+    }
+
+    //UI images are looked up in the atlas as they are added, the default one is optional
+    std::string uiAtlasPath = parser.value(uiAtlasOption).toStdString();
+    if (parser.isSet(uiAtlasOption) || std::filesystem::exists(uiAtlasPath))
+    {
+        sceneManager->LoadUIAtlas(uiAtlasPath);
+    }
+
+    //replays reuse the recorded seed so the same objects get spawned
+    InputRecorder& inputRecorder = renderingApp.GetWindowManager()->GetInputRecorder();
+
+    if (parser.isSet(recordOption))
+    {
+        inputRecorder.StartRecording(parser.value(recordOption).toStdString(), sceneManager->GetRandomSeed());
+    }
+    else if (parser.isSet(replayOption))
+    {
+        inputRecorder.StartReplay(parser.value(replayOption).toStdString());
+        sceneManager->SetRandomSeed(inputRecorder.GetRandomSeed());
+    }
+
     std::shared_ptr<RenderObject> cameraObject = std::make_shared<RenderObject>();
 
     std::shared_ptr<Transform> cameraTransform = cameraObject->AddComponent<Transform>();
@@ -56,10 +238,27 @@ int main(int argc, char* argv[]) {
     cameraTransform->SetScale(glm::vec3(1.0f));
     cameraObject->AddComponent<Camera>();
     cameraObject->AddComponent<FirstPersonController>();
-    cameraObject->AddComponent<DemoBehavior>();
+    std::shared_ptr<DemoBehavior> demoBehavior = cameraObject->AddComponent<DemoBehavior>();
+    demoBehavior->SetSpawnSpheres(parser.isSet(spawnSpheresOption));
     cameraObject->SetTag("Player");
     sceneManager->AddObject(cameraObject);
 
+    if (parser.isSet(churnBenchmarkOption))
+    {
+        std::shared_ptr<RenderObject> benchmarkObject = Scene::CreateObject();
+        std::shared_ptr<ChurnBenchmark> churnBenchmark = benchmarkObject->AddComponent<ChurnBenchmark>();
+        churnBenchmark->SetObjectsPerSecond(parser.value(churnBenchmarkOption).toULongLong());
+        sceneManager->AddObject(benchmarkObject);
+    }
+
+    if (parser.isSet(customMeshBenchmarkOption))
+    {
+        std::shared_ptr<RenderObject> benchmarkObject = Scene::CreateObject();
+        std::shared_ptr<CustomMeshBenchmark> customMeshBenchmark = benchmarkObject->AddComponent<CustomMeshBenchmark>();
+        customMeshBenchmark->SetMeshCount(parser.value(customMeshBenchmarkOption).toULongLong());
+        sceneManager->AddObject(benchmarkObject);
+    }
+
 	renderingApp.BeginRendering();
 
     renderingApp.show();